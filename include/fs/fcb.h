@@ -58,6 +58,22 @@ struct fcb_entry {
 	u16_t fe_data_len; /**< Size of data area in fcb entry*/
 };
 
+/**
+ * @brief FCB index entry structure. This data structure describes an element
+ * appended to the FCB in the RAM index of the FCB.
+ * The index is only available with CONFIG_FCB_INDEX enabled.
+ */
+struct fcb_index_entry {
+	u32_t fie_elem_off;
+	/**< Offset from the start of the sector to beginning of element. */
+
+	u16_t fie_data_len; /**< Size of data area in fcb entry */
+
+	u8_t fie_sector; /**< Index of the element sector in f_sectors */
+
+	u8_t fie_valid; /**< Element has been finished, its CRC is valid */
+};
+
 /**
  * @brief Helper macro for calculating the data offset related to
  * the fcb flash_area start offset.
@@ -101,6 +117,16 @@ struct fcb {
 	struct flash_sector *f_sectors;
 	/**< Array of sectors, must be contiguous */
 
+#if defined(CONFIG_FCB_INDEX)
+	struct fcb_index_entry *f_index;
+	/**< Array of index entries, can be NULL. The newest elements of the
+	 * FCB are described in it, so that walking them does not need to
+	 * read their length and CRC from flash.
+	 */
+
+	u16_t f_index_cnt; /**< Number of elements in index array */
+#endif
+
 	/* Flash circular buffer internal state */
 	struct k_mutex f_mtx;
 	/**< Locking for accessing the FCB data, internal state */
@@ -121,6 +147,18 @@ struct fcb {
 	/**< Flash area used by the fcb instance, , internal state.
 	 * This can be transfer to FCB user
 	 */
+
+#if defined(CONFIG_FCB_INDEX)
+	u16_t f_index_head;
+	/**< Index entry where the next element is added, internal state */
+
+	u16_t f_index_used; /**< Number of index entries used, internal state */
+
+	struct fcb_entry f_index_start;
+	/**< All elements from this location on are in the index,
+	 * internal state
+	 */
+#endif
 };
 
 /**
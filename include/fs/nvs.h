@@ -43,6 +43,10 @@ extern "C" {
  * @param write_block_size Alignment size
  * @param nvs_lock Mutex
  * @param flash_device Flash Device
+ * @param lookup_cache Address of the most recent ATE for each id hash
+ * @param gc_node Node in the list of file systems with a pending erase
+ * @param gc_erase_addr Address of the sector waiting to be erased
+ * @param gc_erase_pending Is a sector waiting to be erased ?
  */
 struct nvs_fs {
 	off_t offset;		/* filesystem offset in flash */
@@ -57,6 +61,14 @@ struct nvs_fs {
 
 	struct k_mutex nvs_lock;
 	struct device *flash_device;
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	u32_t lookup_cache[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+#endif
+#ifdef CONFIG_NVS_GC_DEFERRED
+	sys_snode_t gc_node;
+	u32_t gc_erase_addr;
+	bool gc_erase_pending;
+#endif
 };
 
 /**
@@ -92,6 +104,19 @@ int nvs_init(struct nvs_fs *fs, const char *dev_name);
  */
 int nvs_clear(struct nvs_fs *fs);
 
+/**
+ * @brief nvs_gc_flush
+ *
+ * Erase the sector freed by the last garbage collection if this erase was
+ * deferred to the background and has not run yet. Only does something when
+ * CONFIG_NVS_GC_DEFERRED is enabled.
+ *
+ * @param fs Pointer to file system
+ * @retval 0 Success
+ * @retval -ERRNO errno code if error
+ */
+int nvs_gc_flush(struct nvs_fs *fs);
+
 /**
  * @brief nvs_write
  *
@@ -478,6 +478,14 @@ struct _thread_base {
 
 #endif
 
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	/* In the ready queue of CPU cpu.  Replaces _THREAD_QUEUED, as it
+	 * is protected by that queue's lock and not by the one of the
+	 * other thread states.
+	 */
+	u8_t queued;
+#endif
+
 #ifdef CONFIG_SCHED_CPU_MASK
 	/* "May run on" bits for each CPU */
 	u8_t cpu_mask;
@@ -2352,6 +2360,31 @@ extern int k_queue_merge_slist(struct k_queue *queue, sys_slist_t *list);
  */
 __syscall void *k_queue_get(struct k_queue *queue, k_timeout_t timeout);
 
+/**
+ * @brief Get several elements from a queue.
+ *
+ * This routine removes up to @a max data items from @a queue under a
+ * single lock acquisition and stores their addresses in @a items. The
+ * first word of each data item is reserved for the kernel's use.
+ *
+ * If the queue is empty, the caller waits up to @a timeout for one data
+ * item and then returns.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param queue Address of the queue.
+ * @param items Array to hold the addresses of up to @a max data items.
+ * @param max Maximum number of data items to get.
+ * @param timeout Non-negative waiting period to obtain a data item
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @return Number of data items obtained; 0 if returned without waiting,
+ * or waiting period timed out.
+ */
+__syscall int k_queue_get_many(struct k_queue *queue, void **items, u32_t max,
+			       k_timeout_t timeout);
+
 /**
  * @brief Remove an element from a queue.
  *
@@ -2687,6 +2720,27 @@ struct k_fifo {
 #define k_fifo_get(fifo, timeout) \
 	k_queue_get(&(fifo)->_queue, timeout)
 
+/**
+ * @brief Get several elements from a FIFO queue.
+ *
+ * This routine removes up to @a max data items from @a fifo in a "first
+ * in, first out" manner under a single lock acquisition. The first word
+ * of each data item is reserved for the kernel's use.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param fifo Address of the FIFO queue.
+ * @param items Array to hold the addresses of up to @a max data items.
+ * @param max Maximum number of data items to get.
+ * @param timeout Waiting period to obtain a data item,
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @return Number of data items obtained; 0 if returned without waiting,
+ * or waiting period timed out.
+ */
+#define k_fifo_get_many(fifo, items, max, timeout) \
+	k_queue_get_many(&(fifo)->_queue, items, max, timeout)
+
 /**
  * @brief Query a FIFO queue to see if it has data available.
  *
@@ -3532,6 +3586,20 @@ extern int k_work_poll_cancel(struct k_work_poll *work);
  * Mutex Structure
  * @ingroup mutex_apis
  */
+/**
+ * Mutex contention statistics
+ */
+struct k_mutex_stats {
+	/** Number of times the mutex was locked */
+	u32_t acquisitions;
+	/** Number of lock attempts which found it owned by another thread */
+	u32_t contended;
+	/** Number of contended acquisitions completed without pending */
+	u32_t spin_acquired;
+	/** Total time spent in contended lock attempts, in cycles */
+	u64_t wait_cycles;
+};
+
 struct k_mutex {
 	/** Mutex wait queue */
 	_wait_q_t wait_q;
@@ -3544,6 +3612,11 @@ struct k_mutex {
 	/** Original thread priority */
 	int owner_orig_prio;
 
+#ifdef CONFIG_MUTEX_STATS
+	/** Contention statistics */
+	struct k_mutex_stats stats;
+#endif
+
 	_OBJECT_TRACING_NEXT_PTR(k_mutex)
 	_OBJECT_TRACING_LINKED_FLAG
 };
@@ -3634,6 +3707,18 @@ __syscall int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
  */
 __syscall int k_mutex_unlock(struct k_mutex *mutex);
 
+#ifdef CONFIG_MUTEX_STATS
+/**
+ * @brief Get the contention statistics of a mutex.
+ *
+ * This routine takes a consistent snapshot of the statistics of @a mutex.
+ *
+ * @param mutex Address of the mutex.
+ * @param stats Address of the structure to fill in.
+ */
+void k_mutex_stats_get(struct k_mutex *mutex, struct k_mutex_stats *stats);
+#endif
+
 /**
  * @}
  */
@@ -3971,6 +4056,60 @@ __syscall int k_msgq_put(struct k_msgq *msgq, void *data, k_timeout_t timeout);
  */
 __syscall int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout);
 
+/**
+ * @brief Send several messages to a message queue.
+ *
+ * This routine sends up to @a count messages, stored back to back at
+ * @a data, to message queue @a msgq. The messages are handed to waiting
+ * receivers or copied into the queue under a single lock acquisition,
+ * and the scheduler is invoked at most once.
+ *
+ * If none of the messages fits, the caller waits up to @a timeout for
+ * the first one to be accepted and then returns.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param msgq Address of the message queue.
+ * @param data Pointer to the messages.
+ * @param count Number of messages at @a data.
+ * @param timeout Waiting period to add the first message,
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @return Number of messages sent, which may be less than @a count.
+ * @retval -ENOMSG Returned without waiting or queue purged.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_put_many(struct k_msgq *msgq, const void *data,
+			      u32_t count, k_timeout_t timeout);
+
+/**
+ * @brief Receive several messages from a message queue.
+ *
+ * This routine receives up to @a count messages from message queue
+ * @a msgq in a "first in, first out" manner and stores them back to back
+ * at @a data. All available messages are copied out, and the queue is
+ * refilled from blocked senders, under a single lock acquisition.
+ *
+ * If the queue is empty, the caller waits up to @a timeout for a
+ * message and then returns.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param msgq Address of the message queue.
+ * @param data Address of area to hold up to @a count messages.
+ * @param count Maximum number of messages to receive.
+ * @param timeout Waiting period to receive the first message,
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @return Number of messages received, which may be less than @a count.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_get_many(struct k_msgq *msgq, void *data, u32_t count,
+			      k_timeout_t timeout);
+
 /**
  * @brief Peek/read a message from a message queue.
  *
@@ -4436,14 +4575,31 @@ extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+struct k_mem_slab_cpu_cache {
+	struct k_spinlock lock;
+	char *free_list;
+	u32_t count;
+} __aligned(CONFIG_MEM_SLAB_CPU_CACHE_ALIGN);
+#endif
+
 struct k_mem_slab {
 	_wait_q_t wait_q;
+	struct k_spinlock lock;
 	u32_t num_blocks;
 	size_t block_size;
 	char *buffer;
 	char *free_list;
 	u32_t num_used;
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	/* Set while threads may be pending on wait_q, forces frees
+	 * through the shared free list so waiters get woken up.
+	 */
+	bool waiters;
+	struct k_mem_slab_cpu_cache cpu_cache[CONFIG_MP_NUM_CPUS];
+#endif
+
 	_OBJECT_TRACING_NEXT_PTR(k_mem_slab)
 	_OBJECT_TRACING_LINKED_FLAG
 };
@@ -4568,7 +4724,20 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	/* Blocks stashed in the per-CPU caches are accounted as used
+	 * by the shared free list, but are free from the user's view.
+	 */
+	u32_t cached = 0U;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		cached += slab->cpu_cache[i].count;
+	}
+
+	return slab->num_used - cached;
+#else
 	return slab->num_used;
+#endif
 }
 
 /**
@@ -4583,7 +4752,7 @@ static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - k_mem_slab_num_used_get(slab);
 }
 
 /** @} */
@@ -4625,6 +4794,42 @@ void k_heap_init(struct k_heap *h, void *mem, size_t bytes);
  */
 void *k_heap_alloc(struct k_heap *h, size_t bytes, k_timeout_t timeout);
 
+/**
+ * @brief Allocate aligned memory from a k_heap
+ *
+ * Behaves in all ways like k_heap_alloc(), except that the returned
+ * memory (if available) will have a starting address in memory which
+ * is a multiple of the specified power-of-two alignment value in
+ * bytes.  The resulting memory can be returned to the heap using
+ * k_heap_free().
+ *
+ * @param h Heap from which to allocate
+ * @param align Alignment in bytes, must be a power of two
+ * @param bytes Number of bytes requested
+ * @param timeout How long to wait, or K_NO_WAIT
+ * @return Pointer to memory the caller can now use, or NULL
+ */
+void *k_heap_aligned_alloc(struct k_heap *h, size_t align, size_t bytes,
+			   k_timeout_t timeout);
+
+/**
+ * @brief Resize memory allocated by k_heap_alloc()
+ *
+ * Resizes the block in place where possible, otherwise moves its
+ * contents to a new block as described for sys_heap_realloc().  If
+ * the memory is not available immediately, the call will block for
+ * the specified timeout waiting for memory to be freed.  On failure
+ * NULL is returned and @a ptr remains valid.
+ *
+ * @param h Heap from which the block was allocated
+ * @param ptr Block to resize, or NULL to allocate a new one
+ * @param bytes New size of the block, or 0 to free it
+ * @param timeout How long to wait, or K_NO_WAIT
+ * @return Pointer to the resized block, or NULL
+ */
+void *k_heap_realloc(struct k_heap *h, void *ptr, size_t bytes,
+		     k_timeout_t timeout);
+
 /**
  * @brief Free memory allocated by k_heap_alloc()
  *
@@ -94,6 +94,8 @@ struct _ready_q {
 	struct _priq_rb runq;
 #elif defined(CONFIG_SCHED_MULTIQ)
 	struct _priq_mq runq;
+#elif defined(CONFIG_SCHED_BITMAP)
+	struct _priq_bm runq;
 #endif
 };
 
@@ -128,6 +130,11 @@ struct _cpu {
 	/* True when _current is allowed to context switch */
 	u8_t swap_ok;
 #endif
+
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	/* threads whose home is this CPU */
+	struct _ready_q ready_q;
+#endif
 };
 
 typedef struct _cpu _cpu_t;
@@ -162,11 +169,13 @@ struct z_kernel {
 	s32_t idle; /* Number of ticks for kernel idling */
 #endif
 
+#ifndef CONFIG_SCHED_CPU_QUEUES
 	/*
 	 * ready queue: can be big, keep after small fields, since some
 	 * assembly (e.g. ARC) are limited in the encoding of the offset
 	 */
 	struct _ready_q ready_q;
+#endif
 
 #ifdef CONFIG_FP_SHARING
 	/*
@@ -240,6 +249,10 @@ struct _timeout {
 	sys_dnode_t node;
 	s32_t dticks;
 	_timeout_func_t fn;
+#ifdef CONFIG_TIMEOUT_WHEEL
+	/* absolute expiry tick */
+	u64_t expires;
+#endif
 };
 
 /* kernel spinlock type */
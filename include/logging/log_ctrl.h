@@ -169,6 +169,23 @@ void log_backend_enable(struct log_backend const *const backend,
  */
 void log_backend_disable(struct log_backend const *const backend);
 
+/** @brief Usage statistics of the log message ring. */
+struct log_msg_ring_stats {
+	u32_t size;	/*!< Ring capacity in bytes. */
+	u32_t used;	/*!< Bytes currently claimed. */
+	u32_t max_used;	/*!< Highest number of bytes claimed at once. */
+	u32_t dropped;	/*!< Messages dropped because the ring was full. */
+};
+
+/**
+ * @brief Get usage statistics of the log message ring.
+ *
+ * Only available when CONFIG_LOG_MSG_RING is enabled.
+ *
+ * @param stats Location where the statistics are written.
+ */
+void log_msg_ring_stats_get(struct log_msg_ring_stats *stats);
+
 #if defined(CONFIG_LOG) && !defined(CONFIG_LOG_MINIMAL)
 #define LOG_CORE_INIT() log_core_init()
 #define LOG_INIT() log_init()
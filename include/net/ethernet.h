@@ -126,6 +126,16 @@ enum ethernet_hw_caps {
 
 	/** VLAN Tag stripping */
 	ETHERNET_HW_VLAN_TAG_STRIP	= BIT(14),
+
+	/** TCP segmentation offload, packets with net_pkt_tso_mss() set are
+	 * split by the hardware in segments of that size
+	 */
+	ETHERNET_HW_TX_TSO		= BIT(15),
+
+	/** Large receive offload, the hardware may coalesce received TCP
+	 * segments of a connection in one packet
+	 */
+	ETHERNET_HW_RX_LRO		= BIT(16),
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -1931,6 +1931,26 @@ void net_if_call_link_cb(struct net_if *iface, struct net_linkaddr *lladdr,
  */
 bool net_if_need_calc_rx_checksum(struct net_if *iface);
 
+/**
+ * @brief Check if the network interface splits TCP packets larger than
+ * the MTU in segments itself (TCP segmentation offload).
+ *
+ * @param iface Network interface
+ *
+ * @return True if TCP segmentation is offloaded, false otherwise.
+ */
+bool net_if_tso_supported(struct net_if *iface);
+
+/**
+ * @brief Check if the network interface already coalesces received TCP
+ * segments (large receive offload).
+ *
+ * @param iface Network interface
+ *
+ * @return True if TCP receive coalescing is offloaded, false otherwise.
+ */
+bool net_if_lro_supported(struct net_if *iface);
+
 /**
  * @brief Check if network packet checksum calculation can be avoided or not
  * when sending the packet. For example many ethernet devices support network
@@ -219,6 +219,13 @@ struct net_pkt {
 	u16_t vlan_tci;
 #endif /* CONFIG_NET_VLAN */
 
+#if defined(CONFIG_NET_TCP_TSO)
+	/* Maximum segment size the TCP data of this packet is to be split
+	 * in by the interface, 0 if the packet is a single segment.
+	 */
+	u16_t tso_mss;
+#endif /* CONFIG_NET_TCP_TSO */
+
 #if defined(CONFIG_NET_IPV6)
 	/* Where is the start of the last header before payload data
 	 * in IPv6 packet. This is offset value from start of the IPv6
@@ -694,6 +701,31 @@ static inline u8_t net_pkt_priority(struct net_pkt *pkt)
 
 #endif /* NET_TC_COUNT > 1 */
 
+#if defined(CONFIG_NET_TCP_TSO)
+static inline u16_t net_pkt_tso_mss(struct net_pkt *pkt)
+{
+	return pkt->tso_mss;
+}
+
+static inline void net_pkt_set_tso_mss(struct net_pkt *pkt, u16_t mss)
+{
+	pkt->tso_mss = mss;
+}
+#else
+static inline u16_t net_pkt_tso_mss(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_tso_mss(struct net_pkt *pkt, u16_t mss)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(mss);
+}
+#endif /* CONFIG_NET_TCP_TSO */
+
 #if defined(CONFIG_NET_VLAN)
 static inline u16_t net_pkt_vlan_tag(struct net_pkt *pkt)
 {
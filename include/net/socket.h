@@ -56,6 +56,10 @@ struct zsock_pollfd {
 #define ZSOCK_MSG_PEEK 0x02
 /** zsock_recv/zsock_send: Override operation to non-blocking */
 #define ZSOCK_MSG_DONTWAIT 0x40
+/** zsock_recv: Hand out the packet holding the data instead of copying it,
+ *  see zsock_recv_zc()
+ */
+#define ZSOCK_MSG_ZEROCOPY 0x4000000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -328,6 +332,54 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+struct net_pkt;
+
+/**
+ * @brief Receive data without copying it
+ *
+ * @details
+ * Instead of copying the received data to a buffer, hand out the network
+ * packet holding it. The packet cursor is at the first byte of the data,
+ * which can be read with net_pkt_read() or accessed in place in the packet
+ * fragments. The packet must be given back with zsock_recv_zc_release()
+ * once the data is not used anymore.
+ *
+ * For a SOCK_STREAM socket, all the data remaining in the first received
+ * packet is handed out. For a SOCK_DGRAM socket, the packet holds one
+ * datagram, it is never truncated.
+ *
+ * This is the same as calling zsock_recv() with the
+ * :c:macro:`ZSOCK_MSG_ZEROCOPY` flag and a pointer to a packet pointer as
+ * buffer. It is only supported by native sockets, from kernel mode, and
+ * cannot be combined with :c:macro:`ZSOCK_MSG_PEEK`.
+ *
+ * @param sock Socket to receive from
+ * @param pkt Set to the packet holding the data
+ * @param flags ZSOCK_MSG_DONTWAIT to override operation to non-blocking
+ *
+ * @return Length of the data in the packet, 0 when the peer closed the
+ *         connection or for an empty datagram (no packet is handed out,
+ *         @p pkt is set to NULL for a datagram), or -1 with errno set.
+ */
+static inline ssize_t zsock_recv_zc(int sock, struct net_pkt **pkt, int flags)
+{
+	return zsock_recv(sock, pkt, sizeof(*pkt), flags | ZSOCK_MSG_ZEROCOPY);
+}
+
+/**
+ * @brief Give back a packet received with zsock_recv_zc()
+ *
+ * @details
+ * For a SOCK_STREAM socket, the receive window is only opened again for the
+ * handed out data at this point, so packets should not be held longer than
+ * needed.
+ *
+ * @param sock Socket the packet was received from
+ * @param pkt Packet handed out by zsock_recv_zc()
+ * @param len Length returned by zsock_recv_zc() for this packet
+ */
+void zsock_recv_zc_release(int sock, struct net_pkt *pkt, size_t len);
+
 /**
  * @brief Control blocking/non-blocking mode of a socket
  *
@@ -703,6 +755,7 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 
 #define MSG_PEEK ZSOCK_MSG_PEEK
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_ZEROCOPY ZSOCK_MSG_ZEROCOPY
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
@@ -60,4 +60,31 @@ void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread);
 void z_priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread);
 struct k_thread *z_priq_mq_best(struct _priq_mq *pq);
 
+/* Bitmap-indexed multi-queue.  Like the multi-queue above there is one
+ * list per priority, but a two-level bitmap index removes the limit of
+ * 32 priorities, and the best thread is cached and updated
+ * incrementally on add/remove so that looking it up is a single load.
+ * With 32 or fewer priorities the second index level compiles out.
+ */
+#define Z_PRIQ_BM_NUM_PRIOS (CONFIG_NUM_COOP_PRIORITIES + \
+			     CONFIG_NUM_PREEMPT_PRIORITIES + 1)
+#define Z_PRIQ_BM_NUM_WORDS ((Z_PRIQ_BM_NUM_PRIOS + 31) / 32)
+
+struct _priq_bm {
+	struct k_thread *best; /* head of highest priority list, or NULL */
+#if Z_PRIQ_BM_NUM_WORDS > 1
+	unsigned int summary; /* bit 1<<i set if bitmask[i] is non-zero */
+#endif
+	unsigned int bitmask[Z_PRIQ_BM_NUM_WORDS];
+	sys_dlist_t queues[Z_PRIQ_BM_NUM_PRIOS];
+};
+
+void z_priq_bm_add(struct _priq_bm *pq, struct k_thread *thread);
+void z_priq_bm_remove(struct _priq_bm *pq, struct k_thread *thread);
+
+static inline struct k_thread *z_priq_bm_best(struct _priq_bm *pq)
+{
+	return pq->best;
+}
+
 #endif /* ZEPHYR_INCLUDE_SCHED_PRIQ_H_ */
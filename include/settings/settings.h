@@ -333,6 +333,44 @@ int settings_save_one(const char *name, const void *value, size_t val_len);
  */
 int settings_delete(const char *name);
 
+/**
+ * Start a batch of settings changes.
+ *
+ * Until @ref settings_batch_commit or @ref settings_batch_abort is called,
+ * settings saved or deleted by the calling thread, with
+ * @ref settings_save_one, @ref settings_delete or @ref settings_save, are
+ * buffered in RAM instead of being written to the storage back-end. Other
+ * threads using the settings subsystem block until the batch ends. When the
+ * buffer of CONFIG_SETTINGS_BATCH_BUF_SIZE bytes is full, saving returns
+ * -ENOMEM and the batch keeps the previous value of the setting. The
+ * back-end csi_save_start and csi_save_end calls of @ref settings_save are
+ * made once, around the writes of the commit.
+ *
+ * Requires CONFIG_SETTINGS_BATCH.
+ *
+ * @return 0 on success, -EBUSY if the calling thread already has a batch open.
+ */
+int settings_batch_begin(void);
+
+/**
+ * Write the settings changes of the batch to the storage back-end and end
+ * the batch.
+ *
+ * With CONFIG_SETTINGS_BATCH_JOURNAL the batch is first stored as a journal
+ * entry, so a batch interrupted by a reset is completed by
+ * @ref settings_subsys_init. This doubles the data written by the commit.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int settings_batch_commit(void);
+
+/**
+ * Discard the settings changes of the batch and end the batch.
+ *
+ * @return 0 on success, -EINVAL if the calling thread has no batch open.
+ */
+int settings_batch_abort(void);
+
 /**
  * Call commit for all settings handler. This should apply all
  * settings which has been set, but not applied yet.
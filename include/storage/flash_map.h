@@ -145,6 +145,44 @@ int flash_area_write(const struct flash_area *fa, off_t off, const void *src,
  */
 int flash_area_erase(const struct flash_area *fa, off_t off, size_t len);
 
+/**
+ * @brief Flush flash area
+ *
+ * Write the data written to the flash area and still held by the flash map
+ * cache to the device. Does nothing unless CONFIG_FLASH_MAP_CACHE_WRITE_BACK
+ * is enabled. flash_area_close() flushes the flash area too.
+ *
+ * @param[in] fa Flash area
+ *
+ * @return  0 on success, negative errno code on fail.
+ */
+int flash_area_flush(const struct flash_area *fa);
+
+/**
+ * @brief Flash map cache statistics
+ */
+struct flash_area_cache_stats {
+	u32_t hits; /** page lookups served by the cache */
+	u32_t misses; /** page lookups that read the page from the device */
+	u32_t evictions; /** pages replaced to make room for another one */
+	u32_t write_backs; /** device writes made to flush dirty data */
+};
+
+/**
+ * @brief Get flash map cache statistics
+ *
+ * The statistics cover all flash areas. Only available with
+ * CONFIG_FLASH_MAP_CACHE enabled.
+ *
+ * @param[out] stats Statistics
+ */
+void flash_area_cache_stats_get(struct flash_area_cache_stats *stats);
+
+/**
+ * @brief Reset flash map cache statistics
+ */
+void flash_area_cache_stats_reset(void);
+
 /**
  * @brief Get write block size of the flash area
  *
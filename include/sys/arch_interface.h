@@ -654,6 +654,30 @@ size_t arch_user_string_nlen(const char *s, size_t maxsize, int *err);
 
 /** @} */
 
+/**
+ * @defgroup arch-net Architecture-specific networking APIs
+ * @ingroup arch-interface
+ * @{
+ */
+
+#ifdef CONFIG_ARCH_HAS_NET_CHKSUM
+/**
+ * @brief Add data to an Internet checksum sum
+ *
+ * Compute the 16-bit one's complement sum of the data, read as big endian
+ * 16-bit words, and add it to sum. An odd trailing byte is padded with zero.
+ * The data may have any alignment.
+ *
+ * @param sum One's complement sum so far, in host byte order
+ * @param data Data to add
+ * @param len Length of the data in bytes
+ * @return New sum in host byte order, 0 only if sum and data are all zero
+ */
+u16_t arch_net_chksum(u16_t sum, const u8_t *data, size_t len);
+#endif /* CONFIG_ARCH_HAS_NET_CHKSUM */
+
+/** @} */
+
 /**
  * @defgroup arch-benchmarking Architecture-specific benchmarking globals
  * @ingroup arch-interface
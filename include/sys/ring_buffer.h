@@ -23,6 +23,11 @@ extern "C" {
 
 /**
  * @brief A structure to represent a ring buffer
+ *
+ * The head index is only written by the consumer and the tail index only
+ * by the producer, so one producer and one consumer may access a ring
+ * buffer concurrently (e.g. an ISR and a thread, or threads on different
+ * CPUs) without any locking.
  */
 struct ring_buf {
 	u32_t head;	 /**< Index in buf for the head element */
@@ -33,6 +38,9 @@ struct ring_buf {
 						   * number of failed put
 						   * attempts.
 						   */
+			u32_t reserved_tail; /**< Tail claimed by
+					       * ring_buf_item_put_mp().
+					       */
 		} item_mode;
 		struct ring_buf_misc_byte_mode {
 			u32_t tmp_tail;
@@ -156,6 +164,52 @@ static inline void ring_buf_init(struct ring_buf *buf, u32_t size, void *data)
 	}
 }
 
+/** @brief Read a head or tail index updated by the other side.
+ *
+ * @note Function for internal use.
+ *
+ * Data read from the ring buffer after this call is guaranteed to be at
+ * least as recent as the index.
+ *
+ * @param idx Address of the index.
+ *
+ * @return Index value.
+ */
+static inline u32_t z_ring_buf_idx_get(const u32_t *idx)
+{
+#ifdef CONFIG_SMP
+	return __atomic_load_n(idx, __ATOMIC_ACQUIRE);
+#else
+	/* Only ISRs on this CPU can race with us: keep the compiler from
+	 * tearing or caching the load and from hoisting data accesses.
+	 */
+	u32_t val = __atomic_load_n(idx, __ATOMIC_RELAXED);
+
+	compiler_barrier();
+	return val;
+#endif
+}
+
+/** @brief Publish a head or tail index to the other side.
+ *
+ * @note Function for internal use.
+ *
+ * Data written to the ring buffer before this call is visible to the
+ * other side once it reads the new index.
+ *
+ * @param idx Address of the index.
+ * @param val New index value.
+ */
+static inline void z_ring_buf_idx_set(u32_t *idx, u32_t val)
+{
+#ifdef CONFIG_SMP
+	__atomic_store_n(idx, val, __ATOMIC_RELEASE);
+#else
+	compiler_barrier();
+	__atomic_store_n(idx, val, __ATOMIC_RELAXED);
+#endif
+}
+
 /** @brief Determine free space based on ring buffer parameters.
  *
  * @note Function for internal use.
@@ -186,12 +240,17 @@ static inline u32_t z_ring_buf_custom_space_get(u32_t size, u32_t head,
  */
 static inline int ring_buf_is_empty(struct ring_buf *buf)
 {
-	return (buf->head == buf->tail);
+	return (z_ring_buf_idx_get(&buf->head) ==
+		z_ring_buf_idx_get(&buf->tail));
 }
 
 /**
  * @brief Reset ring buffer state.
  *
+ * @warning
+ * Neither the producer nor the consumer may access the ring buffer while
+ * it is being reset.
+ *
  * @param buf Address of ring buffer.
  */
 static inline void ring_buf_reset(struct ring_buf *buf)
@@ -210,7 +269,9 @@ static inline void ring_buf_reset(struct ring_buf *buf)
  */
 static inline u32_t ring_buf_space_get(struct ring_buf *buf)
 {
-	return z_ring_buf_custom_space_get(buf->size, buf->head, buf->tail);
+	return z_ring_buf_custom_space_get(buf->size,
+					   z_ring_buf_idx_get(&buf->head),
+					   z_ring_buf_idx_get(&buf->tail));
 }
 
 /**
@@ -236,7 +297,9 @@ static inline u32_t ring_buf_capacity_get(struct ring_buf *buf)
  * @warning
  * Use cases involving multiple writers to the ring buffer must prevent
  * concurrent write operations, either by preventing all writers from
- * being preempted or by using a mutex to govern writes to the ring buffer.
+ * being preempted or by using a mutex to govern writes to the ring buffer,
+ * or use ring_buf_item_put_mp() instead. A single writer may run
+ * concurrently with a single reader.
  *
  * @param buf Address of ring buffer.
  * @param type Data item's type identifier (application specific).
@@ -250,6 +313,32 @@ static inline u32_t ring_buf_capacity_get(struct ring_buf *buf)
 int ring_buf_item_put(struct ring_buf *buf, u16_t type, u8_t value,
 		      u32_t *data, u8_t size32);
 
+/**
+ * @brief Write a data item to a ring buffer shared by several writers.
+ *
+ * This routine works like ring_buf_item_put(), but any number of writers,
+ * in threads or ISRs and on any CPU, may call it concurrently without
+ * further locking. Writers claim space with an atomic compare-and-swap and
+ * publish their items in the order the space was claimed; interrupts are
+ * locked on the local CPU in between so that a writer can never be
+ * preempted by another one waiting for it.
+ *
+ * @warning
+ * All writers of the ring buffer must use this routine; a single reader
+ * may use ring_buf_item_get() concurrently.
+ *
+ * @param buf Address of ring buffer.
+ * @param type Data item's type identifier (application specific).
+ * @param value Data item's integer value (application specific).
+ * @param data Address of data item.
+ * @param size32 Data item size (number of 32-bit words).
+ *
+ * @retval 0 Data item was written.
+ * @retval -EMSGSIZE Ring buffer has insufficient free space.
+ */
+int ring_buf_item_put_mp(struct ring_buf *buf, u16_t type, u8_t value,
+			 u32_t *data, u8_t size32);
+
 /**
  * @brief Read a data item from a ring buffer.
  *
@@ -261,6 +350,7 @@ int ring_buf_item_put(struct ring_buf *buf, u16_t type, u8_t value,
  * Use cases involving multiple reads of the ring buffer must prevent
  * concurrent read operations, either by preventing all readers from
  * being preempted or by using a mutex to govern reads to the ring buffer.
+ * A single reader may run concurrently with a single writer.
  *
  * @param buf Address of ring buffer.
  * @param type Area to store the data item's type identifier.
@@ -288,6 +378,7 @@ int ring_buf_item_get(struct ring_buf *buf, u16_t *type, u8_t *value,
  * Use cases involving multiple writers to the ring buffer must prevent
  * concurrent write operations, either by preventing all writers from
  * being preempted or by using a mutex to govern writes to the ring buffer.
+ * A single writer may run concurrently with a single reader.
  *
  * @warning
  * Ring buffer instance should not mix byte access and item access
@@ -310,6 +401,7 @@ u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size);
  * Use cases involving multiple writers to the ring buffer must prevent
  * concurrent write operations, either by preventing all writers from
  * being preempted or by using a mutex to govern writes to the ring buffer.
+ * A single writer may run concurrently with a single reader.
  *
  * @warning
  * Ring buffer instance should not mix byte access and item access
@@ -332,6 +424,7 @@ int ring_buf_put_finish(struct ring_buf *buf, u32_t size);
  * Use cases involving multiple writers to the ring buffer must prevent
  * concurrent write operations, either by preventing all writers from
  * being preempted or by using a mutex to govern writes to the ring buffer.
+ * A single writer may run concurrently with a single reader.
  *
  * @warning
  * Ring buffer instance should not mix byte access and item access
@@ -356,6 +449,7 @@ u32_t ring_buf_put(struct ring_buf *buf, const u8_t *data, u32_t size);
  * Use cases involving multiple reads of the ring buffer must prevent
  * concurrent read operations, either by preventing all readers from
  * being preempted or by using a mutex to govern reads to the ring buffer.
+ * A single reader may run concurrently with a single writer.
  *
  * @warning
  * Ring buffer instance should not mix byte access and item access
@@ -378,6 +472,7 @@ u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size);
  * Use cases involving multiple reads of the ring buffer must prevent
  * concurrent read operations, either by preventing all readers from
  * being preempted or by using a mutex to govern reads to the ring buffer.
+ * A single reader may run concurrently with a single writer.
  *
  * @warning
  * Ring buffer instance should not mix byte access and  item mode
@@ -400,6 +495,7 @@ int ring_buf_get_finish(struct ring_buf *buf, u32_t size);
  * Use cases involving multiple reads of the ring buffer must prevent
  * concurrent read operations, either by preventing all readers from
  * being preempted or by using a mutex to govern reads to the ring buffer.
+ * A single reader may run concurrently with a single writer.
  *
  * @warning
  * Ring buffer instance should not mix byte access and  item mode
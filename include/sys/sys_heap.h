@@ -39,6 +39,11 @@
  * extreme values results in an effectively linear search of the
  * list), objectively fast (~hundred instructions) and and amenable to
  * locked operation.
+ *
+ * Optional small object front end.  With
+ * CONFIG_SYS_HEAP_SMALL_OBJECTS, requests of up to 128 bytes are
+ * served in constant time from per-size-class slabs carved from the
+ * heap, without searching or splitting free chunks.
  */
 
 /* Note: the init_mem/bytes fields are for the static initializer to
@@ -61,6 +66,26 @@ struct z_heap_stress_result {
 	u64_t accumulated_in_use_bytes;
 };
 
+/**
+ * @brief sys_heap runtime statistics
+ *
+ * All sizes are in bytes and include the per-chunk header overhead,
+ * except for @a max_free_bytes which is the size of the largest
+ * allocation that could currently succeed.
+ */
+struct sys_heap_runtime_stats {
+	/** Memory in use, including allocator metadata */
+	size_t allocated_bytes;
+	/** Memory in free chunks */
+	size_t free_bytes;
+	/** Free blocks held by the small object front end */
+	size_t cached_bytes;
+	/** Largest block that can be allocated right now */
+	size_t max_free_bytes;
+	/** Percentage of free memory outside the largest free chunk */
+	u32_t fragmentation;
+};
+
 /** @brief Initialize sys_heap
  *
  * Initializes a sys_heap struct to manage the specified memory.
@@ -76,7 +101,7 @@ void sys_heap_init(struct sys_heap *h, void *mem, size_t bytes);
  * Returns a pointer to a block of unused memory in the heap.  This
  * memory will not otherwise be used until it is freed with
  * sys_heap_free().  If no memory can be allocated, NULL will be
- * returned.
+ * returned.  The block is aligned to 8 bytes.
  *
  * @note The sys_heap implementation is not internally synchronized.
  * No two sys_heap functions should operate on the same heap at the
@@ -88,6 +113,62 @@ void sys_heap_init(struct sys_heap *h, void *mem, size_t bytes);
  */
 void *sys_heap_alloc(struct sys_heap *h, size_t bytes);
 
+/** @brief Allocate aligned memory from a sys_heap
+ *
+ * Behaves in all ways like sys_heap_alloc(), except that the returned
+ * memory (if available) will have a starting address in memory which
+ * is a multiple of the specified power-of-two alignment value in
+ * bytes.  The resulting memory can be returned to the heap using
+ * sys_heap_free().  Only the padding actually needed to reach the
+ * alignment is consumed, the rest is given back to the heap.
+ *
+ * @param h Heap from which to allocate
+ * @param align Alignment in bytes, must be a power of two
+ * @param bytes Number of bytes requested
+ * @return Pointer to memory the caller can now use
+ */
+void *sys_heap_aligned_alloc(struct sys_heap *h, size_t align, size_t bytes);
+
+/** @brief Expand the size of an existing allocation
+ *
+ * Returns a pointer to a region of memory of the requested size
+ * holding the contents of the block at @a ptr, up to the smaller of
+ * the two sizes.  Where possible the block is resized in place: it
+ * shrinks by giving its tail back to the heap, and grows by absorbing
+ * a free chunk directly after it.  Only when that is not possible is
+ * a new block allocated, the data copied and the old block freed.
+ * Note that in that case the alignment of a block obtained from
+ * sys_heap_aligned_alloc() is not preserved, use
+ * sys_heap_aligned_realloc() for such blocks.
+ *
+ * As with ISO C realloc(), a NULL @a ptr behaves like
+ * sys_heap_alloc(), a zero @a bytes frees @a ptr and returns NULL,
+ * and on failure NULL is returned and @a ptr is left untouched.
+ *
+ * @param h Heap from which to allocate
+ * @param ptr Original pointer returned from a previous allocation
+ * @param bytes Number of bytes requested for the new block
+ * @return Pointer to memory the caller can now use, or NULL
+ */
+void *sys_heap_realloc(struct sys_heap *h, void *ptr, size_t bytes);
+
+/** @brief Expand the size of an existing allocation, keeping it aligned
+ *
+ * Behaves in all ways like sys_heap_realloc(), except that the
+ * returned memory (if available) will have a starting address in
+ * memory which is a multiple of the specified power-of-two alignment
+ * value in bytes, whether or not the block had to move.  A block which
+ * isn't aligned yet always moves.
+ *
+ * @param h Heap from which to allocate
+ * @param ptr Original pointer returned from a previous allocation
+ * @param align Alignment in bytes, must be a power of two
+ * @param bytes Number of bytes requested for the new block
+ * @return Pointer to memory the caller can now use, or NULL
+ */
+void *sys_heap_aligned_realloc(struct sys_heap *h, void *ptr,
+			       size_t align, size_t bytes);
+
 /** @brief Free memory into a sys_heap
  *
  * De-allocates a pointer to memory previously returned from
@@ -118,6 +199,22 @@ void sys_heap_free(struct sys_heap *h, void *mem);
  */
 bool sys_heap_validate(struct sys_heap *h);
 
+/** @brief Get sys_heap runtime statistics
+ *
+ * Reports how much of the heap is allocated and free, the largest
+ * block that can currently be allocated and how fragmented the free
+ * memory is.  Requires CONFIG_SYS_HEAP_RUNTIME_STATS.
+ *
+ * @note Like the rest of the sys_heap API this is not synchronized,
+ * the caller must hold the lock protecting the heap.
+ *
+ * @param h Heap to inspect
+ * @param stats Struct into which to store the statistics
+ * @return 0 on success, -EINVAL if a parameter is NULL
+ */
+int sys_heap_runtime_stats_get(struct sys_heap *h,
+			       struct sys_heap_runtime_stats *stats);
+
 /** @brief sys_heap stress test rig
  *
  * Test rig for heap allocation validation.  This will loop for @a
@@ -26,7 +26,9 @@ static int statics_init(struct device *unused)
 
 SYS_INIT(statics_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
-void *k_heap_alloc(struct k_heap *h, size_t bytes, k_timeout_t timeout)
+/* An alignment of zero takes the plain sys_heap_alloc() path */
+static void *heap_alloc(struct k_heap *h, size_t align, size_t bytes,
+			k_timeout_t timeout)
 {
 	s64_t now, end = z_timeout_end_calc(timeout);
 	void *ret = NULL;
@@ -35,7 +37,11 @@ void *k_heap_alloc(struct k_heap *h, size_t bytes, k_timeout_t timeout)
 	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
 
 	while (ret == NULL) {
-		ret = sys_heap_alloc(&h->heap, bytes);
+		if (align != 0) {
+			ret = sys_heap_aligned_alloc(&h->heap, align, bytes);
+		} else {
+			ret = sys_heap_alloc(&h->heap, bytes);
+		}
 
 		now = z_tick_get();
 		if ((ret != NULL) || ((end - now) <= 0)) {
@@ -51,6 +57,51 @@ void *k_heap_alloc(struct k_heap *h, size_t bytes, k_timeout_t timeout)
 	return ret;
 }
 
+void *k_heap_aligned_alloc(struct k_heap *h, size_t align, size_t bytes,
+			   k_timeout_t timeout)
+{
+	return heap_alloc(h, align, bytes, timeout);
+}
+
+void *k_heap_alloc(struct k_heap *h, size_t bytes, k_timeout_t timeout)
+{
+	return heap_alloc(h, 0, bytes, timeout);
+}
+
+void *k_heap_realloc(struct k_heap *h, void *ptr, size_t bytes,
+		     k_timeout_t timeout)
+{
+	s64_t now, end = z_timeout_end_calc(timeout);
+	void *ret = NULL;
+	k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
+
+	while (ret == NULL) {
+		ret = sys_heap_realloc(&h->heap, ptr, bytes);
+
+		now = z_tick_get();
+		if ((ret != NULL) || (bytes == 0) || ((end - now) <= 0)) {
+			break;
+		}
+
+		(void) z_pend_curr(&h->lock, key, &h->wait_q,
+				   K_TICKS(end - now));
+		key = k_spin_lock(&h->lock);
+	}
+
+	/* Shrinking, moving or freeing the block may have made room
+	 * for waiters
+	 */
+	if ((ret != NULL || bytes == 0) && z_unpend_all(&h->wait_q) != 0) {
+		z_reschedule(&h->lock, key);
+	} else {
+		k_spin_unlock(&h->lock, key);
+	}
+
+	return ret;
+}
+
 void k_heap_free(struct k_heap *h, void *mem)
 {
 	k_spinlock_key_t key = k_spin_lock(&h->lock);
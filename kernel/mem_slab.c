@@ -14,8 +14,7 @@
 #include <ksched.h>
 #include <init.h>
 #include <sys/check.h>
-
-static struct k_spinlock lock;
+#include <string.h>
 
 #ifdef CONFIG_OBJECT_TRACING
 struct k_mem_slab *_trace_list_k_mem_slab;
@@ -64,6 +63,11 @@ static int init_mem_slab_module(struct device *dev)
 	ARG_UNUSED(dev);
 
 	Z_STRUCT_SECTION_FOREACH(k_mem_slab, slab) {
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+		__ASSERT(((uintptr_t)slab->cpu_cache &
+			  (CONFIG_MEM_SLAB_CPU_CACHE_ALIGN - 1)) == 0,
+			 "Slab %p caches not aligned", slab);
+#endif
 		rc = create_free_list(slab);
 		if (rc < 0) {
 			goto out;
@@ -88,6 +92,10 @@ int k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	slab->block_size = block_size;
 	slab->buffer = buffer;
 	slab->num_used = 0U;
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	slab->waiters = false;
+	(void)memset(slab->cpu_cache, 0, sizeof(slab->cpu_cache));
+#endif
 	rc = create_free_list(slab);
 	if (rc < 0) {
 		goto out;
@@ -101,48 +109,313 @@ out:
 	return rc;
 }
 
+/* Hand a block back to the shared free list, or directly to the
+ * first pending thread.  Returns true if a thread has been readied,
+ * in which case the caller needs to reschedule.  Called with the
+ * slab lock held.
+ */
+static bool slab_release_locked(struct k_mem_slab *slab, char *block)
+{
+	struct k_thread *pending_thread = z_unpend_first_thread(&slab->wait_q);
+
+	if (pending_thread != NULL) {
+		z_thread_return_value_set_with_data(pending_thread, 0, block);
+		z_ready_thread(pending_thread);
+		return true;
+	}
+
+	*(char **)block = slab->free_list;
+	slab->free_list = block;
+	slab->num_used--;
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	slab->waiters = false;
+#endif
+	return false;
+}
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+/*
+ * Per-CPU block caches.
+ *
+ * Each CPU owns a small LIFO of free blocks per slab, protected by its
+ * own spinlock which in the common case is only ever taken by its
+ * owning CPU.  Blocks sitting in a cache are accounted as used by the
+ * shared free list.  Blocks move between the caches and the shared
+ * free list in batches, without ever holding the slab lock and a cache
+ * lock at the same time except when an allocator that found the
+ * shared list empty steals from the caches of other CPUs, which always
+ * takes the slab lock first.
+ *
+ * An allocator about to steal sets slab->waiters before inspecting the
+ * caches and keeps the slab lock held until it pends, so any block
+ * freed into a cache after it has been inspected sees the flag and is
+ * released through the shared free list instead, waking the waiter.
+ */
+
+#define CACHE_BATCH (CONFIG_MEM_SLAB_CPU_CACHE_SIZE / 2)
+
+/* Static slabs are laid out back to back in the _k_mem_slab_area
+ * section, so the caches of each slab only start on a fresh cache
+ * line if the whole object is a multiple of the alignment.
+ */
+BUILD_ASSERT(offsetof(struct k_mem_slab, cpu_cache) %
+	     CONFIG_MEM_SLAB_CPU_CACHE_ALIGN == 0,
+	     "Per-CPU slab caches not aligned in struct k_mem_slab");
+BUILD_ASSERT(sizeof(struct k_mem_slab) %
+	     CONFIG_MEM_SLAB_CPU_CACHE_ALIGN == 0,
+	     "struct k_mem_slab size not a multiple of the cache alignment");
+
+static inline struct k_mem_slab_cpu_cache *cache_lock(struct k_mem_slab *slab,
+						      unsigned int *irq,
+						      k_spinlock_key_t *key)
+{
+	struct k_mem_slab_cpu_cache *cache;
+
+	/* Lock out interrupts first to pin ourselves to this CPU */
+	*irq = arch_irq_lock();
+	cache = &slab->cpu_cache[_current_cpu->id];
+	*key = k_spin_lock(&cache->lock);
+
+	return cache;
+}
+
+static inline void cache_unlock(struct k_mem_slab_cpu_cache *cache,
+				unsigned int irq, k_spinlock_key_t key)
+{
+	k_spin_unlock(&cache->lock, key);
+	arch_irq_unlock(irq);
+}
+
+static inline char *cache_pop(struct k_mem_slab_cpu_cache *cache)
+{
+	char *block = cache->free_list;
+
+	cache->free_list = *(char **)block;
+	cache->count--;
+
+	return block;
+}
+
+static inline void cache_push(struct k_mem_slab_cpu_cache *cache, char *block)
+{
+	*(char **)block = cache->free_list;
+	cache->free_list = block;
+	cache->count++;
+}
+
+/* Return a detached chain of blocks to the shared free list */
+static void cache_chain_release(struct k_mem_slab *slab, char *chain)
+{
+	k_spinlock_key_t key = k_spin_lock(&slab->lock);
+	bool resched = false;
+
+	while (chain != NULL) {
+		char *block = chain;
+
+		chain = *(char **)chain;
+		resched |= slab_release_locked(slab, block);
+	}
+
+	if (resched) {
+		z_reschedule(&slab->lock, key);
+	} else {
+		k_spin_unlock(&slab->lock, key);
+	}
+}
+
+static bool cache_alloc(struct k_mem_slab *slab, void **mem)
+{
+	struct k_mem_slab_cpu_cache *cache;
+	k_spinlock_key_t key;
+	unsigned int irq;
+	bool ret = false;
+
+	cache = cache_lock(slab, &irq, &key);
+	if (cache->count != 0U) {
+		*mem = cache_pop(cache);
+		ret = true;
+	}
+	cache_unlock(cache, irq, key);
+
+	return ret;
+}
+
+static bool cache_free(struct k_mem_slab *slab, char *block)
+{
+	struct k_mem_slab_cpu_cache *cache;
+	k_spinlock_key_t key;
+	unsigned int irq;
+	char *chain = NULL;
+
+	cache = cache_lock(slab, &irq, &key);
+	if (slab->waiters) {
+		cache_unlock(cache, irq, key);
+		return false;
+	}
+
+	if (cache->count >= CONFIG_MEM_SLAB_CPU_CACHE_SIZE) {
+		/* Full, detach a batch to drain to the shared list */
+		for (int i = 0; i < CACHE_BATCH; i++) {
+			char *b = cache_pop(cache);
+
+			*(char **)b = chain;
+			chain = b;
+		}
+	}
+	cache_push(cache, block);
+	cache_unlock(cache, irq, key);
+
+	if (chain != NULL) {
+		cache_chain_release(slab, chain);
+	}
+
+	return true;
+}
+
+/* Move a batch of blocks taken off the shared free list into the
+ * cache of the current CPU, unless threads started waiting on the
+ * slab in the meantime.
+ */
+static void cache_refill(struct k_mem_slab *slab, char *chain)
+{
+	struct k_mem_slab_cpu_cache *cache;
+	k_spinlock_key_t key;
+	unsigned int irq;
+
+	cache = cache_lock(slab, &irq, &key);
+	if (!slab->waiters) {
+		while (chain != NULL) {
+			char *block = chain;
+
+			chain = *(char **)chain;
+			cache_push(cache, block);
+		}
+	}
+	cache_unlock(cache, irq, key);
+
+	if (chain != NULL) {
+		cache_chain_release(slab, chain);
+	}
+}
+
+/* Take one block from any CPU cache, to be put on the (empty) shared
+ * free list.  Called with the slab lock held.
+ */
+static char *cache_steal_locked(struct k_mem_slab *slab)
+{
+	char *block = NULL;
+
+	slab->waiters = true;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS && block == NULL; i++) {
+		struct k_mem_slab_cpu_cache *cache = &slab->cpu_cache[i];
+		k_spinlock_key_t key = k_spin_lock(&cache->lock);
+
+		if (cache->count != 0U) {
+			block = cache_pop(cache);
+		}
+		k_spin_unlock(&cache->lock, key);
+	}
+
+	if (block != NULL) {
+		*(char **)block = NULL;
+		if (z_waitq_head(&slab->wait_q) == NULL) {
+			slab->waiters = false;
+		}
+	}
+
+	return block;
+}
+#endif /* CONFIG_MEM_SLAB_CPU_CACHE */
+
 int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, k_timeout_t timeout)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
+	k_spinlock_key_t key;
 	int result;
 
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	char *chain = NULL;
+
+	if (cache_alloc(slab, mem)) {
+		return 0;
+	}
+#endif
+
+	key = k_spin_lock(&slab->lock);
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	if (slab->free_list == NULL) {
+		/* shared list is empty, look in other CPU caches */
+		slab->free_list = cache_steal_locked(slab);
+		if (slab->free_list != NULL) {
+			slab->num_used--;
+		}
+	}
+#endif
+
 	if (slab->free_list != NULL) {
 		/* take a free block */
 		*mem = slab->free_list;
 		slab->free_list = *(char **)(slab->free_list);
 		slab->num_used++;
 		result = 0;
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+		/* and a batch more for the local cache */
+		for (int i = 0; i < CACHE_BATCH && slab->free_list != NULL;
+		     i++) {
+			char *block = slab->free_list;
+
+			slab->free_list = *(char **)block;
+			slab->num_used++;
+			*(char **)block = chain;
+			chain = block;
+		}
+#endif
 	} else if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
 		/* don't wait for a free block to become available */
 		*mem = NULL;
 		result = -ENOMEM;
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+		if (z_waitq_head(&slab->wait_q) == NULL) {
+			slab->waiters = false;
+		}
+#endif
 	} else {
 		/* wait for a free block or timeout */
-		result = z_pend_curr(&lock, key, &slab->wait_q, timeout);
+		result = z_pend_curr(&slab->lock, key, &slab->wait_q, timeout);
 		if (result == 0) {
 			*mem = _current->base.swap_data;
 		}
 		return result;
 	}
 
-	k_spin_unlock(&lock, key);
+	k_spin_unlock(&slab->lock, key);
+
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	if (chain != NULL) {
+		cache_refill(slab, chain);
+	}
+#endif
 
 	return result;
 }
 
 void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
-	struct k_thread *pending_thread = z_unpend_first_thread(&slab->wait_q);
+	k_spinlock_key_t key;
 
-	if (pending_thread != NULL) {
-		z_thread_return_value_set_with_data(pending_thread, 0, *mem);
-		z_ready_thread(pending_thread);
-		z_reschedule(&lock, key);
+#ifdef CONFIG_MEM_SLAB_CPU_CACHE
+	if (cache_free(slab, *mem)) {
+		return;
+	}
+#endif
+
+	key = k_spin_lock(&slab->lock);
+	if (slab_release_locked(slab, *mem)) {
+		z_reschedule(&slab->lock, key);
 	} else {
-		**(char ***)mem = slab->free_list;
-		slab->free_list = *(char **)mem;
-		slab->num_used--;
-		k_spin_unlock(&lock, key);
+		k_spin_unlock(&slab->lock, key);
 	}
 }
@@ -171,6 +171,116 @@ static inline int z_vrfy_k_msgq_put(struct k_msgq *q, void *data,
 #include <syscalls/k_msgq_put_mrsh.c>
 #endif
 
+/* Copy @a count messages into the ring buffer, wrapping as needed. The
+ * caller must have checked that there is room for them.
+ */
+static void msgq_ring_write(struct k_msgq *msgq, const char *data,
+			    u32_t count)
+{
+	size_t len = count * msgq->msg_size;
+	size_t first = MIN(len, (size_t)(msgq->buffer_end - msgq->write_ptr));
+
+	(void)memcpy(msgq->write_ptr, data, first);
+	msgq->write_ptr += first;
+	if (msgq->write_ptr == msgq->buffer_end) {
+		msgq->write_ptr = msgq->buffer_start;
+	}
+	if (len > first) {
+		(void)memcpy(msgq->write_ptr, data + first, len - first);
+		msgq->write_ptr += len - first;
+	}
+	msgq->used_msgs += count;
+}
+
+/* Copy the @a count oldest messages out of the ring buffer, wrapping as
+ * needed. The caller must have checked that there are that many.
+ */
+static void msgq_ring_read(struct k_msgq *msgq, char *data, u32_t count)
+{
+	size_t len = count * msgq->msg_size;
+	size_t first = MIN(len, (size_t)(msgq->buffer_end - msgq->read_ptr));
+
+	(void)memcpy(data, msgq->read_ptr, first);
+	msgq->read_ptr += first;
+	if (msgq->read_ptr == msgq->buffer_end) {
+		msgq->read_ptr = msgq->buffer_start;
+	}
+	if (len > first) {
+		(void)memcpy(data + first, msgq->read_ptr, len - first);
+		msgq->read_ptr += len - first;
+	}
+	msgq->used_msgs -= count;
+}
+
+int z_impl_k_msgq_put_many(struct k_msgq *msgq, const void *data,
+			   u32_t count, k_timeout_t timeout)
+{
+	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
+
+	const char *src = data;
+	struct k_thread *pending_thread;
+	k_spinlock_key_t key;
+	bool woken = false;
+	u32_t n = 0U;
+	u32_t chunk;
+
+	key = k_spin_lock(&msgq->lock);
+
+	/* readers only wait on an empty queue: hand messages to them first */
+	while ((n < count) && (msgq->used_msgs == 0U)) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+		(void)memcpy(pending_thread->base.swap_data, src,
+			     msgq->msg_size);
+		arch_thread_return_value_set(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		src += msgq->msg_size;
+		n++;
+		woken = true;
+	}
+
+	/* then queue as many of the others as there is room for */
+	chunk = MIN(count - n, msgq->max_msgs - msgq->used_msgs);
+	msgq_ring_write(msgq, src, chunk);
+	n += chunk;
+
+	if ((n == 0U) && (count != 0U)) {
+		if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+			/* don't wait for message space to become available */
+			k_spin_unlock(&msgq->lock, key);
+			return -ENOMSG;
+		}
+
+		/* wait until the first message can be put */
+		_current->base.swap_data = (void *)data;
+		int ret = z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
+
+		return (ret == 0) ? 1 : ret;
+	}
+
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return n;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_put_many(struct k_msgq *q, const void *data,
+					 u32_t count, k_timeout_t timeout)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_READ(data, count, q->msg_size));
+
+	return z_impl_k_msgq_put_many(q, data, count, timeout);
+}
+#include <syscalls/k_msgq_put_many_mrsh.c>
+#endif
+
 void z_impl_k_msgq_get_attrs(struct k_msgq *msgq, struct k_msgq_attrs *attrs)
 {
 	attrs->msg_size = msgq->msg_size;
@@ -253,6 +363,68 @@ static inline int z_vrfy_k_msgq_get(struct k_msgq *q, void *data,
 #include <syscalls/k_msgq_get_mrsh.c>
 #endif
 
+int z_impl_k_msgq_get_many(struct k_msgq *msgq, void *data, u32_t count,
+			   k_timeout_t timeout)
+{
+	__ASSERT(!arch_is_in_isr() || K_TIMEOUT_EQ(timeout, K_NO_WAIT), "");
+
+	struct k_thread *pending_thread;
+	k_spinlock_key_t key;
+	bool woken = false;
+	u32_t n;
+
+	key = k_spin_lock(&msgq->lock);
+
+	n = MIN(count, msgq->used_msgs);
+	msgq_ring_read(msgq, data, n);
+
+	/* writers only wait on a full queue: refill it from them */
+	while ((n != 0U) && (msgq->used_msgs < msgq->max_msgs)) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+		msgq_ring_write(msgq, pending_thread->base.swap_data, 1);
+		arch_thread_return_value_set(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		woken = true;
+	}
+
+	if ((n == 0U) && (count != 0U)) {
+		if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+			/* don't wait for a message to become available */
+			k_spin_unlock(&msgq->lock, key);
+			return -ENOMSG;
+		}
+
+		/* wait for the first message */
+		_current->base.swap_data = data;
+		int ret = z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
+
+		return (ret == 0) ? 1 : ret;
+	}
+
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return n;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_get_many(struct k_msgq *q, void *data,
+					 u32_t count, k_timeout_t timeout)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(data, count, q->msg_size));
+
+	return z_impl_k_msgq_get_many(q, data, count, timeout);
+}
+#include <syscalls/k_msgq_get_many_mrsh.c>
+#endif
+
 int z_impl_k_msgq_peek(struct k_msgq *msgq, void *data)
 {
 	k_spinlock_key_t key;
@@ -72,6 +72,9 @@ int z_impl_k_mutex_init(struct k_mutex *mutex)
 {
 	mutex->owner = NULL;
 	mutex->lock_count = 0U;
+#ifdef CONFIG_MUTEX_STATS
+	mutex->stats = (struct k_mutex_stats) {};
+#endif
 
 	sys_trace_void(SYS_TRACE_ID_MUTEX_INIT);
 
@@ -116,6 +119,87 @@ static bool adjust_owner_prio(struct k_mutex *mutex, s32_t new_prio)
 	return false;
 }
 
+static void take_mutex(struct k_mutex *mutex)
+{
+	mutex->owner_orig_prio = (mutex->lock_count == 0U) ?
+				_current->base.prio :
+				mutex->owner_orig_prio;
+
+	mutex->lock_count++;
+	mutex->owner = _current;
+
+	K_DEBUG("%p took mutex %p, count: %d, orig prio: %d\n",
+		_current, mutex, mutex->lock_count,
+		mutex->owner_orig_prio);
+}
+
+#ifdef CONFIG_MUTEX_STATS
+static inline void stats_acquired(struct k_mutex *mutex, u32_t wait_start,
+				  bool spun)
+{
+	mutex->stats.acquisitions++;
+	mutex->stats.wait_cycles += k_cycle_get_32() - wait_start;
+	if (spun) {
+		mutex->stats.spin_acquired++;
+	}
+}
+
+void k_mutex_stats_get(struct k_mutex *mutex, struct k_mutex_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*stats = mutex->stats;
+	k_spin_unlock(&lock, key);
+}
+#endif
+
+#ifdef CONFIG_MUTEX_ADAPTIVE_SPIN
+static bool thread_running(struct k_thread *thread)
+{
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (*(struct k_thread * volatile *)&_kernel.cpus[i].current ==
+		    thread) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Spin, with the lock released, while the owner of the mutex runs on
+ * another CPU.  Returns with the lock held again, and true if the mutex
+ * was released meanwhile.  A mutex released while threads are pending
+ * on it is handed to the first of them, so spinning never steals it
+ * from a waiter.
+ */
+static bool spin_on_owner(struct k_mutex *mutex, k_spinlock_key_t *key)
+{
+	struct k_thread *owner = mutex->owner;
+	u32_t start = k_cycle_get_32();
+	u32_t limit = k_us_to_cyc_ceil32(CONFIG_MUTEX_SPIN_TIME_US);
+
+	if (!thread_running(owner)) {
+		return false;
+	}
+
+	k_spin_unlock(&lock, *key);
+
+	while (*(volatile u32_t *)&mutex->lock_count != 0U) {
+		if ((*(struct k_thread * volatile *)&mutex->owner != owner) ||
+		    !thread_running(owner)) {
+			break;
+		}
+		if ((k_cycle_get_32() - start) >= limit) {
+			break;
+		}
+	}
+
+	*key = k_spin_lock(&lock);
+
+	return mutex->lock_count == 0U;
+}
+#endif
+
 int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 {
 	int new_prio;
@@ -126,30 +210,41 @@ int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 	key = k_spin_lock(&lock);
 
 	if (likely((mutex->lock_count == 0U) || (mutex->owner == _current))) {
-
-		mutex->owner_orig_prio = (mutex->lock_count == 0U) ?
-					_current->base.prio :
-					mutex->owner_orig_prio;
-
-		mutex->lock_count++;
-		mutex->owner = _current;
-
-		K_DEBUG("%p took mutex %p, count: %d, orig prio: %d\n",
-			_current, mutex, mutex->lock_count,
-			mutex->owner_orig_prio);
-
+		take_mutex(mutex);
+#ifdef CONFIG_MUTEX_STATS
+		mutex->stats.acquisitions++;
+#endif
 		k_spin_unlock(&lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 
 		return 0;
 	}
 
+#ifdef CONFIG_MUTEX_STATS
+	u32_t wait_start = k_cycle_get_32();
+
+	mutex->stats.contended++;
+#endif
+
 	if (unlikely(K_TIMEOUT_EQ(timeout, K_NO_WAIT))) {
 		k_spin_unlock(&lock, key);
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 		return -EBUSY;
 	}
 
+#ifdef CONFIG_MUTEX_ADAPTIVE_SPIN
+	if (spin_on_owner(mutex, &key)) {
+		take_mutex(mutex);
+#ifdef CONFIG_MUTEX_STATS
+		stats_acquired(mutex, wait_start, true);
+#endif
+		k_spin_unlock(&lock, key);
+		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
+
+		return 0;
+	}
+#endif
+
 	new_prio = new_prio_for_inheritance(_current->base.prio,
 					    mutex->owner->base.prio);
 
@@ -167,6 +262,11 @@ int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 		got_mutex ? 'y' : 'n');
 
 	if (got_mutex == 0) {
+#ifdef CONFIG_MUTEX_STATS
+		key = k_spin_lock(&lock);
+		stats_acquired(mutex, wait_start, false);
+		k_spin_unlock(&lock, key);
+#endif
 		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
 		return 0;
 	}
@@ -187,6 +287,10 @@ int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 
 	resched = adjust_owner_prio(mutex, new_prio) || resched;
 
+#ifdef CONFIG_MUTEX_STATS
+	mutex->stats.wait_cycles += k_cycle_get_32() - wait_start;
+#endif
+
 	if (resched) {
 		z_reschedule(&lock, key);
 	} else {
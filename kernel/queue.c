@@ -349,6 +349,43 @@ void *z_impl_k_queue_get(struct k_queue *queue, k_timeout_t timeout)
 #endif /* CONFIG_POLL */
 }
 
+int z_impl_k_queue_get_many(struct k_queue *queue, void **items, u32_t max,
+			    k_timeout_t timeout)
+{
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+	u32_t n = 0U;
+
+	while ((n < max) && !sys_sflist_is_empty(&queue->data_q)) {
+		sys_sfnode_t *node;
+
+		node = sys_sflist_get_not_empty(&queue->data_q);
+		items[n++] = z_queue_node_peek(node, true);
+	}
+
+	if ((n != 0U) || (max == 0U) || K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		k_spin_unlock(&queue->lock, key);
+		return n;
+	}
+
+#if defined(CONFIG_POLL)
+	k_spin_unlock(&queue->lock, key);
+
+	items[0] = k_queue_poll(queue, timeout);
+
+	return (items[0] != NULL) ? 1 : 0;
+#else
+	int ret = z_pend_curr(&queue->lock, key, &queue->wait_q, timeout);
+
+	if (ret != 0) {
+		return 0;
+	}
+
+	items[0] = _current->base.swap_data;
+
+	return 1;
+#endif /* CONFIG_POLL */
+}
+
 #ifdef CONFIG_USERSPACE
 static inline void *z_vrfy_k_queue_get(struct k_queue *queue,
 				       k_timeout_t timeout)
@@ -358,6 +395,16 @@ static inline void *z_vrfy_k_queue_get(struct k_queue *queue,
 }
 #include <syscalls/k_queue_get_mrsh.c>
 
+static inline int z_vrfy_k_queue_get_many(struct k_queue *queue,
+					  void **items, u32_t max,
+					  k_timeout_t timeout)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(queue, K_OBJ_QUEUE));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(items, max, sizeof(void *)));
+	return z_impl_k_queue_get_many(queue, items, max, timeout);
+}
+#include <syscalls/k_queue_get_many_mrsh.c>
+
 static inline int z_vrfy_k_queue_is_empty(struct k_queue *queue)
 {
 	Z_OOPS(Z_SYSCALL_OBJ(queue, K_OBJ_QUEUE));
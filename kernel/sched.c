@@ -14,6 +14,7 @@
 #include <drivers/timer/system_timer.h>
 #include <stdbool.h>
 #include <kernel_internal.h>
+#include <sys/math_extras.h>
 
 /* Maximum time between the time a self-aborting thread flags itself
  * DEAD and the last read or write to its stack memory (i.e. the time
@@ -38,6 +39,10 @@
 #define _priq_run_add		z_priq_mq_add
 #define _priq_run_remove	z_priq_mq_remove
 #define _priq_run_best		z_priq_mq_best
+#elif defined(CONFIG_SCHED_BITMAP)
+#define _priq_run_add		z_priq_bm_add
+#define _priq_run_remove	z_priq_bm_remove
+#define _priq_run_best		z_priq_bm_best
 #endif
 
 #if defined(CONFIG_WAITQ_SCALABLE)
@@ -176,9 +181,194 @@ static ALWAYS_INLINE struct k_thread *_priq_dumb_mask_best(sys_dlist_t *pq)
 }
 #endif
 
+#ifdef CONFIG_SCHED_CPU_QUEUES
+/*
+ * Each CPU has its own ready queue, threads are queued on the queue of
+ * their home CPU (the one they last ran on).
+ *
+ * Every queue has its own lock, which protects the queue, the queued
+ * flag of the threads in it and their home CPU.  The other thread
+ * states stay under sched_spinlock.  A queue lock may be taken with
+ * sched_spinlock held but not the other way round, and two queue
+ * locks are always taken in increasing CPU order.
+ *
+ * Picking the next thread of a CPU only takes the lock of its own
+ * queue, so context switches on different CPUs do not serialize.
+ * The switch path looks at the state of _current with its queue
+ * locked before putting it back, so code stopping a thread from
+ * running changes its state in the same queue locked section that
+ * removes it from its queue.
+ */
+static struct k_spinlock runq_locks[CONFIG_MP_NUM_CPUS];
+
+static ALWAYS_INLINE void *cpu_runq(int cpu)
+{
+	return &_kernel.cpus[cpu].ready_q.runq;
+}
+
+/* Lock the queue of the home CPU of a thread, returns that CPU.  The
+ * home of a queued thread only changes with both the old and the new
+ * queue locked, so it is stable once the lock is held.
+ */
+static int runq_lock(struct k_thread *thread, k_spinlock_key_t *key)
+{
+	int cpu;
+
+	while (true) {
+		cpu = thread->base.cpu;
+		*key = k_spin_lock(&runq_locks[cpu]);
+		if (cpu == thread->base.cpu) {
+			return cpu;
+		}
+		k_spin_unlock(&runq_locks[cpu], *key);
+	}
+}
+
+static ALWAYS_INLINE void runq_unlock(int cpu, k_spinlock_key_t key)
+{
+	k_spin_unlock(&runq_locks[cpu], key);
+}
+#else
+/* One queue shared by all CPUs, under sched_spinlock */
+static ALWAYS_INLINE void *cpu_runq(int cpu)
+{
+	ARG_UNUSED(cpu);
+
+	return &_kernel.ready_q.runq;
+}
+
+static ALWAYS_INLINE int runq_lock(struct k_thread *thread,
+				   k_spinlock_key_t *key)
+{
+	ARG_UNUSED(thread);
+	ARG_UNUSED(key);
+
+	return 0;
+}
+
+static ALWAYS_INLINE void runq_unlock(int cpu, k_spinlock_key_t key)
+{
+	ARG_UNUSED(cpu);
+	ARG_UNUSED(key);
+}
+#endif
+
+/* Queue and dequeue with the queue locked */
+static ALWAYS_INLINE void queue_thread(void *pq, struct k_thread *thread)
+{
+	_priq_run_add(pq, thread);
+	z_mark_thread_as_queued(thread);
+}
+
+static ALWAYS_INLINE void dequeue_thread(void *pq, struct k_thread *thread)
+{
+	_priq_run_remove(pq, thread);
+	z_mark_thread_as_not_queued(thread);
+}
+
+static void runq_add(struct k_thread *thread)
+{
+	k_spinlock_key_t key;
+	int cpu;
+
+#if defined(CONFIG_SCHED_CPU_QUEUES) && defined(CONFIG_SCHED_CPU_MASK)
+	u32_t mask = thread->base.cpu_mask & BIT_MASK(CONFIG_MP_NUM_CPUS);
+
+	/* Rehome threads which may not run on their home CPU */
+	if (!z_is_thread_queued(thread) &&
+	    (mask & BIT(thread->base.cpu)) == 0U && mask != 0U) {
+		thread->base.cpu = u32_count_trailing_zeros(mask);
+	}
+#endif
+
+	cpu = runq_lock(thread, &key);
+	if (!z_is_thread_queued(thread)) {
+		queue_thread(cpu_runq(cpu), thread);
+	}
+	runq_unlock(cpu, key);
+}
+
+/* Returns true if the thread was queued */
+static bool runq_remove(struct k_thread *thread)
+{
+	k_spinlock_key_t key;
+	int cpu = runq_lock(thread, &key);
+	bool queued = z_is_thread_queued(thread);
+
+	if (queued) {
+		dequeue_thread(cpu_runq(cpu), thread);
+	}
+	runq_unlock(cpu, key);
+
+	return queued;
+}
+
+#ifdef CONFIG_SCHED_CPU_QUEUES
+/* Best thread of the queue of another CPU that may be moved here.
+ * Not a thread which queued itself and is still running there.
+ */
+static struct k_thread *stealable(int cpu)
+{
+	struct k_thread *thread = _priq_run_best(cpu_runq(cpu));
+
+	if (thread == _kernel.cpus[cpu].current) {
+		return NULL;
+	}
+	return thread;
+}
+
+/* Called on a CPU with nothing left to run and its queue unlocked:
+ * migrate the highest priority thread allowed to run here from the
+ * queue of another CPU to our own.
+ */
+static void steal_thread(void)
+{
+	int self = _current_cpu->id;
+	int from = -1;
+	struct k_thread *best = NULL;
+	k_spinlock_key_t key, key2;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct k_thread *thread;
+
+		if (i == self) {
+			continue;
+		}
+
+		key = k_spin_lock(&runq_locks[i]);
+		thread = stealable(i);
+		if (thread != NULL && (best == NULL ||
+		    z_is_t1_higher_prio_than_t2(thread, best))) {
+			best = thread;
+			from = i;
+		}
+		k_spin_unlock(&runq_locks[i], key);
+	}
+
+	if (from < 0) {
+		return;
+	}
+
+	/* Its best thread may have changed once both are locked */
+	key = k_spin_lock(&runq_locks[MIN(self, from)]);
+	key2 = k_spin_lock(&runq_locks[MAX(self, from)]);
+
+	best = stealable(from);
+	if (best != NULL) {
+		dequeue_thread(cpu_runq(from), best);
+		best->base.cpu = self;
+		queue_thread(cpu_runq(self), best);
+	}
+
+	k_spin_unlock(&runq_locks[MAX(self, from)], key2);
+	k_spin_unlock(&runq_locks[MIN(self, from)], key);
+}
+#endif
+
 static ALWAYS_INLINE struct k_thread *next_up(void)
 {
-	struct k_thread *thread = _priq_run_best(&_kernel.ready_q.runq);
+	void *pq = cpu_runq(_current_cpu->id);
+	struct k_thread *thread = _priq_run_best(pq);
 
 #if (CONFIG_NUM_METAIRQ_PRIORITIES > 0) && (CONFIG_NUM_COOP_PRIORITIES > 0)
 	/* MetaIRQs must always attempt to return back to a
@@ -197,8 +387,10 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	}
 #endif
 
+#ifndef CONFIG_SCHED_CPU_QUEUES
 	/* If the current thread is marked aborting, mark it
-	 * dead so it will not be scheduled again.
+	 * dead so it will not be scheduled again.  With per-CPU
+	 * queues this is done by next_up_locked().
 	 */
 	if (_current->base.thread_state & _THREAD_ABORTING) {
 		_current->base.thread_state |= _THREAD_DEAD;
@@ -206,6 +398,7 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 		_current_cpu->swap_ok = true;
 #endif
 	}
+#endif
 
 #ifndef CONFIG_SMP
 	/* In uniprocessor mode, we can leave the current thread in
@@ -248,20 +441,57 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	/* Put _current back into the queue */
 	if (thread != _current && active &&
 		!z_is_idle_thread_object(_current) && !queued) {
-		_priq_run_add(&_kernel.ready_q.runq, _current);
-		z_mark_thread_as_queued(_current);
+		queue_thread(pq, _current);
 	}
 
-	/* Take the new _current out of the queue */
+	/* Take the new _current out of the queue.  A queued _current
+	 * is in our own queue too, as no other CPU steals a thread that
+	 * is still running.
+	 */
 	if (z_is_thread_queued(thread)) {
-		_priq_run_remove(&_kernel.ready_q.runq, thread);
+		dequeue_thread(pq, thread);
 	}
 	z_mark_thread_as_not_queued(thread);
 
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	/* Which makes this CPU its new home */
+	thread->base.cpu = _current_cpu->id;
+#endif
+
 	return thread;
 #endif
 }
 
+#ifdef CONFIG_SCHED_CPU_QUEUES
+/* next_up() with only the queue of this CPU locked, which is left
+ * locked for the caller.  Work is stolen from other CPUs first if
+ * this one would otherwise go idle.
+ */
+static struct k_thread *next_up_locked(k_spinlock_key_t *key)
+{
+	int cpu = _current_cpu->id;
+
+	if ((_current->base.thread_state & _THREAD_ABORTING) != 0U) {
+		LOCKED(&sched_spinlock) {
+			_current->base.thread_state |= _THREAD_DEAD;
+			_current_cpu->swap_ok = true;
+		}
+	}
+
+	*key = k_spin_lock(&runq_locks[cpu]);
+
+	if (_priq_run_best(cpu_runq(cpu)) == NULL &&
+	    (z_is_idle_thread_object(_current) ||
+	     z_is_thread_prevented_from_running(_current))) {
+		k_spin_unlock(&runq_locks[cpu], *key);
+		steal_thread();
+		*key = k_spin_lock(&runq_locks[cpu]);
+	}
+
+	return next_up();
+}
+#endif
+
 #ifdef CONFIG_TIMESLICING
 
 static int slice_time;
@@ -380,8 +610,7 @@ static void ready_thread(struct k_thread *thread)
 {
 	if (z_is_thread_ready(thread)) {
 		sys_trace_thread_ready(thread);
-		_priq_run_add(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_queued(thread);
+		runq_add(thread);
 		update_cache(0);
 #if defined(CONFIG_SMP) &&  defined(CONFIG_SCHED_IPI_SUPPORTED)
 		arch_sched_ipi();
@@ -399,11 +628,8 @@ void z_ready_thread(struct k_thread *thread)
 void z_move_thread_to_end_of_prio_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
-		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
-		}
-		_priq_run_add(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_queued(thread);
+		runq_remove(thread);
+		runq_add(thread);
 		update_cache(thread == _current);
 	}
 }
@@ -427,11 +653,15 @@ void z_impl_k_thread_suspend(struct k_thread *thread)
 	(void)z_abort_thread_timeout(thread);
 
 	LOCKED(&sched_spinlock) {
+		k_spinlock_key_t key;
+		int cpu = runq_lock(thread, &key);
+
+		/* In one section, see runq_lock() */
 		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
-			z_mark_thread_as_not_queued(thread);
+			dequeue_thread(cpu_runq(cpu), thread);
 		}
 		z_mark_thread_as_suspended(thread);
+		runq_unlock(cpu, key);
 		update_cache(thread == _current);
 	}
 
@@ -491,11 +721,7 @@ void z_thread_single_abort(struct k_thread *thread)
 		struct k_thread *waiter;
 
 		if (z_is_thread_ready(thread)) {
-			if (z_is_thread_queued(thread)) {
-				_priq_run_remove(&_kernel.ready_q.runq,
-						 thread);
-				z_mark_thread_as_not_queued(thread);
-			}
+			runq_remove(thread);
 			update_cache(thread == _current);
 		} else {
 			if (z_is_thread_pending(thread)) {
@@ -555,10 +781,7 @@ void z_thread_single_abort(struct k_thread *thread)
 
 static void unready_thread(struct k_thread *thread)
 {
-	if (z_is_thread_queued(thread)) {
-		_priq_run_remove(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_not_queued(thread);
-	}
+	runq_remove(thread);
 	update_cache(thread == _current);
 }
 
@@ -705,14 +928,18 @@ bool z_set_prio(struct k_thread *thread, int prio)
 		need_sched = z_is_thread_ready(thread);
 
 		if (need_sched) {
+			k_spinlock_key_t key;
+			int cpu = runq_lock(thread, &key);
+
 			/* Don't requeue on SMP if it's the running thread */
 			if (!IS_ENABLED(CONFIG_SMP) || z_is_thread_queued(thread)) {
-				_priq_run_remove(&_kernel.ready_q.runq, thread);
+				_priq_run_remove(cpu_runq(cpu), thread);
 				thread->base.prio = prio;
-				_priq_run_add(&_kernel.ready_q.runq, thread);
+				_priq_run_add(cpu_runq(cpu), thread);
 			} else {
 				thread->base.prio = prio;
 			}
+			runq_unlock(cpu, key);
 			update_cache(1);
 		} else {
 			thread->base.prio = prio;
@@ -793,9 +1020,16 @@ struct k_thread *z_get_next_ready_thread(void)
 {
 	struct k_thread *ret = 0;
 
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	k_spinlock_key_t key;
+
+	ret = next_up_locked(&key);
+	k_spin_unlock(&runq_locks[_current_cpu->id], key);
+#else
 	LOCKED(&sched_spinlock) {
 		ret = next_up();
 	}
+#endif
 
 	return ret;
 }
@@ -815,27 +1049,35 @@ void *z_get_next_switch_handle(void *interrupted)
 	z_check_stack_sentinel();
 
 #ifdef CONFIG_SMP
-	LOCKED(&sched_spinlock) {
-		struct k_thread *thread = next_up();
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	/* Only the queue of this CPU is locked, see runq_lock() */
+	struct k_spinlock *lock = &runq_locks[_current_cpu->id];
+	k_spinlock_key_t key;
+	struct k_thread *thread = next_up_locked(&key);
+#else
+	struct k_spinlock *lock = &sched_spinlock;
+	k_spinlock_key_t key = k_spin_lock(lock);
+	struct k_thread *thread = next_up();
+#endif
 
-		if (_current != thread) {
-			update_metairq_preempt(thread);
+	if (_current != thread) {
+		update_metairq_preempt(thread);
 
 #ifdef CONFIG_TIMESLICING
-			z_reset_time_slice();
+		z_reset_time_slice();
 #endif
-			_current_cpu->swap_ok = 0;
-			set_current(thread);
+		_current_cpu->swap_ok = 0;
+		set_current(thread);
 #ifdef CONFIG_SPIN_VALIDATE
-			/* Changed _current!  Update the spinlock
-			 * bookeeping so the validation doesn't get
-			 * confused when the "wrong" thread tries to
-			 * release the lock.
-			 */
-			z_spin_lock_set_owner(&sched_spinlock);
+		/* Changed _current!  Update the spinlock
+		 * bookeeping so the validation doesn't get
+		 * confused when the "wrong" thread tries to
+		 * release the lock.
+		 */
+		z_spin_lock_set_owner(lock);
 #endif
-		}
 	}
+	k_spin_unlock(lock, key);
 #else
 	set_current(z_get_next_ready_thread());
 #endif
@@ -1001,6 +1243,79 @@ struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
 	return thread;
 }
 
+#ifdef CONFIG_SCHED_BITMAP
+BUILD_ASSERT(Z_PRIQ_BM_NUM_WORDS <= 32,
+	     "Too many priorities for bitmap scheduler (max 1024)");
+
+static ALWAYS_INLINE struct k_thread *priq_bm_scan(struct _priq_bm *pq)
+{
+#if Z_PRIQ_BM_NUM_WORDS > 1
+	if (pq->summary == 0U) {
+		return NULL;
+	}
+
+	int word = __builtin_ctz(pq->summary);
+#else
+	if (pq->bitmask[0] == 0U) {
+		return NULL;
+	}
+
+	int word = 0;
+#endif
+	int prio = (word * 32) + __builtin_ctz(pq->bitmask[word]);
+	sys_dnode_t *n = sys_dlist_peek_head(&pq->queues[prio]);
+
+	return CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+}
+
+void z_priq_bm_add(struct _priq_bm *pq, struct k_thread *thread)
+{
+	int prio = thread->base.prio - K_HIGHEST_THREAD_PRIO;
+
+	__ASSERT_NO_MSG(!z_is_idle_thread_object(thread));
+
+	sys_dlist_append(&pq->queues[prio], &thread->base.qnode_dlist);
+	pq->bitmask[prio / 32] |= BIT(prio % 32);
+#if Z_PRIQ_BM_NUM_WORDS > 1
+	pq->summary |= BIT(prio / 32);
+#endif
+
+	/* Appending never displaces the head of a non-empty list, so
+	 * the cache only changes for a strictly better priority
+	 */
+	if (pq->best == NULL || thread->base.prio < pq->best->base.prio) {
+		pq->best = thread;
+	}
+}
+
+void z_priq_bm_remove(struct _priq_bm *pq, struct k_thread *thread)
+{
+#if defined(CONFIG_SWAP_NONATOMIC) && defined(CONFIG_SCHED_BITMAP)
+	if (pq == &_kernel.ready_q.runq && thread == _current &&
+	    z_is_thread_prevented_from_running(thread)) {
+		return;
+	}
+#endif
+	int prio = thread->base.prio - K_HIGHEST_THREAD_PRIO;
+
+	__ASSERT_NO_MSG(!z_is_idle_thread_object(thread));
+
+	sys_dlist_remove(&thread->base.qnode_dlist);
+	if (sys_dlist_is_empty(&pq->queues[prio])) {
+		pq->bitmask[prio / 32] &= ~BIT(prio % 32);
+#if Z_PRIQ_BM_NUM_WORDS > 1
+		if (pq->bitmask[prio / 32] == 0U) {
+			pq->summary &= ~BIT(prio / 32);
+		}
+#endif
+	}
+
+	if (pq->best == thread) {
+		pq->best = priq_bm_scan(pq);
+	}
+}
+#endif /* CONFIG_SCHED_BITMAP */
+
 int z_unpend_all(_wait_q_t *wait_q)
 {
 	int need_sched = 0;
@@ -1015,14 +1330,14 @@ int z_unpend_all(_wait_q_t *wait_q)
 	return need_sched;
 }
 
-void z_sched_init(void)
+static void init_ready_q(struct _ready_q *rq)
 {
 #ifdef CONFIG_SCHED_DUMB
-	sys_dlist_init(&_kernel.ready_q.runq);
+	sys_dlist_init(&rq->runq);
 #endif
 
 #ifdef CONFIG_SCHED_SCALABLE
-	_kernel.ready_q.runq = (struct _priq_rb) {
+	rq->runq = (struct _priq_rb) {
 		.tree = {
 			.lessthan_fn = z_priq_rb_lessthan,
 		}
@@ -1030,11 +1345,28 @@ void z_sched_init(void)
 #endif
 
 #ifdef CONFIG_SCHED_MULTIQ
-	for (int i = 0; i < ARRAY_SIZE(_kernel.ready_q.runq.queues); i++) {
-		sys_dlist_init(&_kernel.ready_q.runq.queues[i]);
+	for (int i = 0; i < ARRAY_SIZE(rq->runq.queues); i++) {
+		sys_dlist_init(&rq->runq.queues[i]);
 	}
 #endif
 
+#ifdef CONFIG_SCHED_BITMAP
+	for (int i = 0; i < ARRAY_SIZE(rq->runq.queues); i++) {
+		sys_dlist_init(&rq->runq.queues[i]);
+	}
+#endif
+}
+
+void z_sched_init(void)
+{
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		init_ready_q(&_kernel.cpus[i].ready_q);
+	}
+#else
+	init_ready_q(&_kernel.ready_q);
+#endif
+
 #ifdef CONFIG_TIMESLICING
 	k_sched_time_slice_set(CONFIG_TIMESLICE_SIZE,
 		CONFIG_TIMESLICE_PRIORITY);
@@ -1090,11 +1422,17 @@ void z_impl_k_thread_deadline_set(k_tid_t tid, int deadline)
 	struct k_thread *thread = tid;
 
 	LOCKED(&sched_spinlock) {
-		thread->base.prio_deadline = k_cycle_get_32() + deadline;
+		k_spinlock_key_t key;
+		int cpu = runq_lock(thread, &key);
+
 		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
-			_priq_run_add(&_kernel.ready_q.runq, thread);
+			_priq_run_remove(cpu_runq(cpu), thread);
+			thread->base.prio_deadline = k_cycle_get_32() + deadline;
+			_priq_run_add(cpu_runq(cpu), thread);
+		} else {
+			thread->base.prio_deadline = k_cycle_get_32() + deadline;
 		}
+		runq_unlock(cpu, key);
 	}
 }
 
@@ -1120,13 +1458,8 @@ void z_impl_k_yield(void)
 
 	if (!z_is_idle_thread_object(_current)) {
 		LOCKED(&sched_spinlock) {
-			if (!IS_ENABLED(CONFIG_SMP) ||
-			    z_is_thread_queued(_current)) {
-				_priq_run_remove(&_kernel.ready_q.runq,
-						 _current);
-			}
-			_priq_run_add(&_kernel.ready_q.runq, _current);
-			z_mark_thread_as_queued(_current);
+			runq_remove(_current);
+			runq_add(_current);
 			update_cache(1);
 		}
 	}
@@ -1273,6 +1606,24 @@ void z_sched_ipi(void)
 	 */
 }
 
+/* Kill a thread caught in a ready queue, in one queue locked section
+ * so that no CPU can pick it in between.
+ */
+static bool abort_queued(struct k_thread *thread)
+{
+	k_spinlock_key_t key;
+	int cpu = runq_lock(thread, &key);
+	bool queued = z_is_thread_queued(thread);
+
+	if (queued) {
+		dequeue_thread(cpu_runq(cpu), thread);
+		thread->base.thread_state |= _THREAD_DEAD;
+	}
+	runq_unlock(cpu, key);
+
+	return queued;
+}
+
 void z_sched_abort(struct k_thread *thread)
 {
 	k_spinlock_key_t key;
@@ -1302,10 +1653,7 @@ void z_sched_abort(struct k_thread *thread)
 			__ASSERT(!z_is_thread_queued(thread), "");
 			thread->base.thread_state |= _THREAD_DEAD;
 			k_spin_unlock(&sched_spinlock, key);
-		} else if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
-			z_mark_thread_as_not_queued(thread);
-			thread->base.thread_state |= _THREAD_DEAD;
+		} else if (abort_queued(thread)) {
 			k_spin_unlock(&sched_spinlock, key);
 		} else {
 			k_spin_unlock(&sched_spinlock, key);
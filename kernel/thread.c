@@ -734,6 +734,11 @@ void z_init_thread_base(struct _thread_base *thread_base, int priority,
 	thread_base->is_idle = 0;
 #endif
 
+#ifdef CONFIG_SCHED_CPU_QUEUES
+	/* New threads start out on the queue of the creating CPU */
+	thread_base->cpu = _current_cpu->id;
+#endif
+
 	/* swap_data does not need to be initialized */
 
 	z_init_thread_timeout(thread_base);
@@ -41,6 +41,136 @@ static inline int z_vrfy_z_clock_hw_cycles_per_sec_runtime_get(void)
 #endif /* CONFIG_USERSPACE */
 #endif /* CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME */
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+/*
+ * Hashed hierarchical timing wheel.
+ *
+ * Level L has WHEEL_SLOTS slots of 32^L ticks each.  A timeout expiring
+ * at absolute tick e is kept in the lowest level L where the block of
+ * e, (e >> (L * WHEEL_BITS)), is at most WHEEL_SLOTS blocks after the
+ * block of curr_tick, in slot (block & WHEEL_MASK).  Every time the
+ * tick count crosses into a new block of a level >= 1 the matching slot
+ * is emptied and its timeouts re-inserted, which moves them down the
+ * levels until they reach level 0, whose slots each hold the timeouts
+ * expiring on one tick.  Timeouts beyond the range of the top level are
+ * parked in its farthest slot and re-inserted on each of its rotations.
+ *
+ * Per level bitmaps mark slots that may be non-empty.  Aborting a
+ * timeout does not know its slot, so bits are only cleared lazily when
+ * an empty slot is visited.
+ */
+#define WHEEL_BITS 5
+#define WHEEL_SLOTS BIT(WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1U)
+#define WHEEL_LEVELS CONFIG_TIMEOUT_WHEEL_LEVELS
+
+static sys_dlist_t wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static u32_t wheel_bitmap[WHEEL_LEVELS];
+static bool wheel_ready;
+
+/* Lower bound of the earliest pending expiry, used to decide whether
+ * a new timeout needs the timer driver to be reprogrammed.
+ */
+static u64_t wheel_next = UINT64_MAX;
+
+static void wheel_init(void)
+{
+	for (int lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+		for (int i = 0; i < WHEEL_SLOTS; i++) {
+			sys_dlist_init(&wheel[lvl][i]);
+		}
+	}
+	wheel_ready = true;
+}
+
+/* Place a timeout in the wheel, relative to the already processed
+ * tick now.  Its expiry must be later than now.
+ */
+static void wheel_insert(struct _timeout *t, u64_t now)
+{
+	int lvl, shift = 0;
+	u32_t idx;
+
+	__ASSERT(t->expires > now, "");
+
+	for (lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+		shift = lvl * WHEEL_BITS;
+		if (((t->expires >> shift) - (now >> shift)) <= WHEEL_SLOTS) {
+			break;
+		}
+	}
+
+	if (lvl == WHEEL_LEVELS) {
+		/* Too far out, park in the farthest top level slot */
+		lvl = WHEEL_LEVELS - 1;
+		idx = (u32_t)(now >> shift) & WHEEL_MASK;
+	} else {
+		idx = (u32_t)(t->expires >> shift) & WHEEL_MASK;
+	}
+
+	sys_dlist_append(&wheel[lvl][idx], &t->node);
+	wheel_bitmap[lvl] |= BIT(idx);
+}
+
+/* Re-insert all timeouts of a slot, relative to now */
+static void wheel_cascade(int lvl, u32_t idx, u64_t now)
+{
+	sys_dnode_t *n;
+
+	while ((n = sys_dlist_get(&wheel[lvl][idx])) != NULL) {
+		wheel_insert(CONTAINER_OF(n, struct _timeout, node), now);
+	}
+	wheel_bitmap[lvl] &= ~BIT(idx);
+}
+
+/* Earliest expiry of all pending timeouts, or UINT64_MAX */
+static u64_t wheel_first(void)
+{
+	u64_t ret = UINT64_MAX;
+
+	for (int lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+		int shift = lvl * WHEEL_BITS;
+		u64_t block = (curr_tick >> shift) + 1;
+		u32_t start = (u32_t)block & WHEEL_MASK;
+
+		/* Nothing at this level or above can expire before
+		 * the start of its next block.
+		 */
+		if (ret <= (block << shift)) {
+			break;
+		}
+
+		while (wheel_bitmap[lvl] != 0U) {
+			u32_t bm = wheel_bitmap[lvl];
+			u32_t idx;
+			struct _timeout *t;
+
+			/* Search in slot order starting from the next block */
+			bm = (bm >> start) | (bm << ((WHEEL_SLOTS - start) &
+						     WHEEL_MASK));
+			idx = (start + __builtin_ctz(bm)) & WHEEL_MASK;
+
+			if (sys_dlist_is_empty(&wheel[lvl][idx])) {
+				wheel_bitmap[lvl] &= ~BIT(idx);
+				continue;
+			}
+
+			SYS_DLIST_FOR_EACH_CONTAINER(&wheel[lvl][idx], t, node) {
+				ret = MIN(ret, t->expires);
+			}
+			break;
+		}
+	}
+
+	wheel_next = ret;
+	return ret;
+}
+
+static void remove_timeout(struct _timeout *t)
+{
+	sys_dlist_remove(&t->node);
+}
+#else
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -64,6 +194,8 @@ static void remove_timeout(struct _timeout *t)
 	sys_dlist_remove(&t->node);
 }
 
+#endif /* CONFIG_TIMEOUT_WHEEL */
+
 static s32_t elapsed(void)
 {
 	return announce_remaining == 0 ? z_clock_elapsed() : 0;
@@ -71,9 +203,21 @@ static s32_t elapsed(void)
 
 static s32_t next_timeout(void)
 {
+#ifdef CONFIG_TIMEOUT_WHEEL
+	u64_t expiry = wheel_first();
+	s32_t ticks_elapsed = elapsed();
+	s32_t ret = MAX_WAIT;
+
+	if (expiry != UINT64_MAX) {
+		u64_t now = curr_tick + ticks_elapsed;
+
+		ret = expiry <= now ? 0 : (s32_t)MIN(expiry - now, INT_MAX);
+	}
+#else
 	struct _timeout *to = first();
 	s32_t ticks_elapsed = elapsed();
 	s32_t ret = to == NULL ? MAX_WAIT : MAX(0, to->dticks - ticks_elapsed);
+#endif
 
 #ifdef CONFIG_TIMESLICING
 	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
@@ -105,6 +249,20 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 	ticks = MAX(1, ticks);
 
 	LOCKED(&timeout_lock) {
+#ifdef CONFIG_TIMEOUT_WHEEL
+		if (!wheel_ready) {
+			wheel_init();
+		}
+
+		to->dticks = ticks;
+		to->expires = curr_tick + elapsed() + ticks;
+		wheel_insert(to, curr_tick);
+
+		if (to->expires < wheel_next) {
+			wheel_next = to->expires;
+			z_clock_set_timeout(next_timeout(), false);
+		}
+#else
 		struct _timeout *t;
 
 		to->dticks = ticks + elapsed();
@@ -126,6 +284,7 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn,
 		if (to == first()) {
 			z_clock_set_timeout(next_timeout(), false);
 		}
+#endif
 	}
 }
 
@@ -152,12 +311,16 @@ static k_ticks_t timeout_rem(struct _timeout *timeout)
 		return 0;
 	}
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+	ticks = timeout->expires - curr_tick;
+#else
 	for (struct _timeout *t = first(); t != NULL; t = next(t)) {
 		ticks += t->dticks;
 		if (timeout == t) {
 			break;
 		}
 	}
+#endif
 
 	return ticks - elapsed();
 }
@@ -217,6 +380,99 @@ void z_set_timeout_expiry(s32_t ticks, bool idle)
 	}
 }
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+/* Process tick t: cascade the slots of all levels whose block starts
+ * at t, then expire the level 0 slot of t.  Called locked, returns
+ * with the lock held, but drops it around the timeout callbacks.
+ */
+static k_spinlock_key_t wheel_step(u64_t t, k_spinlock_key_t key)
+{
+	u32_t idx = (u32_t)t & WHEEL_MASK;
+	sys_dlist_t expired;
+	sys_dnode_t *n;
+
+	for (int lvl = 1; lvl < WHEEL_LEVELS; lvl++) {
+		int shift = lvl * WHEEL_BITS;
+
+		if ((t & (BIT64(shift) - 1U)) != 0U) {
+			break;
+		}
+		wheel_cascade(lvl, (u32_t)(t >> shift) & WHEEL_MASK, t - 1U);
+	}
+
+	curr_tick = t;
+
+	if ((wheel_bitmap[0] & BIT(idx)) == 0U) {
+		return key;
+	}
+
+	/* Detach the slot first: timeouts added by the callbacks may
+	 * hash to the same slot one rotation later.
+	 */
+	sys_dlist_init(&expired);
+	while ((n = sys_dlist_get(&wheel[0][idx])) != NULL) {
+		sys_dlist_append(&expired, n);
+	}
+	wheel_bitmap[0] &= ~BIT(idx);
+
+	while ((n = sys_dlist_get(&expired)) != NULL) {
+		struct _timeout *to = CONTAINER_OF(n, struct _timeout, node);
+
+		to->dticks = 0;
+
+		k_spin_unlock(&timeout_lock, key);
+		to->fn(to);
+		key = k_spin_lock(&timeout_lock);
+	}
+
+	return key;
+}
+
+void z_clock_announce(s32_t ticks)
+{
+#ifdef CONFIG_TIMESLICING
+	z_time_slice(ticks);
+#endif
+
+	k_spinlock_key_t key = k_spin_lock(&timeout_lock);
+	u64_t target = curr_tick + ticks;
+
+	if (!wheel_ready) {
+		wheel_init();
+	}
+
+	while (curr_tick < target) {
+		int lvl = 0;
+		u64_t t;
+
+		/* With the lower levels empty nothing happens until
+		 * the next block boundary of the lowest busy level
+		 */
+		while (lvl < WHEEL_LEVELS && wheel_bitmap[lvl] == 0U) {
+			lvl++;
+		}
+
+		if (lvl == 0) {
+			t = curr_tick + 1;
+		} else if (lvl == WHEEL_LEVELS) {
+			t = target;
+		} else {
+			int shift = lvl * WHEEL_BITS;
+
+			t = MIN(target, ((curr_tick >> shift) + 1) << shift);
+		}
+
+		announce_remaining = target - t;
+		key = wheel_step(t, key);
+	}
+
+	announce_remaining = 0;
+
+	z_clock_set_timeout(next_timeout(), false);
+
+	k_spin_unlock(&timeout_lock, key);
+}
+#else
 void z_clock_announce(s32_t ticks)
 {
 #ifdef CONFIG_TIMESLICING
@@ -252,6 +508,7 @@ void z_clock_announce(s32_t ticks)
 
 	k_spin_unlock(&timeout_lock, key);
 }
+#endif /* CONFIG_TIMEOUT_WHEEL */
 
 s64_t z_tick_get(void)
 {
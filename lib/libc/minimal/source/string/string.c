@@ -8,8 +8,44 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <sys/types.h>
 
+/*
+ * Unless optimizing for size, the routines below work a word at a time
+ * where they can.  A word contains a zero byte exactly when
+ * (w - 0x0101...01) & ~w & 0x8080...80 is non-zero; comparing against
+ * another byte value is done by XOR-ing with that byte replicated in
+ * every lane first.  Aligned word reads never cross into another page,
+ * so reading a few bytes past the end of a string within the word
+ * holding its terminator is safe.
+ *
+ * An architecture can replace any of the optimized routines with its
+ * own by selecting the matching CONFIG_ARCH_HAS_<ROUTINE> option.
+ */
+
+#define WORD_SIZE sizeof(mem_word_t)
+#define WORD_MASK (WORD_SIZE - 1)
+#define WORD_ONES ((mem_word_t)-1 / 0xff)
+#define WORD_HIGHS (WORD_ONES << 7)
+
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+static inline bool word_aligned(const void *p)
+{
+	return ((uintptr_t)p & WORD_MASK) == 0;
+}
+
+static inline bool word_has_zero(mem_word_t w)
+{
+	return ((w - WORD_ONES) & ~w & WORD_HIGHS) != 0;
+}
+
+static inline mem_word_t word_splat(unsigned char c)
+{
+	return WORD_ONES * c;
+}
+#endif
+
 /**
  *
  * @brief Copy a string
@@ -104,17 +140,35 @@ char *strrchr(const char *s, int c)
  * @return number of bytes in string <s>
  */
 
+#ifndef CONFIG_ARCH_HAS_STRLEN
 size_t strlen(const char *s)
 {
-	size_t n = 0;
+	const char *p = s;
 
-	while (*s != '\0') {
-		s++;
-		n++;
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+	while (!word_aligned(p)) {
+		if (*p == '\0') {
+			return p - s;
+		}
+		p++;
 	}
 
-	return n;
+	const mem_word_t *w = (const mem_word_t *)p;
+
+	while (!word_has_zero(*w)) {
+		w++;
+	}
+
+	p = (const char *)w;
+#endif
+
+	while (*p != '\0') {
+		p++;
+	}
+
+	return p - s;
 }
+#endif
 
 /**
  *
@@ -142,15 +196,41 @@ size_t strnlen(const char *s, size_t maxlen)
  * @return negative # if <s1> < <s2>, 0 if <s1> == <s2>, else positive #
  */
 
+#ifndef CONFIG_ARCH_HAS_STRCMP
 int strcmp(const char *s1, const char *s2)
 {
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+	if ((((uintptr_t)s1 ^ (uintptr_t)s2) & WORD_MASK) == 0) {
+		while (!word_aligned(s1)) {
+			if ((*s1 != *s2) || (*s1 == '\0')) {
+				return (unsigned char)*s1 - (unsigned char)*s2;
+			}
+			s1++;
+			s2++;
+		}
+
+		const mem_word_t *w1 = (const mem_word_t *)s1;
+		const mem_word_t *w2 = (const mem_word_t *)s2;
+
+		while ((*w1 == *w2) && !word_has_zero(*w1)) {
+			w1++;
+			w2++;
+		}
+
+		/* The bytes loop below finds the difference or the end */
+		s1 = (const char *)w1;
+		s2 = (const char *)w2;
+	}
+#endif
+
 	while ((*s1 == *s2) && (*s1 != '\0')) {
 		s1++;
 		s2++;
 	}
 
-	return *s1 - *s2;
+	return (unsigned char)*s1 - (unsigned char)*s2;
 }
+#endif
 
 /**
  *
@@ -197,15 +277,44 @@ char *strncat(char *_MLIBC_RESTRICT dest, const char *_MLIBC_RESTRICT src,
  *
  * @return negative # if <m1> < <m2>, 0 if <m1> == <m2>, else positive #
  */
+#ifndef CONFIG_ARCH_HAS_MEMCMP
 int memcmp(const void *m1, const void *m2, size_t n)
 {
-	const char *c1 = m1;
-	const char *c2 = m2;
+	const unsigned char *c1 = m1;
+	const unsigned char *c2 = m2;
 
 	if (!n) {
 		return 0;
 	}
 
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+	if ((((uintptr_t)c1 ^ (uintptr_t)c2) & WORD_MASK) == 0) {
+		while (!word_aligned(c1) && (n > 1)) {
+			if (*c1 != *c2) {
+				return *c1 - *c2;
+			}
+			c1++;
+			c2++;
+			n--;
+		}
+
+		const mem_word_t *w1 = (const mem_word_t *)c1;
+		const mem_word_t *w2 = (const mem_word_t *)c2;
+
+		/* Keep at least one byte for the loop below, which
+		 * also locates the first difference in a word
+		 */
+		while ((n > WORD_SIZE) && (*w1 == *w2)) {
+			w1++;
+			w2++;
+			n -= WORD_SIZE;
+		}
+
+		c1 = (const unsigned char *)w1;
+		c2 = (const unsigned char *)w2;
+	}
+#endif
+
 	while ((--n > 0) && (*c1 == *c2)) {
 		c1++;
 		c2++;
@@ -213,6 +322,92 @@ int memcmp(const void *m1, const void *m2, size_t n)
 
 	return *c1 - *c2;
 }
+#endif
+
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+/*
+ * Forward copy for memcpy() and memmove(), safe for overlapping areas
+ * as long as <d> is below <s>: every word is read before the word
+ * covering the same bytes is written.
+ */
+static unsigned char *copy_forward(unsigned char *d_byte,
+				   const unsigned char *s_byte, size_t n)
+{
+	/* do byte-sized copying until the destination is word-aligned */
+
+	while (!word_aligned(d_byte)) {
+		if (n == 0) {
+			return d_byte;
+		}
+		*(d_byte++) = *(s_byte++);
+		n--;
+	}
+
+	mem_word_t *d_word = (mem_word_t *)d_byte;
+
+	if (word_aligned(s_byte)) {
+		/* do unrolled word-sized copying as long as possible */
+
+		const mem_word_t *s_word = (const mem_word_t *)s_byte;
+
+		while (n >= 4 * WORD_SIZE) {
+			d_word[0] = s_word[0];
+			d_word[1] = s_word[1];
+			d_word[2] = s_word[2];
+			d_word[3] = s_word[3];
+			d_word += 4;
+			s_word += 4;
+			n -= 4 * WORD_SIZE;
+		}
+
+		while (n >= WORD_SIZE) {
+			*(d_word++) = *(s_word++);
+			n -= WORD_SIZE;
+		}
+
+		s_byte = (const unsigned char *)s_word;
+	} else if (n >= 2 * WORD_SIZE) {
+		/*
+		 * Misaligned source: read aligned source words and shift
+		 * the two halves of each destination word into place.
+		 * Only words holding at least one source byte are read.
+		 */
+
+		unsigned int off = (uintptr_t)s_byte & WORD_MASK;
+		unsigned int shift = off * 8U;
+		const mem_word_t *s_word =
+			(const mem_word_t *)(s_byte - off);
+		mem_word_t w0 = *(s_word++);
+
+		while (n >= 2 * WORD_SIZE) {
+			mem_word_t w1 = *(s_word++);
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			*(d_word++) = (w0 >> shift) |
+				      (w1 << (Z_MEM_WORD_T_WIDTH - shift));
+#else
+			*(d_word++) = (w0 << shift) |
+				      (w1 >> (Z_MEM_WORD_T_WIDTH - shift));
+#endif
+			w0 = w1;
+			n -= WORD_SIZE;
+		}
+
+		s_byte = (const unsigned char *)s_word - WORD_SIZE + off;
+	}
+
+	d_byte = (unsigned char *)d_word;
+
+	/* do byte-sized copying until finished */
+
+	while (n > 0) {
+		*(d_byte++) = *(s_byte++);
+		n--;
+	}
+
+	return d_byte;
+}
+#endif
 
 /**
  *
@@ -220,7 +415,7 @@ int memcmp(const void *m1, const void *m2, size_t n)
  *
  * @return pointer to destination buffer <d>
  */
-
+#ifndef CONFIG_ARCH_HAS_MEMMOVE
 void *memmove(void *d, const void *s, size_t n)
 {
 	char *dest = d;
@@ -232,22 +427,43 @@ void *memmove(void *d, const void *s, size_t n)
 		 * Copy backwards to prevent the premature corruption of <src>.
 		 */
 
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+		if ((((uintptr_t)dest ^ (uintptr_t)src) & WORD_MASK) == 0) {
+			while (!word_aligned(dest + n) && (n > 0)) {
+				n--;
+				dest[n] = src[n];
+			}
+
+			while (n >= WORD_SIZE) {
+				n -= WORD_SIZE;
+				*(mem_word_t *)(dest + n) =
+					*(const mem_word_t *)(src + n);
+			}
+		}
+#endif
+
 		while (n > 0) {
 			n--;
 			dest[n] = src[n];
 		}
 	} else {
 		/* It is safe to perform a forward-copy */
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+		copy_forward((unsigned char *)dest,
+			     (const unsigned char *)src, n);
+#else
 		while (n > 0) {
 			*dest = *src;
 			dest++;
 			src++;
 			n--;
 		}
+#endif
 	}
 
 	return d;
 }
+#endif
 
 /**
  *
@@ -255,9 +471,12 @@ void *memmove(void *d, const void *s, size_t n)
  *
  * @return pointer to start of destination buffer
  */
-
+#ifndef CONFIG_ARCH_HAS_MEMCPY
 void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 {
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+	copy_forward((unsigned char *)d, (const unsigned char *)s, n);
+#else
 	/* attempt word-sized copying only if buffers have identical alignment */
 
 	unsigned char *d_byte = (unsigned char *)d;
@@ -296,9 +515,11 @@ void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 		*(d_byte++) = *(s_byte++);
 		n--;
 	}
+#endif
 
 	return d;
 }
+#endif
 
 /**
  *
@@ -306,7 +527,7 @@ void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
  *
  * @return pointer to start of buffer
  */
-
+#ifndef CONFIG_ARCH_HAS_MEMSET
 void *memset(void *buf, int c, size_t n)
 {
 	/* do byte-sized initialization until word-aligned or finished */
@@ -333,6 +554,17 @@ void *memset(void *buf, int c, size_t n)
 	c_word |= c_word << 32;
 #endif
 
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+	while (n >= 4 * sizeof(mem_word_t)) {
+		d_word[0] = c_word;
+		d_word[1] = c_word;
+		d_word[2] = c_word;
+		d_word[3] = c_word;
+		d_word += 4;
+		n -= 4 * sizeof(mem_word_t);
+	}
+#endif
+
 	while (n >= sizeof(mem_word_t)) {
 		*(d_word++) = c_word;
 		n -= sizeof(mem_word_t);
@@ -349,6 +581,7 @@ void *memset(void *buf, int c, size_t n)
 
 	return buf;
 }
+#endif
 
 /**
  *
@@ -356,12 +589,33 @@ void *memset(void *buf, int c, size_t n)
  *
  * @return pointer to start of found byte
  */
-
+#ifndef CONFIG_ARCH_HAS_MEMCHR
 void *memchr(const void *s, int c, size_t n)
 {
-	if (n != 0) {
-		const unsigned char *p = s;
+	const unsigned char *p = s;
+
+#ifndef CONFIG_MINIMAL_LIBC_OPTIMIZE_STRING_FOR_SIZE
+	while (!word_aligned(p) && (n > 0)) {
+		if (*p == (unsigned char)c) {
+			return (void *)p;
+		}
+		p++;
+		n--;
+	}
 
+	const mem_word_t *w = (const mem_word_t *)p;
+	mem_word_t c_word = word_splat((unsigned char)c);
+
+	/* Skip words which can't contain the byte */
+	while ((n >= WORD_SIZE) && !word_has_zero(*w ^ c_word)) {
+		w++;
+		n -= WORD_SIZE;
+	}
+
+	p = (const unsigned char *)w;
+#endif
+
+	if (n != 0) {
 		do {
 			if (*p++ == (unsigned char)c) {
 				return ((void *)(p - 1));
@@ -372,3 +626,4 @@ void *memchr(const void *s, int c, size_t n)
 
 	return NULL;
 }
+#endif
@@ -19,7 +19,7 @@
 
 static size_t max_chunkid(struct z_heap *h)
 {
-	return h->len - bytes_to_chunksz(h, 1);
+	return h->len - min_chunk_size(h);
 }
 
 static bool in_bounds(struct z_heap *h, chunkid_t c)
@@ -68,11 +68,68 @@ static inline void check_nexts(struct z_heap *h, int bidx)
 	}
 }
 
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+/* Every slab on a class list must be a used chunk with a free count
+ * matching its free list, and the free block total must match the
+ * heap's accounting.
+ */
+static bool valid_slabs(struct z_heap *h)
+{
+	size_t free_units = 0;
+
+	if (h->slabs == NULL) {
+		return true;
+	}
+
+	for (int i = 0; i < Z_HEAP_SLAB_CLASSES; i++) {
+		struct z_heap_slab *s;
+
+		SYS_DLIST_FOR_EACH_CONTAINER(&h->slabs->lists[i], s, node) {
+			chunkid_t sc = mem_to_chunkid(h, s);
+			u32_t n = 0;
+
+			if (!valid_chunk(h, sc) || !used(h, sc)) {
+				return false;
+			}
+			if (s->cls != i || s->nfree == 0U ||
+			    s->nfree > s->nblocks) {
+				return false;
+			}
+
+			for (void **b = s->free_list; b != NULL; b = *b) {
+				chunkid_t c = mem_to_chunkid(h, b);
+
+				if (c <= sc || c >= right_chunk(h, sc) ||
+				    size(h, c) != 0 ||
+				    c - left_size(h, c) != sc ||
+				    ++n > s->nfree) {
+					return false;
+				}
+			}
+
+			if (n != s->nfree) {
+				return false;
+			}
+			free_units += n * bytes_to_chunksz(h,
+							   slab_class_bytes(i));
+		}
+	}
+
+	return free_units == h->slabs->free_units;
+}
+#endif
+
 bool sys_heap_validate(struct sys_heap *heap)
 {
 	struct z_heap *h = heap->heap;
 	chunkid_t c;
 
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	if (!valid_slabs(h)) {
+		return false;
+	}
+#endif
+
 	/* Check the free lists: entry count should match, empty bit
 	 * should be correct, and all chunk entries should point into
 	 * valid unused chunks.  Mark those chunks USED, temporarily.
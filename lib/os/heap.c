@@ -5,17 +5,9 @@
  */
 #include <sys/sys_heap.h>
 #include <kernel.h>
+#include <string.h>
 #include "heap.h"
 
-static void *chunk_mem(struct z_heap *h, chunkid_t c)
-{
-	u8_t *ret = ((u8_t *)&h->buf[c]) + chunk_header_bytes(h);
-
-	CHECK(!(((size_t)ret) & (big_heap(h) ? 7 : 3)));
-
-	return ret;
-}
-
 static void free_list_remove(struct z_heap *h, int bidx,
 			     chunkid_t c)
 {
@@ -73,6 +65,26 @@ static ALWAYS_INLINE bool last_chunk(struct z_heap *h, chunkid_t c)
 	return (c + size(h, c)) == h->len;
 }
 
+/* Splits chunk lc at rc into two chunks.  Both end up marked unused,
+ * neither is on a free list.
+ */
+static void split_chunks(struct z_heap *h, chunkid_t lc, chunkid_t rc)
+{
+	CHECK(rc > lc);
+	CHECK(rc - lc < size(h, lc));
+
+	size_t sz0 = size(h, lc);
+	size_t lsz = rc - lc;
+	size_t rsz = sz0 - lsz;
+
+	chunk_set(h, lc, SIZE_AND_USED, lsz);
+	chunk_set(h, rc, SIZE_AND_USED, rsz);
+	chunk_set(h, rc, LEFT_SIZE, lsz);
+	if (!last_chunk(h, rc)) {
+		chunk_set(h, right_chunk(h, rc), LEFT_SIZE, rsz);
+	}
+}
+
 /* Allocates (fit check has already been perfomred) from the next
  * chunk at the specified bucket level
  */
@@ -90,33 +102,25 @@ static void *split_alloc(struct z_heap *h, int bidx, size_t sz)
 
 	CHECK(rem < h->len);
 
-	if (rem >= (big_heap(h) ? 2 : 1)) {
-		chunkid_t c2 = c + sz;
-		chunkid_t c3 = right_chunk(h, c);
-
-		chunk_set(h, c, SIZE_AND_USED, sz);
-		chunk_set(h, c2, SIZE_AND_USED, rem);
-		chunk_set(h, c2, LEFT_SIZE, sz);
-		if (!last_chunk(h, c2)) {
-			chunk_set(h, c3, LEFT_SIZE, rem);
-		}
-		free_list_add(h, c2);
+	if (rem >= min_chunk_size(h)) {
+		split_chunks(h, c, c + sz);
+		free_list_add(h, c + sz);
 	}
 
 	chunk_set_used(h, c, true);
 
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	h->free_units -= size(h, c);
+#endif
+
 	return chunk_mem(h, c);
 }
 
-void sys_heap_free(struct sys_heap *heap, void *mem)
+static void free_chunk(struct z_heap *h, chunkid_t c)
 {
-	if (mem == NULL) {
-		return; /* ISO C free() semantics */
-	}
-
-	struct z_heap *h = heap->heap;
-	chunkid_t c = ((u8_t *)mem - chunk_header_bytes(h)
-		       - (u8_t *)h->buf) / CHUNK_UNIT;
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	h->free_units += size(h, c);
+#endif
 
 	/* Merge with right chunk?  We can just absorb it. */
 	if (!last_chunk(h, c) && !used(h, right_chunk(h, c))) {
@@ -150,9 +154,8 @@ void sys_heap_free(struct sys_heap *heap, void *mem)
 	free_list_add(h, c);
 }
 
-void *sys_heap_alloc(struct sys_heap *heap, size_t bytes)
+static void *alloc_chunk(struct z_heap *h, size_t bytes)
 {
-	struct z_heap *h = heap->heap;
 	size_t sz = bytes_to_chunksz(h, bytes);
 	int bi = bucket_idx(h, sz);
 	struct z_heap_bucket *b = &h->buckets[bi];
@@ -199,6 +202,418 @@ void *sys_heap_alloc(struct sys_heap *heap, size_t bytes)
 	return NULL;
 }
 
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+/* Size class of a request, indexed by (bytes - 1) / 8 */
+static const u8_t slab_class_of[Z_HEAP_SLAB_MAX_BYTES / 8] = {
+	0, 0, 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6
+};
+
+static size_t slab_hdr_units(struct z_heap *h)
+{
+	return bytes_to_chunksz(h, sizeof(struct z_heap_slab));
+}
+
+static size_t slab_stride(struct z_heap *h, int cls)
+{
+	return bytes_to_chunksz(h, slab_class_bytes(cls));
+}
+
+static struct z_heap_slab *slab_new(struct z_heap *h, int cls)
+{
+	size_t stride = slab_stride(h, cls);
+	size_t units = slab_hdr_units(h)
+		+ CONFIG_SYS_HEAP_SMALL_OBJECT_BLOCKS * stride;
+	struct z_heap_slab *s;
+
+	/* Don't let slabs eat up small heaps */
+	if (units * 8 > h->len) {
+		return NULL;
+	}
+
+	if (h->slabs == NULL) {
+		h->slabs = alloc_chunk(h, sizeof(*h->slabs));
+		if (h->slabs == NULL) {
+			return NULL;
+		}
+
+		h->slabs->free_units = 0;
+		h->slabs->count = 0;
+		for (int i = 0; i < Z_HEAP_SLAB_CLASSES; i++) {
+			sys_dlist_init(&h->slabs->lists[i]);
+		}
+	}
+
+	s = alloc_chunk(h, units * CHUNK_UNIT - chunk_header_bytes(h));
+	if (s == NULL) {
+		return NULL;
+	}
+
+	chunkid_t sc = mem_to_chunkid(h, s);
+	chunkid_t first = sc + slab_hdr_units(h);
+
+	s->free_list = NULL;
+	s->nblocks = CONFIG_SYS_HEAP_SMALL_OBJECT_BLOCKS;
+	s->nfree = s->nblocks;
+	s->cls = cls;
+
+	/* Block headers never change, write them once */
+	for (int i = s->nblocks - 1; i >= 0; i--) {
+		chunkid_t b = first + i * stride;
+		void **blk = chunk_mem(h, b);
+
+		chunk_set(h, b, SIZE_AND_USED, 0);
+		chunk_set(h, b, LEFT_SIZE, b - sc);
+		*blk = s->free_list;
+		s->free_list = blk;
+	}
+
+	sys_dlist_append(&h->slabs->lists[cls], &s->node);
+	h->slabs->free_units += s->nblocks * stride;
+	h->slabs->count++;
+
+	return s;
+}
+
+static void *slab_alloc(struct z_heap *h, size_t bytes)
+{
+	int cls = slab_class_of[(bytes - 1) / 8];
+	sys_dnode_t *node = NULL;
+	struct z_heap_slab *s;
+	void **blk;
+
+	if (h->slabs != NULL) {
+		node = sys_dlist_peek_head(&h->slabs->lists[cls]);
+	}
+
+	if (node != NULL) {
+		s = CONTAINER_OF(node, struct z_heap_slab, node);
+	} else {
+		s = slab_new(h, cls);
+		if (s == NULL) {
+			return NULL;
+		}
+	}
+
+	blk = s->free_list;
+	s->free_list = *blk;
+	s->nfree--;
+	if (s->nfree == 0U) {
+		sys_dlist_remove(&s->node);
+	}
+	h->slabs->free_units -= slab_stride(h, cls);
+
+	return blk;
+}
+
+static void slab_release(struct z_heap *h, struct z_heap_slab *s)
+{
+	sys_dlist_remove(&s->node);
+	h->slabs->free_units -= s->nblocks * slab_stride(h, s->cls);
+	h->slabs->count--;
+	free_chunk(h, mem_to_chunkid(h, s));
+}
+
+static void slab_free(struct z_heap *h, chunkid_t c)
+{
+	chunkid_t sc = c - left_size(h, c);
+	struct z_heap_slab *s = chunk_mem(h, sc);
+	void **blk = chunk_mem(h, c);
+	sys_dlist_t *list = &h->slabs->lists[s->cls];
+
+	*blk = s->free_list;
+	s->free_list = blk;
+	h->slabs->free_units += slab_stride(h, s->cls);
+
+	if (s->nfree++ == 0U) {
+		sys_dlist_prepend(list, &s->node);
+	} else if (s->nfree == s->nblocks &&
+		   sys_dlist_has_multiple_nodes(list)) {
+		/* Empty and not the last slab of its class: give the
+		 * memory back to the heap
+		 */
+		slab_release(h, s);
+	}
+}
+
+/* Gives all slabs without allocated blocks, and the slab lists if no
+ * slabs are left, back to the heap.  Returns true if anything was
+ * freed.
+ */
+static bool slab_reclaim(struct z_heap *h)
+{
+	bool freed = false;
+
+	if (h->slabs == NULL) {
+		return false;
+	}
+
+	for (int i = 0; i < Z_HEAP_SLAB_CLASSES; i++) {
+		struct z_heap_slab *s, *tmp;
+
+		SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&h->slabs->lists[i],
+						  s, tmp, node) {
+			if (s->nfree == s->nblocks) {
+				slab_release(h, s);
+				freed = true;
+			}
+		}
+	}
+
+	if (h->slabs->count == 0U) {
+		free_chunk(h, mem_to_chunkid(h, h->slabs));
+		h->slabs = NULL;
+		freed = true;
+	}
+
+	return freed;
+}
+#endif
+
+void sys_heap_free(struct sys_heap *heap, void *mem)
+{
+	if (mem == NULL) {
+		return; /* ISO C free() semantics */
+	}
+
+	struct z_heap *h = heap->heap;
+	chunkid_t c = mem_to_chunkid(h, mem);
+
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	if (size(h, c) == 0) {
+		slab_free(h, c);
+		return;
+	}
+#endif
+
+	free_chunk(h, c);
+}
+
+void *sys_heap_alloc(struct sys_heap *heap, size_t bytes)
+{
+	struct z_heap *h = heap->heap;
+
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	if (bytes != 0 && bytes <= Z_HEAP_SLAB_MAX_BYTES) {
+		void *ret = slab_alloc(h, bytes);
+
+		/* No room for a new slab, the general allocator
+		 * might still find a fit
+		 */
+		if (ret != NULL) {
+			return ret;
+		}
+	}
+#endif
+
+	void *ret = alloc_chunk(h, bytes);
+
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	/* Empty slabs kept around are just a cache, reclaim them
+	 * before giving up
+	 */
+	if (ret == NULL && slab_reclaim(h)) {
+		ret = alloc_chunk(h, bytes);
+	}
+#endif
+
+	return ret;
+}
+
+/* Gives the tail of used chunk c beyond its first sz units back to
+ * the heap, if it is large enough to be a chunk of its own
+ */
+static void trim_chunk(struct z_heap *h, chunkid_t c, size_t sz)
+{
+	if (size(h, c) - sz >= min_chunk_size(h)) {
+		split_chunks(h, c, c + sz);
+		chunk_set_used(h, c, true);
+		free_chunk(h, c + sz);
+	}
+}
+
+void *sys_heap_aligned_alloc(struct sys_heap *heap, size_t align,
+			     size_t bytes)
+{
+	struct z_heap *h = heap->heap;
+
+	CHECK((align & (align - 1)) == 0);
+
+	/* Every allocation is aligned to a chunk unit */
+	if (align <= CHUNK_UNIT) {
+		return sys_heap_alloc(heap, bytes);
+	}
+
+	if (bytes == 0) {
+		return NULL;
+	}
+
+	/* Over-allocate enough to find an aligned address which
+	 * leaves either nothing or a whole free chunk in front of it,
+	 * then give the unused head and tail back to the heap.
+	 */
+	size_t pad = align - 1 + min_chunk_size(h) * CHUNK_UNIT;
+	u8_t *mem0 = alloc_chunk(h, bytes + pad);
+
+	if (mem0 == NULL) {
+		return NULL;
+	}
+
+	chunkid_t c0 = mem_to_chunkid(h, mem0);
+	u8_t *mem = (u8_t *)ROUND_UP(mem0, align);
+	chunkid_t c = mem_to_chunkid(h, mem);
+
+	while (c != c0 && c - c0 < min_chunk_size(h)) {
+		mem += align;
+		c = mem_to_chunkid(h, mem);
+	}
+
+	if (c != c0) {
+		/* The head is free again, c is the used chunk */
+		split_chunks(h, c0, c);
+		chunk_set_used(h, c, true);
+		free_chunk(h, c0);
+	}
+
+	trim_chunk(h, c, bytes_to_chunksz(h, bytes));
+
+	return mem;
+}
+
+static void *realloc_move(struct sys_heap *heap, void *ptr, size_t align,
+			  size_t old_bytes, size_t bytes)
+{
+	void *ret = sys_heap_aligned_alloc(heap, align, bytes);
+
+	if (ret != NULL) {
+		memcpy(ret, ptr, MIN(old_bytes, bytes));
+		sys_heap_free(heap, ptr);
+	}
+
+	return ret;
+}
+
+void *sys_heap_aligned_realloc(struct sys_heap *heap, void *ptr,
+			       size_t align, size_t bytes)
+{
+	struct z_heap *h = heap->heap;
+
+	CHECK((align & (align - 1)) == 0);
+
+	if (ptr == NULL) {
+		return sys_heap_aligned_alloc(heap, align, bytes);
+	}
+
+	if (bytes == 0) {
+		sys_heap_free(heap, ptr);
+		return NULL;
+	}
+
+	chunkid_t c = mem_to_chunkid(h, ptr);
+	size_t old_bytes;
+	bool aligned = align == 0 || ((uintptr_t)ptr & (align - 1)) == 0;
+
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	if (size(h, c) == 0) {
+		struct z_heap_slab *s = chunk_mem(h, c - left_size(h, c));
+
+		old_bytes = slab_class_bytes(s->cls);
+		if (aligned && bytes <= old_bytes) {
+			return ptr;
+		}
+
+		return realloc_move(heap, ptr, align, old_bytes, bytes);
+	}
+#endif
+
+	size_t sz = bytes_to_chunksz(h, bytes);
+
+	old_bytes = size(h, c) * CHUNK_UNIT - chunk_header_bytes(h);
+
+	if (!aligned) {
+		return realloc_move(heap, ptr, align, old_bytes, bytes);
+	}
+
+	if (sz <= size(h, c)) {
+		/* Shrink in place */
+		trim_chunk(h, c, sz);
+		return ptr;
+	}
+
+	if (!last_chunk(h, c) && !used(h, right_chunk(h, c))) {
+		chunkid_t rc = right_chunk(h, c);
+		size_t merged_sz = size(h, c) + size(h, rc);
+
+		if (sz <= merged_sz) {
+			/* Grow in place by absorbing the free right
+			 * neighbor, then give back what isn't needed
+			 */
+			free_list_remove(h, bucket_idx(h, size(h, rc)), rc);
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+			h->free_units -= size(h, rc);
+#endif
+			chunk_set(h, c, SIZE_AND_USED, merged_sz);
+			chunk_set_used(h, c, true);
+			if (!last_chunk(h, c)) {
+				chunk_set(h, right_chunk(h, c), LEFT_SIZE,
+					  merged_sz);
+			}
+			trim_chunk(h, c, sz);
+			return ptr;
+		}
+	}
+
+	return realloc_move(heap, ptr, align, old_bytes, bytes);
+}
+
+void *sys_heap_realloc(struct sys_heap *heap, void *ptr, size_t bytes)
+{
+	return sys_heap_aligned_realloc(heap, ptr, 0, bytes);
+}
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+int sys_heap_runtime_stats_get(struct sys_heap *heap,
+			       struct sys_heap_runtime_stats *stats)
+{
+	if (heap == NULL || stats == NULL) {
+		return -EINVAL;
+	}
+
+	struct z_heap *h = heap->heap;
+	size_t total = h->len - h->chunk0;
+	size_t cached = 0, largest = 0;
+
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	if (h->slabs != NULL) {
+		cached = h->slabs->free_units;
+	}
+#endif
+
+	/* The largest free chunk lives in the highest non-empty
+	 * bucket, but that bucket must be searched for it.
+	 */
+	if (h->avail_buckets != 0) {
+		int bi = 31 - __builtin_clz(h->avail_buckets);
+		struct z_heap_bucket *b = &h->buckets[bi];
+		chunkid_t c = b->next;
+
+		for (size_t i = 0; i < b->list_size; i++) {
+			largest = MAX(largest, size(h, c));
+			c = free_next(h, c);
+		}
+	}
+
+	stats->allocated_bytes = (total - h->free_units - cached) * CHUNK_UNIT;
+	stats->free_bytes = h->free_units * CHUNK_UNIT;
+	stats->cached_bytes = cached * CHUNK_UNIT;
+	stats->max_free_bytes = largest != 0 ?
+		largest * CHUNK_UNIT - chunk_header_bytes(h) : 0;
+	stats->fragmentation = h->free_units != 0 ?
+		100 - (largest * 100) / h->free_units : 0;
+
+	return 0;
+}
+#endif
+
 void sys_heap_init(struct sys_heap *heap, void *mem, size_t bytes)
 {
 	/* Must fit in a 32 bit count of u64's */
@@ -233,6 +648,14 @@ void sys_heap_init(struct sys_heap *heap, void *mem, size_t bytes)
 		heap->heap->buckets[i].next = 0;
 	}
 
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	h->slabs = NULL;
+#endif
+
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	h->free_units = buf_sz - h->chunk0;
+#endif
+
 	chunk_set(h, h->chunk0, SIZE_AND_USED, buf_sz - h->chunk0);
 	free_list_add(h, h->chunk0);
 }
@@ -43,7 +43,12 @@
  * The free lists are circular lists, one for each power-of-two size
  * category.  The free list pointers exist only for free chunks,
  * obviously.  This memory is part of the user's buffer when
- * allocated.
+ * allocated on big heaps.
+ *
+ * The user's buffer always starts one unit into the chunk, so every
+ * allocation is 8 byte aligned.  On small heaps that leaves the upper
+ * half of the header unit, where the free list pointers live, unused
+ * while the chunk is allocated.
  */
 typedef size_t chunkid_t;
 
@@ -51,6 +56,47 @@ typedef size_t chunkid_t;
 
 enum chunk_fields { SIZE_AND_USED, LEFT_SIZE, FREE_PREV, FREE_NEXT };
 
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+/* Small object front end.  Allocations up to 128 bytes are rounded to
+ * one of a handful of exact size classes and served from "slabs":
+ * ordinary used chunks carved from the heap which hold a slab header
+ * followed by an array of equally sized blocks.
+ *
+ * Each block is laid out like a chunk of its own, with a chunk header
+ * followed by the user memory, so sys_heap_free() finds its header
+ * the usual way.  The header of a block has a SIZE_AND_USED field of
+ * zero (never valid for a real chunk) and its LEFT_SIZE field holds
+ * the offset in chunk units back to the slab chunk.  Free blocks are
+ * kept on a singly linked list through their user memory.
+ */
+#define Z_HEAP_SLAB_CLASSES 7
+#define Z_HEAP_SLAB_MAX_BYTES 128
+
+/* Class sizes are 16, 24, 32, 48, 64, 96 and 128 bytes */
+static inline size_t slab_class_bytes(int cls)
+{
+	return ((2 + (cls & 1)) * 8) << (cls >> 1);
+}
+
+struct z_heap_slab {
+	sys_dnode_t node;	/* in the class list while not full */
+	void *free_list;
+	u16_t nfree;
+	u16_t nblocks;
+	u8_t cls;
+};
+
+/* Per-class lists of the slabs which have free blocks.  Carved from
+ * the heap itself when the first slab is needed, so heaps too small
+ * for slabs don't pay for them.
+ */
+struct z_heap_slab_lists {
+	u32_t free_units;	/* units in free slab blocks */
+	u32_t count;		/* slabs in existence */
+	sys_dlist_t lists[Z_HEAP_SLAB_CLASSES];
+};
+#endif
+
 struct z_heap {
 	u64_t *buf;
 	struct z_heap_bucket *buckets;
@@ -58,6 +104,12 @@ struct z_heap {
 	u32_t size_mask;
 	u32_t chunk0;
 	u32_t avail_buckets;
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+	u32_t free_units;	/* units in free chunks */
+#endif
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+	struct z_heap_slab_lists *slabs;
+#endif
 };
 
 struct z_heap_bucket {
@@ -142,7 +194,30 @@ static inline chunkid_t right_chunk(struct z_heap *h, chunkid_t c)
 
 static inline size_t chunk_header_bytes(struct z_heap *h)
 {
-	return big_heap(h) ? 8 : 4;
+	ARG_UNUSED(h);
+
+	return CHUNK_UNIT;
+}
+
+static inline void *chunk_mem(struct z_heap *h, chunkid_t c)
+{
+	u8_t *ret = ((u8_t *)&h->buf[c]) + chunk_header_bytes(h);
+
+	CHECK(!(((size_t)ret) & (CHUNK_UNIT - 1)));
+
+	return ret;
+}
+
+static inline chunkid_t mem_to_chunkid(struct z_heap *h, void *p)
+{
+	return ((u8_t *)p - chunk_header_bytes(h) - (u8_t *)h->buf)
+		/ CHUNK_UNIT;
+}
+
+/* Smallest chunk which can hold the free list pointers */
+static inline size_t min_chunk_size(struct z_heap *h)
+{
+	return big_heap(h) ? 2 : 1;
 }
 
 static inline size_t chunksz(size_t bytes)
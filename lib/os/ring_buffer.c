@@ -7,6 +7,7 @@
  */
 
 #include <sys/ring_buffer.h>
+#include <sys/atomic.h>
 #include <string.h>
 
 /**
@@ -21,32 +22,43 @@ struct ring_element {
 	u32_t  value  :8;  /**< Room for small integral values */
 };
 
+/* Store an item at @a tail and return the index following it */
+static u32_t item_write(struct ring_buf *buf, u32_t tail, u16_t type,
+			u8_t value, u32_t *data, u8_t size32)
+{
+	struct ring_element *header =
+		(struct ring_element *)&buf->buf.buf32[tail];
+	u32_t i, index;
+
+	header->type = type;
+	header->length = size32;
+	header->value = value;
+
+	if (likely(buf->mask)) {
+		for (i = 0U; i < size32; ++i) {
+			index = (i + tail + 1) & buf->mask;
+			buf->buf.buf32[index] = data[i];
+		}
+		return (tail + size32 + 1) & buf->mask;
+	}
+
+	for (i = 0U; i < size32; ++i) {
+		index = (i + tail + 1) % buf->size;
+		buf->buf.buf32[index] = data[i];
+	}
+	return (tail + size32 + 1) % buf->size;
+}
+
 int ring_buf_item_put(struct ring_buf *buf, u16_t type, u8_t value,
 		      u32_t *data, u8_t size32)
 {
-	u32_t i, space, index, rc;
+	u32_t space, rc;
 
 	space = ring_buf_space_get(buf);
 	if (space >= (size32 + 1)) {
-		struct ring_element *header =
-			(struct ring_element *)&buf->buf.buf32[buf->tail];
-		header->type = type;
-		header->length = size32;
-		header->value = value;
-
-		if (likely(buf->mask)) {
-			for (i = 0U; i < size32; ++i) {
-				index = (i + buf->tail + 1) & buf->mask;
-				buf->buf.buf32[index] = data[i];
-			}
-			buf->tail = (buf->tail + size32 + 1) & buf->mask;
-		} else {
-			for (i = 0U; i < size32; ++i) {
-				index = (i + buf->tail + 1) % buf->size;
-				buf->buf.buf32[index] = data[i];
-			}
-			buf->tail = (buf->tail + size32 + 1) % buf->size;
-		}
+		z_ring_buf_idx_set(&buf->tail,
+				   item_write(buf, buf->tail, type, value,
+					      data, size32));
 		rc = 0U;
 	} else {
 		buf->misc.item_mode.dropped_put_count++;
@@ -56,6 +68,44 @@ int ring_buf_item_put(struct ring_buf *buf, u16_t type, u8_t value,
 	return rc;
 }
 
+int ring_buf_item_put_mp(struct ring_buf *buf, u16_t type, u8_t value,
+			 u32_t *data, u8_t size32)
+{
+	atomic_t *reserved = (atomic_t *)&buf->misc.item_mode.reserved_tail;
+	u32_t start, end;
+	unsigned int key;
+
+	/* Writers publish in claim order, so one must not be preempted on
+	 * this CPU by another one waiting for it to publish.
+	 */
+	key = arch_irq_lock();
+
+	do {
+		start = atomic_get(reserved);
+		if (z_ring_buf_custom_space_get(buf->size,
+						z_ring_buf_idx_get(&buf->head),
+						start) < (size32 + 1)) {
+			(void)atomic_inc((atomic_t *)
+				&buf->misc.item_mode.dropped_put_count);
+			arch_irq_unlock(key);
+			return -EMSGSIZE;
+		}
+		end = likely(buf->mask) ? ((start + size32 + 1) & buf->mask) :
+					  ((start + size32 + 1) % buf->size);
+	} while (!atomic_cas(reserved, start, end));
+
+	(void)item_write(buf, start, type, value, data, size32);
+
+	/* Wait for writers which claimed space before us to publish it */
+	while (z_ring_buf_idx_get(&buf->tail) != start) {
+	}
+	z_ring_buf_idx_set(&buf->tail, end);
+
+	arch_irq_unlock(key);
+
+	return 0;
+}
+
 int ring_buf_item_get(struct ring_buf *buf, u16_t *type, u8_t *value,
 		      u32_t *data, u8_t *size32)
 {
@@ -82,13 +132,15 @@ int ring_buf_item_get(struct ring_buf *buf, u16_t *type, u8_t *value,
 			index = (i + buf->head + 1) & buf->mask;
 			data[i] = buf->buf.buf32[index];
 		}
-		buf->head = (buf->head + header->length + 1) & buf->mask;
+		z_ring_buf_idx_set(&buf->head,
+			(buf->head + header->length + 1) & buf->mask);
 	} else {
 		for (i = 0U; i < header->length; ++i) {
 			index = (i + buf->head + 1) % buf->size;
 			data[i] = buf->buf.buf32[index];
 		}
-		buf->head = (buf->head + header->length + 1) % buf->size;
+		z_ring_buf_idx_set(&buf->head,
+			(buf->head + header->length + 1) % buf->size);
 	}
 
 	return 0;
@@ -110,7 +162,8 @@ u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 {
 	u32_t space, trail_size, allocated;
 
-	space = z_ring_buf_custom_space_get(buf->size, buf->head,
+	space = z_ring_buf_custom_space_get(buf->size,
+					    z_ring_buf_idx_get(&buf->head),
 					    buf->misc.byte_mode.tmp_tail);
 
 	/* Limit requested size to available size. */
@@ -133,8 +186,8 @@ int ring_buf_put_finish(struct ring_buf *buf, u32_t size)
 		return -EINVAL;
 	}
 
-	buf->tail = wrap(buf->tail + size, buf->size);
-	buf->misc.byte_mode.tmp_tail = buf->tail;
+	buf->misc.byte_mode.tmp_tail = wrap(buf->tail + size, buf->size);
+	z_ring_buf_idx_set(&buf->tail, buf->misc.byte_mode.tmp_tail);
 
 	return 0;
 }
@@ -167,7 +220,7 @@ u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 	space = (buf->size - 1) -
 		z_ring_buf_custom_space_get(buf->size,
 					    buf->misc.byte_mode.tmp_head,
-					    buf->tail);
+					    z_ring_buf_idx_get(&buf->tail));
 	trail_size = buf->size - buf->misc.byte_mode.tmp_head;
 
 	/* Limit requested size to available size. */
@@ -191,8 +244,8 @@ int ring_buf_get_finish(struct ring_buf *buf, u32_t size)
 		return -EINVAL;
 	}
 
-	buf->head = wrap(buf->head + size, buf->size);
-	buf->misc.byte_mode.tmp_head = buf->head;
+	buf->misc.byte_mode.tmp_head = wrap(buf->head + size, buf->size);
+	z_ring_buf_idx_set(&buf->head, buf->misc.byte_mode.tmp_head);
 
 	return 0;
 }
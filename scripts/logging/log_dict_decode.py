@@ -0,0 +1,367 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 The Zephyr Project Contributors
+#
+# SPDX-License-Identifier: Apache-2.0
+"""
+Decode the binary log records sent by backends using the dictionary output
+format (CONFIG_LOG_DICTIONARY).
+
+Records hold the address of the format string instead of the string itself,
+together with the source id, level, timestamp and arguments. The format
+strings and log source names are read from the zephyr.elf file the target
+runs, so it must be the exact image that produced the records.
+
+The input is the raw byte stream, read from a file or from the standard
+input. With --hex, the input is text and only the lines written by the
+native_posix backend with CONFIG_LOG_BACKEND_NATIVE_POSIX_DICT are decoded:
+
+    ./zephyr/zephyr.exe | log_dict_decode.py --hex zephyr/zephyr.exe
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+# Must match subsys/logging/log_output_dict.c
+LOG_DICT_MAGIC = 0xD0
+LOG_DICT_TYPE_STD = 0
+LOG_DICT_TYPE_HEXDUMP = 1
+LOG_DICT_TYPE_DROPPED = 2
+
+HEX_LINE_PREFIX = "#zlog:"
+
+LEVELS = [None, "err", "wrn", "inf", "dbg"]
+
+SHF_ALLOC = 0x2
+
+HEXDUMP_BYTES_IN_LINE = 16
+
+# Conversion parsing as done by fmt_parse() on the target
+FMT_RE = re.compile(r"%(%|([-+ #0-9.]*)([hlLqjzt]*)([^\0]))")
+
+ARG_INT, ARG_LONG, ARG_LONG_LONG, ARG_DOUBLE, ARG_PTR, ARG_STR = range(6)
+
+
+class Incomplete(Exception):
+    """Raised when a record continues past the end of the input so far."""
+
+
+class Dictionary:
+    """Format strings and log source names of a Zephyr image."""
+
+    def __init__(self, elf_file):
+        with open(elf_file, "rb") as f:
+            elf = ELFFile(f)
+            self.little_endian = elf.little_endian
+            self.long_size = elf.elfclass // 8
+            self.sections = []
+            symbols = {}
+            consts = []
+
+            for section in elf.iter_sections():
+                if (section["sh_flags"] & SHF_ALLOC and
+                        section["sh_type"] != "SHT_NOBITS"):
+                    self.sections.append((section["sh_addr"],
+                                          section.data()))
+
+                if isinstance(section, SymbolTableSection):
+                    for sym in section.iter_symbols():
+                        symbols[sym.name] = sym.entry["st_value"]
+                        if sym.name.startswith("log_const_"):
+                            consts.append((sym.entry["st_value"],
+                                           sym.name[len("log_const_"):]))
+
+        if "__log_const_start" not in symbols:
+            sys.exit("{} has no log sources".format(elf_file))
+
+        self.base = symbols["__log_const_start"]
+        end = symbols.get("__log_const_end", self.base)
+        consts = sorted(c for c in consts if self.base <= c[0] < end)
+        self.sources = [self.source_name(addr, sym) for addr, sym in consts]
+
+    def read(self, addr, size):
+        for start, data in self.sections:
+            if start <= addr and addr + size <= start + len(data):
+                return data[addr - start:addr - start + size]
+        return None
+
+    def string(self, addr):
+        for start, data in self.sections:
+            if start <= addr < start + len(data):
+                end = data.find(b"\0", addr - start)
+                if end < 0:
+                    end = len(data)
+                return data[addr - start:end].decode("utf-8", "replace")
+        return None
+
+    def source_name(self, addr, sym_name):
+        # The first member of struct log_source_const_data is the name. It
+        # is not in the file for position independent images, the symbol
+        # name is then used.
+        ptr = self.read(addr, self.long_size)
+        if ptr is not None:
+            fmt = ("<" if self.little_endian else ">") + \
+                  ("I" if self.long_size == 4 else "Q")
+            name = self.string(struct.unpack(fmt, ptr)[0])
+            if name:
+                return name
+        return sym_name
+
+
+class Reader:
+    """Reads record fields from a byte buffer."""
+
+    def __init__(self, buf, little_endian):
+        self.buf = buf
+        self.pos = 0
+        self.order = "<" if little_endian else ">"
+
+    def bytes(self, size):
+        if self.pos + size > len(self.buf):
+            raise Incomplete()
+        data = self.buf[self.pos:self.pos + size]
+        self.pos += size
+        return data
+
+    def u8(self):
+        return self.bytes(1)[0]
+
+    def unpack(self, fmt, size):
+        return struct.unpack(self.order + fmt, self.bytes(size))[0]
+
+    def var(self):
+        val = 0
+        shift = 0
+        while True:
+            b = self.u8()
+            val |= (b & 0x7f) << shift
+            shift += 7
+            if not b & 0x80:
+                return val
+
+    def svar(self):
+        val = self.var()
+        return (val >> 1) ^ -(val & 1)
+
+
+def arg_type(length, conv):
+    if conv == "s":
+        return ARG_STR
+    if conv == "p":
+        return ARG_PTR
+    if conv in "fFeEgG":
+        return ARG_DOUBLE
+    longs = length.count("l") + 2 * (length.count("L") + length.count("q"))
+    if longs == 0:
+        return ARG_INT
+    return ARG_LONG if longs == 1 else ARG_LONG_LONG
+
+
+def arg_types(fmt):
+    return [arg_type(m.group(3), m.group(4))
+            for m in FMT_RE.finditer(fmt) if m.group(1) != "%"]
+
+
+def format_string(fmt, args, long_size):
+    """printf() the way the target would, args are already decoded."""
+    it = iter(args)
+
+    def conv(m):
+        if m.group(1) == "%":
+            return "%"
+
+        flags, length, c = m.group(2), m.group(3), m.group(4)
+        try:
+            val = next(it)
+        except StopIteration:
+            return m.group(0)
+
+        if c == "s":
+            return ("%" + flags + "s") % val
+        if c == "p":
+            return "0x%x" % val
+        if c in "fFeEgG":
+            return ("%" + flags + c) % float(val)
+
+        bits = 32 if arg_type(length, c) == ARG_INT else long_size * 8
+        val &= (1 << bits) - 1
+        if c in "di":
+            if val >> (bits - 1):
+                val -= 1 << bits
+            return ("%" + flags + "d") % val
+        if c == "c":
+            return chr(val & 0xff)
+        if c in "xXo":
+            return ("%" + flags + c) % val
+        return ("%" + flags + "d") % val
+
+    return FMT_RE.sub(conv, fmt)
+
+
+class Decoder:
+    def __init__(self, dictionary, timestamp_freq):
+        self.dict = dictionary
+        self.freq = timestamp_freq
+        self.buf = b""
+        self.skipped = 0
+
+    def timestamp(self, ts):
+        if not self.freq:
+            return "[%08u]" % ts
+
+        us = (ts * 1000000) // self.freq
+        seconds, us = divmod(us, 1000000)
+        minutes, seconds = divmod(seconds, 60)
+        hours, minutes = divmod(minutes, 60)
+        return "[%02u:%02u:%02u.%03u,%03u]" % (hours, minutes, seconds,
+                                               us // 1000, us % 1000)
+
+    def prefix(self, level, source_id, ts):
+        if source_id < len(self.dict.sources):
+            source = self.dict.sources[source_id]
+        else:
+            source = "<source %u>" % source_id
+        lvl = LEVELS[level] if level < len(LEVELS) else str(level)
+        return "%s <%s> %s: " % (self.timestamp(ts), lvl, source)
+
+    def addr_string(self, rd):
+        addr = self.dict.base + rd.svar()
+        string = self.dict.string(addr)
+        return string if string is not None else "<0x%x>" % addr
+
+    def std(self, rd, level, source_id, ts):
+        fmt = self.addr_string(rd)
+        nargs = rd.u8()
+        types = arg_types(fmt)
+        types += [ARG_INT] * (nargs - len(types))
+        args = []
+
+        for t in types[:nargs]:
+            if t == ARG_STR:
+                args.append(rd.bytes(rd.u8()).decode("utf-8", "replace"))
+            elif t == ARG_PTR:
+                args.append(rd.var())
+            else:
+                args.append(rd.svar())
+
+        text = format_string(fmt, args, self.dict.long_size)
+        if level == 0:
+            # printk() string, printed as is
+            return text
+        return self.prefix(level, source_id, ts) + text + "\n"
+
+    def hexdump(self, rd, level, source_id, ts):
+        if level == 0:
+            # printk() string formatted on the target, there is no metadata
+            rd.svar()
+            return rd.bytes(rd.var()).decode("utf-8", "replace")
+
+        prefix = self.prefix(level, source_id, ts)
+        out = prefix + self.addr_string(rd) + "\n"
+        data = rd.bytes(rd.var())
+
+        for i in range(0, len(data), HEXDUMP_BYTES_IN_LINE):
+            line = data[i:i + HEXDUMP_BYTES_IN_LINE]
+            hexa = " ".join("%02x" % b for b in line)
+            text = "".join(chr(b) if 32 <= b < 127 else "." for b in line)
+            out += "%s%-48s |%s\n" % (" " * len(prefix), hexa, text)
+        return out
+
+    def record(self, rd):
+        rtype = rd.u8()
+        ids = rd.u8()
+        source_id = rd.unpack("H", 2)
+        ts = rd.unpack("I", 4)
+        level = ids & 0x7
+
+        if rtype == LOG_DICT_MAGIC | LOG_DICT_TYPE_STD:
+            return self.std(rd, level, source_id, ts)
+        if rtype == LOG_DICT_MAGIC | LOG_DICT_TYPE_HEXDUMP:
+            return self.hexdump(rd, level, source_id, ts)
+        return "--- %u messages dropped ---\n" % rd.var()
+
+    def feed(self, data):
+        """Decode as many records as possible, return the decoded text."""
+        self.buf += data
+        out = ""
+
+        while self.buf:
+            if self.buf[0] & 0xf0 != LOG_DICT_MAGIC or \
+               self.buf[0] & 0x0f > LOG_DICT_TYPE_DROPPED:
+                # not the start of a record, resynchronize
+                self.buf = self.buf[1:]
+                self.skipped += 1
+                continue
+
+            rd = Reader(self.buf, self.dict.little_endian)
+            try:
+                out += self.record(rd)
+            except Incomplete:
+                break
+            self.buf = self.buf[rd.pos:]
+
+        return out
+
+
+def hex_lines(stream):
+    for line in stream:
+        idx = line.find(HEX_LINE_PREFIX)
+        if idx >= 0:
+            yield bytes.fromhex(line[idx + len(HEX_LINE_PREFIX):].strip())
+
+
+def binary_chunks(stream):
+    while True:
+        data = stream.read1(4096) if hasattr(stream, "read1") else \
+               stream.read(4096)
+        if not data:
+            return
+        yield data
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="zephyr.elf of the image sending logs")
+    parser.add_argument("input", nargs="?", default="-",
+                        help="file with log records, standard input if "
+                        "omitted")
+    parser.add_argument("--hex", action="store_true",
+                        help="input is native_posix output with records "
+                        "in hexadecimal lines")
+    parser.add_argument("--timestamp-freq", type=int, default=0,
+                        help="timestamp frequency in Hz, timestamps are "
+                        "printed raw if omitted")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    decoder = Decoder(Dictionary(args.elf), args.timestamp_freq)
+
+    if args.hex:
+        stream = sys.stdin if args.input == "-" else \
+                 open(args.input, "r", errors="replace")
+        chunks = hex_lines(stream)
+    else:
+        stream = sys.stdin.buffer if args.input == "-" else \
+                 open(args.input, "rb")
+        chunks = binary_chunks(stream)
+
+    for data in chunks:
+        sys.stdout.write(decoder.feed(data))
+        sys.stdout.flush()
+
+    if decoder.buf or decoder.skipped:
+        sys.stderr.write("%u bytes skipped, %u bytes left undecoded\n" %
+                         (decoder.skipped, len(decoder.buf)))
+
+
+if __name__ == "__main__":
+    main()
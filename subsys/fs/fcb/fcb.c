@@ -164,6 +164,11 @@ fcb_init(int f_area_id, struct fcb *fcb)
 			break;
 		}
 	}
+#if defined(CONFIG_FCB_INDEX)
+	if (rc == 0) {
+		fcb_index_build(fcb);
+	}
+#endif
 	k_mutex_init(&fcb->f_mtx);
 	return rc;
 }
@@ -297,6 +302,18 @@ fcb_offset_last_n(struct fcb *fcb, u8_t entries,
 		entries = 1U;
 	}
 
+#if defined(CONFIG_FCB_INDEX)
+	rc = k_mutex_lock(&fcb->f_mtx, K_FOREVER);
+	if (rc) {
+		return -EINVAL;
+	}
+	rc = fcb_index_last_n(fcb, entries, last_n_entry);
+	k_mutex_unlock(&fcb->f_mtx);
+	if (rc != -EAGAIN) {
+		return rc;
+	}
+#endif
+
 	i = 0;
 	(void)memset(&loc, 0, sizeof(loc));
 	while (!fcb_getnext(fcb, &loc)) {
@@ -64,6 +64,9 @@ fcb_append(struct fcb *fcb, u16_t len, struct fcb_entry *append_loc)
 	int cnt;
 	int rc;
 	u8_t tmp_str[8];
+#if defined(CONFIG_FCB_INDEX)
+	u16_t data_len = len;
+#endif
 
 	cnt = fcb_put_len(tmp_str, len);
 	if (cnt < 0) {
@@ -106,6 +109,11 @@ fcb_append(struct fcb *fcb, u16_t len, struct fcb_entry *append_loc)
 
 	active->fe_elem_off = append_loc->fe_data_off + len;
 
+#if defined(CONFIG_FCB_INDEX)
+	append_loc->fe_data_len = data_len;
+	fcb_index_add(fcb, append_loc, false);
+#endif
+
 	k_mutex_unlock(&fcb->f_mtx);
 
 	return 0;
@@ -133,5 +141,14 @@ fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
 	if (rc) {
 		return -EIO;
 	}
+
+#if defined(CONFIG_FCB_INDEX)
+	rc = k_mutex_lock(&fcb->f_mtx, K_FOREVER);
+	if (rc) {
+		return -EINVAL;
+	}
+	fcb_index_finish(fcb, loc);
+	k_mutex_unlock(&fcb->f_mtx);
+#endif
 	return 0;
 }
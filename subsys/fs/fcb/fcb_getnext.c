@@ -41,7 +41,7 @@ fcb_getnext_sector(struct fcb *fcb, struct flash_sector *sector)
 }
 
 int
-fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
+fcb_getnext_flash(struct fcb *fcb, struct fcb_entry *loc)
 {
 	int rc;
 
@@ -105,6 +105,21 @@ next_sector:
 	return 0;
 }
 
+int
+fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
+{
+#if defined(CONFIG_FCB_INDEX)
+	int rc;
+
+	rc = fcb_index_getnext(fcb, loc);
+	if (rc != -EAGAIN) {
+		return rc;
+	}
+#endif
+
+	return fcb_getnext_flash(fcb, loc);
+}
+
 int
 fcb_getnext(struct fcb *fcb, struct fcb_entry *loc)
 {
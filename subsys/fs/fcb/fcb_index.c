@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+
+#include <fs/fcb.h>
+#include "fcb_priv.h"
+
+/*
+ * The index is a ring of entries describing the newest elements of the FCB
+ * in the order they were appended. When it is full the oldest entry is
+ * dropped, f_index_start then tells from where on the index holds all
+ * elements. Older elements are looked up in flash.
+ */
+
+static struct fcb_index_entry *fcb_index_at(struct fcb *fcb, u16_t i)
+{
+	return &fcb->f_index[(fcb->f_index_head + fcb->f_index_cnt -
+			      fcb->f_index_used + i) % fcb->f_index_cnt];
+}
+
+/* Compare two locations in the order of the FCB, from the oldest sector */
+static int fcb_index_cmp(struct fcb *fcb, const struct flash_sector *sa,
+			 u32_t off_a, const struct flash_sector *sb,
+			 u32_t off_b)
+{
+	int da, db;
+
+	da = (sa - fcb->f_oldest + fcb->f_sector_cnt) % fcb->f_sector_cnt;
+	db = (sb - fcb->f_oldest + fcb->f_sector_cnt) % fcb->f_sector_cnt;
+
+	if (da != db) {
+		return (da < db) ? -1 : 1;
+	}
+	if (off_a != off_b) {
+		return (off_a < off_b) ? -1 : 1;
+	}
+	return 0;
+}
+
+/* Find the first index entry after the given location */
+static u16_t fcb_index_upper(struct fcb *fcb,
+			     const struct flash_sector *sector, u32_t off)
+{
+	struct fcb_index_entry *ie;
+	u16_t lo = 0U;
+	u16_t hi = fcb->f_index_used;
+	u16_t mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2U;
+		ie = fcb_index_at(fcb, mid);
+		if (fcb_index_cmp(fcb, &fcb->f_sectors[ie->fie_sector],
+				  ie->fie_elem_off, sector, off) > 0) {
+			hi = mid;
+		} else {
+			lo = mid + 1U;
+		}
+	}
+
+	return lo;
+}
+
+static void fcb_index_to_entry(struct fcb *fcb, struct fcb_index_entry *ie,
+			       struct fcb_entry *loc)
+{
+	loc->fe_sector = &fcb->f_sectors[ie->fie_sector];
+	loc->fe_elem_off = ie->fie_elem_off;
+	loc->fe_data_off = ie->fie_elem_off +
+		fcb_len_in_flash(fcb, (ie->fie_data_len < 0x80) ? 1 : 2);
+	loc->fe_data_len = ie->fie_data_len;
+}
+
+void fcb_index_build(struct fcb *fcb)
+{
+	struct fcb_entry loc;
+
+	fcb->f_index_head = 0U;
+	fcb->f_index_used = 0U;
+	fcb->f_index_start.fe_sector = fcb->f_oldest;
+	fcb->f_index_start.fe_elem_off = 0U;
+
+	if (!fcb->f_index || !fcb->f_index_cnt) {
+		return;
+	}
+
+	loc.fe_sector = NULL;
+	loc.fe_elem_off = 0U;
+	while (fcb_getnext_flash(fcb, &loc) == 0) {
+		fcb_index_add(fcb, &loc, true);
+	}
+}
+
+void fcb_index_add(struct fcb *fcb, const struct fcb_entry *loc, bool valid)
+{
+	struct fcb_index_entry *ie;
+
+	if (!fcb->f_index || !fcb->f_index_cnt) {
+		return;
+	}
+
+	if (fcb->f_index_used == fcb->f_index_cnt) {
+		/* Elements up to the dropped one are no longer indexed */
+		ie = fcb_index_at(fcb, 0);
+		fcb->f_index_start.fe_sector = &fcb->f_sectors[ie->fie_sector];
+		fcb->f_index_start.fe_elem_off = ie->fie_elem_off + 1U;
+		fcb->f_index_used--;
+	}
+
+	ie = &fcb->f_index[fcb->f_index_head];
+	ie->fie_elem_off = loc->fe_elem_off;
+	ie->fie_data_len = loc->fe_data_len;
+	ie->fie_sector = loc->fe_sector - fcb->f_sectors;
+	ie->fie_valid = valid;
+
+	fcb->f_index_head = (fcb->f_index_head + 1U) % fcb->f_index_cnt;
+	fcb->f_index_used++;
+}
+
+void fcb_index_finish(struct fcb *fcb, const struct fcb_entry *loc)
+{
+	struct fcb_index_entry *ie;
+	u16_t i;
+
+	if (!fcb->f_index || !fcb->f_index_cnt) {
+		return;
+	}
+
+	i = fcb_index_upper(fcb, loc->fe_sector, loc->fe_elem_off);
+	if (i == 0U) {
+		return;
+	}
+
+	ie = fcb_index_at(fcb, i - 1U);
+	if ((&fcb->f_sectors[ie->fie_sector] == loc->fe_sector) &&
+	    (ie->fie_elem_off == loc->fe_elem_off)) {
+		ie->fie_data_len = loc->fe_data_len;
+		ie->fie_valid = 1U;
+	}
+}
+
+void fcb_index_rotate(struct fcb *fcb)
+{
+	if (!fcb->f_index || !fcb->f_index_cnt) {
+		return;
+	}
+
+	while (fcb->f_index_used &&
+	       (&fcb->f_sectors[fcb_index_at(fcb, 0)->fie_sector] ==
+		fcb->f_oldest)) {
+		fcb->f_index_used--;
+	}
+
+	if (fcb->f_index_start.fe_sector == fcb->f_oldest) {
+		fcb->f_index_start.fe_sector =
+			fcb_getnext_sector(fcb, fcb->f_oldest);
+		fcb->f_index_start.fe_elem_off = 0U;
+	}
+}
+
+/*
+ * Get the element after loc from the index. Returns -EAGAIN if the index
+ * does not hold all the elements after loc.
+ */
+int fcb_index_getnext(struct fcb *fcb, struct fcb_entry *loc)
+{
+	struct flash_sector *sector;
+	struct fcb_index_entry *ie;
+	u16_t i;
+
+	if (!fcb->f_index || !fcb->f_index_cnt) {
+		return -EAGAIN;
+	}
+
+	sector = loc->fe_sector ? loc->fe_sector : fcb->f_oldest;
+	if (fcb_index_cmp(fcb, sector, loc->fe_elem_off,
+			  fcb->f_index_start.fe_sector,
+			  fcb->f_index_start.fe_elem_off) < 0) {
+		return -EAGAIN;
+	}
+
+	for (i = fcb_index_upper(fcb, sector, loc->fe_elem_off);
+	     i < fcb->f_index_used; i++) {
+		ie = fcb_index_at(fcb, i);
+		if (ie->fie_valid) {
+			fcb_index_to_entry(fcb, ie, loc);
+			return 0;
+		}
+	}
+
+	return -ENOTSUP;
+}
+
+/*
+ * Find the element giving back up to n elements at the end from the index.
+ * Returns -EAGAIN if the index holds less elements and not all of them.
+ */
+int fcb_index_last_n(struct fcb *fcb, u8_t entries,
+		     struct fcb_entry *last_n_entry)
+{
+	struct fcb_index_entry *ie = NULL;
+	int found = 0;
+	int i;
+
+	if (!fcb->f_index || !fcb->f_index_cnt) {
+		return -EAGAIN;
+	}
+
+	for (i = fcb->f_index_used - 1; i >= 0; i--) {
+		if (!fcb_index_at(fcb, i)->fie_valid) {
+			continue;
+		}
+		ie = fcb_index_at(fcb, i);
+		if (++found == entries) {
+			break;
+		}
+	}
+
+	if ((found < entries) &&
+	    ((fcb->f_index_start.fe_sector != fcb->f_oldest) ||
+	     (fcb->f_index_start.fe_elem_off != 0U))) {
+		return -EAGAIN;
+	}
+
+	if (!ie) {
+		return -ENOENT;
+	}
+
+	fcb_index_to_entry(fcb, ie, last_n_entry);
+
+	return 0;
+}
@@ -43,6 +43,7 @@ int fcb_getnext_in_sector(struct fcb *fcb, struct fcb_entry *loc);
 struct flash_sector *fcb_getnext_sector(struct fcb *fcb,
 					struct flash_sector *sector);
 int fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc);
+int fcb_getnext_flash(struct fcb *fcb, struct fcb_entry *loc);
 
 int fcb_elem_info(struct fcb *fcb, struct fcb_entry *loc);
 int fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, u8_t *crc8p);
@@ -51,6 +52,16 @@ int fcb_sector_hdr_init(struct fcb *fcb, struct flash_sector *sector, u16_t id);
 int fcb_sector_hdr_read(struct fcb *fcb, struct flash_sector *sector,
 			struct fcb_disk_area *fdap);
 
+#if defined(CONFIG_FCB_INDEX)
+void fcb_index_build(struct fcb *fcb);
+void fcb_index_add(struct fcb *fcb, const struct fcb_entry *loc, bool valid);
+void fcb_index_finish(struct fcb *fcb, const struct fcb_entry *loc);
+void fcb_index_rotate(struct fcb *fcb);
+int fcb_index_getnext(struct fcb *fcb, struct fcb_entry *loc);
+int fcb_index_last_n(struct fcb *fcb, u8_t entries,
+		     struct fcb_entry *last_n_entry);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,9 @@ fcb_rotate(struct fcb *fcb)
 		rc = -EIO;
 		goto out;
 	}
+#if defined(CONFIG_FCB_INDEX)
+	fcb_index_rotate(fcb);
+#endif
 	if (fcb->f_oldest == fcb->f_active.fe_sector) {
 		/*
 		 * Need to create a new active area, as we're wiping
@@ -6,6 +6,7 @@
  */
 
 #include <drivers/flash.h>
+#include <init.h>
 #include <string.h>
 #include <errno.h>
 #include <inttypes.h>
@@ -26,6 +27,23 @@ static inline size_t nvs_al_size(struct nvs_fs *fs, size_t len)
 	}
 	return (len + (fs->write_block_size - 1U)) & ~(fs->write_block_size - 1U);
 }
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* lookup cache entry value for ids that have no ate in the file system */
+#define NVS_LOOKUP_CACHE_NO_ADDR 0xFFFFFFFF
+
+/* nvs_lookup_cache_pos returns the lookup cache entry used for id */
+static inline size_t nvs_lookup_cache_pos(u16_t id)
+{
+	return id % CONFIG_NVS_LOOKUP_CACHE_SIZE;
+}
+
+/* nvs_lookup_cache_clear marks all lookup cache entries as empty */
+static inline void nvs_lookup_cache_clear(struct nvs_fs *fs)
+{
+	(void)memset(fs->lookup_cache, 0xff, sizeof(fs->lookup_cache));
+}
+#endif
 /* end basic routines */
 
 /* flash routines */
@@ -103,6 +121,14 @@ static int nvs_flash_ate_wrt(struct nvs_fs *fs, const struct nvs_ate *entry)
 
 	rc = nvs_flash_al_wrt(fs, fs->ate_wra, entry,
 			       sizeof(struct nvs_ate));
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* only an ate that made it to flash becomes the most recent one for
+	 * its cache entry, sector close and gc done ate's are not entries.
+	 */
+	if (!rc && (entry->id != 0xFFFF)) {
+		fs->lookup_cache[nvs_lookup_cache_pos(entry->id)] = fs->ate_wra;
+	}
+#endif
 	fs->ate_wra -= nvs_al_size(fs, sizeof(struct nvs_ate));
 
 	return rc;
@@ -346,6 +372,17 @@ static int nvs_prev_ate(struct nvs_fs *fs, u32_t *addr, struct nvs_ate *ate)
 		*addr -= (1 << ADDR_SECT_SHIFT);
 	}
 
+#ifdef CONFIG_NVS_GC_DEFERRED
+	/* the sector waiting for its erase is the oldest one, gc copied its
+	 * valid entries to the write sector: this is the end of filesystem.
+	 */
+	if (fs->gc_erase_pending &&
+	    (((*addr) & ADDR_SECT_MASK) == fs->gc_erase_addr)) {
+		*addr = fs->ate_wra;
+		return 0;
+	}
+#endif
+
 	rc = nvs_flash_ate_rd(fs, *addr, &close_ate);
 	if (rc) {
 		return rc;
@@ -405,6 +442,282 @@ static void nvs_sector_advance(struct nvs_fs *fs, u32_t *addr)
 	}
 }
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* lookup cache routines */
+/* the lookup cache stores for each cache entry the address of the most recent
+ * ate with an id that maps to this entry. A search for an id can start at
+ * this address instead of at fs->ate_wra, as all more recent ate's have an id
+ * that maps to another cache entry.
+ */
+
+/* rebuild the lookup cache by walking from the newest to the oldest ate */
+static int nvs_lookup_cache_rebuild(struct nvs_fs *fs)
+{
+	int rc;
+	u32_t addr, ate_addr;
+	u32_t *cache_entry;
+	struct nvs_ate ate;
+
+	nvs_lookup_cache_clear(fs);
+
+	addr = fs->ate_wra;
+
+	while (1) {
+		ate_addr = addr;
+		rc = nvs_prev_ate(fs, &addr, &ate);
+		if (rc) {
+			return rc;
+		}
+
+		cache_entry = &fs->lookup_cache[nvs_lookup_cache_pos(ate.id)];
+
+		/* only the first (most recent) valid ate is stored, sector
+		 * close and gc done ate's (id 0xFFFF) are not entries.
+		 */
+		if ((*cache_entry == NVS_LOOKUP_CACHE_NO_ADDR) &&
+		    (ate.id != 0xFFFF) && (!nvs_ate_crc8_check(&ate))) {
+			*cache_entry = ate_addr;
+		}
+
+		if (addr == fs->ate_wra) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* remove all lookup cache entries that point to the sector at addr */
+static void nvs_lookup_cache_invalidate(struct nvs_fs *fs, u32_t addr)
+{
+	addr &= ADDR_SECT_MASK;
+
+	for (size_t i = 0; i < CONFIG_NVS_LOOKUP_CACHE_SIZE; i++) {
+		if ((fs->lookup_cache[i] & ADDR_SECT_MASK) == addr) {
+			fs->lookup_cache[i] = NVS_LOOKUP_CACHE_NO_ADDR;
+		}
+	}
+}
+/* end lookup cache routines */
+#endif
+
+#ifdef CONFIG_NVS_GC_DEFERRED
+/* deferred gc erase routines */
+/* when gc has copied all valid entries of a sector to the write sector, a gc
+ * done ate (id 0xFFFF, len 0) is written to the free ate location below the
+ * last ate of the gc'ed sector and the erase of that sector is left to a work
+ * queue. The gc done ate is not reached by nvs_prev_ate(), it only allows
+ * nvs_startup() to tell an interrupted erase from an interrupted gc.
+ */
+#define NVS_GC_DONE_ID 0xFFFF
+
+static K_THREAD_STACK_DEFINE(nvs_gc_workq_stack,
+			     CONFIG_NVS_GC_WORKQ_STACK_SIZE);
+static struct k_work_q nvs_gc_workq;
+static struct k_work nvs_gc_work;
+
+/* file systems with a pending erase, the list is owned by this module so
+ * that nvs_init() can tell whether a file system is still queued without
+ * trusting the content of struct nvs_fs.
+ */
+static sys_slist_t nvs_gc_list = SYS_SLIST_STATIC_INIT(&nvs_gc_list);
+static struct k_spinlock nvs_gc_list_lock;
+
+/* write the gc done ate below the last ate at addr, returns -ENOSPC when the
+ * sector has no free ate location left.
+ */
+static int nvs_gc_done_ate_wrt(struct nvs_fs *fs, u32_t addr)
+{
+	int rc;
+	struct nvs_ate last_ate, gc_done_ate;
+	u32_t data_end_addr;
+	size_t ate_size;
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	rc = nvs_flash_ate_rd(fs, addr, &last_ate);
+	if (rc) {
+		return rc;
+	}
+	if (nvs_ate_crc8_check(&last_ate)) {
+		return -ENOSPC;
+	}
+
+	data_end_addr = addr & ADDR_SECT_MASK;
+	data_end_addr += last_ate.offset + nvs_al_size(fs, last_ate.len);
+
+	if (((addr & ADDR_OFFS_MASK) < ate_size) ||
+	    (addr - ate_size < data_end_addr)) {
+		return -ENOSPC;
+	}
+
+	gc_done_ate.id = NVS_GC_DONE_ID;
+	gc_done_ate.offset = (u16_t)(data_end_addr & ADDR_OFFS_MASK);
+	gc_done_ate.len = 0U;
+	gc_done_ate.part = 0xff;
+
+	nvs_ate_crc8_update(&gc_done_ate);
+
+	return nvs_flash_al_wrt(fs, addr - ate_size, &gc_done_ate,
+				sizeof(struct nvs_ate));
+}
+
+/* check the closed sector at addr for a gc done ate */
+static int nvs_gc_done_find(struct nvs_fs *fs, u32_t addr)
+{
+	int rc;
+	struct nvs_ate ate;
+	size_t ate_size;
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	addr &= ADDR_SECT_MASK;
+	rc = nvs_flash_ate_rd(fs, addr + fs->sector_size - ate_size, &ate);
+	if (rc) {
+		return rc;
+	}
+	if (nvs_ate_crc8_check(&ate) || (ate.offset < ate_size) ||
+	    (ate.offset >= (fs->sector_size - ate_size)) ||
+	    (ate.offset % ate_size)) {
+		return 0;
+	}
+
+	rc = nvs_flash_ate_rd(fs, addr + ate.offset - ate_size, &ate);
+	if (rc) {
+		return rc;
+	}
+
+	return ((ate.id == NVS_GC_DONE_ID) && (ate.len == 0U) &&
+		(!nvs_ate_crc8_check(&ate)));
+}
+
+/* erase the sector left behind by gc, nvs_lock must be held */
+static int nvs_gc_erase_pending(struct nvs_fs *fs)
+{
+	int rc;
+
+	if (!fs->gc_erase_pending) {
+		return 0;
+	}
+
+	rc = nvs_flash_erase_sector(fs, fs->gc_erase_addr);
+	if (rc) {
+		return rc;
+	}
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	nvs_lookup_cache_invalidate(fs, fs->gc_erase_addr);
+#endif
+	fs->gc_erase_pending = false;
+	return 0;
+}
+
+/* remove fs from the list of file systems with a pending erase */
+static void nvs_gc_list_remove(struct nvs_fs *fs)
+{
+	k_spinlock_key_t key = k_spin_lock(&nvs_gc_list_lock);
+
+	(void)sys_slist_find_and_remove(&nvs_gc_list, &fs->gc_node);
+	k_spin_unlock(&nvs_gc_list_lock, key);
+}
+
+static void nvs_gc_submit(struct nvs_fs *fs)
+{
+	k_spinlock_key_t key = k_spin_lock(&nvs_gc_list_lock);
+
+	/* fs is still queued when a write did the previous erase */
+	(void)sys_slist_find_and_remove(&nvs_gc_list, &fs->gc_node);
+	sys_slist_append(&nvs_gc_list, &fs->gc_node);
+	k_spin_unlock(&nvs_gc_list_lock, key);
+
+	k_work_submit_to_queue(&nvs_gc_workq, &nvs_gc_work);
+}
+
+static void nvs_gc_work_handler(struct k_work *work)
+{
+	k_spinlock_key_t key;
+	sys_snode_t *node;
+	struct nvs_fs *fs;
+	int rc;
+
+	ARG_UNUSED(work);
+
+	while (1) {
+		key = k_spin_lock(&nvs_gc_list_lock);
+		node = sys_slist_get(&nvs_gc_list);
+		k_spin_unlock(&nvs_gc_list_lock, key);
+
+		if (!node) {
+			break;
+		}
+
+		fs = CONTAINER_OF(node, struct nvs_fs, gc_node);
+
+		k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+		rc = nvs_gc_erase_pending(fs);
+		k_mutex_unlock(&fs->nvs_lock);
+
+		if (rc) {
+			LOG_ERR("Deferred sector erase failed (%d)", rc);
+		}
+	}
+}
+
+static int nvs_gc_workq_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_init(&nvs_gc_work, nvs_gc_work_handler);
+	k_work_q_start(&nvs_gc_workq, nvs_gc_workq_stack,
+		       K_THREAD_STACK_SIZEOF(nvs_gc_workq_stack),
+		       CONFIG_NVS_GC_WORKQ_PRIORITY);
+	k_thread_name_set(&nvs_gc_workq.thread, "nvs_gc");
+
+	return 0;
+}
+
+SYS_INIT(nvs_gc_workq_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+/* end deferred gc erase routines */
+#endif
+
+/* erase the sector at sec_addr after gc has copied its valid entries, addr
+ * is the address of the last ate in this sector.
+ */
+static int nvs_gc_erase(struct nvs_fs *fs, u32_t sec_addr, u32_t addr)
+{
+	int rc;
+
+#ifdef CONFIG_NVS_GC_DEFERRED
+	/* without room for the gc done ate the sector is erased right away */
+	rc = nvs_gc_done_ate_wrt(fs, addr);
+	if (!rc) {
+		fs->gc_erase_addr = sec_addr;
+		fs->gc_erase_pending = true;
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+		/* lookups must not start in the sector waiting for the erase */
+		nvs_lookup_cache_invalidate(fs, sec_addr);
+#endif
+		nvs_gc_submit(fs);
+		return 0;
+	}
+	if (rc != -ENOSPC) {
+		return rc;
+	}
+#else
+	ARG_UNUSED(addr);
+#endif
+	rc = nvs_flash_erase_sector(fs, sec_addr);
+	if (rc) {
+		return rc;
+	}
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* all entries that still point to the erased sector belong to ids
+	 * that were deleted or superseded.
+	 */
+	nvs_lookup_cache_invalidate(fs, sec_addr);
+#endif
+	return 0;
+}
+
 /* allocation entry close (this closes the current sector) by writing offset
  * of last ate to the sector end.
  */
@@ -444,7 +757,7 @@ static int nvs_gc(struct nvs_fs *fs)
 	int rc;
 	struct nvs_ate close_ate, gc_ate, wlk_ate;
 	u32_t sec_addr, gc_addr, gc_prev_addr, wlk_addr, wlk_prev_addr,
-	      data_addr, stop_addr;
+	      data_addr, stop_addr, last_addr;
 	size_t ate_size;
 
 	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
@@ -462,10 +775,20 @@ static int nvs_gc(struct nvs_fs *fs)
 
 	rc = nvs_ate_cmp_const(&close_ate, 0xff);
 	if (!rc) {
+#ifdef CONFIG_NVS_GC_DEFERRED
+		/* no need to erase a sector that is still empty */
+		rc = nvs_flash_cmp_const(fs, sec_addr, 0xff, fs->sector_size);
+		if (rc <= 0) {
+			return rc;
+		}
+#endif
 		rc = nvs_flash_erase_sector(fs, sec_addr);
 		if (rc) {
 			return rc;
 		}
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+		nvs_lookup_cache_invalidate(fs, sec_addr);
+#endif
 		return 0;
 	}
 
@@ -473,6 +796,7 @@ static int nvs_gc(struct nvs_fs *fs)
 
 	gc_addr &= ADDR_SECT_MASK;
 	gc_addr += close_ate.offset;
+	last_addr = gc_addr;
 
 	while (1) {
 		gc_prev_addr = gc_addr;
@@ -480,7 +804,15 @@ static int nvs_gc(struct nvs_fs *fs)
 		if (rc) {
 			return rc;
 		}
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+		wlk_addr = fs->lookup_cache[nvs_lookup_cache_pos(gc_ate.id)];
+
+		if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+			wlk_addr = fs->ate_wra;
+		}
+#else
 		wlk_addr = fs->ate_wra;
+#endif
 		while (1) {
 			wlk_prev_addr = wlk_addr;
 			rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
@@ -527,11 +859,7 @@ static int nvs_gc(struct nvs_fs *fs)
 		}
 	}
 
-	rc = nvs_flash_erase_sector(fs, sec_addr);
-	if (rc) {
-		return rc;
-	}
-	return 0;
+	return nvs_gc_erase(fs, sec_addr, last_addr);
 }
 
 static int nvs_startup(struct nvs_fs *fs)
@@ -548,6 +876,17 @@ static int nvs_startup(struct nvs_fs *fs)
 
 	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* drop entries of a previous mount, gc falls back to a full walk for
+	 * empty cache entries.
+	 */
+	nvs_lookup_cache_clear(fs);
+#endif
+#ifdef CONFIG_NVS_GC_DEFERRED
+	/* an erase left by a previous mount is finished below */
+	fs->gc_erase_pending = false;
+#endif
+
 	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
 	/* step through the sectors to find a open sector following
 	 * a closed sector, this is where NVS can to write.
@@ -653,6 +992,22 @@ static int nvs_startup(struct nvs_fs *fs)
 	}
 	if (rc) {
 		/* the sector after fs->ate_wrt is not empty */
+#ifdef CONFIG_NVS_GC_DEFERRED
+		/* with a gc done ate in the sector gc was completed and
+		 * only the erase of this sector was interrupted.
+		 */
+		rc = nvs_gc_done_find(fs, addr);
+		if (rc < 0) {
+			goto end;
+		}
+		if (rc) {
+			rc = nvs_flash_erase_sector(fs, addr);
+			if (rc) {
+				goto end;
+			}
+			goto gc_done;
+		}
+#endif
 		rc = nvs_flash_erase_sector(fs, fs->ate_wra);
 		if (rc) {
 			goto end;
@@ -666,6 +1021,13 @@ static int nvs_startup(struct nvs_fs *fs)
 		}
 	}
 
+#ifdef CONFIG_NVS_GC_DEFERRED
+gc_done:
+#endif
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	rc = nvs_lookup_cache_rebuild(fs);
+#endif
+
 end:
 	k_mutex_unlock(&fs->nvs_lock);
 	return rc;
@@ -688,6 +1050,12 @@ int nvs_clear(struct nvs_fs *fs)
 			return rc;
 		}
 	}
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	nvs_lookup_cache_clear(fs);
+#endif
+#ifdef CONFIG_NVS_GC_DEFERRED
+	fs->gc_erase_pending = false;
+#endif
 	return 0;
 }
 
@@ -698,6 +1066,12 @@ int nvs_init(struct nvs_fs *fs, const char *dev_name)
 	struct flash_pages_info info;
 
 	k_mutex_init(&fs->nvs_lock);
+#ifdef CONFIG_NVS_GC_DEFERRED
+	/* an erase left pending by a previous mount is finished by
+	 * nvs_startup(), drop the file system from the work list.
+	 */
+	nvs_gc_list_remove(fs);
+#endif
 
 	fs->flash_device = device_get_binding(dev_name);
 	if (!fs->flash_device) {
@@ -776,7 +1150,15 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 	}
 
 	/* find latest entry with same id */
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	wlk_addr = fs->lookup_cache[nvs_lookup_cache_pos(id)];
+
+	if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+		goto no_cached_entry;
+	}
+#else
 	wlk_addr = fs->ate_wra;
+#endif
 	rd_addr = wlk_addr;
 
 	while (1) {
@@ -794,6 +1176,9 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 		}
 	}
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+no_cached_entry:
+#endif
 	if (prev_found) {
 		/* previous entry found */
 		rd_addr &= ADDR_SECT_MASK;
@@ -849,7 +1234,15 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 			break;
 		}
 
-
+#ifdef CONFIG_NVS_GC_DEFERRED
+		/* the next sector becomes the write sector, it can only be
+		 * used once its deferred erase is done.
+		 */
+		rc = nvs_gc_erase_pending(fs);
+		if (rc) {
+			goto end;
+		}
+#endif
 		rc = nvs_sector_close(fs);
 		if (rc) {
 			goto end;
@@ -867,6 +1260,23 @@ end:
 	return rc;
 }
 
+int nvs_gc_flush(struct nvs_fs *fs)
+{
+	int rc = 0;
+
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+#ifdef CONFIG_NVS_GC_DEFERRED
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+	rc = nvs_gc_erase_pending(fs);
+	k_mutex_unlock(&fs->nvs_lock);
+#endif
+	return rc;
+}
+
 int nvs_delete(struct nvs_fs *fs, u16_t id)
 {
 	return nvs_write(fs, id, NULL, 0);
@@ -894,7 +1304,16 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 
 	cnt_his = 0U;
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	wlk_addr = fs->lookup_cache[nvs_lookup_cache_pos(id)];
+
+	if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+		rc = -ENOENT;
+		goto err;
+	}
+#else
 	wlk_addr = fs->ate_wra;
+#endif
 	rd_addr = wlk_addr;
 
 	while (cnt_his <= cnt) {
@@ -55,7 +55,36 @@ static int char_out(u8_t *data, size_t length, void *ctx)
 	return length;
 }
 
-LOG_OUTPUT_DEFINE(log_output, char_out, buf, sizeof(buf));
+#define DICT_LINE_PREFIX "#zlog:"
+#define DICT_BYTES_IN_LINE 32
+
+/* Dictionary records are binary, print them as lines of hexadecimal digits
+ * which the decoder picks out of the rest of the output.
+ */
+static int dict_out(u8_t *data, size_t length, void *ctx)
+{
+	static const char hex[] = "0123456789abcdef";
+	char line[2 * DICT_BYTES_IN_LINE + 1];
+	size_t part;
+
+	for (size_t i = 0; i < length; i += part) {
+		part = MIN(length - i, DICT_BYTES_IN_LINE);
+
+		for (size_t j = 0; j < part; j++) {
+			line[2 * j] = hex[data[i + j] >> 4];
+			line[2 * j + 1] = hex[data[i + j] & 0xf];
+		}
+		line[2 * part] = '\0';
+
+		posix_print_trace(DICT_LINE_PREFIX "%s\n", line);
+	}
+
+	return length;
+}
+
+LOG_OUTPUT_DEFINE(log_output,
+		  IS_ENABLED(CONFIG_LOG_BACKEND_NATIVE_POSIX_DICT) ?
+		  dict_out : char_out, buf, sizeof(buf));
 
 static void put(const struct log_backend *const backend,
 		struct log_msg *msg)
@@ -64,6 +93,10 @@ static void put(const struct log_backend *const backend,
 
 	u32_t flags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP;
 
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_NATIVE_POSIX_DICT)) {
+		flags |= LOG_OUTPUT_FLAG_FORMAT_DICT;
+	}
+
 	if (IS_ENABLED(CONFIG_LOG_BACKEND_SHOW_COLOR)) {
 		if (posix_trace_over_tty(0)) {
 			flags |= LOG_OUTPUT_FLAG_COLORS;
@@ -89,7 +122,11 @@ static void dropped(const struct log_backend *const backend, u32_t cnt)
 {
 	ARG_UNUSED(backend);
 
-	log_output_dropped_process(&log_output, cnt);
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_NATIVE_POSIX_DICT)) {
+		log_output_dict_dropped_process(&log_output, cnt);
+	} else {
+		log_output_dropped_process(&log_output, cnt);
+	}
 }
 
 static void sync_string(const struct log_backend *const backend,
@@ -99,6 +136,10 @@ static void sync_string(const struct log_backend *const backend,
 	u32_t flags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP;
 	u32_t key;
 
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_NATIVE_POSIX_DICT)) {
+		flags |= LOG_OUTPUT_FLAG_FORMAT_DICT;
+	}
+
 	if (IS_ENABLED(CONFIG_LOG_BACKEND_SHOW_COLOR)) {
 		flags |= LOG_OUTPUT_FLAG_COLORS;
 	}
@@ -119,6 +160,10 @@ static void sync_hexdump(const struct log_backend *const backend,
 	u32_t flags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP;
 	u32_t key;
 
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_NATIVE_POSIX_DICT)) {
+		flags |= LOG_OUTPUT_FLAG_FORMAT_DICT;
+	}
+
 	if (IS_ENABLED(CONFIG_LOG_BACKEND_SHOW_COLOR)) {
 		flags |= LOG_OUTPUT_FLAG_COLORS;
 	}
@@ -11,6 +11,7 @@
 #include "log_backend_std.h"
 #include <device.h>
 #include <drivers/uart.h>
+#include <sys/ring_buffer.h>
 #include <assert.h>
 
 static int char_out(u8_t *data, size_t length, void *ctx)
@@ -24,15 +25,128 @@ static int char_out(u8_t *data, size_t length, void *ctx)
 	return length;
 }
 
+#ifdef CONFIG_LOG_BACKEND_UART_ASYNC
+/* Messages are formatted into the ring buffer by the log thread and sent from
+ * the UART interrupt in chunks as large as the UART FIFO accepts. The log
+ * thread only waits when the ring buffer is full, and is woken once half of
+ * it is free again, or all of it, rather than for every chunk sent.
+ */
+static u8_t tx_buf[CONFIG_LOG_BACKEND_UART_BUFFER_SIZE];
+static struct ring_buf tx_ring;
+static K_SEM_DEFINE(tx_sem, 0, 1);
+static bool in_panic;
+
+#define TX_WAKE_SPACE (sizeof(tx_buf) / 2)
+
+static void uart_isr(void *user_data)
+{
+	struct device *dev = (struct device *)user_data;
+	u32_t space;
+	u8_t *data;
+	u32_t len;
+	int err;
+
+	uart_irq_update(dev);
+
+	if (!uart_irq_tx_ready(dev)) {
+		return;
+	}
+
+	len = ring_buf_get_claim(&tx_ring, &data, sizeof(tx_buf));
+	if (len) {
+		space = ring_buf_space_get(&tx_ring);
+		len = uart_fifo_fill(dev, data, len);
+		err = ring_buf_get_finish(&tx_ring, len);
+		__ASSERT_NO_MSG(err == 0);
+
+		if ((space < TX_WAKE_SPACE &&
+		     ring_buf_space_get(&tx_ring) >= TX_WAKE_SPACE) ||
+		    ring_buf_is_empty(&tx_ring)) {
+			k_sem_give(&tx_sem);
+		}
+	} else {
+		uart_irq_tx_disable(dev);
+	}
+}
+
+/* Largest amount of data sent by polling with interrupts locked. */
+#define TX_DRAIN_CHUNK 16
+
+/* Send what is left in the ring buffer by polling. Interrupts are only
+ * locked while a chunk is sent, so that they are not held off for the
+ * whole buffer. The interrupt may send data queued in between, each
+ * chunk is complete before it can run so the order is kept.
+ */
+static void tx_ring_drain(struct device *dev)
+{
+	unsigned int key;
+	u8_t *data;
+	u32_t len;
+
+	do {
+		key = irq_lock();
+		uart_irq_tx_disable(dev);
+
+		len = ring_buf_get_claim(&tx_ring, &data, TX_DRAIN_CHUNK);
+		if (len) {
+			(void)char_out(data, len, dev);
+			(void)ring_buf_get_finish(&tx_ring, len);
+		}
+
+		irq_unlock(key);
+	} while (len);
+}
+
+static int async_out(u8_t *data, size_t length, void *ctx)
+{
+	struct device *dev = (struct device *)ctx;
+	unsigned int key;
+	u32_t len;
+
+	if (in_panic) {
+		return char_out(data, length, ctx);
+	}
+
+	/* Locked so that the interrupt cannot disable transmission after
+	 * finding the buffer empty but before the data is added.
+	 */
+	key = irq_lock();
+	len = ring_buf_put(&tx_ring, data, length);
+	if (len) {
+		uart_irq_tx_enable(dev);
+	}
+	irq_unlock(key);
+
+	if (len == 0) {
+		if (k_is_in_isr()) {
+			/* Cannot wait for the interrupt, make room by
+			 * polling.
+			 */
+			tx_ring_drain(dev);
+		} else {
+			(void)k_sem_take(&tx_sem, K_FOREVER);
+		}
+	}
+
+	return len;
+}
+
+static u8_t buf[32];
+
+LOG_OUTPUT_DEFINE(log_output, async_out, buf, sizeof(buf));
+#else
 static u8_t buf;
 
 LOG_OUTPUT_DEFINE(log_output, char_out, &buf, 1);
+#endif /* CONFIG_LOG_BACKEND_UART_ASYNC */
 
 static void put(const struct log_backend *const backend,
 		struct log_msg *msg)
 {
 	u32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
+		LOG_OUTPUT_FLAG_FORMAT_SYST :
+		IS_ENABLED(CONFIG_LOG_BACKEND_UART_DICT) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0;
 
 	log_backend_std_put(&log_output, flag, msg);
 }
@@ -45,10 +159,19 @@ static void log_backend_uart_init(void)
 	assert(dev);
 
 	log_output_ctx_set(&log_output, dev);
+
+#ifdef CONFIG_LOG_BACKEND_UART_ASYNC
+	ring_buf_init(&tx_ring, sizeof(tx_buf), tx_buf);
+	uart_irq_callback_user_data_set(dev, uart_isr, dev);
+#endif
 }
 
 static void panic(struct log_backend const *const backend)
 {
+#ifdef CONFIG_LOG_BACKEND_UART_ASYNC
+	in_panic = true;
+	tx_ring_drain(log_output.control_block->ctx);
+#endif
 	log_backend_std_panic(&log_output);
 }
 
@@ -56,7 +179,11 @@ static void dropped(const struct log_backend *const backend, u32_t cnt)
 {
 	ARG_UNUSED(backend);
 
-	log_backend_std_dropped(&log_output, cnt);
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_UART_DICT)) {
+		log_output_dict_dropped_process(&log_output, cnt);
+	} else {
+		log_backend_std_dropped(&log_output, cnt);
+	}
 }
 
 static void sync_string(const struct log_backend *const backend,
@@ -64,7 +191,9 @@ static void sync_string(const struct log_backend *const backend,
 		     const char *fmt, va_list ap)
 {
 	u32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
+		LOG_OUTPUT_FLAG_FORMAT_SYST :
+		IS_ENABLED(CONFIG_LOG_BACKEND_UART_DICT) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0;
 
 	log_backend_std_sync_string(&log_output, flag, src_level,
 				    timestamp, fmt, ap);
@@ -75,7 +204,9 @@ static void sync_hexdump(const struct log_backend *const backend,
 			 const char *metadata, const u8_t *data, u32_t length)
 {
 	u32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
+		LOG_OUTPUT_FLAG_FORMAT_SYST :
+		IS_ENABLED(CONFIG_LOG_BACKEND_UART_DICT) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0;
 
 	log_backend_std_sync_hexdump(&log_output, flag, src_level,
 				     timestamp, metadata, data, length);
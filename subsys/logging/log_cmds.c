@@ -402,6 +402,27 @@ static int cmd_log_strdup_utilization(const struct shell *shell,
 }
 
 
+#ifdef CONFIG_LOG_MSG_RING
+static int cmd_log_ring_stats(const struct shell *shell,
+			      size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	struct log_msg_ring_stats stats;
+
+	log_msg_ring_stats_get(&stats);
+
+	shell_print(shell,
+		"Message ring: %d bytes, in use: %d, maximal usage: %d (%d %%).",
+		stats.size, stats.used, stats.max_used,
+		100 * stats.max_used / stats.size);
+	shell_print(shell, "Messages dropped: %d.", stats.dropped);
+
+	return 0;
+}
+#endif
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_log_backend,
 	SHELL_CMD_ARG(disable, &dsub_module_name,
 		  "'log disable <module_0> .. <module_n>' disables logs in "
@@ -454,6 +475,9 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_log_stat,
 	SHELL_COND_CMD_ARG(CONFIG_LOG_STRDUP_POOL_PROFILING, strdup_utilization,
 			NULL, "Get utilization of string duplicates pool",
 			cmd_log_strdup_utilization, 1, 0),
+	SHELL_COND_CMD_ARG(CONFIG_LOG_MSG_RING, ring_stats, NULL,
+			"Get usage of the log message ring",
+			cmd_log_ring_stats, 1, 0),
 	SHELL_SUBCMD_SET_END
 );
 
@@ -5,6 +5,7 @@
  */
 #include <logging/log_msg.h>
 #include "log_list.h"
+#include "log_msg_ring.h"
 #include <logging/log.h>
 #include <logging/log_backend.h>
 #include <logging/log_ctrl.h>
@@ -191,11 +192,15 @@ static inline void msg_finalize(struct log_msg *msg,
 
 	atomic_inc(&buffered_cnt);
 
-	key = irq_lock();
+	if (IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		log_msg_ring_commit(msg);
+	} else {
+		key = irq_lock();
 
-	log_list_add_tail(&list, msg);
+		log_list_add_tail(&list, msg);
 
-	irq_unlock(key);
+		irq_unlock(key);
+	}
 
 	if (panic_mode) {
 		key = irq_lock();
@@ -213,6 +218,28 @@ static inline void msg_finalize(struct log_msg *msg,
 	}
 }
 
+/* Strings duplicated into the message ring must be given back when the
+ * message could not be created, the ring can not reuse anything behind them.
+ */
+static void dropped_strdup_free(const char *str, log_arg_t *args, u32_t nargs)
+{
+	u32_t mask;
+	u32_t idx;
+
+	if (!IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		return;
+	}
+
+	mask = z_log_get_s_mask(str, nargs);
+	while (mask) {
+		idx = 31 - __builtin_clz(mask);
+		if (log_is_strdup((void *)args[idx])) {
+			log_free((void *)args[idx]);
+		}
+		mask &= ~BIT(idx);
+	}
+}
+
 void log_0(const char *str, struct log_msg_ids src_level)
 {
 	if (IS_ENABLED(CONFIG_LOG_FRONTEND)) {
@@ -237,6 +264,9 @@ void log_1(const char *str,
 		struct log_msg *msg = log_msg_create_1(str, arg0);
 
 		if (msg == NULL) {
+			log_arg_t args[] = {arg0};
+
+			dropped_strdup_free(str, args, ARRAY_SIZE(args));
 			return;
 		}
 		msg_finalize(msg, src_level);
@@ -254,6 +284,9 @@ void log_2(const char *str,
 		struct log_msg *msg = log_msg_create_2(str, arg0, arg1);
 
 		if (msg == NULL) {
+			log_arg_t args[] = {arg0, arg1};
+
+			dropped_strdup_free(str, args, ARRAY_SIZE(args));
 			return;
 		}
 
@@ -273,6 +306,9 @@ void log_3(const char *str,
 		struct log_msg *msg = log_msg_create_3(str, arg0, arg1, arg2);
 
 		if (msg == NULL) {
+			log_arg_t args[] = {arg0, arg1, arg2};
+
+			dropped_strdup_free(str, args, ARRAY_SIZE(args));
 			return;
 		}
 
@@ -291,6 +327,7 @@ void log_n(const char *str,
 		struct log_msg *msg = log_msg_create_n(str, args, narg);
 
 		if (msg == NULL) {
+			dropped_strdup_free(str, args, narg);
 			return;
 		}
 
@@ -309,6 +346,10 @@ void log_hexdump(const char *str, const void *data, u32_t length,
 			log_msg_hexdump_create(str, (const u8_t *)data, length);
 
 		if (msg == NULL) {
+			if (IS_ENABLED(CONFIG_LOG_MSG_RING) &&
+			    log_is_strdup(str)) {
+				log_free((void *)str);
+			}
 			return;
 		}
 
@@ -456,9 +497,11 @@ void log_core_init(void)
 		log_msg_pool_init();
 		log_list_init(&list);
 
-		k_mem_slab_init(&log_strdup_pool, log_strdup_pool_buf,
+		if (!IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+			k_mem_slab_init(&log_strdup_pool, log_strdup_pool_buf,
 					sizeof(struct log_strdup_buf),
 					CONFIG_LOG_STRDUP_BUF_COUNT);
+		}
 	}
 
 	/* Set default timestamp. */
@@ -656,10 +699,14 @@ bool z_impl_log_process(bool bypass)
 	if (!backend_attached && !bypass) {
 		return false;
 	}
-	unsigned int key = irq_lock();
+	if (IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		msg = log_msg_ring_get();
+	} else {
+		unsigned int key = irq_lock();
 
-	msg = log_list_head_get(&list);
-	irq_unlock(key);
+		msg = log_list_head_get(&list);
+		irq_unlock(key);
+	}
 
 	if (msg != NULL) {
 		atomic_dec(&buffered_cnt);
@@ -670,6 +717,10 @@ bool z_impl_log_process(bool bypass)
 		dropped_notify();
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		return log_msg_ring_pending();
+	}
+
 	return (log_list_head_peek(&list) != NULL);
 }
 
@@ -862,6 +913,13 @@ char *log_strdup(const char *str)
 		return (char *)str;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		char *ring_dup = log_msg_ring_strdup(str,
+						CONFIG_LOG_STRDUP_MAX_STRING);
+
+		return ring_dup ? ring_dup : (char *)log_strdup_fail_msg;
+	}
+
 	err = k_mem_slab_alloc(&log_strdup_pool, (void **)&dup, K_NO_WAIT);
 	if (err != 0) {
 		/* failed to allocate */
@@ -904,6 +962,10 @@ u32_t log_get_strdup_longest_string(void)
 
 bool log_is_strdup(const void *buf)
 {
+	if (IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		return log_msg_ring_contains(buf);
+	}
+
 	return PART_OF_ARRAY(log_strdup_pool_buf, (u8_t *)buf);
 
 }
@@ -913,6 +975,11 @@ void log_free(void *str)
 	struct log_strdup_buf *dup = CONTAINER_OF(str, struct log_strdup_buf,
 						  buf);
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_RING)) {
+		log_msg_ring_free(str);
+		return;
+	}
+
 	if (atomic_dec(&dup->refcount) == 1) {
 		k_mem_slab_free(&log_strdup_pool, (void **)&dup);
 		if (IS_ENABLED(CONFIG_LOG_STRDUP_POOL_PROFILING)) {
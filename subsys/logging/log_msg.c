@@ -10,6 +10,7 @@
 #include <logging/log_core.h>
 #include <string.h>
 #include <assert.h>
+#include "log_msg_ring.h"
 
 BUILD_ASSERT((sizeof(struct log_msg_ids) == sizeof(u16_t)),
 	     "Structure must fit in 2 bytes");
@@ -40,6 +41,39 @@ BUILD_ASSERT((sizeof(union log_msg_head_data) ==
 #define MSG_SIZE sizeof(union log_msg_chunk)
 #define NUM_OF_MSGS (CONFIG_LOG_BUFFER_SIZE / MSG_SIZE)
 
+#ifdef CONFIG_LOG_MSG_RING
+void log_msg_pool_init(void)
+{
+	log_msg_ring_init();
+}
+
+/* Claim contiguous chunks from the ring, making room by dropping the oldest
+ * messages in overflow mode.
+ */
+static union log_msg_chunk *ring_chunks_alloc(u32_t nchunks)
+{
+	union log_msg_chunk *chunks = log_msg_ring_alloc(nchunks);
+	bool more;
+
+	if (chunks != NULL) {
+		return chunks;
+	}
+
+	if (IS_ENABLED(CONFIG_LOG_MODE_OVERFLOW)) {
+		do {
+			more = log_process(true);
+			log_dropped();
+			log_msg_ring_dropped();
+			chunks = log_msg_ring_alloc(nchunks);
+		} while ((chunks == NULL) && more);
+	} else {
+		log_dropped();
+		log_msg_ring_dropped();
+	}
+
+	return chunks;
+}
+#else
 struct k_mem_slab log_msg_pool;
 static u8_t __noinit __aligned(sizeof(void *))
 		log_msg_pool_buf[CONFIG_LOG_BUFFER_SIZE];
@@ -70,9 +104,13 @@ static bool block_on_alloc(void)
 
 	return (!k_is_in_isr() && is_irq_unlocked());
 }
+#endif
 
 union log_msg_chunk *log_msg_chunk_alloc(void)
 {
+#ifdef CONFIG_LOG_MSG_RING
+	return ring_chunks_alloc(1);
+#else
 	union log_msg_chunk *msg = NULL;
 	int err = k_mem_slab_alloc(&log_msg_pool, (void **)&msg,
 		   block_on_alloc()
@@ -84,6 +122,7 @@ union log_msg_chunk *log_msg_chunk_alloc(void)
 	}
 
 	return msg;
+#endif
 }
 
 void log_msg_get(struct log_msg *msg)
@@ -91,6 +130,7 @@ void log_msg_get(struct log_msg *msg)
 	atomic_inc(&msg->hdr.ref_cnt);
 }
 
+#ifndef CONFIG_LOG_MSG_RING
 static void cont_free(struct log_msg_cont *cont)
 {
 	struct log_msg_cont *next;
@@ -101,6 +141,7 @@ static void cont_free(struct log_msg_cont *cont)
 		cont = next;
 	}
 }
+#endif
 
 static void msg_free(struct log_msg *msg)
 {
@@ -151,13 +192,19 @@ static void msg_free(struct log_msg *msg)
 		}
 	}
 
+#ifdef CONFIG_LOG_MSG_RING
+	/* continuation chunks belong to the same ring packet */
+	log_msg_ring_free(msg);
+#else
 	if (msg->hdr.params.generic.ext == 1) {
 		cont_free(msg->payload.ext.next);
 	}
 
 	k_mem_slab_free(&log_msg_pool, (void **)&msg);
+#endif
 }
 
+#ifndef CONFIG_LOG_MSG_RING
 union log_msg_chunk *log_msg_no_space_handle(void)
 {
 	union log_msg_chunk *msg = NULL;
@@ -178,6 +225,8 @@ union log_msg_chunk *log_msg_no_space_handle(void)
 	return msg;
 
 }
+#endif
+
 void log_msg_put(struct log_msg *msg)
 {
 	atomic_dec(&msg->hdr.ref_cnt);
@@ -249,8 +298,28 @@ static struct log_msg *msg_alloc(u32_t nargs)
 {
 	struct log_msg_cont *cont;
 	struct log_msg_cont **next;
-	struct  log_msg *msg = z_log_msg_std_alloc();
 	int n = (int)nargs;
+#ifdef CONFIG_LOG_MSG_RING
+	union log_msg_chunk *chunk = NULL;
+	struct log_msg *msg;
+
+	if (nargs > LOG_MSG_NARGS_SINGLE_CHUNK) {
+		/* all chunks are claimed at once */
+		chunk = ring_chunks_alloc(1 + ceiling_fraction(
+				nargs - LOG_MSG_NARGS_HEAD_CHUNK,
+				ARGS_CONT_MSG));
+		msg = (struct log_msg *)chunk;
+		if (msg != NULL) {
+			msg->hdr.ref_cnt = 1;
+			msg->hdr.params.raw = 0U;
+			msg->hdr.params.std.type = LOG_MSG_TYPE_STD;
+		}
+	} else {
+		msg = z_log_msg_std_alloc();
+	}
+#else
+	struct  log_msg *msg = z_log_msg_std_alloc();
+#endif
 
 	if ((msg == NULL) || nargs <= LOG_MSG_NARGS_SINGLE_CHUNK) {
 		return msg;
@@ -263,12 +332,16 @@ static struct log_msg *msg_alloc(u32_t nargs)
 	*next = NULL;
 
 	while (n > 0) {
+#ifdef CONFIG_LOG_MSG_RING
+		cont = &(++chunk)->cont;
+#else
 		cont = (struct log_msg_cont *)log_msg_chunk_alloc();
 
 		if (cont == NULL) {
 			msg_free(msg);
 			return NULL;
 		}
+#endif
 
 		*next = cont;
 		cont->next = NULL;
@@ -335,7 +408,21 @@ struct log_msg *log_msg_hexdump_create(const char *str,
 	length = (length > LOG_MSG_HEXDUMP_MAX_LENGTH) ?
 		 LOG_MSG_HEXDUMP_MAX_LENGTH : length;
 
+#ifdef CONFIG_LOG_MSG_RING
+	union log_msg_chunk *chunk;
+	u32_t nchunks = 1U;
+
+	if (length > LOG_MSG_HEXDUMP_BYTES_SINGLE_CHUNK) {
+		nchunks += ceiling_fraction(
+				length - LOG_MSG_HEXDUMP_BYTES_HEAD_CHUNK,
+				HEXDUMP_BYTES_CONT_MSG);
+	}
+
+	chunk = ring_chunks_alloc(nchunks);
+	msg = (struct log_msg *)chunk;
+#else
 	msg = (struct log_msg *)log_msg_chunk_alloc();
+#endif
 	if (msg == NULL) {
 		return NULL;
 	}
@@ -365,11 +452,15 @@ struct log_msg *log_msg_hexdump_create(const char *str,
 	prev_cont = &msg->payload.ext.next;
 
 	while (length > 0) {
+#ifdef CONFIG_LOG_MSG_RING
+		cont = &(++chunk)->cont;
+#else
 		cont = (struct log_msg_cont *)log_msg_chunk_alloc();
 		if (cont == NULL) {
 			msg_free(msg);
 			return NULL;
 		}
+#endif
 
 		*prev_cont = cont;
 		cont->next = NULL;
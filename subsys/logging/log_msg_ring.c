@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <kernel.h>
+#include <string.h>
+#include <sys/atomic.h>
+#include <logging/log_msg.h>
+#include <logging/log_ctrl.h>
+#include "log_msg_ring.h"
+
+/*
+ * The ring is an array of words holding variable length packets. A packet is
+ * a header word followed by either a log message, made of contiguous chunks,
+ * or a string copied by log_strdup().
+ *
+ * Producers claim a packet by advancing the head counter with a compare and
+ * swap, then write the packet length to the header. A packet that does not
+ * fit before the end of the ring is preceded by a padding packet that covers
+ * the end. The consumer walks packets from the read index and stops at the
+ * first one without the committed flag, so messages are processed in claim
+ * order. A packet is given back once it is freed and all packets before it
+ * were given back: it is cleared, so any word reads as an empty header when
+ * claimed again, and the tail counter moves past it.
+ *
+ * The head, tail and read counters run freely and are masked to a word
+ * index on access, which is why the ring size must be a power of two.  A
+ * head value read by a producer thus only comes back after 2^32 words were
+ * claimed, and a preempted producer can't succeed its compare and swap
+ * against a head that went once around the ring in the meantime.
+ */
+
+#define PKT_LEN_MASK	BIT_MASK(24)
+#define PKT_COMMITTED	BIT(24)
+#define PKT_FREED	BIT(25)
+#define PKT_STR		BIT(26)
+#define PKT_PAD		BIT(27)
+
+#define WORD_SIZE	sizeof(log_arg_t)
+#define RING_WORDS	(CONFIG_LOG_BUFFER_SIZE / WORD_SIZE)
+#define CHUNK_WORDS	(sizeof(union log_msg_chunk) / WORD_SIZE)
+
+BUILD_ASSERT((sizeof(union log_msg_chunk) % WORD_SIZE) == 0,
+	     "Chunk must be a multiple of the ring word");
+BUILD_ASSERT(RING_WORDS <= PKT_LEN_MASK, "Ring too big");
+BUILD_ASSERT((RING_WORDS & (RING_WORDS - 1)) == 0,
+	     "LOG_BUFFER_SIZE must be a power of two");
+
+#define RING_IDX(cnt)	((cnt) & (RING_WORDS - 1))
+
+static log_arg_t ring[RING_WORDS];
+static atomic_t head;	/* count of words claimed */
+static atomic_t tail;	/* count of words given back */
+static u32_t rd;	/* count of words walked by the consumer */
+static struct k_spinlock lock;	/* serializes rd and tail updates */
+
+static atomic_t max_used;
+static atomic_t dropped;
+
+static inline atomic_t *pkt_hdr(u32_t idx)
+{
+	return (atomic_t *)&ring[idx];
+}
+
+static inline u32_t ring_used(u32_t h, u32_t t)
+{
+	return h - t;
+}
+
+static void max_used_update(u32_t used)
+{
+	atomic_val_t prev;
+
+	do {
+		prev = atomic_get(&max_used);
+		if (used <= (u32_t)prev) {
+			return;
+		}
+	} while (!atomic_cas(&max_used, prev, used));
+}
+
+/* Claim a packet of words words, header included. */
+static void *pkt_claim(u32_t words, atomic_val_t flags)
+{
+	atomic_val_t h;
+	u32_t idx, pad, used;
+
+	do {
+		h = atomic_get(&head);
+		used = ring_used(h, atomic_get(&tail));
+		idx = RING_IDX((u32_t)h);
+		pad = ((idx + words) > RING_WORDS) ? (RING_WORDS - idx) : 0;
+
+		if ((used + pad + words) > RING_WORDS) {
+			return NULL;
+		}
+	} while (!atomic_cas(&head, h, (u32_t)h + pad + words));
+
+	if (pad != 0) {
+		atomic_set(pkt_hdr(idx),
+			   pad | PKT_COMMITTED | PKT_FREED | PKT_PAD);
+		idx = 0U;
+	}
+
+	atomic_set(pkt_hdr(idx), words | flags);
+	max_used_update(used + pad + words);
+
+	return &ring[idx + 1];
+}
+
+static inline u32_t pkt_idx(const void *buf)
+{
+	return ((const log_arg_t *)buf - ring) - 1;
+}
+
+/* Give back freed packets the consumer is done with, lock must be held. */
+static void pkt_reclaim(void)
+{
+	u32_t t = atomic_get(&tail);
+	atomic_val_t hdr;
+	u32_t len;
+
+	while (t != rd) {
+		hdr = atomic_get(pkt_hdr(RING_IDX(t)));
+		if ((hdr & PKT_FREED) == 0) {
+			break;
+		}
+
+		len = hdr & PKT_LEN_MASK;
+		(void)memset(&ring[RING_IDX(t)], 0, len * WORD_SIZE);
+		t += len;
+		atomic_set(&tail, t);
+	}
+}
+
+void log_msg_ring_init(void)
+{
+	(void)memset(ring, 0, sizeof(ring));
+	atomic_set(&head, 0);
+	atomic_set(&tail, 0);
+	atomic_set(&max_used, 0);
+	atomic_set(&dropped, 0);
+	rd = 0U;
+}
+
+union log_msg_chunk *log_msg_ring_alloc(u32_t nchunks)
+{
+	return pkt_claim(1 + nchunks * CHUNK_WORDS, 0);
+}
+
+void log_msg_ring_commit(struct log_msg *msg)
+{
+	atomic_or(pkt_hdr(pkt_idx(msg)), PKT_COMMITTED);
+}
+
+struct log_msg *log_msg_ring_get(void)
+{
+	struct log_msg *msg = NULL;
+	k_spinlock_key_t key;
+	atomic_val_t hdr;
+
+	key = k_spin_lock(&lock);
+
+	while (rd != (u32_t)atomic_get(&head)) {
+		hdr = atomic_get(pkt_hdr(RING_IDX(rd)));
+		if ((hdr & PKT_COMMITTED) == 0) {
+			break;
+		}
+
+		if ((hdr & (PKT_STR | PKT_PAD)) == 0) {
+			msg = (struct log_msg *)&ring[RING_IDX(rd) + 1];
+		}
+
+		rd += hdr & PKT_LEN_MASK;
+
+		if (msg != NULL) {
+			break;
+		}
+	}
+
+	/* string and padding packets skipped above may be free already */
+	pkt_reclaim();
+
+	k_spin_unlock(&lock, key);
+
+	return msg;
+}
+
+bool log_msg_ring_pending(void)
+{
+	k_spinlock_key_t key;
+	atomic_val_t hdr;
+	u32_t idx;
+	bool ret = false;
+
+	key = k_spin_lock(&lock);
+
+	idx = rd;
+	while (idx != (u32_t)atomic_get(&head)) {
+		hdr = atomic_get(pkt_hdr(RING_IDX(idx)));
+		if ((hdr & PKT_COMMITTED) == 0) {
+			break;
+		}
+
+		if ((hdr & (PKT_STR | PKT_PAD)) == 0) {
+			ret = true;
+			break;
+		}
+
+		idx += hdr & PKT_LEN_MASK;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	return ret;
+}
+
+void log_msg_ring_free(void *buf)
+{
+	k_spinlock_key_t key;
+
+	atomic_or(pkt_hdr(pkt_idx(buf)), PKT_FREED);
+
+	key = k_spin_lock(&lock);
+	pkt_reclaim();
+	k_spin_unlock(&lock, key);
+}
+
+char *log_msg_ring_strdup(const char *str, size_t max_len)
+{
+	size_t len = strlen(str);
+	bool trim = (len > max_len);
+	char *dup;
+
+	if (trim) {
+		len = max_len;
+	}
+
+	dup = pkt_claim(1 + ceiling_fraction(len + 1, WORD_SIZE), PKT_STR);
+	if (dup == NULL) {
+		return NULL;
+	}
+
+	(void)memcpy(dup, str, len);
+	if (trim) {
+		dup[len - 1] = '~';
+	}
+	dup[len] = '\0';
+
+	atomic_or(pkt_hdr(pkt_idx(dup)), PKT_COMMITTED);
+
+	return dup;
+}
+
+bool log_msg_ring_contains(const void *buf)
+{
+	return PART_OF_ARRAY(ring, (log_arg_t *)buf);
+}
+
+void log_msg_ring_dropped(void)
+{
+	atomic_inc(&dropped);
+}
+
+void log_msg_ring_stats_get(struct log_msg_ring_stats *stats)
+{
+	stats->size = RING_WORDS * WORD_SIZE;
+	stats->used = ring_used(atomic_get(&head), atomic_get(&tail)) *
+		      WORD_SIZE;
+	stats->max_used = atomic_get(&max_used) * WORD_SIZE;
+	stats->dropped = atomic_get(&dropped);
+}
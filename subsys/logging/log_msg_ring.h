@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef LOG_MSG_RING_H_
+#define LOG_MSG_RING_H_
+
+#include <logging/log_msg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Initialize the ring, dropping all packets. */
+void log_msg_ring_init(void);
+
+/** @brief Claim contiguous chunks for a log message.
+ *
+ * The message is not visible to the consumer until committed.
+ *
+ * @param nchunks Number of chunks.
+ *
+ * @return Pointer to the first chunk or NULL if the ring is full.
+ */
+union log_msg_chunk *log_msg_ring_alloc(u32_t nchunks);
+
+/** @brief Make a message claimed with @ref log_msg_ring_alloc available to
+ *	   the consumer.
+ *
+ * @param msg Message.
+ */
+void log_msg_ring_commit(struct log_msg *msg);
+
+/** @brief Get the oldest committed message.
+ *
+ * @return Message or NULL if there is no message or the oldest one is not
+ *	   committed yet.
+ */
+struct log_msg *log_msg_ring_get(void);
+
+/** @brief Check if a committed message is waiting for the consumer.
+ *
+ * @return True if @ref log_msg_ring_get would return a message.
+ */
+bool log_msg_ring_pending(void);
+
+/** @brief Give back a message or string duplicate to the ring.
+ *
+ * @param buf Message or string returned by @ref log_msg_ring_strdup.
+ */
+void log_msg_ring_free(void *buf);
+
+/** @brief Copy a string into the ring.
+ *
+ * @param str     String.
+ * @param max_len Longest string stored, longer strings are truncated and
+ *		  end with '~'.
+ *
+ * @return Copy of the string or NULL if the ring is full.
+ */
+char *log_msg_ring_strdup(const char *str, size_t max_len);
+
+/** @brief Check if address is within the ring.
+ *
+ * @param buf Address.
+ *
+ * @return True if address within the ring.
+ */
+bool log_msg_ring_contains(const void *buf);
+
+/** @brief Count a message dropped because the ring was full. */
+void log_msg_ring_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_MSG_RING_H_ */
@@ -57,6 +57,16 @@ extern void log_output_string_syst_process(const struct log_output *log_output,
 extern void log_output_hexdump_syst_process(const struct log_output *log_output,
 				struct log_msg_ids src_level,
 				const u8_t *data, u32_t length, u32_t flag);
+extern void log_output_msg_dict_process(const struct log_output *log_output,
+				struct log_msg *msg, u32_t flag);
+extern void log_output_string_dict_process(const struct log_output *log_output,
+				struct log_msg_ids src_level, u32_t timestamp,
+				const char *fmt, va_list ap, u32_t flag);
+extern void log_output_hexdump_dict_process(
+				const struct log_output *log_output,
+				struct log_msg_ids src_level, u32_t timestamp,
+				const char *metadata, const u8_t *data,
+				u32_t length, u32_t flag);
 
 /* The RFC 5424 allows very flexible mapping and suggest the value 0 being the
  * highest severity and 7 to be the lowest (debugging level) severity.
@@ -536,6 +546,12 @@ void log_output_msg_process(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_msg_dict_process(log_output, msg, flags);
+		return;
+	}
+
 	prefix_offset = raw_string ?
 			0 : prefix_print(log_output, flags, std_msg, timestamp,
 					 level, domain_id, source_id);
@@ -584,6 +600,13 @@ void log_output_string(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_string_dict_process(log_output, src_level,
+				timestamp, fmt, ap, flags);
+		return;
+	}
+
 	if (!raw_string) {
 		prefix_print(log_output, flags, true, timestamp,
 				level, domain_id, source_id);
@@ -627,6 +650,13 @@ void log_output_hexdump(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_hexdump_dict_process(log_output, src_level,
+				timestamp, metadata, data, length, flags);
+		return;
+	}
+
 	prefix_offset = prefix_print(log_output, flags, true, timestamp,
 				     level, domain_id, source_id);
 
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <logging/log.h>
+#include <logging/log_ctrl.h>
+#include <logging/log_output.h>
+
+/*
+ * Dictionary output sends log messages as binary records instead of text.
+ * Format strings are not sent, only their address, which the host decoder
+ * (scripts/logging/log_dict_decode.py) resolves using zephyr.elf. Addresses
+ * are sent relative to __log_const_start, so that images loaded at another
+ * address than the one they are linked at (native_posix) can be decoded as
+ * well.
+ *
+ * Most values are sent as LEB128 variable length integers (var), signed ones
+ * zigzag encoded first (svar), so that small values take a single byte.
+ * Fixed size fields use the byte order of the target. Each record starts
+ * with a header:
+ *
+ *   u8  record type, LOG_DICT_MAGIC | type
+ *   u8  level in bits 0-2, domain id in bits 3-5
+ *   u16 source id
+ *   u32 timestamp
+ *
+ * A standard message continues with:
+ *
+ *   svar format string address
+ *   u8   number of arguments
+ *   then for each argument, depending on its conversion in the format:
+ *   %s   u8 length and the string without its '\0'
+ *   %p   var value
+ *   else svar value, of an int unless a l, ll or floating point conversion
+ *
+ * A hexdump message continues with:
+ *
+ *   svar metadata string address
+ *   var  data length
+ *   u8   data
+ *
+ * A dropped messages record has a zero header except for the type and
+ * continues with the var number of dropped messages.
+ */
+
+#define LOG_DICT_MAGIC		0xD0
+#define LOG_DICT_TYPE_STD	0
+#define LOG_DICT_TYPE_HEXDUMP	1
+#define LOG_DICT_TYPE_DROPPED	2
+
+#define LOG_DICT_MAX_ARGS	15
+
+struct log_dict_hdr {
+	u8_t type;
+	u8_t ids;
+	u16_t source_id;
+	u32_t timestamp;
+} __packed;
+
+enum arg_type {
+	ARG_INT,
+	ARG_LONG,
+	ARG_LONG_LONG,
+	ARG_DOUBLE,
+	ARG_PTR,
+	ARG_STR,
+};
+
+/* Return the type of each argument consumed by the format string, the host
+ * decoder parses format strings the same way.
+ */
+static u32_t fmt_parse(const char *fmt, u8_t *types, u32_t max)
+{
+	u32_t n = 0U;
+	int longs;
+
+	while ((*fmt != '\0') && (n < max)) {
+		if (*fmt++ != '%') {
+			continue;
+		}
+
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+
+		while ((*fmt != '\0') && (strchr("-+ #0123456789.", *fmt))) {
+			fmt++;
+		}
+
+		longs = 0;
+		while ((*fmt != '\0') && (strchr("hlLqjzt", *fmt))) {
+			longs += (*fmt == 'l') ? 1 : 0;
+			longs += (*fmt == 'L' || *fmt == 'q') ? 2 : 0;
+			fmt++;
+		}
+
+		switch (*fmt) {
+		case '\0':
+			return n;
+		case 's':
+			types[n++] = ARG_STR;
+			break;
+		case 'p':
+			types[n++] = ARG_PTR;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+			types[n++] = ARG_DOUBLE;
+			break;
+		default:
+			types[n++] = (longs == 0) ? ARG_INT :
+				     (longs == 1) ? ARG_LONG : ARG_LONG_LONG;
+			break;
+		}
+		fmt++;
+	}
+
+	return n;
+}
+
+static void dict_write(const struct log_output *log_output,
+		       const void *data, size_t len)
+{
+	const u8_t *src = data;
+	size_t part;
+	int processed;
+
+	if (IS_ENABLED(CONFIG_LOG_IMMEDIATE)) {
+		/* Backend must be thread safe in synchronous operation. */
+		while (len != 0) {
+			processed = log_output->func((u8_t *)src, len,
+					log_output->control_block->ctx);
+			src += processed;
+			len -= processed;
+		}
+		return;
+	}
+
+	while (len != 0) {
+		if (log_output->control_block->offset == log_output->size) {
+			log_output_flush(log_output);
+		}
+
+		part = MIN(len, log_output->size -
+				log_output->control_block->offset);
+		(void)memcpy(&log_output->buf[log_output->control_block->offset],
+			     src, part);
+		atomic_add(&log_output->control_block->offset, part);
+		src += part;
+		len -= part;
+	}
+}
+
+static void hdr_write(const struct log_output *log_output, u8_t type,
+		      struct log_msg_ids src_level, u32_t timestamp)
+{
+	struct log_dict_hdr hdr = {
+		.type = LOG_DICT_MAGIC | type,
+		.ids = src_level.level | (src_level.domain_id << 3),
+		.source_id = src_level.source_id,
+		.timestamp = timestamp,
+	};
+
+	dict_write(log_output, &hdr, sizeof(hdr));
+}
+
+static void var_write(const struct log_output *log_output, u64_t val)
+{
+	u8_t buf[10];
+	int n = 0;
+
+	do {
+		buf[n] = val & 0x7f;
+		val >>= 7;
+		if (val != 0) {
+			buf[n] |= 0x80;
+		}
+		n++;
+	} while (val != 0);
+
+	dict_write(log_output, buf, n);
+}
+
+static void svar_write(const struct log_output *log_output, s64_t val)
+{
+	var_write(log_output, ((u64_t)val << 1) ^ (u64_t)(val >> 63));
+}
+
+static void str_addr_write(const struct log_output *log_output,
+			   const char *str)
+{
+	svar_write(log_output, (intptr_t)str - (intptr_t)__log_const_start);
+}
+
+static void std_write(const struct log_output *log_output, const char *fmt,
+		      const log_arg_t *args, u8_t nargs, const u8_t *types)
+{
+	const char *str;
+	u8_t len;
+
+	str_addr_write(log_output, fmt);
+	dict_write(log_output, &nargs, sizeof(nargs));
+
+	for (int i = 0; i < nargs; i++) {
+		switch (types[i]) {
+		case ARG_STR:
+			str = (const char *)args[i];
+			len = (str == NULL) ? 0 :
+			      strnlen(str, CONFIG_LOG_DICTIONARY_MAX_STRING);
+			dict_write(log_output, &len, sizeof(len));
+			dict_write(log_output, str, len);
+			break;
+		case ARG_PTR:
+			var_write(log_output, args[i]);
+			break;
+		case ARG_INT:
+			svar_write(log_output, (int)args[i]);
+			break;
+		default:
+			svar_write(log_output, (long)args[i]);
+			break;
+		}
+	}
+}
+
+static struct log_msg_ids msg_ids_get(struct log_msg *msg)
+{
+	struct log_msg_ids src_level = {
+		.level = log_msg_level_get(msg),
+		.domain_id = log_msg_domain_id_get(msg),
+		.source_id = log_msg_source_id_get(msg),
+	};
+
+	return src_level;
+}
+
+void log_output_msg_dict_process(const struct log_output *log_output,
+				 struct log_msg *msg, u32_t flag)
+{
+	u32_t timestamp = log_msg_timestamp_get(msg);
+
+	if (log_msg_is_std(msg)) {
+		log_arg_t args[LOG_DICT_MAX_ARGS];
+		u8_t types[LOG_DICT_MAX_ARGS];
+		const char *fmt = log_msg_str_get(msg);
+		u32_t nargs = log_msg_nargs_get(msg);
+
+		(void)memset(types, ARG_INT, sizeof(types));
+		(void)fmt_parse(fmt, types, nargs);
+
+		for (u32_t i = 0; i < nargs; i++) {
+			args[i] = log_msg_arg_get(msg, i);
+		}
+
+		hdr_write(log_output, LOG_DICT_TYPE_STD, msg_ids_get(msg),
+			  timestamp);
+		std_write(log_output, fmt, args, nargs, types);
+	} else {
+		const char *metadata = log_msg_str_get(msg);
+		u8_t buf[HEXDUMP_BYTES_CONT_MSG];
+		u32_t length = msg->hdr.params.hexdump.length;
+		size_t offset = 0;
+		size_t len;
+
+		hdr_write(log_output, LOG_DICT_TYPE_HEXDUMP, msg_ids_get(msg),
+			  timestamp);
+		str_addr_write(log_output, metadata);
+		var_write(log_output, length);
+
+		do {
+			len = sizeof(buf);
+			log_msg_hexdump_data_get(msg, buf, &len, offset);
+			dict_write(log_output, buf, len);
+			offset += len;
+		} while (len != 0);
+	}
+
+	log_output_flush(log_output);
+}
+
+void log_output_string_dict_process(const struct log_output *log_output,
+				    struct log_msg_ids src_level,
+				    u32_t timestamp, const char *fmt,
+				    va_list ap, u32_t flag)
+{
+	log_arg_t args[LOG_DICT_MAX_ARGS];
+	u8_t types[LOG_DICT_MAX_ARGS];
+	u32_t nargs;
+
+	nargs = fmt_parse(fmt, types, ARRAY_SIZE(types));
+
+	/* Arguments are converted as in deferred mode. */
+	for (u32_t i = 0; i < nargs; i++) {
+		switch (types[i]) {
+		case ARG_INT:
+			args[i] = (log_arg_t)va_arg(ap, int);
+			break;
+		case ARG_LONG:
+			args[i] = (log_arg_t)va_arg(ap, long);
+			break;
+		case ARG_LONG_LONG:
+			args[i] = (log_arg_t)va_arg(ap, long long);
+			break;
+		case ARG_DOUBLE:
+			args[i] = (log_arg_t)va_arg(ap, double);
+			break;
+		default:
+			args[i] = (log_arg_t)va_arg(ap, void *);
+			break;
+		}
+	}
+
+	hdr_write(log_output, LOG_DICT_TYPE_STD, src_level, timestamp);
+	std_write(log_output, fmt, args, nargs, types);
+	log_output_flush(log_output);
+}
+
+void log_output_hexdump_dict_process(const struct log_output *log_output,
+				     struct log_msg_ids src_level,
+				     u32_t timestamp, const char *metadata,
+				     const u8_t *data, u32_t length,
+				     u32_t flag)
+{
+	hdr_write(log_output, LOG_DICT_TYPE_HEXDUMP, src_level, timestamp);
+	str_addr_write(log_output, metadata);
+	var_write(log_output, length);
+	dict_write(log_output, data, length);
+	log_output_flush(log_output);
+}
+
+void log_output_dict_dropped_process(const struct log_output *log_output,
+				     u32_t cnt)
+{
+	struct log_msg_ids src_level = { 0 };
+
+	hdr_write(log_output, LOG_DICT_TYPE_DROPPED, src_level, 0);
+	var_write(log_output, cnt);
+	log_output_flush(log_output);
+}
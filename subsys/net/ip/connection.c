@@ -59,6 +59,22 @@ static struct net_conn conns[CONFIG_NET_MAX_CONN];
 static sys_slist_t conn_unused;
 static sys_slist_t conn_used;
 
+/* Lookup tables for received packets. Handlers with both ports set are
+ * hashed on protocol and both ports, handlers with only the local port set
+ * on protocol and local port, the others are in a wildcard list. Each list
+ * is kept newest first, like conn_used.
+ */
+static sys_slist_t conn_exact[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_listen[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_wildcard;
+static u32_t conn_seq;
+
+#define CONN_LISTS 3
+
+struct conn_iter {
+	sys_snode_t *node[CONN_LISTS];
+};
+
 #if (CONFIG_NET_CONN_LOG_LEVEL >= LOG_LEVEL_DBG)
 static inline
 void conn_register_debug(struct net_conn *conn,
@@ -127,11 +143,67 @@ static struct net_conn *conn_get_unused(void)
 	return CONTAINER_OF(node, struct net_conn, node);
 }
 
+static inline u32_t conn_hash(u16_t proto, u16_t local_port,
+			      u16_t remote_port)
+{
+	u32_t hash = ((u32_t)local_port << 16 | remote_port) ^ proto;
+
+	hash ^= hash >> 16;
+	hash *= 0x45d9f3bU;
+	hash ^= hash >> 16;
+
+	return hash % CONFIG_NET_CONN_HASH_SIZE;
+}
+
+static inline bool conn_proto_has_ports(u16_t proto)
+{
+	return (IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) ||
+	       (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP);
+}
+
+static inline bool conn_has_ports(struct net_conn *conn)
+{
+	if (conn->family != AF_INET && conn->family != AF_INET6) {
+		return false;
+	}
+
+	return conn_proto_has_ports(conn->proto);
+}
+
+/* The list is chosen from the ports as net_conn_input() compares them, in
+ * network byte order and from the stored addresses.  Handlers without
+ * ports (packet and CAN sockets) hold other data there and always go to
+ * the wildcard list.
+ */
+static sys_slist_t *conn_list_get(struct net_conn *conn)
+{
+	u16_t local_port, remote_port;
+
+	if (!conn_has_ports(conn)) {
+		return &conn_wildcard;
+	}
+
+	local_port = net_sin(&conn->local_addr)->sin_port;
+	remote_port = net_sin(&conn->remote_addr)->sin_port;
+
+	if (!local_port) {
+		return &conn_wildcard;
+	}
+
+	if (!remote_port) {
+		return &conn_listen[conn_hash(conn->proto, local_port, 0)];
+	}
+
+	return &conn_exact[conn_hash(conn->proto, local_port, remote_port)];
+}
+
 static void conn_set_used(struct net_conn *conn)
 {
 	conn->flags |= NET_CONN_IN_USE;
+	conn->seq = conn_seq++;
 
 	sys_slist_prepend(&conn_used, &conn->node);
+	sys_slist_prepend(conn_list_get(conn), &conn->hash_node);
 }
 
 static void conn_set_unused(struct net_conn *conn)
@@ -377,6 +449,7 @@ int net_conn_unregister(struct net_conn_handle *handle)
 	NET_DBG("Connection handler %p removed", conn);
 
 	sys_slist_find_and_remove(&conn_used, &conn->node);
+	sys_slist_find_and_remove(conn_list_get(conn), &conn->hash_node);
 
 	conn_set_unused(conn);
 
@@ -456,6 +529,44 @@ static bool conn_addr_cmp(struct net_pkt *pkt,
 	return true;
 }
 
+/* Iterate over the handlers a packet can match, in the order of conn_used:
+ * those registered with the destination and source ports, with the
+ * destination port only, and with no local port.
+ */
+static void conn_iter_init(struct conn_iter *iter, u16_t proto,
+			   u16_t src_port, u16_t dst_port)
+{
+	iter->node[0] = sys_slist_peek_head(
+			&conn_exact[conn_hash(proto, dst_port, src_port)]);
+	iter->node[1] = sys_slist_peek_head(
+			&conn_listen[conn_hash(proto, dst_port, 0)]);
+	iter->node[2] = sys_slist_peek_head(&conn_wildcard);
+}
+
+static struct net_conn *conn_iter_next(struct conn_iter *iter)
+{
+	struct net_conn *conn, *newest = NULL;
+	int idx = 0;
+
+	for (int i = 0; i < CONN_LISTS; i++) {
+		if (!iter->node[i]) {
+			continue;
+		}
+
+		conn = CONTAINER_OF(iter->node[i], struct net_conn, hash_node);
+		if (!newest || (s32_t)(conn->seq - newest->seq) > 0) {
+			newest = conn;
+			idx = i;
+		}
+	}
+
+	if (newest) {
+		iter->node[idx] = sys_slist_peek_next(iter->node[idx]);
+	}
+
+	return newest;
+}
+
 static inline void conn_send_icmp_error(struct net_pkt *pkt)
 {
 	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
@@ -513,6 +624,7 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 	struct net_conn *best_match = NULL;
 	bool is_mcast_pkt = false, mcast_pkt_delivered = false;
 	s16_t best_rank = -1;
+	struct conn_iter iter;
 	struct net_conn *conn;
 	u16_t src_port;
 	u16_t dst_port;
@@ -568,7 +680,9 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		}
 	}
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
+	conn_iter_init(&iter, proto, src_port, dst_port);
+
+	while ((conn = conn_iter_next(&iter)) != NULL) {
 		if (conn->proto != proto) {
 			continue;
 		}
@@ -578,8 +692,7 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 			continue;
 		}
 
-		if (IS_ENABLED(CONFIG_NET_UDP) ||
-		    IS_ENABLED(CONFIG_NET_TCP)) {
+		if (conn_proto_has_ports(proto)) {
 			if (net_sin(&conn->remote_addr)->sin_port) {
 				if (net_sin(&conn->remote_addr)->sin_port !=
 				    src_port) {
@@ -732,6 +845,12 @@ void net_conn_init(void)
 
 	sys_slist_init(&conn_unused);
 	sys_slist_init(&conn_used);
+	sys_slist_init(&conn_wildcard);
+
+	for (i = 0; i < CONFIG_NET_CONN_HASH_SIZE; i++) {
+		sys_slist_init(&conn_exact[i]);
+		sys_slist_init(&conn_listen[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
 		sys_slist_prepend(&conn_unused, &conns[i].node);
@@ -50,6 +50,12 @@ struct net_conn {
 	/** Internal slist node */
 	sys_snode_t node;
 
+	/** Internal slist node in the lookup table */
+	sys_snode_t hash_node;
+
+	/** Registration order, handlers are matched newest first */
+	u32_t seq;
+
 	/** Remote IP address */
 	struct sockaddr remote_addr;
 
@@ -3423,19 +3423,24 @@ void net_if_call_link_cb(struct net_if *iface, struct net_linkaddr *lladdr,
 	}
 }
 
-static bool need_calc_checksum(struct net_if *iface, enum ethernet_hw_caps caps)
+static bool has_hw_caps(struct net_if *iface, enum ethernet_hw_caps caps)
 {
 #if defined(CONFIG_NET_L2_ETHERNET)
 	if (net_if_l2(iface) != &NET_L2_GET_NAME(ETHERNET)) {
-		return true;
+		return false;
 	}
 
-	return !(net_eth_get_hw_capabilities(iface) & caps);
+	return (net_eth_get_hw_capabilities(iface) & caps) == caps;
 #else
-	return true;
+	return false;
 #endif
 }
 
+static bool need_calc_checksum(struct net_if *iface, enum ethernet_hw_caps caps)
+{
+	return !has_hw_caps(iface, caps);
+}
+
 bool net_if_need_calc_tx_checksum(struct net_if *iface)
 {
 	return need_calc_checksum(iface, ETHERNET_HW_TX_CHKSUM_OFFLOAD);
@@ -3446,6 +3451,16 @@ bool net_if_need_calc_rx_checksum(struct net_if *iface)
 	return need_calc_checksum(iface, ETHERNET_HW_RX_CHKSUM_OFFLOAD);
 }
 
+bool net_if_tso_supported(struct net_if *iface)
+{
+	return has_hw_caps(iface, ETHERNET_HW_TX_TSO);
+}
+
+bool net_if_lro_supported(struct net_if *iface)
+{
+	return has_hw_caps(iface, ETHERNET_HW_RX_LRO);
+}
+
 struct net_if *net_if_get_by_index(int index)
 {
 	if (index <= 0) {
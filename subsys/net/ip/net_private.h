@@ -149,6 +149,23 @@ extern char *net_sprint_ll_addr_buf(const u8_t *ll, u8_t ll_len,
 				    char *buf, int buflen);
 extern u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto);
 
+/**
+ * @brief Update a checksum after some of the data it covers changed
+ *
+ * Implements RFC 1624, so that rewriting a header field does not require
+ * summing the whole packet again. The changed data must start at an even
+ * offset of the checksummed data.
+ *
+ * @param chksum	Checksum of the old data, in network byte order
+ * @param old_data	Data before the change
+ * @param new_data	Data after the change
+ * @param len		Length of the changed data
+ *
+ * @return Checksum of the new data, in network byte order
+ */
+extern u16_t net_chksum_update(u16_t chksum, const void *old_data,
+			       const void *new_data, size_t len);
+
 /**
  * @brief Deliver the incoming packet through the recv_cb of the net_context
  *        to the upper layers
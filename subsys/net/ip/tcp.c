@@ -918,7 +918,8 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
 	struct net_context *ctx = net_pkt_context(pkt);
 	struct net_tcp_hdr *tcp_hdr;
-	bool calc_chksum = false;
+	bool update_chksum = false;
+	u16_t chksum;
 	int ret;
 
 	if (!ctx || !ctx->tcp) {
@@ -941,10 +942,19 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 		return -EMSGSIZE;
 	}
 
+	/* The header is already finalized, the checksum is updated for the
+	 * fields changed instead of summing the whole segment again.
+	 */
+	chksum = tcp_hdr->chksum;
+
 	if (sys_get_be32(tcp_hdr->ack) != ctx->tcp->send_ack) {
-		sys_put_be32(ctx->tcp->send_ack, tcp_hdr->ack);
-		tcp_hdr->chksum = 0U;
-		calc_chksum = true;
+		u8_t ack[sizeof(tcp_hdr->ack)];
+
+		sys_put_be32(ctx->tcp->send_ack, ack);
+		chksum = net_chksum_update(chksum, tcp_hdr->ack, ack,
+					   sizeof(ack));
+		memcpy(tcp_hdr->ack, ack, sizeof(ack));
+		update_chksum = true;
 	}
 
 	/* The data stream code always sets this flag, because
@@ -954,26 +964,25 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 	 */
 	if (ctx->tcp->sent_ack != ctx->tcp->send_ack &&
 		(tcp_hdr->flags & NET_TCP_ACK) == 0U) {
+		/* The flags share a 16-bit word with the data offset */
+		u8_t word[2] = { tcp_hdr->offset, tcp_hdr->flags };
+
 		tcp_hdr->flags |= NET_TCP_ACK;
-		tcp_hdr->chksum = 0U;
-		calc_chksum = true;
+		chksum = net_chksum_update(chksum, word, &tcp_hdr->offset,
+					   sizeof(word));
+		update_chksum = true;
+	}
+
+	/* The checksum is left to the hardware when it was not computed */
+	if (update_chksum &&
+	    net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+		tcp_hdr->chksum = chksum;
 	}
 
 	/* As we modified the header, we need to write it back.
 	 */
 	net_pkt_set_data(pkt, &tcp_access);
 
-	if (calc_chksum) {
-		net_pkt_cursor_init(pkt);
-		net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
-			     net_pkt_ip_opts_len(pkt));
-
-		/* No need to get tcp_hdr again */
-		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
-
-		net_pkt_set_data(pkt, &tcp_access);
-	}
-
 	if (tcp_hdr->flags & NET_TCP_FIN) {
 		ctx->tcp->fin_sent = 1U;
 	}
@@ -27,11 +27,20 @@ static int tcp_window = NET_IPV6_MTU;
 
 static sys_slist_t tcp_conns = SYS_SLIST_STATIC_INIT(&tcp_conns);
 
+/* Connections with their endpoints set, hashed on the ports and the remote
+ * address, for matching incoming segments.
+ */
+static sys_slist_t tcp_conns_hash[CONFIG_NET_CONN_HASH_SIZE];
+static int tcp_conns_hashed;
+
 static K_MEM_SLAB_DEFINE(tcp_conns_slab, sizeof(struct tcp),
 				CONFIG_NET_MAX_CONTEXTS, 4);
 
 static void tcp_in(struct tcp *conn, struct net_pkt *pkt);
 static size_t tcp_data_len(struct net_pkt *pkt);
+#if defined(CONFIG_NET_TCP_GRO)
+static void tcp_gro_timeout(struct k_work *work);
+#endif
 int net_tcp_finalize(struct net_pkt *pkt);
 
 int (*tcp_send_cb)(struct net_pkt *pkt) = NULL;
@@ -110,6 +119,54 @@ static int tcp_endpoint_set(union tcp_endpoint *ep, struct net_pkt *pkt,
 	return ret;
 }
 
+static u32_t tcp_endpoint_hash(union tcp_endpoint *src,
+			       union tcp_endpoint *dst)
+{
+	u32_t hash = (u32_t)src->sin.sin_port << 16 | dst->sin.sin_port;
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && dst->sa.sa_family == AF_INET6) {
+		for (int i = 0; i < 4; i++) {
+			hash ^= UNALIGNED_GET(
+				&dst->sin6.sin6_addr.s6_addr32[i]);
+		}
+	} else {
+		hash ^= UNALIGNED_GET(&dst->sin.sin_addr.s_addr);
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x45d9f3bU;
+	hash ^= hash >> 16;
+
+	return hash % CONFIG_NET_CONN_HASH_SIZE;
+}
+
+/* The hash table and tcp_conns_hashed are accessed with interrupts locked,
+ * like tcp_conns.
+ */
+static void tcp_conn_hash_del(struct tcp *conn)
+{
+	if (conn->hash_list) {
+		sys_slist_find_and_remove(conn->hash_list, &conn->hash_next);
+		conn->hash_list = NULL;
+		tcp_conns_hashed--;
+	}
+}
+
+/* Called once the endpoints of the connection are set */
+static void tcp_conn_hash_add(struct tcp *conn)
+{
+	int key = irq_lock();
+
+	tcp_conn_hash_del(conn);
+
+	conn->hash_list = &tcp_conns_hash[tcp_endpoint_hash(&conn->src,
+							    &conn->dst)];
+	sys_slist_append(conn->hash_list, &conn->hash_next);
+	tcp_conns_hashed++;
+
+	irq_unlock(key);
+}
+
 static const char *tcp_flags(u8_t flags)
 {
 #define BUF_SIZE 25 /* 6 * 4 + 1 */
@@ -243,6 +300,16 @@ static int tcp_conn_unref(struct tcp *conn)
 
 	k_delayed_work_cancel(&conn->timewait_timer);
 
+#if defined(CONFIG_NET_TCP_GRO)
+	k_delayed_work_cancel(&conn->gro_timer);
+
+	if (conn->gro_pkt) {
+		tcp_pkt_unref(conn->gro_pkt);
+	}
+#endif
+
+	tcp_conn_hash_del(conn);
+
 	memset(conn, 0, sizeof(*conn));
 
 	sys_slist_find_and_remove(&tcp_conns, (sys_snode_t *)conn);
@@ -419,7 +486,8 @@ static bool tcp_options_check(struct tcp_options *recv_options,
 				goto end;
 			}
 
-			recv_options->mss = opt;
+			recv_options->mss =
+				ntohs(UNALIGNED_GET((u16_t *)(options + 2)));
 			recv_options->mss_found = true;
 			break;
 		case TCPOPT_WINDOW:
@@ -495,7 +563,8 @@ static int tcp_finalize_pkt(struct net_pkt *pkt)
 	return -EINVAL;
 }
 
-static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, u8_t flags)
+static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, u8_t flags,
+			  u32_t seq)
 {
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
 	struct tcphdr *th;
@@ -513,7 +582,7 @@ static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, u8_t flags)
 	th->th_off = 5;
 	th->th_flags = flags;
 	th->th_win = htons(conn->win);
-	th->th_seq = htonl(conn->seq);
+	th->th_seq = htonl(seq);
 
 	if (ACK & flags) {
 		th->th_ack = htonl(conn->ack);
@@ -539,30 +608,137 @@ static int ip_header_add(struct tcp *conn, struct net_pkt *pkt)
 	return -EINVAL;
 }
 
-static void tcp_out(struct tcp *conn, u8_t flags, ...)
+/* Largest amount of data in a segment sent on the connection */
+static u16_t tcp_mss(struct tcp *conn)
 {
+	u16_t mtu = net_if_get_mtu(conn->iface);
+	u16_t mss;
+
+	/* The minimum MTU of the protocol is only used when the interface
+	 * does not tell its own.
+	 */
+	if (IS_ENABLED(CONFIG_NET_IPV6) &&
+	    net_context_get_family(conn->context) == AF_INET6) {
+		mss = (mtu ? mtu : NET_IPV6_MTU) - sizeof(struct net_ipv6_hdr);
+	} else {
+		mss = (mtu ? mtu : NET_IPV4_MTU) - sizeof(struct net_ipv4_hdr);
+	}
+
+	mss -= sizeof(struct tcphdr);
+
+	if (conn->recv_options.mss_found && conn->recv_options.mss) {
+		mss = MIN(mss, conn->recv_options.mss);
+	}
+
+	return mss;
+}
+
+static void tcp_pkt_send(struct tcp *conn, struct net_pkt *pkt)
+{
+	NET_DBG("%s", log_strdup(tcp_th(pkt)));
+
+	if (tcp_send_cb) {
+		tcp_send_cb(pkt);
+		return;
+	}
+
+	sys_slist_append(&conn->send_queue, &pkt->next);
+
+	tcp_send_process((struct k_work *)&conn->send_timer);
+}
+
+#if defined(CONFIG_NET_TCP_TSO)
+/* Split the data in segments of at most mss bytes, for interfaces that do
+ * not do it themselves. Only the last segment gets the PSH flag. All the
+ * segments, headers included, are built before the first one is sent, so
+ * that the data is either sent as a whole or left to the caller on failure.
+ */
+static int tcp_out_segments(struct tcp *conn, u8_t flags,
+			    struct net_pkt *data, u16_t mss)
+{
+	size_t total = net_pkt_get_len(data);
+	size_t len = total;
+	u32_t seq = conn->seq;
+	sys_slist_t segs;
+	sys_snode_t *node;
+	struct net_pkt *seg;
+	size_t seg_len;
+
+	sys_slist_init(&segs);
+
+	net_pkt_cursor_init(data);
+	net_pkt_set_overwrite(data, true);
+
+	while (len) {
+		seg_len = MIN(len, mss);
+
+		seg = tcp_pkt_alloc(conn, sizeof(struct tcphdr) + seg_len);
+		if (!seg) {
+			NET_ERR("conn: %p, cannot allocate segment", conn);
+			goto fail;
+		}
+
+		sys_slist_append(&segs, &seg->next);
+
+		if (ip_header_add(conn, seg) < 0 ||
+		    tcp_header_add(conn, seg, seg_len == len ?
+				   flags : (flags & ~PSH), seq) < 0 ||
+		    net_pkt_copy(seg, data, seg_len) < 0 ||
+		    tcp_finalize_pkt(seg) < 0) {
+			goto fail;
+		}
+
+		seq += seg_len;
+		len -= seg_len;
+	}
+
+	tcp_pkt_unref(data);
+
+	conn_seq(conn, + total);
+
+	while ((node = sys_slist_get(&segs))) {
+		tcp_pkt_send(conn, CONTAINER_OF(node, struct net_pkt, next));
+	}
+
+	return 0;
+
+fail:
+	while ((node = sys_slist_get(&segs))) {
+		tcp_pkt_unref(CONTAINER_OF(node, struct net_pkt, next));
+	}
+
+	net_pkt_cursor_init(data);
+
+	return -ENOBUFS;
+}
+#endif /* CONFIG_NET_TCP_TSO */
+
+/* Send a segment. The data is consumed on success and left to the caller
+ * when a negative error is returned.
+ */
+static int tcp_out_ext(struct tcp *conn, u8_t flags, struct net_pkt *data)
+{
+	struct net_buf *hdr_buf = NULL;
 	struct net_pkt *pkt;
 	size_t len = 0;
+	u16_t mss = 0;
 	int r;
 
-	pkt = tcp_pkt_alloc(conn, sizeof(struct tcphdr));
-	if (!pkt) {
-		goto fail;
-	}
-
-	if (PSH & flags) {
-		struct net_pkt *data_pkt;
-		va_list ap;
-		va_start(ap, flags);
-		data_pkt = va_arg(ap, struct net_pkt *);
-		va_end(ap);
+	if (data) {
+		len = net_pkt_get_len(data);
+		mss = tcp_mss(conn);
 
-		len = net_pkt_get_len(data_pkt);
-		/* Append the data buffer to pkt */
-		net_pkt_append_buffer(pkt, data_pkt->buffer);
+		if (IS_ENABLED(CONFIG_NET_TCP_TSO) && len > mss &&
+		    !net_if_tso_supported(conn->iface)) {
+#if defined(CONFIG_NET_TCP_TSO)
+			return tcp_out_segments(conn, flags, data, mss);
+#endif
+		}
+	}
 
-		data_pkt->buffer = NULL;
-		tcp_pkt_unref(data_pkt);
+	pkt = tcp_pkt_alloc(conn, sizeof(struct tcphdr));
+	if (!pkt) {
+		return -ENOBUFS;
 	}
 
 	r = ip_header_add(conn, pkt);
@@ -570,37 +746,53 @@ static void tcp_out(struct tcp *conn, u8_t flags, ...)
 		goto fail;
 	}
 
-	r = tcp_header_add(conn, pkt, flags);
+	r = tcp_header_add(conn, pkt, flags, conn->seq);
 	if (r < 0) {
 		goto fail;
 	}
 
+	if (data) {
+		/* Append the data buffer to pkt, behind the headers */
+		hdr_buf = net_buf_frag_last(pkt->buffer);
+		net_pkt_append_buffer(pkt, data->buffer);
+
+		if (len > mss) {
+			/* Segmented by the interface */
+			net_pkt_set_tso_mss(pkt, mss);
+		}
+	}
+
 	r = tcp_finalize_pkt(pkt);
 	if (r < 0) {
+		if (data) {
+			/* Give the data buffer back */
+			hdr_buf->frags = NULL;
+		}
 		goto fail;
 	}
 
+	if (data) {
+		data->buffer = NULL;
+		tcp_pkt_unref(data);
+	}
+
 	if (len) {
 		conn_seq(conn, + len);
 	}
 
-	NET_DBG("%s", log_strdup(tcp_th(pkt)));
+	tcp_pkt_send(conn, pkt);
 
-	if (tcp_send_cb) {
-		tcp_send_cb(pkt);
-		goto out;
-	}
+	return 0;
 
-	sys_slist_append(&conn->send_queue, &pkt->next);
+fail:
+	tcp_pkt_unref(pkt);
 
-	tcp_send_process((struct k_work *)&conn->send_timer);
-out:
-	return;
+	return r;
+}
 
-fail:
-	if (pkt) {
-		tcp_pkt_unref(pkt);
-	}
+static void tcp_out(struct tcp *conn, u8_t flags)
+{
+	(void)tcp_out_ext(conn, flags, NULL);
 }
 
 static void tcp_timewait_timeout(struct k_work *work)
@@ -643,6 +835,10 @@ static struct tcp *tcp_conn_alloc(void)
 
 	k_delayed_work_init(&conn->timewait_timer, tcp_timewait_timeout);
 
+#if defined(CONFIG_NET_TCP_GRO)
+	k_delayed_work_init(&conn->gro_timer, tcp_gro_timeout);
+#endif
+
 	tcp_conn_ref(conn);
 
 	sys_slist_append(&tcp_conns, (sys_snode_t *)conn);
@@ -672,41 +868,199 @@ out:
 	return ret;
 }
 
-static bool tcp_endpoint_cmp(union tcp_endpoint *ep, struct net_pkt *pkt,
-			     enum pkt_addr which)
+static struct tcp *tcp_conn_search(struct net_pkt *pkt)
 {
-	union tcp_endpoint ep_tmp;
+	union tcp_endpoint src, dst;
+	sys_slist_t *list;
+	struct tcp *conn;
+	size_t len;
+	int key;
 
-	if (tcp_endpoint_set(&ep_tmp, pkt, which) < 0) {
-		return false;
+	/* The local endpoint of the connection is the destination of the
+	 * segment.
+	 */
+	if (tcp_endpoint_set(&src, pkt, TCP_EP_DST) < 0 ||
+	    tcp_endpoint_set(&dst, pkt, TCP_EP_SRC) < 0) {
+		return NULL;
 	}
 
-	return !memcmp(ep, &ep_tmp, tcp_endpoint_len(ep->sa.sa_family));
+	len = tcp_endpoint_len(src.sa.sa_family);
+
+	key = irq_lock();
+
+	/* With a single connection, comparing its endpoints is cheaper than
+	 * hashing those of the segment.
+	 */
+	if (tcp_conns_hashed > 1) {
+		list = &tcp_conns_hash[tcp_endpoint_hash(&src, &dst)];
+
+		SYS_SLIST_FOR_EACH_CONTAINER(list, conn, hash_next) {
+			if (!memcmp(&conn->src, &src, len) &&
+			    !memcmp(&conn->dst, &dst, len)) {
+				goto out;
+			}
+		}
+	} else {
+		SYS_SLIST_FOR_EACH_CONTAINER(&tcp_conns, conn, next) {
+			if (conn->hash_list &&
+			    !memcmp(&conn->src, &src, len) &&
+			    !memcmp(&conn->dst, &dst, len)) {
+				goto out;
+			}
+		}
+	}
+
+	conn = NULL;
+out:
+	irq_unlock(key);
+
+	return conn;
 }
 
-static bool tcp_conn_cmp(struct tcp *conn, struct net_pkt *pkt)
+static struct tcp *tcp_conn_new(struct net_pkt *pkt);
+
+#if defined(CONFIG_NET_TCP_GRO)
+/* Process the segments coalesced so far. The packet keeps the IP and TCP
+ * headers of the first segment: its flags (no PSH, see tcp_gro_in()) and
+ * the IP total length are stale. This is fine as tcp_in() only uses the
+ * sequence and acknowledgment numbers, which match the first segment, and
+ * takes the data length from the packet length, not from the IP header.
+ */
+static void tcp_gro_flush(struct tcp *conn)
 {
-	return tcp_endpoint_cmp(&conn->src, pkt, TCP_EP_DST) &&
-		tcp_endpoint_cmp(&conn->dst, pkt, TCP_EP_SRC);
+	struct net_pkt *pkt = conn->gro_pkt;
+
+	if (!pkt) {
+		return;
+	}
+
+	__ASSERT(tcp_data_len(pkt) == conn->gro_len,
+		 "Coalesced data length %zu, expected %zu",
+		 tcp_data_len(pkt), conn->gro_len);
+
+	conn->gro_pkt = NULL;
+	conn->gro_len = 0;
+
+	k_delayed_work_cancel(&conn->gro_timer);
+
+	tcp_in(conn, pkt);
+
+	tcp_pkt_unref(pkt);
 }
 
-static struct tcp *tcp_conn_search(struct net_pkt *pkt)
+static void tcp_gro_timeout(struct k_work *work)
 {
-	bool found = false;
-	struct tcp *conn;
+	struct tcp *conn = CONTAINER_OF(work, struct tcp, gro_timer);
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+	tcp_gro_flush(conn);
+	k_mutex_unlock(&conn->lock);
+}
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&tcp_conns, conn, next) {
+/* Append the data of the segment to the ones held */
+static int tcp_gro_append(struct tcp *conn, struct net_pkt *pkt, size_t len)
+{
+	struct net_buf *frags = NULL;
+	struct net_buf *buf;
+	size_t n;
 
-		found = tcp_conn_cmp(conn, pkt);
-		if (found) {
-			break;
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, net_pkt_get_len(pkt) - len);
+
+	/* The data is copied to new buffers, as net_pkt_alloc_buffer() would
+	 * cap the packet at the MTU, and appended only once all of it fits.
+	 */
+	while (len) {
+		buf = net_pkt_get_frag(conn->gro_pkt, K_NO_WAIT);
+		if (!buf) {
+			goto fail;
+		}
+
+		frags = frags ? net_buf_frag_add(frags, buf) : buf;
+
+		n = MIN(len, net_buf_tailroom(buf));
+		if (!n || net_pkt_read(pkt, net_buf_add(buf, n), n) < 0) {
+			goto fail;
 		}
+
+		len -= n;
 	}
 
-	return found ? conn : NULL;
+	net_pkt_append_buffer(conn->gro_pkt, frags);
+
+	return 0;
+fail:
+	if (frags) {
+		net_buf_unref(frags);
+	}
+
+	return -ENOBUFS;
 }
 
-static struct tcp *tcp_conn_new(struct net_pkt *pkt);
+/* Hold the in-order data segments of an established connection, and
+ * process them at once when one with PSH, a segment that cannot be
+ * coalesced or enough data arrives. Return false if the segment is to be
+ * processed on its own.
+ */
+static bool tcp_gro_in(struct tcp *conn, struct net_pkt *pkt)
+{
+	struct tcphdr *th = th_get(pkt);
+	u8_t fl = th->th_flags;
+	u32_t seq = th_seq(th);
+	u32_t ack = th_ack(th);
+	size_t len = tcp_data_len(pkt);
+	bool held = false;
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	if (conn->state != TCP_ESTABLISHED || !len || th->th_off != 5 ||
+	    (fl & ~PSH) != ACK || net_if_lro_supported(conn->iface)) {
+		tcp_gro_flush(conn);
+		goto out;
+	}
+
+	if (conn->gro_pkt && (seq != conn->ack + conn->gro_len ||
+			      ack != conn->gro_ack ||
+			      conn->gro_len + len > CONFIG_NET_TCP_GRO_MAX_SIZE)) {
+		tcp_gro_flush(conn);
+	}
+
+	if (conn->gro_pkt) {
+		if (tcp_gro_append(conn, pkt, len) < 0) {
+			tcp_gro_flush(conn);
+			goto out;
+		}
+
+		conn->gro_len += len;
+	} else {
+		if (seq != conn->ack || (fl & PSH)) {
+			goto out;
+		}
+
+		conn->gro_pkt = tcp_pkt_clone(pkt);
+		if (!conn->gro_pkt) {
+			goto out;
+		}
+
+		conn->gro_len = len;
+		conn->gro_ack = ack;
+
+		k_delayed_work_submit(&conn->gro_timer,
+				      K_MSEC(CONFIG_NET_TCP_GRO_TIMEOUT));
+	}
+
+	held = true;
+
+	if ((fl & PSH) || conn->gro_len >= CONFIG_NET_TCP_GRO_MAX_SIZE) {
+		tcp_gro_flush(conn);
+	}
+out:
+	k_mutex_unlock(&conn->lock);
+
+	return held;
+}
+#endif /* CONFIG_NET_TCP_GRO */
 
 static enum net_verdict tcp_recv(struct net_conn *net_conn,
 				 struct net_pkt *pkt,
@@ -741,6 +1095,11 @@ static enum net_verdict tcp_recv(struct net_conn *net_conn,
 	}
  in:
 	if (conn) {
+#if defined(CONFIG_NET_TCP_GRO)
+		if (tcp_gro_in(conn, pkt)) {
+			return NET_DROP;
+		}
+#endif
 		tcp_in(conn, pkt);
 	}
 
@@ -828,6 +1187,8 @@ static struct tcp *tcp_conn_new(struct net_pkt *pkt)
 		conn = NULL;
 		goto err;
 	}
+
+	tcp_conn_hash_add(conn);
 err:
 	return conn;
 }
@@ -1048,7 +1409,7 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 		goto out;
 	}
 
-	tcp_out(conn, PSH | ACK, pkt);
+	ret = tcp_out_ext(conn, PSH | ACK, pkt);
 out:
 	return ret;
 }
@@ -1145,6 +1506,8 @@ int net_tcp_connect(struct net_context *context,
 		log_strdup(net_sprint_addr(conn->dst.sa.sa_family,
 				(const void *)&conn->dst.sin.sin_addr)));
 
+	tcp_conn_hash_add(conn);
+
 	net_context_set_state(context, NET_CONTEXT_CONNECTING);
 
 	ret = net_conn_register(net_context_get_ip_proto(context),
@@ -1312,6 +1675,7 @@ static enum net_verdict tcp_input(struct net_conn *net_conn,
 			conn = context->tcp;
 			tcp_endpoint_set(&conn->dst, pkt, TCP_EP_SRC);
 			tcp_endpoint_set(&conn->src, pkt, TCP_EP_DST);
+			tcp_conn_hash_add(conn);
 			/* Make an extra reference, the sanity check suite
 			 * will delete the connection explicitly
 			 */
@@ -1433,6 +1797,7 @@ enum net_verdict tp_input(struct net_conn *net_conn,
 				conn = context->tcp;
 				tcp_endpoint_set(&conn->dst, pkt, TCP_EP_SRC);
 				tcp_endpoint_set(&conn->src, pkt, TCP_EP_DST);
+				tcp_conn_hash_add(conn);
 				conn->iface = pkt->iface;
 				tcp_conn_ref(conn);
 			}
@@ -146,6 +146,8 @@ struct tcp_options {
 
 struct tcp { /* TCP connection */
 	sys_snode_t next;
+	sys_snode_t hash_next;
+	sys_slist_t *hash_list;
 	struct net_context *context;
 	struct k_mutex lock;
 	void *recv_user_data;
@@ -164,6 +166,12 @@ struct tcp { /* TCP connection */
 	struct net_if *iface;
 	net_tcp_accept_cb_t accept_cb;
 	atomic_t ref_count;
+#if defined(CONFIG_NET_TCP_GRO)
+	struct net_pkt *gro_pkt; /* segments held for coalescing */
+	size_t gro_len;
+	u32_t gro_ack;
+	struct k_delayed_work gro_timer;
+#endif
 };
 
 #define _flags(_fl, _op, _mask, _cond)					\
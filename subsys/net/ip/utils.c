@@ -489,34 +489,97 @@ int z_vrfy_net_addr_pton(sa_family_t family, const char *src,
 #include <syscalls/net_addr_pton_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
-static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+#if defined(CONFIG_ARCH_HAS_NET_CHKSUM)
+static inline u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	return arch_net_chksum(sum, data, len);
+}
+#else
+static inline u16_t chksum_fold(u64_t sum)
 {
-	const u8_t *end;
-	u16_t tmp;
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
 
-	end = data + len - 1;
+	return sum;
+}
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+/* Sum of the 16-bit words of 2-byte aligned data in host byte order. The
+ * sum is accumulated 32 bits at a time in a 64-bit variable, so that there
+ * is no carry to handle, and folded at the end.
+ */
+static u16_t chksum_words(const u8_t *data, size_t len)
+{
+	const u32_t *words;
+	u64_t sum = 0U;
 
+	if (((uintptr_t)data & 2) && len >= 2) {
+		sum += *(const u16_t *)data;
 		data += 2;
+		len -= 2;
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	words = (const u32_t *)data;
+
+	while (len >= 16) {
+		sum += words[0];
+		sum += words[1];
+		sum += words[2];
+		sum += words[3];
+		words += 4;
+		len -= 16;
 	}
 
-	return sum;
+	while (len >= 4) {
+		sum += *words++;
+		len -= 4;
+	}
+
+	data = (const u8_t *)words;
+
+	if (len >= 2) {
+		sum += *(const u16_t *)data;
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		sum += sys_be16_to_cpu((u16_t)(data[0] << 8));
+	}
+
+	return chksum_fold(sum);
 }
 
+static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	u32_t tmp;
+
+	if (len == 0) {
+		return sum;
+	}
+
+	/* The one's complement sum does not depend on the byte order, the
+	 * words are summed as read and the result converted.
+	 */
+	if ((uintptr_t)data & 1) {
+		/* The words of the aligned data straddle the ones of the
+		 * checksum, which swaps the bytes of their sum.
+		 */
+		tmp = sys_be16_to_cpu(chksum_words(data + 1, len - 1));
+		tmp = __bswap_16(tmp) + (data[0] << 8);
+	} else {
+		tmp = sys_be16_to_cpu(chksum_words(data, len));
+	}
+
+	tmp += sum;
+	tmp = (tmp & 0xffff) + (tmp >> 16);
+	tmp = (tmp & 0xffff) + (tmp >> 16);
+
+	return tmp;
+}
+#endif /* CONFIG_ARCH_HAS_NET_CHKSUM */
+
 static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
@@ -617,6 +680,33 @@ u16_t net_calc_chksum_ipv4(struct net_pkt *pkt)
 }
 #endif /* CONFIG_NET_IPV4 */
 
+u16_t net_chksum_update(u16_t chksum, const void *old_data,
+			const void *new_data, size_t len)
+{
+	const u8_t *old = old_data;
+	const u8_t *new = new_data;
+	u32_t sum;
+	size_t i;
+
+	/* RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m') */
+	sum = (u16_t)~ntohs(chksum);
+
+	for (i = 0; i + 1 < len; i += 2) {
+		sum += (u16_t)~((old[i] << 8) | old[i + 1]);
+		sum += (new[i] << 8) | new[i + 1];
+	}
+
+	if (i < len) {
+		sum += (u16_t)~(old[i] << 8);
+		sum += new[i] << 8;
+	}
+
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return htons(~sum);
+}
+
 #if defined(CONFIG_NET_IPV6) || defined(CONFIG_NET_IPV4)
 static bool convert_port(const char *buf, u16_t *port)
 {
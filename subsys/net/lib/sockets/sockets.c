@@ -787,13 +787,26 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	}
 
 	recv_len = net_pkt_remaining_data(pkt);
-	if (recv_len > max_len) {
-		recv_len = max_len;
-	}
 
-	if (net_pkt_read(pkt, buf, recv_len)) {
-		errno = ENOBUFS;
-		goto fail;
+	if (flags & ZSOCK_MSG_ZEROCOPY) {
+		if (recv_len == 0) {
+			/* Empty datagram, no packet is handed out */
+			*(struct net_pkt **)buf = NULL;
+			net_pkt_unref(pkt);
+			return 0;
+		}
+
+		/* The whole datagram goes to the caller */
+		*(struct net_pkt **)buf = pkt;
+	} else {
+		if (recv_len > max_len) {
+			recv_len = max_len;
+		}
+
+		if (net_pkt_read(pkt, buf, recv_len)) {
+			errno = ENOBUFS;
+			goto fail;
+		}
 	}
 
 	net_stats_update_tc_rx_time(net_pkt_iface(pkt),
@@ -801,6 +814,10 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 				    net_pkt_timestamp(pkt)->nanosecond,
 				    k_cycle_get_32());
 
+	if (flags & ZSOCK_MSG_ZEROCOPY) {
+		return recv_len;
+	}
+
 	if (!(flags & ZSOCK_MSG_PEEK)) {
 		net_pkt_unref(pkt);
 	} else {
@@ -869,14 +886,20 @@ static inline ssize_t zsock_recv_stream(struct net_context *ctx,
 
 		data_len = net_pkt_remaining_data(pkt);
 		recv_len = data_len;
-		if (recv_len > max_len) {
-			recv_len = max_len;
-		}
 
-		/* Actually copy data to application buffer */
-		if (net_pkt_read(pkt, buf, recv_len)) {
-			errno = ENOBUFS;
-			return -1;
+		/* With ZSOCK_MSG_ZEROCOPY, the packet is handed out below
+		 * with its cursor at the data not read yet.
+		 */
+		if (!(flags & ZSOCK_MSG_ZEROCOPY)) {
+			if (recv_len > max_len) {
+				recv_len = max_len;
+			}
+
+			/* Actually copy data to application buffer */
+			if (net_pkt_read(pkt, buf, recv_len)) {
+				errno = ENOBUFS;
+				return -1;
+			}
 		}
 
 		if (!(flags & ZSOCK_MSG_PEEK)) {
@@ -895,14 +918,21 @@ static inline ssize_t zsock_recv_stream(struct net_context *ctx,
 					net_pkt_timestamp(pkt)->nanosecond,
 					k_cycle_get_32());
 
-				net_pkt_unref(pkt);
+				if ((flags & ZSOCK_MSG_ZEROCOPY) && recv_len) {
+					*(struct net_pkt **)buf = pkt;
+				} else {
+					net_pkt_unref(pkt);
+				}
 			}
 		} else {
 			net_pkt_cursor_restore(pkt, &backup);
 		}
 	} while (recv_len == 0);
 
-	if (!(flags & ZSOCK_MSG_PEEK)) {
+	/* A packet handed out with ZSOCK_MSG_ZEROCOPY still holds its data,
+	 * the window is opened when it is given back.
+	 */
+	if (!(flags & (ZSOCK_MSG_PEEK | ZSOCK_MSG_ZEROCOPY))) {
 		net_context_update_recv_wnd(ctx, recv_len);
 	}
 
@@ -915,6 +945,12 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 {
 	enum net_sock_type sock_type = net_context_get_type(ctx);
 
+	if ((flags & ZSOCK_MSG_ZEROCOPY) &&
+	    ((flags & ZSOCK_MSG_PEEK) || max_len < sizeof(struct net_pkt *))) {
+		errno = EINVAL;
+		return -1;
+	}
+
 	if (max_len == 0) {
 		return 0;
 	}
@@ -933,6 +969,20 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 ssize_t z_impl_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 			     struct sockaddr *src_addr, socklen_t *addrlen)
 {
+	if (flags & ZSOCK_MSG_ZEROCOPY) {
+		/* Only native sockets hold the data in packets */
+		struct net_context *ctx = z_get_fd_obj(sock,
+			(const struct fd_op_vtable *)&sock_fd_op_vtable,
+			EOPNOTSUPP);
+
+		if (ctx == NULL) {
+			return -1;
+		}
+
+		return zsock_recvfrom_ctx(ctx, buf, max_len, flags,
+					  src_addr, addrlen);
+	}
+
 	VTABLE_CALL(recvfrom, sock, buf, max_len, flags, src_addr, addrlen);
 }
 
@@ -943,6 +993,12 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 	socklen_t addrlen_copy;
 	ssize_t ret;
 
+	if (flags & ZSOCK_MSG_ZEROCOPY) {
+		/* Packets are kernel objects */
+		errno = EINVAL;
+		return -1;
+	}
+
 	if (Z_SYSCALL_MEMORY_WRITE(buf, max_len)) {
 		errno = EFAULT;
 		return -1;
@@ -968,6 +1024,22 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #include <syscalls/zsock_recvfrom_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+void zsock_recv_zc_release(int sock, struct net_pkt *pkt, size_t len)
+{
+	struct net_context *ctx = z_get_fd_obj(sock,
+		(const struct fd_op_vtable *)&sock_fd_op_vtable, EBADF);
+
+	/* The socket may be closed already, then there is no window left
+	 * to open.
+	 */
+	if (ctx != NULL && net_context_is_used(ctx) &&
+	    net_context_get_type(ctx) == SOCK_STREAM) {
+		net_context_update_recv_wnd(ctx, len);
+	}
+
+	net_pkt_unref(pkt);
+}
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -33,11 +33,27 @@ extern "C" {
 #define NVS_NAMECNT_ID 0x8000
 #define NVS_NAME_ID_OFFSET 0x4000
 
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+/* Name cache entry: maps the hash of a setting's name to its name ID. */
+struct settings_nvs_cache_entry {
+	u16_t name_hash;
+	u16_t name_id;
+};
+#endif
+
 struct settings_nvs {
 	struct settings_store cf_store;
 	struct nvs_fs cf_nvs;
 	u16_t last_name_id;
 	const char *flash_dev_name;
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+	/* Open addressing hash table of the names stored in NVS. It is
+	 * filled by settings_nvs_load() and only used to look up names once
+	 * it holds all of them (cache_complete).
+	 */
+	struct settings_nvs_cache_entry cache[CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE];
+	bool cache_complete;
+#endif
 };
 
 /* register nvs to be a source of settings */
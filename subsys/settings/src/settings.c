@@ -134,17 +134,137 @@ int settings_name_next(const char *name, const char **next)
 	return rc;
 }
 
-struct settings_handler_static *settings_parse_and_lookup(const char *name,
-							const char **next)
+#if defined(CONFIG_SETTINGS_HANDLER_TRIE)
+/*
+ * Trie of the static handler names, one node per name segment. Siblings are
+ * linked through next_sibling, the node of the last segment of a handler
+ * name points to the handler. Segments point into the handler names.
+ */
+struct settings_trie_node {
+	const char *seg;
+	u16_t seg_len;
+	struct settings_trie_node *first_child;
+	struct settings_trie_node *next_sibling;
+	struct settings_handler_static *handler;
+};
+
+static struct settings_trie_node
+	settings_trie_nodes[CONFIG_SETTINGS_HANDLER_TRIE_NODES];
+static struct settings_trie_node settings_trie_root;
+static size_t settings_trie_used;
+static bool settings_trie_ready;
+static bool settings_trie_valid;
+
+static struct settings_trie_node *settings_trie_child(
+	struct settings_trie_node *node, const char *seg, size_t seg_len)
 {
-	struct settings_handler_static *bestmatch;
-	const char *tmpnext;
+	struct settings_trie_node *child;
 
-	bestmatch = NULL;
-	if (next) {
-		*next = NULL;
+	for (child = node->first_child; child; child = child->next_sibling) {
+		if ((child->seg_len == seg_len) &&
+		    !strncmp(child->seg, seg, seg_len)) {
+			return child;
+		}
+	}
+
+	return NULL;
+}
+
+static int settings_trie_insert(struct settings_handler_static *handler)
+{
+	struct settings_trie_node *node = &settings_trie_root;
+	struct settings_trie_node *child;
+	const char *seg = handler->name;
+	const char *next;
+	size_t seg_len;
+
+	while (seg) {
+		seg_len = settings_name_next(seg, &next);
+
+		child = settings_trie_child(node, seg, seg_len);
+		if (!child) {
+			if (settings_trie_used == ARRAY_SIZE(settings_trie_nodes)) {
+				return -ENOMEM;
+			}
+
+			child = &settings_trie_nodes[settings_trie_used++];
+			child->seg = seg;
+			child->seg_len = seg_len;
+			child->first_child = NULL;
+			child->next_sibling = node->first_child;
+			child->handler = NULL;
+			node->first_child = child;
+		}
+
+		node = child;
+		seg = next;
 	}
 
+	/* like the linear lookup, the last of equal names wins */
+	node->handler = handler;
+
+	return 0;
+}
+
+static void settings_trie_build(void)
+{
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	if (!settings_trie_ready) {
+		settings_trie_valid = true;
+
+		Z_STRUCT_SECTION_FOREACH(settings_handler_static, ch) {
+			if (settings_trie_insert(ch)) {
+				LOG_WRN("Handler trie full, using linear lookup");
+				settings_trie_valid = false;
+				break;
+			}
+		}
+
+		settings_trie_ready = true;
+	}
+
+	k_mutex_unlock(&settings_lock);
+}
+
+/* Find the static handler with the longest name matching name */
+static struct settings_handler_static *settings_trie_lookup(const char *name,
+							  const char **next)
+{
+	struct settings_handler_static *bestmatch = NULL;
+	struct settings_trie_node *node = &settings_trie_root;
+	const char *seg = name;
+	const char *seg_next;
+	size_t seg_len;
+
+	while (seg) {
+		seg_len = settings_name_next(seg, &seg_next);
+
+		node = settings_trie_child(node, seg, seg_len);
+		if (!node) {
+			break;
+		}
+
+		if (node->handler) {
+			bestmatch = node->handler;
+			if (next) {
+				*next = seg_next;
+			}
+		}
+
+		seg = seg_next;
+	}
+
+	return bestmatch;
+}
+#endif /* CONFIG_SETTINGS_HANDLER_TRIE */
+
+static struct settings_handler_static *settings_static_lookup(
+	const char *name, const char **next)
+{
+	struct settings_handler_static *bestmatch = NULL;
+	const char *tmpnext;
+
 	Z_STRUCT_SECTION_FOREACH(settings_handler_static, ch) {
 		if (!settings_name_steq(name, ch->name, &tmpnext)) {
 			continue;
@@ -164,8 +284,37 @@ struct settings_handler_static *settings_parse_and_lookup(const char *name,
 		}
 	}
 
+	return bestmatch;
+}
+
+struct settings_handler_static *settings_parse_and_lookup(const char *name,
+							const char **next)
+{
+	struct settings_handler_static *bestmatch;
+
+	if (next) {
+		*next = NULL;
+	}
+
+#if defined(CONFIG_SETTINGS_HANDLER_TRIE)
+	if (!settings_trie_ready) {
+		settings_trie_build();
+	}
+
+	if (!settings_trie_valid) {
+		bestmatch = settings_static_lookup(name, next);
+	} else if (name) {
+		bestmatch = settings_trie_lookup(name, next);
+	} else {
+		bestmatch = NULL;
+	}
+#else
+	bestmatch = settings_static_lookup(name, next);
+#endif /* CONFIG_SETTINGS_HANDLER_TRIE */
+
 #if defined(CONFIG_SETTINGS_DYNAMIC_HANDLERS)
 	struct settings_handler *ch;
+	const char *tmpnext;
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&settings_handlers, ch, node) {
 		if (!settings_name_steq(name, ch->name, &tmpnext)) {
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <kernel.h>
+
+#include "settings/settings.h"
+#include "settings_priv.h"
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
+
+/*
+ * A batch is buffered as a sequence of records, each made of a
+ * struct settings_batch_rec header followed by the name including its
+ * terminating '\0' and by the value. A record with an empty value is a
+ * delete. The buffer holds at most one record per name.
+ */
+
+extern struct k_mutex settings_lock;
+extern struct settings_store *settings_save_dst;
+
+static u8_t batch_buf[CONFIG_SETTINGS_BATCH_BUF_SIZE];
+static size_t batch_len;
+static k_tid_t batch_owner;
+
+/* Get the record at *off and advance *off to the next one */
+static int settings_batch_rec_get(const u8_t *buf, size_t len, size_t *off,
+				  const char **name, const u8_t **val,
+				  size_t *val_len)
+{
+	struct settings_batch_rec rec;
+	size_t rec_len;
+
+	if (len - *off < sizeof(rec)) {
+		return -EINVAL;
+	}
+	memcpy(&rec, &buf[*off], sizeof(rec));
+
+	rec_len = sizeof(rec) + rec.name_len + rec.val_len;
+	if ((rec.name_len == 0U) || (len - *off < rec_len) ||
+	    (buf[*off + sizeof(rec) + rec.name_len - 1] != '\0')) {
+		return -EINVAL;
+	}
+
+	*name = (const char *)&buf[*off + sizeof(rec)];
+	*val = &buf[*off + sizeof(rec) + rec.name_len];
+	*val_len = rec.val_len;
+	*off += rec_len;
+
+	return 0;
+}
+
+/* Find the record of name in the batch buffer, return its size or 0 */
+static size_t settings_batch_find(const char *name, size_t *rec_off)
+{
+	const char *rec_name;
+	const u8_t *val;
+	size_t val_len;
+	size_t off = 0;
+
+	while (off < batch_len) {
+		*rec_off = off;
+		if (settings_batch_rec_get(batch_buf, batch_len, &off,
+					   &rec_name, &val, &val_len)) {
+			return 0;
+		}
+		if (!strcmp(name, rec_name)) {
+			return off - *rec_off;
+		}
+	}
+
+	return 0;
+}
+
+/* Write the records in buf to the backend, journaled if requested */
+static int settings_batch_write(const u8_t *buf, size_t len, bool journal)
+{
+	struct settings_store *cs = settings_save_dst;
+	const char *name;
+	const u8_t *val;
+	size_t val_len;
+	size_t off = 0;
+	int rc = 0;
+	int rc2;
+
+	if (!cs) {
+		return -ENOENT;
+	}
+
+	if (len == 0) {
+		return 0;
+	}
+
+	if (IS_ENABLED(CONFIG_SETTINGS_BATCH_JOURNAL) && journal) {
+		/* The journal is written as a single record, the batch is
+		 * replayed from it if the writes below get interrupted.
+		 */
+		rc = cs->cs_itf->csi_save(cs, SETTINGS_BATCH_JOURNAL_NAME,
+					  (const char *)buf, len);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	if (cs->cs_itf->csi_save_start) {
+		cs->cs_itf->csi_save_start(cs);
+	}
+
+	while (off < len) {
+		rc2 = settings_batch_rec_get(buf, len, &off, &name, &val,
+					     &val_len);
+		if (rc2) {
+			rc = rc2;
+			break;
+		}
+
+		rc2 = cs->cs_itf->csi_save(cs, name, (const char *)val,
+					   val_len);
+		if (!rc) {
+			rc = rc2;
+		}
+	}
+
+	if (cs->cs_itf->csi_save_end) {
+		cs->cs_itf->csi_save_end(cs);
+	}
+
+	if (IS_ENABLED(CONFIG_SETTINGS_BATCH_JOURNAL) && !rc) {
+		rc = cs->cs_itf->csi_save(cs, SETTINGS_BATCH_JOURNAL_NAME,
+					  NULL, 0);
+	}
+
+	return rc;
+}
+
+bool settings_batch_active(void)
+{
+	return batch_owner != NULL;
+}
+
+int settings_batch_add(const char *name, const void *value, size_t val_len)
+{
+	struct settings_batch_rec rec;
+	size_t old_off = 0;
+	size_t old_len;
+	size_t name_len;
+
+	if (!name) {
+		return -EINVAL;
+	}
+
+	if (value == NULL) {
+		val_len = 0;
+	}
+
+	name_len = strlen(name) + 1;
+	if ((name_len > UINT16_MAX) || (val_len > UINT16_MAX)) {
+		return -EINVAL;
+	}
+
+	/* The record replaced by this one does not count against the
+	 * buffer size, it is dropped only once the new one is sure to fit.
+	 */
+	old_len = settings_batch_find(name, &old_off);
+	if (sizeof(batch_buf) - batch_len + old_len <
+	    sizeof(rec) + name_len + val_len) {
+		return -ENOMEM;
+	}
+
+	if (old_len) {
+		memmove(&batch_buf[old_off], &batch_buf[old_off + old_len],
+			batch_len - old_off - old_len);
+		batch_len -= old_len;
+	}
+
+	rec.name_len = name_len;
+	rec.val_len = val_len;
+
+	memcpy(&batch_buf[batch_len], &rec, sizeof(rec));
+	batch_len += sizeof(rec);
+	memcpy(&batch_buf[batch_len], name, name_len);
+	batch_len += name_len;
+	if (val_len) {
+		memcpy(&batch_buf[batch_len], value, val_len);
+		batch_len += val_len;
+	}
+
+	return 0;
+}
+
+int settings_batch_begin(void)
+{
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	if (batch_owner) {
+		/* nested batch of the owner thread */
+		k_mutex_unlock(&settings_lock);
+		return -EBUSY;
+	}
+
+	/* settings_lock is held until the batch is committed or aborted */
+	batch_owner = k_current_get();
+	batch_len = 0;
+
+	return 0;
+}
+
+int settings_batch_commit(void)
+{
+	int rc;
+
+	if (batch_owner != k_current_get()) {
+		return -EINVAL;
+	}
+
+	rc = settings_batch_write(batch_buf, batch_len, true);
+
+	batch_owner = NULL;
+	batch_len = 0;
+	k_mutex_unlock(&settings_lock);
+
+	return rc;
+}
+
+int settings_batch_abort(void)
+{
+	if (batch_owner != k_current_get()) {
+		return -EINVAL;
+	}
+
+	batch_owner = NULL;
+	batch_len = 0;
+	k_mutex_unlock(&settings_lock);
+
+	return 0;
+}
+
+#ifdef CONFIG_SETTINGS_BATCH_JOURNAL
+static int settings_batch_journal_load(const char *key, size_t len,
+				       settings_read_cb read_cb, void *cb_arg,
+				       void *param)
+{
+	ssize_t rc;
+
+	if (key || (len > sizeof(batch_buf))) {
+		return 0;
+	}
+
+	rc = read_cb(cb_arg, batch_buf, len);
+	if (rc == len) {
+		batch_len = len;
+	}
+
+	return 0;
+}
+
+int settings_batch_recover(void)
+{
+	struct settings_store *cs = settings_save_dst;
+	const char *name;
+	const u8_t *val;
+	size_t val_len;
+	size_t off = 0;
+	int rc = 0;
+
+	if (!cs) {
+		return 0;
+	}
+
+	batch_len = 0;
+	settings_load_subtree_direct(SETTINGS_BATCH_JOURNAL_NAME,
+				     settings_batch_journal_load, NULL);
+	if (batch_len == 0) {
+		return 0;
+	}
+
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	while ((off < batch_len) && !rc) {
+		rc = settings_batch_rec_get(batch_buf, batch_len, &off, &name,
+					    &val, &val_len);
+	}
+
+	if (rc) {
+		LOG_ERR("Discarding corrupted settings batch");
+		rc = cs->cs_itf->csi_save(cs, SETTINGS_BATCH_JOURNAL_NAME,
+					  NULL, 0);
+	} else {
+		LOG_WRN("Completing interrupted settings batch");
+		rc = settings_batch_write(batch_buf, batch_len, false);
+	}
+
+	batch_len = 0;
+	k_mutex_unlock(&settings_lock);
+
+	return rc;
+}
+#endif /* CONFIG_SETTINGS_BATCH_JOURNAL */
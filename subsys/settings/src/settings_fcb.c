@@ -377,9 +377,17 @@ int settings_backend_init(void)
 {
 	static struct flash_sector
 		settings_fcb_area[CONFIG_SETTINGS_FCB_NUM_AREAS + 1];
+#if defined(CONFIG_FCB_INDEX)
+	static struct fcb_index_entry
+		settings_fcb_index[CONFIG_SETTINGS_FCB_INDEX_SIZE];
+#endif
 	static struct settings_fcb config_init_settings_fcb = {
 		.cf_fcb.f_magic = CONFIG_SETTINGS_FCB_MAGIC,
 		.cf_fcb.f_sectors = settings_fcb_area,
+#if defined(CONFIG_FCB_INDEX)
+		.cf_fcb.f_index = settings_fcb_index,
+		.cf_fcb.f_index_cnt = CONFIG_SETTINGS_FCB_INDEX_SIZE,
+#endif
 	};
 	u32_t cnt = sizeof(settings_fcb_area) /
 		    sizeof(settings_fcb_area[0]);
@@ -14,6 +14,7 @@
 #include "settings/settings.h"
 #include "settings/settings_file.h"
 #include <zephyr.h>
+#include "settings_priv.h"
 
 
 bool settings_subsys_initialized;
@@ -35,6 +36,13 @@ int settings_subsys_init(void)
 
 	err = settings_backend_init(); /* func rises kernel panic once error */
 
+#ifdef CONFIG_SETTINGS_BATCH_JOURNAL
+	if (!err) {
+		/* complete a batch that was interrupted by a reset */
+		err = settings_batch_recover();
+	}
+#endif
+
 	if (!err) {
 		settings_subsys_initialized = true;
 	}
@@ -12,6 +12,7 @@
 #include "settings/settings_nvs.h"
 #include "settings_priv.h"
 #include <storage/flash_map.h>
+#include <sys/crc.h>
 
 #include <logging/log.h>
 LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
@@ -48,6 +49,101 @@ static ssize_t settings_nvs_read_fn(void *back_end, void *data, size_t len)
 	return rc;
 }
 
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+/* Cache entries with name_id 0 are empty, entries with name_id
+ * NVS_NAMECNT_ID have been removed. Neither is a valid name ID.
+ */
+#define SETTINGS_NVS_CACHE_EMPTY 0
+#define SETTINGS_NVS_CACHE_REMOVED NVS_NAMECNT_ID
+
+static u16_t settings_nvs_cache_hash(const char *name)
+{
+	return crc16_ccitt(0xffff, (const u8_t *)name, strlen(name));
+}
+
+static void settings_nvs_cache_clear(struct settings_nvs *cf)
+{
+	(void)memset(cf->cache, 0, sizeof(cf->cache));
+	cf->cache_complete = false;
+}
+
+static int settings_nvs_cache_add(struct settings_nvs *cf, u16_t name_hash,
+				  u16_t name_id)
+{
+	struct settings_nvs_cache_entry *entry;
+	size_t pos = name_hash % CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE;
+
+	for (size_t i = 0; i < CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE; i++) {
+		entry = &cf->cache[pos];
+		if ((entry->name_id == SETTINGS_NVS_CACHE_EMPTY) ||
+		    (entry->name_id == SETTINGS_NVS_CACHE_REMOVED)) {
+			entry->name_hash = name_hash;
+			entry->name_id = name_id;
+			return 0;
+		}
+		pos = (pos + 1) % CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE;
+	}
+
+	return -ENOMEM;
+}
+
+static void settings_nvs_cache_remove(struct settings_nvs *cf,
+				      u16_t name_hash, u16_t name_id)
+{
+	struct settings_nvs_cache_entry *entry;
+	size_t pos = name_hash % CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE;
+
+	for (size_t i = 0; i < CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE; i++) {
+		entry = &cf->cache[pos];
+		if (entry->name_id == SETTINGS_NVS_CACHE_EMPTY) {
+			return;
+		}
+		if (entry->name_id == name_id) {
+			entry->name_id = SETTINGS_NVS_CACHE_REMOVED;
+			return;
+		}
+		pos = (pos + 1) % CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE;
+	}
+}
+
+/* Find the name ID of name, returns NVS_NAMECNT_ID if name is not stored.
+ * Names with the same hash are told apart by reading them from NVS.
+ */
+static u16_t settings_nvs_cache_match(struct settings_nvs *cf,
+				      const char *name, u16_t name_hash,
+				      char *rdname, size_t len)
+{
+	struct settings_nvs_cache_entry *entry;
+	size_t pos = name_hash % CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE;
+	ssize_t rc;
+
+	for (size_t i = 0; i < CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE; i++) {
+		entry = &cf->cache[pos];
+		pos = (pos + 1) % CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE;
+
+		if (entry->name_id == SETTINGS_NVS_CACHE_EMPTY) {
+			break;
+		}
+		if ((entry->name_id == SETTINGS_NVS_CACHE_REMOVED) ||
+		    (entry->name_hash != name_hash)) {
+			continue;
+		}
+
+		rc = nvs_read(&cf->cf_nvs, entry->name_id, rdname, len - 1);
+		if ((rc <= 0) || (rc >= len)) {
+			continue;
+		}
+		rdname[rc] = '\0';
+
+		if (!strcmp(name, rdname)) {
+			return entry->name_id;
+		}
+	}
+
+	return NVS_NAMECNT_ID;
+}
+#endif /* CONFIG_SETTINGS_NVS_NAME_CACHE */
+
 int settings_nvs_src(struct settings_nvs *cf)
 {
 	cf->cf_store.cs_itf = &settings_nvs_itf;
@@ -74,6 +170,11 @@ static int settings_nvs_load(struct settings_store *cs,
 	char buf;
 	ssize_t rc1, rc2;
 	u16_t name_id = NVS_NAMECNT_ID;
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+	bool cache_full = false;
+
+	settings_nvs_cache_clear(cf);
+#endif
 
 	name_id = cf->last_name_id + 1;
 
@@ -81,6 +182,10 @@ static int settings_nvs_load(struct settings_store *cs,
 
 		name_id--;
 		if (name_id == NVS_NAMECNT_ID) {
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+			/* all names have been seen */
+			cf->cache_complete = !cache_full;
+#endif
 			break;
 		}
 
@@ -114,6 +219,13 @@ static int settings_nvs_load(struct settings_store *cs,
 
 		/* Found a name, this might not include a trailing \0 */
 		name[rc1] = '\0';
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+		if (!cache_full &&
+		    settings_nvs_cache_add(cf, settings_nvs_cache_hash(name),
+					   name_id)) {
+			cache_full = true;
+		}
+#endif
 		read_fn_arg.fs = &cf->cf_nvs;
 		read_fn_arg.id = name_id + NVS_NAME_ID_OFFSET;
 
@@ -136,6 +248,9 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 	u16_t name_id, write_name_id;
 	bool delete, write_name;
 	int rc = 0;
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+	u16_t name_hash;
+#endif
 
 	if (!name) {
 		return -EINVAL;
@@ -148,6 +263,23 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 	write_name_id = cf->last_name_id + 1;
 	write_name = true;
 
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+	name_hash = settings_nvs_cache_hash(name);
+
+	if (cf->cache_complete) {
+		name_id = settings_nvs_cache_match(cf, name, name_hash, rdname,
+						   sizeof(rdname));
+		/* A new name gets the ID after the largest one in use, only
+		 * search for a free ID when all IDs above it are taken.
+		 */
+		if ((name_id != NVS_NAMECNT_ID) || delete ||
+		    (write_name_id != NVS_NAMECNT_ID + NVS_NAME_ID_OFFSET)) {
+			goto found;
+		}
+		name_id = cf->last_name_id + 1;
+	}
+#endif
+
 	while (1) {
 		name_id--;
 		if (name_id == NVS_NAMECNT_ID) {
@@ -170,6 +302,14 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 			continue;
 		}
 
+		break;
+	}
+
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+found:
+#endif
+	if (name_id != NVS_NAMECNT_ID) {
+		/* name found in NVS */
 		if ((delete) && (name_id == cf->last_name_id)) {
 			cf->last_name_id--;
 			rc = nvs_write(&cf->cf_nvs, NVS_NAMECNT_ID,
@@ -194,11 +334,13 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 				return rc;
 			}
 
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+			settings_nvs_cache_remove(cf, name_hash, name_id);
+#endif
 			return 0;
 		}
 		write_name_id = name_id;
 		write_name = false;
-		break;
 	}
 
 	if (delete) {
@@ -220,6 +362,13 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 		if (rc < 0) {
 			return rc;
 		}
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+		if (cf->cache_complete &&
+		    settings_nvs_cache_add(cf, name_hash, write_name_id)) {
+			/* the cache can no longer hold all names */
+			cf->cache_complete = false;
+		}
+#endif
 	}
 
 	/* update the last_name_id and write to flash if required*/
@@ -247,6 +396,10 @@ int settings_nvs_backend_init(struct settings_nvs *cf)
 		return rc;
 	}
 
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+	settings_nvs_cache_clear(cf);
+#endif
+
 	rc = nvs_read(&cf->cf_nvs, NVS_NAMECNT_ID, &last_name_id,
 		      sizeof(last_name_id));
 	if (rc < 0) {
@@ -58,6 +58,21 @@ struct settings_line_dup_check_arg {
 	int is_dup;
 };
 
+#ifdef CONFIG_SETTINGS_BATCH
+/* Name under which the journal of a batch being written is stored */
+#define SETTINGS_BATCH_JOURNAL_NAME ".batch"
+
+/* Header of a settings item buffered in a batch */
+struct settings_batch_rec {
+	u16_t name_len; /* including the terminating '\0' */
+	u16_t val_len;  /* 0 for a delete */
+};
+
+bool settings_batch_active(void);
+int settings_batch_add(const char *name, const void *value, size_t val_len);
+int settings_batch_recover(void);
+#endif
+
 #ifdef CONFIG_SETTINGS_ENCODE_LEN
 /* in storage line contex */
 struct line_entry_ctx {
@@ -103,6 +103,15 @@ int settings_save_one(const char *name, const void *value, size_t val_len)
 
 	k_mutex_lock(&settings_lock, K_FOREVER);
 
+#ifdef CONFIG_SETTINGS_BATCH
+	/* Only the thread owning the batch can get here while it is open. */
+	if (settings_batch_active()) {
+		rc = settings_batch_add(name, value, val_len);
+		k_mutex_unlock(&settings_lock);
+		return rc;
+	}
+#endif
+
 	rc = cs->cs_itf->csi_save(cs, name, (char *)value, val_len);
 
 	k_mutex_unlock(&settings_lock);
@@ -118,6 +127,7 @@ int settings_delete(const char *name)
 int settings_save(void)
 {
 	struct settings_store *cs;
+	bool batch = false;
 	int rc;
 	int rc2;
 
@@ -126,7 +136,19 @@ int settings_save(void)
 		return -ENOENT;
 	}
 
-	if (cs->cs_itf->csi_save_start) {
+	/* Held across the exports so that a batch of another thread cannot
+	 * start or end in the middle of them.
+	 */
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+#ifdef CONFIG_SETTINGS_BATCH
+	/* The exported settings go to the batch of this thread, the back-end
+	 * gets csi_save_start and csi_save_end around them on commit.
+	 */
+	batch = settings_batch_active();
+#endif
+
+	if (!batch && cs->cs_itf->csi_save_start) {
 		cs->cs_itf->csi_save_start(cs);
 	}
 	rc = 0;
@@ -152,9 +174,12 @@ int settings_save(void)
 	}
 #endif /* CONFIG_SETTINGS_DYNAMIC_HANDLERS */
 
-	if (cs->cs_itf->csi_save_end) {
+	if (!batch && cs->cs_itf->csi_save_end) {
 		cs->cs_itf->csi_save_end(cs);
 	}
+
+	k_mutex_unlock(&settings_lock);
+
 	return rc;
 }
 
@@ -171,6 +171,56 @@ static int cmd_kernel_stacks(const struct shell *shell,
 }
 #endif
 
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+static int cmd_kernel_heaps(const struct shell *shell,
+			    size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	Z_STRUCT_SECTION_FOREACH(k_heap, h) {
+		struct sys_heap_runtime_stats stats;
+		k_spinlock_key_t key = k_spin_lock(&h->lock);
+
+		(void)sys_heap_runtime_stats_get(&h->heap, &stats);
+		k_spin_unlock(&h->lock, key);
+
+		shell_print(shell,
+			    "%p:\tallocated %zu\tfree %zu\tcached %zu\t"
+			    "largest free %zu\tfragmentation %u %%",
+			    h, stats.allocated_bytes, stats.free_bytes,
+			    stats.cached_bytes, stats.max_free_bytes,
+			    stats.fragmentation);
+	}
+
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_MUTEX_STATS)
+static int cmd_kernel_mutexes(const struct shell *shell,
+			      size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	Z_STRUCT_SECTION_FOREACH(k_mutex, m) {
+		struct k_mutex_stats stats;
+
+		k_mutex_stats_get(m, &stats);
+
+		shell_print(shell,
+			    "%p:\towner %p\tacquired %u\tcontended %u\t"
+			    "spun %u\twait %u us",
+			    m, m->owner, stats.acquisitions, stats.contended,
+			    stats.spin_acquired,
+			    (u32_t)k_cyc_to_us_floor64(stats.wait_cycles));
+	}
+
+	return 0;
+}
+#endif
+
 #if defined(CONFIG_REBOOT)
 static int cmd_kernel_reboot_warm(const struct shell *shell,
 				  size_t argc, char **argv)
@@ -199,6 +249,12 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel_reboot,
 
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel,
 	SHELL_CMD(cycles, NULL, "Kernel cycles.", cmd_kernel_cycles),
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+	SHELL_CMD(heaps, NULL, "List heap usage.", cmd_kernel_heaps),
+#endif
+#if defined(CONFIG_MUTEX_STATS)
+	SHELL_CMD(mutexes, NULL, "List mutex contention.", cmd_kernel_mutexes),
+#endif
 #if defined(CONFIG_REBOOT)
 	SHELL_CMD(reboot, &sub_kernel_reboot, "Reboot.", NULL),
 #endif
@@ -14,6 +14,7 @@
 #include <drivers/flash.h>
 #include <soc.h>
 #include <init.h>
+#include "flash_map_priv.h"
 
 #if defined(CONFIG_FLASH_PAGE_LAYOUT)
 struct layout_data {
@@ -67,7 +68,7 @@ int flash_area_open(u8_t id, const struct flash_area **fap)
 
 void flash_area_close(const struct flash_area *fa)
 {
-	/* nothing to do for now */
+	(void)flash_area_flush(fa);
 }
 
 static inline bool is_in_flash_area_bounds(const struct flash_area *fa,
@@ -188,7 +189,11 @@ int flash_area_read(const struct flash_area *fa, off_t off, void *dst,
 
 	dev = device_get_binding(fa->fa_dev_name);
 
+#if defined(CONFIG_FLASH_MAP_CACHE)
+	return flash_map_cache_read(dev, fa->fa_off + off, dst, len);
+#else
 	return flash_read(dev, fa->fa_off + off, dst, len);
+#endif
 }
 
 int flash_area_write(const struct flash_area *fa, off_t off, const void *src,
@@ -203,6 +208,9 @@ int flash_area_write(const struct flash_area *fa, off_t off, const void *src,
 
 	flash_dev = device_get_binding(fa->fa_dev_name);
 
+#if defined(CONFIG_FLASH_MAP_CACHE)
+	rc = flash_map_cache_write(flash_dev, fa->fa_off + off, src, len);
+#else
 	rc = flash_write_protection_set(flash_dev, false);
 	if (rc) {
 		return rc;
@@ -212,6 +220,7 @@ int flash_area_write(const struct flash_area *fa, off_t off, const void *src,
 
 	/* Ignore errors here - this does not affect write operation */
 	(void) flash_write_protection_set(flash_dev, true);
+#endif /* CONFIG_FLASH_MAP_CACHE */
 
 	return rc;
 }
@@ -227,6 +236,30 @@ int flash_area_erase(const struct flash_area *fa, off_t off, size_t len)
 
 	flash_dev = device_get_binding(fa->fa_dev_name);
 
+#if defined(CONFIG_FLASH_MAP_CACHE)
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+	/* Storage systems erase a sector when they move on to it, e.g. on a
+	 * FCB rotation or a littlefs block allocation, and expect what they
+	 * wrote before to be on the device: flush the rest of the area.
+	 */
+	if (off > 0) {
+		rc = flash_map_cache_flush(flash_dev, fa->fa_off, off);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	if (off + len < fa->fa_size) {
+		rc = flash_map_cache_flush(flash_dev, fa->fa_off + off + len,
+					   fa->fa_size - off - len);
+		if (rc) {
+			return rc;
+		}
+	}
+#endif /* CONFIG_FLASH_MAP_CACHE_WRITE_BACK */
+
+	rc = flash_map_cache_erase(flash_dev, fa->fa_off + off, len);
+#else
 	rc = flash_write_protection_set(flash_dev, false);
 	if (rc) {
 		return rc;
@@ -236,10 +269,24 @@ int flash_area_erase(const struct flash_area *fa, off_t off, size_t len)
 
 	/* Ignore errors here - this does not affect write operation */
 	(void) flash_write_protection_set(flash_dev, true);
+#endif /* CONFIG_FLASH_MAP_CACHE */
 
 	return rc;
 }
 
+int flash_area_flush(const struct flash_area *fa)
+{
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+	struct device *dev;
+
+	dev = device_get_binding(fa->fa_dev_name);
+
+	return flash_map_cache_flush(dev, fa->fa_off, fa->fa_size);
+#else
+	return 0;
+#endif
+}
+
 u8_t flash_area_align(const struct flash_area *fa)
 {
 	struct device *dev;
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/types.h>
+#include <string.h>
+#include <kernel.h>
+#include <device.h>
+#include <drivers/flash.h>
+#include <storage/flash_map.h>
+#include "flash_map_priv.h"
+
+#define PAGE_SIZE CONFIG_FLASH_MAP_CACHE_PAGE_SIZE
+#define PAGE_ADDR(off) ((off) & ~((off_t)PAGE_SIZE - 1))
+
+BUILD_ASSERT((PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+	     "FLASH_MAP_CACHE_PAGE_SIZE must be a power of two");
+
+/*
+ * A cached page of a flash device. With write-back, written data is only
+ * kept in the page and the program units holding it are marked in dirty,
+ * runs of adjacent dirty units are written to the device when the page is
+ * flushed.
+ */
+struct flash_map_cache_page {
+	struct device *dev;
+	off_t addr;
+	u32_t last_use;
+	bool valid;
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+	bool dirty_any;
+	u16_t unit;
+	u32_t dirty[ceiling_fraction(PAGE_SIZE, 32)];
+#endif
+	u8_t data[PAGE_SIZE];
+};
+
+static struct flash_map_cache_page cache_pages[CONFIG_FLASH_MAP_CACHE_PAGES];
+static struct flash_area_cache_stats cache_stats;
+static u32_t cache_use_cnt;
+static K_MUTEX_DEFINE(cache_lock);
+
+static int flash_map_dev_write(struct device *dev, off_t off,
+			       const void *src, size_t len)
+{
+	int rc;
+
+	rc = flash_write_protection_set(dev, false);
+	if (rc) {
+		return rc;
+	}
+
+	rc = flash_write(dev, off, src, len);
+
+	/* Ignore errors here - this does not affect write operation */
+	(void) flash_write_protection_set(dev, true);
+
+	return rc;
+}
+
+static struct flash_map_cache_page *cache_find(struct device *dev, off_t addr)
+{
+	for (int i = 0; i < ARRAY_SIZE(cache_pages); i++) {
+		if (cache_pages[i].valid && (cache_pages[i].dev == dev) &&
+		    (cache_pages[i].addr == addr)) {
+			return &cache_pages[i];
+		}
+	}
+
+	return NULL;
+}
+
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+/* Write the runs of dirty program units of a page to the device */
+static int cache_page_flush(struct flash_map_cache_page *page)
+{
+	size_t units = PAGE_SIZE / page->unit;
+	size_t start, end;
+	int rc;
+
+	if (!page->dirty_any) {
+		return 0;
+	}
+
+	start = 0;
+	while (start < units) {
+		if (!(page->dirty[start / 32] & BIT(start % 32))) {
+			start++;
+			continue;
+		}
+
+		end = start + 1;
+		while ((end < units) &&
+		       (page->dirty[end / 32] & BIT(end % 32))) {
+			end++;
+		}
+
+		rc = flash_map_dev_write(page->dev,
+					 page->addr + start * page->unit,
+					 &page->data[start * page->unit],
+					 (end - start) * page->unit);
+		if (rc) {
+			return rc;
+		}
+		cache_stats.write_backs++;
+
+		for (; start < end; start++) {
+			page->dirty[start / 32] &= ~BIT(start % 32);
+		}
+	}
+
+	page->dirty_any = false;
+
+	return 0;
+}
+#else
+static inline int cache_page_flush(struct flash_map_cache_page *page)
+{
+	return 0;
+}
+#endif /* CONFIG_FLASH_MAP_CACHE_WRITE_BACK */
+
+/*
+ * Get the cached page at addr, filling the least recently used page from
+ * the device on a miss.
+ */
+static struct flash_map_cache_page *cache_get(struct device *dev, off_t addr)
+{
+	struct flash_map_cache_page *page;
+	int rc;
+
+	page = cache_find(dev, addr);
+	if (page) {
+		cache_stats.hits++;
+		page->last_use = ++cache_use_cnt;
+		return page;
+	}
+
+	cache_stats.misses++;
+
+	page = &cache_pages[0];
+	for (int i = 0; i < ARRAY_SIZE(cache_pages); i++) {
+		if (!cache_pages[i].valid) {
+			page = &cache_pages[i];
+			break;
+		}
+		if (cache_pages[i].last_use < page->last_use) {
+			page = &cache_pages[i];
+		}
+	}
+
+	if (page->valid) {
+		if (cache_page_flush(page)) {
+			return NULL;
+		}
+		page->valid = false;
+		cache_stats.evictions++;
+	}
+
+	rc = flash_read(dev, addr, page->data, PAGE_SIZE);
+	if (rc) {
+		return NULL;
+	}
+
+	page->dev = dev;
+	page->addr = addr;
+	page->last_use = ++cache_use_cnt;
+	page->valid = true;
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+	page->unit = flash_get_write_block_size(dev);
+#endif
+
+	return page;
+}
+
+int flash_map_cache_read(struct device *dev, off_t off, void *dst,
+			 size_t len)
+{
+	struct flash_map_cache_page *page;
+	u8_t *dst8 = dst;
+	size_t chunk;
+	off_t addr;
+	int rc = 0;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	while (len) {
+		addr = PAGE_ADDR(off);
+		chunk = MIN(len, addr + PAGE_SIZE - off);
+
+		page = cache_get(dev, addr);
+		if (page) {
+			memcpy(dst8, &page->data[off - addr], chunk);
+		} else {
+			/* page could not be cached, read the device */
+			rc = flash_read(dev, off, dst8, chunk);
+			if (rc) {
+				break;
+			}
+		}
+
+		off += chunk;
+		dst8 += chunk;
+		len -= chunk;
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	return rc;
+}
+
+int flash_map_cache_flush(struct device *dev, off_t off, size_t len)
+{
+	int rc = 0;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	/* pages are written in ascending address order */
+	for (off_t addr = PAGE_ADDR(off); addr < off + len;
+	     addr += PAGE_SIZE) {
+		struct flash_map_cache_page *page = cache_find(dev, addr);
+
+		if (page) {
+			rc = cache_page_flush(page);
+			if (rc) {
+				break;
+			}
+		}
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	return rc;
+}
+
+/* Copy written data to the cached pages holding it */
+static void cache_update(struct device *dev, off_t off, const u8_t *src,
+			 size_t len)
+{
+	struct flash_map_cache_page *page;
+	size_t chunk;
+	off_t addr;
+
+	while (len) {
+		addr = PAGE_ADDR(off);
+		chunk = MIN(len, addr + PAGE_SIZE - off);
+
+		page = cache_find(dev, addr);
+		if (page) {
+			memcpy(&page->data[off - addr], src, chunk);
+		}
+
+		off += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+}
+
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+static int cache_write_back(struct device *dev, off_t off, const u8_t *src,
+			    size_t len)
+{
+	struct flash_map_cache_page *page;
+	size_t chunk, unit;
+	off_t addr;
+	int rc;
+
+	while (len) {
+		addr = PAGE_ADDR(off);
+		chunk = MIN(len, addr + PAGE_SIZE - off);
+
+		page = cache_get(dev, addr);
+		if (!page) {
+			/* page could not be cached, write the device */
+			rc = flash_map_dev_write(dev, off, src, chunk);
+			if (rc) {
+				return rc;
+			}
+		} else {
+			memcpy(&page->data[off - addr], src, chunk);
+			for (unit = (off - addr) / page->unit;
+			     unit < (off - addr + chunk) / page->unit; unit++) {
+				page->dirty[unit / 32] |= BIT(unit % 32);
+			}
+			page->dirty_any = true;
+		}
+
+		off += chunk;
+		src += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_FLASH_MAP_CACHE_WRITE_BACK */
+
+int flash_map_cache_write(struct device *dev, off_t off, const void *src,
+			  size_t len)
+{
+	int rc;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+	size_t unit = flash_get_write_block_size(dev);
+
+	/* Writes not made of whole program units go to the device */
+	if ((unit <= PAGE_SIZE) && !(PAGE_SIZE % unit) && !(off % unit) &&
+	    !(len % unit)) {
+		rc = cache_write_back(dev, off, src, len);
+		goto end;
+	}
+
+	rc = flash_map_cache_flush(dev, off, len);
+	if (rc) {
+		goto end;
+	}
+#endif /* CONFIG_FLASH_MAP_CACHE_WRITE_BACK */
+
+	rc = flash_map_dev_write(dev, off, src, len);
+	if (!rc) {
+		cache_update(dev, off, src, len);
+	}
+
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+end:
+#endif
+	k_mutex_unlock(&cache_lock);
+
+	return rc;
+}
+
+int flash_map_cache_erase(struct device *dev, off_t off, size_t len)
+{
+	struct flash_map_cache_page *page;
+	int rc = 0;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	for (off_t addr = PAGE_ADDR(off); addr < off + len;
+	     addr += PAGE_SIZE) {
+		page = cache_find(dev, addr);
+		if (!page) {
+			continue;
+		}
+
+		/* the part of the page not erased must reach the device */
+		if ((addr < off) || (addr + PAGE_SIZE > off + len)) {
+			rc = cache_page_flush(page);
+			if (rc) {
+				goto end;
+			}
+		}
+
+		page->valid = false;
+#if defined(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)
+		page->dirty_any = false;
+		(void)memset(page->dirty, 0, sizeof(page->dirty));
+#endif
+	}
+
+	rc = flash_write_protection_set(dev, false);
+	if (rc) {
+		goto end;
+	}
+
+	rc = flash_erase(dev, off, len);
+
+	/* Ignore errors here - this does not affect write operation */
+	(void) flash_write_protection_set(dev, true);
+
+end:
+	k_mutex_unlock(&cache_lock);
+
+	return rc;
+}
+
+void flash_area_cache_stats_get(struct flash_area_cache_stats *stats)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	*stats = cache_stats;
+	k_mutex_unlock(&cache_lock);
+}
+
+void flash_area_cache_stats_reset(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	(void)memset(&cache_stats, 0, sizeof(cache_stats));
+	k_mutex_unlock(&cache_lock);
+}
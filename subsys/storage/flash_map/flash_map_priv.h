@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __FLASH_MAP_PRIV_H_
+#define __FLASH_MAP_PRIV_H_
+
+#include <zephyr/types.h>
+#include <sys/types.h>
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Page cache between the flash areas and the flash drivers. Offsets are
+ * device offsets, bounds have been checked by the caller.
+ */
+int flash_map_cache_read(struct device *dev, off_t off, void *dst,
+			 size_t len);
+int flash_map_cache_write(struct device *dev, off_t off, const void *src,
+			  size_t len);
+int flash_map_cache_erase(struct device *dev, off_t off, size_t len);
+int flash_map_cache_flush(struct device *dev, off_t off, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_MAP_PRIV_H_ */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file elapsed time of benchmark runs
+ *
+ * Measures intervals of any length with cycle resolution, for benchmarks
+ * which report a rate over a run instead of the cost of one operation.
+ */
+
+#ifndef _BENCH_TIME_H_
+#define _BENCH_TIME_H_
+
+#include <zephyr.h>
+
+#ifdef CONFIG_BOARD_NATIVE_POSIX
+/* Simulated time does not advance while the CPU is busy, the host clock
+ * is used instead (boards/posix/native_posix/timer_model.c).
+ */
+extern u64_t get_host_us_time(void);
+
+struct bench_time {
+	u64_t us;
+};
+
+static inline void bench_time_start(struct bench_time *t)
+{
+	t->us = get_host_us_time();
+}
+
+static inline u64_t bench_time_ns(const struct bench_time *t)
+{
+	return (get_host_us_time() - t->us) * NSEC_PER_USEC;
+}
+#else
+struct bench_time {
+	s64_t ticks;
+	u32_t cycles;
+};
+
+static inline void bench_time_start(struct bench_time *t)
+{
+	t->ticks = k_uptime_ticks();
+	t->cycles = k_cycle_get_32();
+}
+
+/* The 32 bit cycle counter wraps within seconds on fast targets: the
+ * uptime, which is off by less than a tick, tells how many times it did.
+ */
+static inline u64_t bench_time_ns(const struct bench_time *t)
+{
+	u32_t cycles = k_cycle_get_32() - t->cycles;
+	u64_t approx = k_ticks_to_cyc_floor64(k_uptime_ticks() - t->ticks);
+	u64_t wraps = (approx + BIT64(31) - cycles) >> 32;
+
+	return k_cyc_to_ns_floor64((wraps << 32) + cycles);
+}
+#endif
+
+/* Nanoseconds, and microseconds, since bench_time_start() */
+static inline u64_t bench_time_us(const struct bench_time *t)
+{
+	return bench_time_ns(t) / NSEC_PER_USEC;
+}
+
+#endif /* _BENCH_TIME_H_ */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <storage/flash_map.h>
+#include <fs/fcb.h>
+
+/* Fill the storage partition used as a FCB with elements of a given size
+ * until it is full, then time a walk over all the elements, last N queries
+ * and the initialization of the FCB.
+ */
+
+#define BENCH_MAGIC 0xbe0cfcb0
+#define MAX_SECTORS 64
+#define INDEX_CNT 4096
+
+static const u16_t elem_sizes[] = { 8, 32, 128 };
+static const u8_t last_n[] = { 1, 16, 255 };
+
+static struct flash_sector sectors[MAX_SECTORS];
+#if defined(CONFIG_FCB_INDEX)
+static struct fcb_index_entry fcb_index[INDEX_CNT];
+#endif
+static struct fcb fcb;
+static u8_t data[128];
+
+static int bench_init(u32_t sector_cnt)
+{
+	(void)memset(&fcb, 0, sizeof(fcb));
+	fcb.f_magic = BENCH_MAGIC;
+	fcb.f_sectors = sectors;
+	fcb.f_sector_cnt = sector_cnt;
+#if defined(CONFIG_FCB_INDEX)
+	fcb.f_index = fcb_index;
+	fcb.f_index_cnt = ARRAY_SIZE(fcb_index);
+#endif
+
+	return fcb_init(DT_FLASH_AREA_STORAGE_ID, &fcb);
+}
+
+static int bench_fill(u16_t size, u32_t *count)
+{
+	struct fcb_entry loc;
+	int rc;
+
+	*count = 0U;
+	while (1) {
+		rc = fcb_append(&fcb, size, &loc);
+		if (rc == -ENOSPC) {
+			return 0;
+		}
+		if (rc) {
+			return rc;
+		}
+
+		(void)memset(data, *count, size);
+		rc = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc),
+				      data, size);
+		if (rc) {
+			return rc;
+		}
+
+		rc = fcb_append_finish(&fcb, &loc);
+		if (rc) {
+			return rc;
+		}
+		(*count)++;
+	}
+}
+
+static int bench_walk_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	(*(u32_t *)arg)++;
+
+	return 0;
+}
+
+void main(void)
+{
+	const struct flash_area *fa;
+	struct fcb_entry loc;
+	u32_t sector_cnt = ARRAY_SIZE(sectors);
+	u32_t count, walked, cycles, start;
+	int rc;
+
+	rc = flash_area_get_sectors(DT_FLASH_AREA_STORAGE_ID, &sector_cnt,
+				    sectors);
+	if (rc) {
+		printk("flash_area_get_sectors failed: %d\n", rc);
+		return;
+	}
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	if (rc) {
+		printk("flash_area_open failed: %d\n", rc);
+		return;
+	}
+
+	printk("FCB: %u sectors of %u bytes, index %s\n", sector_cnt,
+	       sectors[0].fs_size,
+	       IS_ENABLED(CONFIG_FCB_INDEX) ? "on" : "off");
+
+	for (int i = 0; i < ARRAY_SIZE(elem_sizes); i++) {
+		rc = flash_area_erase(fa, 0, fa->fa_size);
+		if (rc == 0) {
+			rc = bench_init(sector_cnt);
+		}
+		if (rc == 0) {
+			rc = bench_fill(elem_sizes[i], &count);
+		}
+		if (rc) {
+			printk("fcb setup for %u byte elements failed: %d\n",
+			       elem_sizes[i], rc);
+			break;
+		}
+
+		printk("%u byte elements:\n", elem_sizes[i]);
+
+		walked = 0U;
+		start = k_cycle_get_32();
+		rc = fcb_walk(&fcb, NULL, bench_walk_cb, &walked);
+		cycles = k_cycle_get_32() - start;
+		printk("fcb walk   %5u elements %10u cycles/element%s\n",
+		       walked, cycles / MAX(walked, 1),
+		       (rc || walked != count) ? " (walk error)" : "");
+
+		for (int j = 0; j < ARRAY_SIZE(last_n); j++) {
+			start = k_cycle_get_32();
+			rc = fcb_offset_last_n(&fcb, last_n[j], &loc);
+			cycles = k_cycle_get_32() - start;
+			printk("fcb last n %5u elements %10u cycles%s\n",
+			       last_n[j], cycles, rc ? " (last n error)" : "");
+		}
+
+		start = k_cycle_get_32();
+		rc = bench_init(sector_cnt);
+		cycles = k_cycle_get_32() - start;
+		printk("fcb init   %5u elements %10u cycles%s\n", count,
+		       cycles, rc ? " (init error)" : "");
+	}
+
+	printk("fin\n");
+}
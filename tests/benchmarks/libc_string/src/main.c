@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <string.h>
+
+/* Lengths 1..MAX_LEN are grouped in power-of-two buckets.  Every
+ * length is run in the small buckets; larger ones are sampled with an
+ * odd stride of about 1/16th of the bucket so that all tail lengths
+ * still show up.  Each length is run at each of the N_OFFS * N_OFFS
+ * source/destination offset combinations (only the source offset
+ * matters for the single buffer routines).  The buffers are word
+ * aligned, so the offsets cover every relative alignment on 32 and
+ * 64 bit targets.
+ */
+
+#define MAX_LEN 4096
+#define N_OFFS 8
+#define BUFSIZE (MAX_LEN + 2 * N_OFFS)
+
+static u8_t __aligned(8) src_buf[BUFSIZE];
+static u8_t __aligned(8) dst_buf[BUFSIZE];
+
+/* Keeps the compiler from dropping calls whose result is unused */
+static volatile uintptr_t sink;
+
+enum routine {
+	R_MEMCPY,
+	R_MEMMOVE,
+	R_MEMSET,
+	R_MEMCMP,
+	R_MEMCHR,
+	R_STRLEN,
+	R_STRCMP,
+	N_ROUTINES
+};
+
+static const char *const routine_names[N_ROUTINES] = {
+	"memcpy", "memmove", "memset", "memcmp", "memchr", "strlen", "strcmp",
+};
+
+static void run(enum routine r, size_t len, int so, int d_o)
+{
+	u8_t *s = src_buf + so;
+	u8_t *d = dst_buf + d_o;
+
+	switch (r) {
+	case R_MEMCPY:
+		sink = (uintptr_t)memcpy(d, s, len);
+		break;
+	case R_MEMMOVE:
+		/* overlapping, alternating between both directions */
+		sink = (uintptr_t)memmove(src_buf + d_o, s, len);
+		break;
+	case R_MEMSET:
+		sink = (uintptr_t)memset(d, so, len);
+		break;
+	case R_MEMCMP:
+		sink = memcmp(d, s, len);
+		break;
+	case R_MEMCHR:
+		sink = (uintptr_t)memchr(s, 0, len);
+		break;
+	case R_STRLEN:
+		s[len - 1] = '\0';
+		sink = strlen((char *)s);
+		s[len - 1] = 'a';
+		break;
+	case R_STRCMP:
+		s[len - 1] = '\0';
+		d[len - 1] = '\0';
+		sink = strcmp((char *)d, (char *)s);
+		s[len - 1] = 'a';
+		d[len - 1] = 'a';
+		break;
+	default:
+		break;
+	}
+}
+
+static void fill(void)
+{
+	(void)memset(src_buf, 'a', sizeof(src_buf));
+	(void)memset(dst_buf, 'a', sizeof(dst_buf));
+}
+
+static void bench_buckets(enum routine r)
+{
+	/* only the source offset matters for single buffer routines */
+	int n_d_offs = (r == R_MEMCHR || r == R_STRLEN) ? 1 : N_OFFS;
+
+	for (size_t lo = 1; lo <= MAX_LEN; lo *= 2) {
+		size_t hi = MIN(2 * lo - 1, MAX_LEN);
+		size_t step = (lo / 16U) | 1U;
+		u32_t start, cycles;
+
+		fill();
+		start = k_cycle_get_32();
+		for (size_t len = lo; len <= hi; len += step) {
+			for (int so = 0; so < N_OFFS; so++) {
+				for (int d_o = 0; d_o < n_d_offs; d_o++) {
+					run(r, len, so, d_o);
+				}
+			}
+		}
+		cycles = k_cycle_get_32() - start;
+
+		printk("%-7s %4zu-%4zu cycles %10u\n",
+		       routine_names[r], lo, hi, cycles);
+	}
+}
+
+static void bench_memcpy_offsets(void)
+{
+	printk("memcpy %d bytes by offset (rows src, columns dst)\n",
+	       MAX_LEN);
+
+	fill();
+	for (int so = 0; so < N_OFFS; so++) {
+		printk("%d:", so);
+		for (int d_o = 0; d_o < N_OFFS; d_o++) {
+			u32_t start = k_cycle_get_32();
+
+			run(R_MEMCPY, MAX_LEN, so, d_o);
+			printk(" %7u", k_cycle_get_32() - start);
+		}
+		printk("\n");
+	}
+}
+
+void main(void)
+{
+	for (int r = 0; r < N_ROUTINES; r++) {
+		bench_buckets(r);
+	}
+
+	bench_memcpy_offsets();
+
+	printk("fin\n");
+}
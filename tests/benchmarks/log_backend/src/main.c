@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <logging/log.h>
+#include <logging/log_ctrl.h>
+#include <bench_time.h>
+
+LOG_MODULE_REGISTER(bench, LOG_LEVEL_INF);
+
+/* Log a batch of messages, then time processing them into the backend
+ * enabled in the build. This is the time the log thread is busy; with a
+ * backend sending from an interrupt, transmission continues afterwards.
+ */
+
+#define ITERATIONS	512
+#define BATCH		32
+
+enum msg_kind {
+	MSG_ARGS_0,
+	MSG_ARGS_6,
+	MSG_HEXDUMP,
+};
+
+static const u8_t data[16] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+static void log_one(enum msg_kind kind, u32_t i)
+{
+	switch (kind) {
+	case MSG_ARGS_0:
+		LOG_INF("benchmark message without arguments");
+		break;
+	case MSG_ARGS_6:
+		LOG_INF("benchmark %d %d %d %d %d %d", i, 2, 3, 4, 5, 6);
+		break;
+	default:
+		LOG_HEXDUMP_INF(data, sizeof(data), "benchmark");
+		break;
+	}
+}
+
+static void bench_run(const char *name, enum msg_kind kind)
+{
+	u32_t process_us = 0U;
+	struct bench_time start;
+
+	for (u32_t i = 0; i < ITERATIONS; i += BATCH) {
+		for (u32_t j = 0; j < BATCH; j++) {
+			log_one(kind, i + j);
+		}
+
+		bench_time_start(&start);
+		while (log_process(false)) {
+		}
+		process_us += (u32_t)bench_time_us(&start);
+	}
+
+	printk("%-8s %6u us/msg in log thread %8u msgs/s\n", name,
+	       process_us / ITERATIONS,
+	       process_us ? (u32_t)((u64_t)ITERATIONS * USEC_PER_SEC /
+				    process_us) : 0);
+}
+
+void main(void)
+{
+	log_init();
+
+	printk("backend %s\n",
+	       IS_ENABLED(CONFIG_LOG_BACKEND_NATIVE_POSIX) ? "native_posix" :
+	       IS_ENABLED(CONFIG_LOG_BACKEND_UART_ASYNC) ? "uart_async" :
+	       IS_ENABLED(CONFIG_LOG_BACKEND_UART) ? "uart_poll" : "none");
+
+	bench_run("args 0", MSG_ARGS_0);
+	bench_run("args 6", MSG_ARGS_6);
+	bench_run("hexdump", MSG_HEXDUMP);
+
+	printk("fin\n");
+}
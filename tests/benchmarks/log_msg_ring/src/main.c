@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <logging/log.h>
+#include <logging/log_backend.h>
+#include <logging/log_ctrl.h>
+
+LOG_MODULE_REGISTER(bench, LOG_LEVEL_INF);
+
+/* Time creating deferred log messages and processing them into a backend
+ * that only counts them. Messages are processed in batches of BATCH so the
+ * buffer never overflows while timing. The burst test then logs from several
+ * threads and a timer interrupt without processing, and reports how many
+ * messages made it to the backend.
+ */
+
+#define ITERATIONS	1024
+#define BATCH		8
+#define BURST		512
+#define BURST_THREADS	2
+#define STACK_SIZE	1024
+
+static u32_t received;
+static u32_t dropped;
+
+static void put(struct log_backend const *const backend, struct log_msg *msg)
+{
+	log_msg_get(msg);
+	received++;
+	log_msg_put(msg);
+}
+
+static void drop(struct log_backend const *const backend, u32_t cnt)
+{
+	dropped += cnt;
+}
+
+static const struct log_backend_api bench_backend_api = {
+	.put = put,
+	.dropped = drop,
+};
+
+LOG_BACKEND_DEFINE(bench_backend, bench_backend_api, false);
+
+static void flush(void)
+{
+	while (log_process(false)) {
+	}
+}
+
+static void log_args(u32_t nargs, u32_t i)
+{
+	switch (nargs) {
+	case 0:
+		LOG_INF("bench");
+		break;
+	case 2:
+		LOG_INF("bench %d %d", i, 2);
+		break;
+	default:
+		LOG_INF("bench %d %d %d %d %d %d", i, 2, 3, 4, 5, 6);
+		break;
+	}
+}
+
+static void log_strdup_msg(u32_t i)
+{
+	LOG_INF("bench %d %s", i, log_strdup("a string of 24 chars...."));
+}
+
+static void bench_run(const char *name, u32_t nargs)
+{
+	u32_t start, log_cycles = 0U, process_cycles = 0U;
+
+	for (u32_t i = 0; i < ITERATIONS; i += BATCH) {
+		start = k_cycle_get_32();
+		for (u32_t j = 0; j < BATCH; j++) {
+			if (name != NULL) {
+				log_strdup_msg(i + j);
+			} else {
+				log_args(nargs, i + j);
+			}
+		}
+		log_cycles += k_cycle_get_32() - start;
+
+		start = k_cycle_get_32();
+		flush();
+		process_cycles += k_cycle_get_32() - start;
+	}
+
+	if (name != NULL) {
+		printk("log %-7s %6u cycles/msg %6u cycles/process\n", name,
+		       log_cycles / ITERATIONS, process_cycles / ITERATIONS);
+	} else {
+		printk("log args %u  %6u cycles/msg %6u cycles/process\n",
+		       nargs, log_cycles / ITERATIONS,
+		       process_cycles / ITERATIONS);
+	}
+}
+
+static K_THREAD_STACK_ARRAY_DEFINE(burst_stack, BURST_THREADS, STACK_SIZE);
+static struct k_thread burst_thread[BURST_THREADS];
+static u32_t isr_logged;
+
+static void burst_entry(void *p1, void *p2, void *p3)
+{
+	u32_t nargs = POINTER_TO_UINT(p1);
+
+	for (u32_t i = 0; i < BURST; i++) {
+		log_args(nargs, i);
+	}
+}
+
+static void burst_timer(struct k_timer *timer)
+{
+	log_args(2, isr_logged++);
+}
+
+static K_TIMER_DEFINE(isr_timer, burst_timer, NULL);
+
+static void bench_burst(void)
+{
+	u32_t logged;
+
+	received = 0U;
+	dropped = 0U;
+	isr_logged = 0U;
+
+	k_timer_start(&isr_timer, K_MSEC(1), K_MSEC(1));
+
+	for (int i = 0; i < BURST_THREADS; i++) {
+		k_thread_create(&burst_thread[i], burst_stack[i], STACK_SIZE,
+				burst_entry, UINT_TO_POINTER(2 * i), NULL,
+				NULL, K_PRIO_PREEMPT(1 + i), 0, K_NO_WAIT);
+	}
+
+	for (int i = 0; i < BURST; i++) {
+		log_strdup_msg(i);
+	}
+
+	k_sleep(K_MSEC(10));
+	k_timer_stop(&isr_timer);
+
+	for (int i = 0; i < BURST_THREADS; i++) {
+		k_thread_abort(&burst_thread[i]);
+	}
+
+	flush();
+
+	logged = (BURST_THREADS + 1) * BURST + isr_logged;
+	printk("log burst   %6u logged %6u received %6u dropped\n",
+	       logged, received, dropped);
+}
+
+void main(void)
+{
+	log_init();
+	log_backend_enable(&bench_backend, NULL, LOG_LEVEL_DBG);
+
+	printk("log message storage: %s, %u bytes\n",
+	       IS_ENABLED(CONFIG_LOG_MSG_RING) ? "ring" : "slab",
+	       CONFIG_LOG_BUFFER_SIZE);
+
+	bench_run(NULL, 0);
+	bench_run(NULL, 2);
+	bench_run(NULL, 6);
+	bench_run("strdup", 0);
+	bench_burst();
+
+#ifdef CONFIG_LOG_MSG_RING
+	struct log_msg_ring_stats stats;
+
+	log_msg_ring_stats_get(&stats);
+	printk("ring high-water %u of %u bytes\n", stats.max_used,
+	       stats.size);
+#endif
+
+	printk("fin\n");
+}
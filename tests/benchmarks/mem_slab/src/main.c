@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+
+/* This benchmark hammers a few memory slabs from one thread per CPU.
+ * Every worker allocates a burst of BURST blocks from each slab and
+ * then frees them again, ITERATIONS times per round.  The main thread
+ * releases 1, 2, ... CONFIG_MP_NUM_CPUS workers at once and reports
+ * the number of cycles elapsed until the last one finishes.  With the per-CPU slab caches
+ * enabled the bursts are mostly served from the local stash, without
+ * the workers contending for the slab lock.
+ */
+
+#define N_ROUNDS 10
+#define ITERATIONS 1000
+#define BURST 4
+#define N_SLABS 2
+#define N_BLOCKS (4 * BURST * CONFIG_MP_NUM_CPUS)
+#define BLOCK_SIZE 64
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+K_MEM_SLAB_DEFINE(slab0, BLOCK_SIZE, N_BLOCKS, 4);
+K_MEM_SLAB_DEFINE(slab1, BLOCK_SIZE, N_BLOCKS, 4);
+
+static struct k_mem_slab *slabs[N_SLABS] = { &slab0, &slab1 };
+
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, CONFIG_MP_NUM_CPUS,
+				   STACK_SIZE);
+static struct k_thread worker_threads[CONFIG_MP_NUM_CPUS];
+
+static K_SEM_DEFINE(start_sem, 0, CONFIG_MP_NUM_CPUS);
+static K_SEM_DEFINE(done_sem, 0, CONFIG_MP_NUM_CPUS);
+
+static atomic_t failures;
+
+static void worker_fn(void *arg1, void *arg2, void *arg3)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
+
+	void *blocks[N_SLABS][BURST];
+
+	while (true) {
+		k_sem_take(&start_sem, K_FOREVER);
+
+		for (int i = 0; i < ITERATIONS; i++) {
+			for (int s = 0; s < N_SLABS; s++) {
+				for (int b = 0; b < BURST; b++) {
+					if (k_mem_slab_alloc(slabs[s],
+							     &blocks[s][b],
+							     K_FOREVER) != 0) {
+						atomic_inc(&failures);
+					}
+				}
+			}
+
+			for (int s = 0; s < N_SLABS; s++) {
+				for (int b = 0; b < BURST; b++) {
+					k_mem_slab_free(slabs[s],
+							&blocks[s][b]);
+				}
+			}
+		}
+
+		k_sem_give(&done_sem);
+	}
+}
+
+void main(void)
+{
+	int prio = k_thread_priority_get(k_current_get());
+
+	/* Workers run below main's priority so that main can release
+	 * them all before any of them runs on this CPU.
+	 */
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_thread_create(&worker_threads[i], worker_stacks[i],
+				STACK_SIZE, worker_fn, NULL, NULL, NULL,
+				prio + 1, 0,
+				K_NO_WAIT);
+	}
+
+	for (int n = 1; n <= CONFIG_MP_NUM_CPUS; n++) {
+		u64_t tot = 0U;
+
+		for (int r = 0; r < N_ROUNDS; r++) {
+			u32_t start, cycles;
+
+			start = k_cycle_get_32();
+			for (int i = 0; i < n; i++) {
+				k_sem_give(&start_sem);
+			}
+			for (int i = 0; i < n; i++) {
+				k_sem_take(&done_sem, K_FOREVER);
+			}
+			cycles = k_cycle_get_32() - start;
+			tot += cycles;
+
+			printk("threads %2d blocks %4d ops %8d cycles %10u\n",
+			       n, N_BLOCKS,
+			       n * ITERATIONS * N_SLABS * BURST * 2, cycles);
+		}
+
+		printk("threads %2d average %u cycles per round\n",
+		       n, (u32_t)(tot / N_ROUNDS));
+	}
+
+	printk("%u failures\n", (u32_t)atomic_get(&failures));
+	printk("fin\n");
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+
+/* The main thread produces ITEMS records for a consumer thread, either
+ * with the single item calls (batch of 1) or with the batch calls.  The
+ * consumer runs at a lower priority so that, once the queue is full,
+ * the producer blocks and the consumer drains as much as it can in one
+ * call, as a pipeline stage running behind its source would.
+ */
+
+#define ITEMS 4096
+#define MAX_BATCH 64
+#define QUEUE_LEN 64
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+struct record {
+	u32_t seq;
+	u32_t value;
+};
+
+/* k_queue elements need their first word for the kernel */
+struct qrecord {
+	void *reserved;
+	struct record rec;
+};
+
+K_MSGQ_DEFINE(bench_msgq, sizeof(struct record), QUEUE_LEN, 4);
+K_QUEUE_DEFINE(bench_queue);
+
+static K_THREAD_STACK_DEFINE(cons_stack, STACK_SIZE);
+static struct k_thread cons_thread;
+
+static const u32_t batches[] = { 1, 4, 16, 64 };
+
+static struct record tx[MAX_BATCH];
+static struct record rx[MAX_BATCH];
+static void *qitems[MAX_BATCH];
+static struct qrecord qrecs[ITEMS];
+static u32_t errors;
+
+static void msgq_consumer(void *p1, void *p2, void *p3)
+{
+	u32_t batch = POINTER_TO_UINT(p1);
+	u32_t seq = 0U;
+
+	while (seq < ITEMS) {
+		int n;
+
+		if (batch == 1U) {
+			n = (k_msgq_get(&bench_msgq, rx, K_FOREVER) == 0) ?
+			    1 : 0;
+		} else {
+			n = k_msgq_get_many(&bench_msgq, rx, batch,
+					    K_FOREVER);
+		}
+
+		for (int i = 0; i < n; i++) {
+			if (rx[i].seq != seq++) {
+				errors++;
+			}
+		}
+	}
+}
+
+static void msgq_produce(u32_t batch)
+{
+	u32_t seq = 0U;
+
+	while (seq < ITEMS) {
+		for (int i = 0; i < batch; i++) {
+			tx[i].seq = seq + i;
+			tx[i].value = ~(seq + i);
+		}
+
+		if (batch == 1U) {
+			(void)k_msgq_put(&bench_msgq, tx, K_FOREVER);
+			seq++;
+			continue;
+		}
+
+		/* the queue may take only part of a batch */
+		for (int done = 0; done < batch; ) {
+			int n = k_msgq_put_many(&bench_msgq, &tx[done],
+						batch - done, K_FOREVER);
+
+			if (n > 0) {
+				done += n;
+			}
+		}
+		seq += batch;
+	}
+}
+
+static void queue_consumer(void *p1, void *p2, void *p3)
+{
+	u32_t batch = POINTER_TO_UINT(p1);
+	u32_t seq = 0U;
+
+	while (seq < ITEMS) {
+		int n;
+
+		if (batch == 1U) {
+			qitems[0] = k_queue_get(&bench_queue, K_FOREVER);
+			n = 1;
+		} else {
+			n = k_queue_get_many(&bench_queue, qitems, batch,
+					     K_FOREVER);
+		}
+
+		for (int i = 0; i < n; i++) {
+			struct qrecord *q = qitems[i];
+
+			if (q->rec.seq != seq++) {
+				errors++;
+			}
+		}
+	}
+}
+
+static void queue_produce(u32_t batch)
+{
+	for (u32_t seq = 0U; seq < ITEMS; seq += batch) {
+		struct qrecord *head = &qrecs[seq];
+
+		for (int i = 0; i < batch; i++) {
+			head[i].rec.seq = seq + i;
+			head[i].rec.value = ~(seq + i);
+		}
+
+		if (batch == 1U) {
+			k_queue_append(&bench_queue, head);
+			continue;
+		}
+
+		/* chain the batch through the reserved words */
+		for (int i = 0; i < batch - 1; i++) {
+			head[i].reserved = &head[i + 1];
+		}
+		head[batch - 1].reserved = NULL;
+		(void)k_queue_append_list(&bench_queue, head,
+					  &head[batch - 1]);
+	}
+}
+
+static void run(const char *name, k_thread_entry_t consumer,
+		 void (*produce)(u32_t batch), u32_t batch)
+{
+	int prio = k_thread_priority_get(k_current_get());
+	u32_t start, cycles;
+
+	k_thread_create(&cons_thread, cons_stack, STACK_SIZE, consumer,
+			UINT_TO_POINTER(batch), NULL, NULL, prio + 1, 0,
+			K_NO_WAIT);
+
+	start = k_cycle_get_32();
+	produce(batch);
+	k_thread_join(&cons_thread, K_FOREVER);
+	cycles = k_cycle_get_32() - start;
+
+	printk("%-5s batch %2u items %5u cycles %10u\n", name, batch, ITEMS,
+	       cycles);
+}
+
+void main(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(batches); i++) {
+		run("msgq", msgq_consumer, msgq_produce, batches[i]);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(batches); i++) {
+		run("queue", queue_consumer, queue_produce, batches[i]);
+	}
+
+	printk("%u errors\n", errors);
+	printk("fin\n");
+}
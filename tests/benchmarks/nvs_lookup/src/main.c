@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <drivers/flash.h>
+#include <storage/flash_map.h>
+#include <fs/nvs.h>
+
+/* Fill the storage partition with an increasing number of entries, each
+ * with its own id, then time reading back every id once and mounting the
+ * file system.  Entries written first are the furthest away from the
+ * newest entry, which is where a read without the lookup cache starts.
+ */
+
+#define SECTOR_SIZE 4096
+
+static const u16_t entry_counts[] = { 16, 64, 256, 1024 };
+
+static struct nvs_fs fs;
+
+static int bench_mount(void)
+{
+	return nvs_init(&fs, DT_CHOSEN_ZEPHYR_FLASH_CONTROLLER_LABEL);
+}
+
+static int bench_fill(u16_t count)
+{
+	for (u16_t id = 0; id < count; id++) {
+		u32_t data = id;
+		ssize_t len;
+
+		len = nvs_write(&fs, id, &data, sizeof(data));
+		if (len != sizeof(data)) {
+			return (len < 0) ? len : -EIO;
+		}
+	}
+
+	return 0;
+}
+
+static int bench_read(u16_t count, u32_t *cycles)
+{
+	u32_t start, data;
+	int errors = 0;
+
+	start = k_cycle_get_32();
+	for (u16_t id = 0; id < count; id++) {
+		if (nvs_read(&fs, id, &data, sizeof(data)) != sizeof(data) ||
+		    data != id) {
+			errors++;
+		}
+	}
+	*cycles = k_cycle_get_32() - start;
+
+	return errors;
+}
+
+void main(void)
+{
+	const struct flash_area *fa;
+	u32_t cycles, start;
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	if (rc) {
+		printk("flash_area_open failed: %d\n", rc);
+		return;
+	}
+
+	fs.offset = fa->fa_off;
+	fs.sector_size = SECTOR_SIZE;
+	fs.sector_count = fa->fa_size / SECTOR_SIZE;
+
+	printk("NVS: %u sectors of %u bytes, lookup cache %s\n",
+	       fs.sector_count, fs.sector_size,
+	       IS_ENABLED(CONFIG_NVS_LOOKUP_CACHE) ? "on" : "off");
+
+	rc = bench_mount();
+	if (rc) {
+		printk("nvs_init failed: %d\n", rc);
+		return;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(entry_counts); i++) {
+		u16_t count = entry_counts[i];
+
+		rc = nvs_clear(&fs);
+		if (rc == 0) {
+			rc = bench_mount();
+		}
+		if (rc == 0) {
+			rc = bench_fill(count);
+		}
+		if (rc) {
+			printk("nvs setup for %u entries failed: %d\n",
+			       count, rc);
+			break;
+		}
+
+		rc = bench_read(count, &cycles);
+		printk("nvs read  %5u entries %10u cycles/read%s\n", count,
+		       cycles / count, rc ? " (read errors)" : "");
+
+		start = k_cycle_get_32();
+		rc = bench_mount();
+		cycles = k_cycle_get_32() - start;
+		printk("nvs mount %5u entries %10u cycles%s\n", count,
+		       cycles, rc ? " (mount error)" : "");
+	}
+
+	printk("fin\n");
+}
@@ -41,10 +41,17 @@
 #define N_RUNS 1000
 #define N_SETTLE 10
 
+#define N_BG CONFIG_BENCHMARK_NUM_READY_THREADS
+#define BG_STACK_SIZE (256 + CONFIG_TEST_EXTRA_STACKSIZE)
 
 static K_THREAD_STACK_DEFINE(partner_stack, 1024);
 static struct k_thread partner_thread;
 
+#if N_BG > 0
+static K_THREAD_STACK_ARRAY_DEFINE(bg_stacks, N_BG, BG_STACK_SIZE);
+static struct k_thread bg_threads[N_BG];
+#endif
+
 _wait_q_t waitq;
 
 enum {
@@ -79,6 +86,32 @@ static inline int _stamp(int state)
 /* #define stamp(s) printk("%s @ %d\n", #s, _stamp(s)) */
 #define stamp(s) _stamp(s)
 
+#if N_BG > 0
+static void bg_fn(void *arg1, void *arg2, void *arg3)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
+
+	/* Never runs while the benchmark is in progress */
+}
+
+/* Fill the ready queue with threads spread over all preemptible
+ * priorities below the main thread, so the backends are measured with
+ * a ready queue of N_BG threads rather than an empty one.
+ */
+static void start_bg_threads(int main_prio)
+{
+	int nprio = K_LOWEST_APPLICATION_THREAD_PRIO - main_prio;
+
+	for (int i = 0; i < N_BG; i++) {
+		k_thread_create(&bg_threads[i], bg_stacks[i], BG_STACK_SIZE,
+				bg_fn, NULL, NULL, NULL,
+				main_prio + 1 + (i % nprio), 0, K_NO_WAIT);
+	}
+}
+#endif
+
 static void partner_fn(void *arg1, void *arg2, void *arg3)
 {
 	ARG_UNUSED(arg1);
@@ -110,6 +143,11 @@ void main(void)
 	/* Let it start running and pend */
 	k_sleep(K_MSEC(100));
 
+#if N_BG > 0
+	start_bg_threads(main_prio);
+#endif
+	printk("ready threads %d\n", N_BG);
+
 	u64_t tot = 0U;
 	u32_t runs = 0U;
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <settings/settings.h>
+
+/* Save an increasing number of keys under the "bench" subtree, update them,
+ * load them back and delete them again, timing each step.  Keys are deleted
+ * from the last to the first one so that every round starts from an empty
+ * name ID range.
+ */
+
+#define NAME_LEN 16
+
+static const u16_t key_counts[] = { 10, 100, 300, 1000 };
+
+static u32_t loaded;
+
+static int bench_set(const char *name, size_t len, settings_read_cb read_cb,
+		     void *cb_arg)
+{
+	u32_t val;
+
+	if (read_cb(cb_arg, &val, sizeof(val)) == sizeof(val)) {
+		loaded++;
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(bench, "bench", NULL, bench_set, NULL, NULL);
+
+static int bench_save_all(u16_t count, u32_t seed, u32_t *cycles)
+{
+	char name[NAME_LEN];
+	u32_t start, val;
+	int rc;
+
+	start = k_cycle_get_32();
+	for (u16_t i = 0; i < count; i++) {
+		snprintk(name, sizeof(name), "bench/k%u", i);
+		val = seed + i;
+		rc = settings_save_one(name, &val, sizeof(val));
+		if (rc) {
+			return rc;
+		}
+	}
+	*cycles = k_cycle_get_32() - start;
+
+	return 0;
+}
+
+static int bench_delete_all(u16_t count, u32_t *cycles)
+{
+	char name[NAME_LEN];
+	u32_t start;
+	int rc;
+
+	start = k_cycle_get_32();
+	for (int i = count - 1; i >= 0; i--) {
+		snprintk(name, sizeof(name), "bench/k%u", i);
+		rc = settings_delete(name);
+		if (rc) {
+			return rc;
+		}
+	}
+	*cycles = k_cycle_get_32() - start;
+
+	return 0;
+}
+
+void main(void)
+{
+	u32_t cycles, start;
+	int rc;
+
+	printk("settings NVS backend, name cache %s\n",
+	       IS_ENABLED(CONFIG_SETTINGS_NVS_NAME_CACHE) ? "on" : "off");
+
+	rc = settings_subsys_init();
+	if (rc == 0) {
+		/* the name cache is filled by the first load */
+		rc = settings_load();
+	}
+	if (rc) {
+		printk("settings init failed: %d\n", rc);
+		return;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(key_counts); i++) {
+		u16_t count = key_counts[i];
+
+		rc = bench_save_all(count, 0, &cycles);
+		if (rc) {
+			printk("settings save of %u keys failed: %d\n",
+			       count, rc);
+			break;
+		}
+		printk("settings save   %4u keys %10u cycles/key\n", count,
+		       cycles / count);
+
+		rc = bench_save_all(count, count, &cycles);
+		if (rc) {
+			printk("settings update of %u keys failed: %d\n",
+			       count, rc);
+			break;
+		}
+		printk("settings update %4u keys %10u cycles/key\n", count,
+		       cycles / count);
+
+		loaded = 0U;
+		start = k_cycle_get_32();
+		rc = settings_load();
+		cycles = k_cycle_get_32() - start;
+		printk("settings load   %4u keys %10u cycles%s\n", count,
+		       cycles, (rc || loaded != count) ? " (load error)" : "");
+
+		rc = bench_delete_all(count, &cycles);
+		if (rc) {
+			printk("settings delete of %u keys failed: %d\n",
+			       count, rc);
+			break;
+		}
+		printk("settings delete %4u keys %10u cycles/key\n", count,
+		       cycles / count);
+	}
+
+	printk("fin\n");
+}
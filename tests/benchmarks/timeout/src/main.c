@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timeout_q.h>
+
+/* Timeout queue microbenchmark.  Arms, cancels and expires large
+ * numbers of raw kernel timeouts (struct _timeout, as embedded in
+ * every thread and k_timer) with pseudo-random durations, to compare
+ * the scaling of the timeout queue backends.
+ */
+
+#define MAX_TIMEOUTS 10000
+#define MAX_TICKS 1000
+
+static struct _timeout timeouts[MAX_TIMEOUTS];
+static const int counts[] = { 100, 1000, MAX_TIMEOUTS };
+
+static u32_t rand_state = 0x2545f491;
+static u32_t fired;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, good enough and deterministic */
+	rand_state = rand_state * 1664525U + 1013904223U;
+	return rand_state >> 8;
+}
+
+static void timeout_fn(struct _timeout *t)
+{
+	ARG_UNUSED(t);
+
+	fired++;
+}
+
+static u32_t arm(int n)
+{
+	u32_t start = k_cycle_get_32();
+
+	for (int i = 0; i < n; i++) {
+		z_add_timeout(&timeouts[i], timeout_fn,
+			      K_TICKS(1 + (next_rand() % MAX_TICKS)));
+	}
+
+	return k_cycle_get_32() - start;
+}
+
+static u32_t cancel(int n)
+{
+	u32_t start = k_cycle_get_32();
+
+	for (int i = 0; i < n; i++) {
+		z_abort_timeout(&timeouts[i]);
+	}
+
+	return k_cycle_get_32() - start;
+}
+
+void main(void)
+{
+	for (int i = 0; i < MAX_TIMEOUTS; i++) {
+		z_init_timeout(&timeouts[i]);
+	}
+
+	for (int c = 0; c < ARRAY_SIZE(counts); c++) {
+		int n = counts[c];
+		u32_t t_arm, t_cancel;
+
+		t_arm = arm(n);
+		t_cancel = cancel(n);
+
+		/* Arm again and check they all expire in time */
+		fired = 0U;
+		arm(n);
+		k_sleep(K_TICKS(MAX_TICKS + 1));
+
+		printk("timeouts %5d arm %10u cancel %10u expired %5u\n",
+		       n, t_arm, t_cancel, fired);
+	}
+
+	printk("fin\n");
+}
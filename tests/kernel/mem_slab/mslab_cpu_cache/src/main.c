@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define BLK_NUM 8
+#define BLK_SIZE 16
+#define BLK_ALIGN 8
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+K_MEM_SLAB_DEFINE(mslab_a, BLK_SIZE, BLK_NUM, BLK_ALIGN);
+K_MEM_SLAB_DEFINE(mslab_c, BLK_SIZE, BLK_NUM, BLK_ALIGN);
+static struct k_mem_slab mslab_b;
+static char __aligned(BLK_ALIGN) mslab_b_buf[BLK_SIZE * BLK_NUM];
+
+static K_THREAD_STACK_DEFINE(tstack, STACK_SIZE);
+static struct k_thread tdata;
+static K_SEM_DEFINE(alloc_sem, 0, 1);
+static void *waiter_block;
+
+static void *blocks[BLK_NUM];
+
+static void alloc_all(struct k_mem_slab *slab, void **mem)
+{
+	for (int i = 0; i < BLK_NUM; i++) {
+		zassert_equal(k_mem_slab_alloc(slab, &mem[i], K_NO_WAIT), 0,
+			      "alloc %d failed", i);
+	}
+}
+
+static void free_all(struct k_mem_slab *slab, void **mem)
+{
+	for (int i = 0; i < BLK_NUM; i++) {
+		k_mem_slab_free(slab, &mem[i]);
+	}
+}
+
+/* Check that the block is one of the slab and not handed out twice */
+static void check_block(struct k_mem_slab *slab, void *block, u32_t *seen)
+{
+	size_t off = (char *)block - slab->buffer;
+	int idx = off / BLK_SIZE;
+
+	zassert_true((char *)block >= slab->buffer &&
+		     off < BLK_NUM * BLK_SIZE && !(off % BLK_SIZE),
+		     "block %p not from slab %p", block, slab);
+	zassert_false(*seen & BIT(idx), "block %p handed out twice", block);
+	*seen |= BIT(idx);
+}
+
+/**
+ * @brief Verify the used and free block counts with the CPU caches
+ *
+ * @details Blocks moved to the cache of the CPU in batches are counted
+ * as free, and the counts go back to their initial values once all the
+ * blocks are freed, whether they end up in the cache or the shared list.
+ */
+void test_mslab_cache_num_used(void)
+{
+	void *block[3];
+
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab_a), BLK_NUM, NULL);
+
+	for (int i = 0; i < ARRAY_SIZE(block); i++) {
+		zassert_equal(k_mem_slab_alloc(&mslab_a, &block[i], K_NO_WAIT),
+			      0, "alloc %d failed", i);
+		zassert_equal(k_mem_slab_num_used_get(&mslab_a), i + 1, NULL);
+		zassert_equal(k_mem_slab_num_free_get(&mslab_a),
+			      BLK_NUM - i - 1, NULL);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(block); i++) {
+		k_mem_slab_free(&mslab_a, &block[i]);
+	}
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab_a), BLK_NUM, NULL);
+
+	/* more frees than the cache holds drain to the shared list */
+	alloc_all(&mslab_a, blocks);
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), BLK_NUM, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab_a), 0, NULL);
+
+	free_all(&mslab_a, blocks);
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab_a), BLK_NUM, NULL);
+}
+
+/**
+ * @brief Verify blocks go back to the slab they come from
+ *
+ * @details Two slabs with blocks of the same size are used alternately,
+ * so that both have blocks in the CPU cache. Every block allocated must
+ * belong to its slab, and all of them must be allocated once.
+ */
+void test_mslab_cache_own_slab(void)
+{
+	void *blocks_b[BLK_NUM];
+	u32_t seen_a, seen_b;
+
+	zassert_equal(k_mem_slab_init(&mslab_b, mslab_b_buf, BLK_SIZE,
+				      BLK_NUM), 0, NULL);
+
+	for (int round = 0; round < 3; round++) {
+		seen_a = 0U;
+		seen_b = 0U;
+
+		for (int i = 0; i < BLK_NUM; i++) {
+			zassert_equal(k_mem_slab_alloc(&mslab_a, &blocks[i],
+						       K_NO_WAIT), 0, NULL);
+			check_block(&mslab_a, blocks[i], &seen_a);
+			zassert_equal(k_mem_slab_alloc(&mslab_b, &blocks_b[i],
+						       K_NO_WAIT), 0, NULL);
+			check_block(&mslab_b, blocks_b[i], &seen_b);
+		}
+
+		for (int i = 0; i < BLK_NUM; i++) {
+			k_mem_slab_free(&mslab_b, &blocks_b[i]);
+			k_mem_slab_free(&mslab_a, &blocks[i]);
+		}
+
+		zassert_equal(k_mem_slab_num_used_get(&mslab_a), 0, NULL);
+		zassert_equal(k_mem_slab_num_used_get(&mslab_b), 0, NULL);
+	}
+}
+
+static void tmslab_waiter(void *p1, void *p2, void *p3)
+{
+	zassert_equal(k_mem_slab_alloc(&mslab_a, &waiter_block, K_FOREVER),
+		      0, NULL);
+	k_sem_give(&alloc_sem);
+}
+
+/**
+ * @brief Verify allocations from a slab with no free block
+ *
+ * @details Blocks freed to the cache are allocated again, an allocation
+ * fails once both the cache and the shared list are empty, and a thread
+ * waiting for a block gets the next one freed instead of the cache.
+ */
+void test_mslab_cache_empty(void)
+{
+	void *block;
+
+	alloc_all(&mslab_a, blocks);
+
+	zassert_equal(k_mem_slab_alloc(&mslab_a, &block, K_NO_WAIT), -ENOMEM,
+		      NULL);
+	zassert_is_null(block, NULL);
+	zassert_equal(k_mem_slab_alloc(&mslab_a, &block, K_MSEC(10)), -EAGAIN,
+		      NULL);
+
+	/* freed to the cache, allocated from it */
+	k_mem_slab_free(&mslab_a, &blocks[0]);
+	k_mem_slab_free(&mslab_a, &blocks[1]);
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), BLK_NUM - 2, NULL);
+	zassert_equal(k_mem_slab_alloc(&mslab_a, &blocks[0], K_NO_WAIT), 0,
+		      NULL);
+	zassert_equal(k_mem_slab_alloc(&mslab_a, &blocks[1], K_NO_WAIT), 0,
+		      NULL);
+	zassert_equal(k_mem_slab_alloc(&mslab_a, &block, K_NO_WAIT), -ENOMEM,
+		      NULL);
+
+	/* a waiting thread gets the block freed */
+	k_thread_create(&tdata, tstack, STACK_SIZE, tmslab_waiter,
+			NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_sleep(K_MSEC(10));
+	zassert_equal(k_sem_count_get(&alloc_sem), 0, "waiter not pending");
+
+	block = blocks[0];
+	k_mem_slab_free(&mslab_a, &blocks[0]);
+	zassert_equal(k_sem_take(&alloc_sem, K_MSEC(100)), 0,
+		      "waiter not woken up");
+	zassert_equal_ptr(waiter_block, block, "waiter got another block");
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), BLK_NUM, NULL);
+
+	k_mem_slab_free(&mslab_a, &waiter_block);
+	for (int i = 1; i < BLK_NUM; i++) {
+		k_mem_slab_free(&mslab_a, &blocks[i]);
+	}
+	k_thread_join(&tdata, K_FOREVER);
+
+	zassert_equal(k_mem_slab_num_used_get(&mslab_a), 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab_a), BLK_NUM, NULL);
+}
+
+/**
+ * @brief Verify the caches of static slabs are cache line aligned
+ *
+ * @details Static slabs are placed back to back by the linker. The
+ * per-CPU caches of each of them must still start on a boundary of
+ * CONFIG_MEM_SLAB_CPU_CACHE_ALIGN.
+ */
+void test_mslab_cache_align(void)
+{
+	struct k_mem_slab *slabs[] = { &mslab_a, &mslab_c };
+
+	for (int i = 0; i < ARRAY_SIZE(slabs); i++) {
+		for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+			uintptr_t addr = (uintptr_t)&slabs[i]->cpu_cache[cpu];
+
+			zassert_equal(addr % CONFIG_MEM_SLAB_CPU_CACHE_ALIGN,
+				      0, "slab %d cpu %d cache at %p", i, cpu,
+				      (void *)addr);
+		}
+	}
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(mslab_cpu_cache,
+			 ztest_1cpu_unit_test(test_mslab_cache_num_used),
+			 ztest_1cpu_unit_test(test_mslab_cache_own_slab),
+			 ztest_1cpu_unit_test(test_mslab_cache_empty),
+			 ztest_unit_test(test_mslab_cache_align));
+	ztest_run_test_suite(mslab_cpu_cache);
+}
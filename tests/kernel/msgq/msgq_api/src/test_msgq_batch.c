@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_msgq.h"
+
+#define BATCH_LEN 5
+
+K_THREAD_STACK_EXTERN(tstack);
+extern struct k_thread tdata;
+extern struct k_msgq msgq;
+static ZTEST_BMEM char __aligned(4) tbuffer[MSG_SIZE * BATCH_LEN];
+static ZTEST_DMEM u32_t tx[BATCH_LEN * 2];
+static ZTEST_DMEM u32_t rx[BATCH_LEN * 2];
+static ZTEST_DMEM u32_t single;
+
+static void batch_put_get(struct k_msgq *q)
+{
+	int ret;
+
+	for (int i = 0; i < ARRAY_SIZE(tx); i++) {
+		tx[i] = MSG0 + i;
+	}
+
+	/**TESTPOINT: batches wrap around the ring buffer */
+	for (int round = 0; round < 2 * BATCH_LEN; round++) {
+		u32_t n = (round % BATCH_LEN) + 1;
+
+		ret = k_msgq_put_many(q, tx, n, K_NO_WAIT);
+		zassert_equal(ret, n, "put %d of %d", ret, n);
+
+		ret = k_msgq_get_many(q, rx, n, K_NO_WAIT);
+		zassert_equal(ret, n, "got %d of %d", ret, n);
+		for (int i = 0; i < n; i++) {
+			zassert_equal(rx[i], tx[i], NULL);
+		}
+		zassert_equal(k_msgq_num_used_get(q), 0, NULL);
+
+		/* mix with single message calls */
+		ret = k_msgq_put(q, &tx[n], K_NO_WAIT);
+		zassert_equal(ret, 0, NULL);
+		ret = k_msgq_get(q, &single, K_NO_WAIT);
+		zassert_equal(ret, 0, NULL);
+		zassert_equal(single, tx[n], NULL);
+	}
+
+	/**TESTPOINT: put_many stops when the queue is full */
+	ret = k_msgq_put_many(q, tx, ARRAY_SIZE(tx), K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN, NULL);
+	ret = k_msgq_put_many(q, tx, 1, K_NO_WAIT);
+	zassert_equal(ret, -ENOMSG, NULL);
+	ret = k_msgq_put_many(q, tx, 1, TIMEOUT);
+	zassert_equal(ret, -EAGAIN, NULL);
+
+	/**TESTPOINT: get_many returns what is available */
+	ret = k_msgq_get_many(q, rx, 2, K_NO_WAIT);
+	zassert_equal(ret, 2, NULL);
+	ret = k_msgq_get_many(q, rx + 2, ARRAY_SIZE(rx), K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN - 2, NULL);
+	for (int i = 0; i < BATCH_LEN; i++) {
+		zassert_equal(rx[i], tx[i], NULL);
+	}
+	ret = k_msgq_get_many(q, rx, 1, K_NO_WAIT);
+	zassert_equal(ret, -ENOMSG, NULL);
+	ret = k_msgq_get_many(q, rx, 1, TIMEOUT);
+	zassert_equal(ret, -EAGAIN, NULL);
+
+	ret = k_msgq_put_many(q, tx, 0, K_NO_WAIT);
+	zassert_equal(ret, 0, NULL);
+	ret = k_msgq_get_many(q, rx, 0, K_NO_WAIT);
+	zassert_equal(ret, 0, NULL);
+}
+
+static void reader_entry(void *p1, void *p2, void *p3)
+{
+	int ret = k_msgq_get_many((struct k_msgq *)p1, rx, BATCH_LEN,
+				  K_FOREVER);
+
+	/* a blocked reader is handed exactly one message */
+	zassert_equal(ret, 1, NULL);
+	zassert_equal(rx[0], MSG0, NULL);
+}
+
+static void writer_entry(void *p1, void *p2, void *p3)
+{
+	int ret = k_msgq_put_many((struct k_msgq *)p1, &tx[BATCH_LEN],
+				  BATCH_LEN, K_FOREVER);
+
+	/* a blocked writer gets exactly one message accepted */
+	zassert_equal(ret, 1, NULL);
+}
+
+static void batch_wake(struct k_msgq *q, u32_t options)
+{
+	int ret;
+
+	for (int i = 0; i < ARRAY_SIZE(tx); i++) {
+		tx[i] = MSG0 + i;
+	}
+
+	/**TESTPOINT: put_many hands the first message to a waiting reader */
+	k_tid_t tid = k_thread_create(&tdata, tstack, STACK_SIZE,
+				      reader_entry, q, NULL, NULL,
+				      K_PRIO_PREEMPT(0), options, K_NO_WAIT);
+
+	k_msleep(TIMEOUT_MS >> 1);
+	ret = k_msgq_put_many(q, tx, BATCH_LEN, K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN, NULL);
+	k_thread_join(tid, K_FOREVER);
+	zassert_equal(k_msgq_num_used_get(q), BATCH_LEN - 1, NULL);
+
+	/**TESTPOINT: get_many refills the queue from a blocked writer */
+	ret = k_msgq_put_many(q, tx, 1, K_NO_WAIT);
+	zassert_equal(ret, 1, NULL);
+	tid = k_thread_create(&tdata, tstack, STACK_SIZE, writer_entry,
+			      q, NULL, NULL, K_PRIO_PREEMPT(0), options,
+			      K_NO_WAIT);
+	k_msleep(TIMEOUT_MS >> 1);
+
+	ret = k_msgq_get_many(q, rx, ARRAY_SIZE(rx), K_NO_WAIT);
+	zassert_equal(ret, BATCH_LEN, NULL);
+	k_thread_join(tid, K_FOREVER);
+	zassert_equal(k_msgq_num_used_get(q), 1, NULL);
+	ret = k_msgq_get(q, &single, K_NO_WAIT);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(single, tx[BATCH_LEN], NULL);
+}
+
+/**
+ * @addtogroup kernel_message_queue_tests
+ * @{
+ */
+
+/**
+ * @brief Test putting and getting several messages at once
+ * @see k_msgq_put_many(), k_msgq_get_many()
+ */
+void test_msgq_put_get_many(void)
+{
+	k_msgq_init(&msgq, tbuffer, MSG_SIZE, BATCH_LEN);
+
+	batch_put_get(&msgq);
+}
+
+/**
+ * @brief Test batch calls waking up blocked readers and writers
+ * @see k_msgq_put_many(), k_msgq_get_many()
+ */
+void test_msgq_many_wake(void)
+{
+	k_msgq_init(&msgq, tbuffer, MSG_SIZE, BATCH_LEN);
+
+	batch_wake(&msgq, 0);
+}
+
+#ifdef CONFIG_USERSPACE
+/**
+ * @brief Test putting and getting several messages at once from user mode
+ * @see k_msgq_put_many(), k_msgq_get_many()
+ */
+void test_msgq_user_put_get_many(void)
+{
+	struct k_msgq *q;
+
+	q = k_object_alloc(K_OBJ_MSGQ);
+	zassert_not_null(q, "couldn't alloc message queue");
+	zassert_false(k_msgq_alloc_init(q, MSG_SIZE, BATCH_LEN), NULL);
+
+	batch_put_get(q);
+	batch_wake(q, K_USER | K_INHERIT_PERMS);
+}
+#endif
+
+/**
+ * @}
+ */
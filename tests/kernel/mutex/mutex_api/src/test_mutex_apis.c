@@ -140,6 +140,105 @@ void test_mutex_lock_unlock(void)
 	tmutex_test_lock_unlock(&kmutex);
 }
 
+#define SPIN_ITERATIONS 20000
+
+K_MUTEX_DEFINE(stats_mutex);
+static K_THREAD_STACK_ARRAY_DEFINE(contend_stacks, CONFIG_MP_NUM_CPUS,
+				   STACK_SIZE);
+static struct k_thread contend_threads[CONFIG_MP_NUM_CPUS];
+static volatile u32_t protected_count;
+
+static void tThread_entry_lock_unlock(void *p1, void *p2, void *p3)
+{
+	zassert_true(k_mutex_lock((struct k_mutex *)p1, K_FOREVER) == 0,
+		     NULL);
+	k_mutex_unlock((struct k_mutex *)p1);
+}
+
+/**
+ * @brief Test mutex contention statistics
+ *
+ * @see k_mutex_stats_get()
+ */
+void test_mutex_stats(void)
+{
+#ifdef CONFIG_MUTEX_STATS
+	struct k_mutex_stats stats;
+
+	tmutex_test_lock_unlock(&stats_mutex);
+	k_mutex_stats_get(&stats_mutex, &stats);
+	zassert_equal(stats.acquisitions, 3, NULL);
+	zassert_equal(stats.contended, 0, NULL);
+
+	/**TESTPOINT: a higher priority thread waits for the mutex */
+	zassert_true(k_mutex_lock(&stats_mutex, K_FOREVER) == 0, NULL);
+	zassert_false(k_mutex_lock(&stats_mutex, K_FOREVER) != 0, NULL);
+	k_thread_create(&contend_threads[0], contend_stacks[0], STACK_SIZE,
+			tThread_entry_lock_unlock, &stats_mutex, NULL, NULL,
+			k_thread_priority_get(k_current_get()) - 1, 0,
+			K_NO_WAIT);
+	/* let it run and pend */
+	k_msleep(10);
+	k_mutex_unlock(&stats_mutex);
+	k_mutex_unlock(&stats_mutex);
+	k_thread_join(&contend_threads[0], K_FOREVER);
+
+	k_mutex_stats_get(&stats_mutex, &stats);
+	zassert_equal(stats.acquisitions, 6, NULL);
+	zassert_equal(stats.contended, 1, NULL);
+	zassert_true(stats.spin_acquired <= 1, NULL);
+	zassert_true(stats.wait_cycles > 0, NULL);
+
+	zassert_equal(k_mutex_lock(&stats_mutex, K_NO_WAIT), 0, NULL);
+	k_mutex_unlock(&stats_mutex);
+#else
+	ztest_test_skip();
+#endif
+}
+
+static void tThread_entry_contend(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < SPIN_ITERATIONS; i++) {
+		zassert_true(k_mutex_lock((struct k_mutex *)p1, K_FOREVER) == 0,
+			     NULL);
+		protected_count++;
+		k_mutex_unlock((struct k_mutex *)p1);
+	}
+}
+
+/**
+ * @brief Test mutual exclusion under contention from all CPUs
+ *
+ * With adaptive spinning, waiters mostly take the mutex without pending.
+ */
+void test_mutex_contention(void)
+{
+	protected_count = 0U;
+	k_mutex_init(&mutex);
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_thread_create(&contend_threads[i], contend_stacks[i],
+				STACK_SIZE, tThread_entry_contend, &mutex,
+				NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	}
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		k_thread_join(&contend_threads[i], K_FOREVER);
+	}
+
+	zassert_equal(protected_count, CONFIG_MP_NUM_CPUS * SPIN_ITERATIONS,
+		      NULL);
+
+#ifdef CONFIG_MUTEX_STATS
+	struct k_mutex_stats stats;
+
+	k_mutex_stats_get(&mutex, &stats);
+	TC_PRINT("acquired %u contended %u spun %u wait %u us\n",
+		 stats.acquisitions, stats.contended, stats.spin_acquired,
+		 (u32_t)k_cyc_to_us_floor64(stats.wait_cycles));
+	zassert_equal(stats.acquisitions, protected_count, NULL);
+#endif
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -151,7 +250,9 @@ void test_main(void)
 			 ztest_1cpu_user_unit_test(test_mutex_reent_lock_forever),
 			 ztest_user_unit_test(test_mutex_reent_lock_no_wait),
 			 ztest_user_unit_test(test_mutex_reent_lock_timeout_fail),
-			 ztest_1cpu_user_unit_test(test_mutex_reent_lock_timeout_pass)
+			 ztest_1cpu_user_unit_test(test_mutex_reent_lock_timeout_pass),
+			 ztest_unit_test(test_mutex_stats),
+			 ztest_unit_test(test_mutex_contention)
 			 );
 	ztest_run_test_suite(mutex_api);
 }
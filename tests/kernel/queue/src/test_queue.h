@@ -16,6 +16,7 @@ extern void test_queue_isr2thread(void);
 extern void test_queue_get_2threads(void);
 extern void test_queue_get_fail(void);
 extern void test_queue_loop(void);
+extern void test_queue_get_many(void);
 #ifdef CONFIG_USERSPACE
 extern void test_queue_supv_to_user(void);
 extern void test_auto_free(void);
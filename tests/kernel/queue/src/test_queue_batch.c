@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_queue.h"
+
+#define LIST_LEN 6
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define TIMEOUT K_MSEC(100)
+
+static K_THREAD_STACK_DEFINE(tstack, STACK_SIZE);
+static struct k_thread tdata;
+static struct k_queue queue;
+static qdata_t data[LIST_LEN];
+static void *items[LIST_LEN + 1];
+
+static void tThread_put(void *p1, void *p2, void *p3)
+{
+	k_queue_append((struct k_queue *)p1, &data[0]);
+}
+
+/**
+ * @brief Test getting several elements from a queue at once
+ * @ingroup kernel_queue_tests
+ * @see k_queue_get_many()
+ */
+void test_queue_get_many(void)
+{
+	int ret;
+
+	k_queue_init(&queue);
+
+	for (int i = 0; i < LIST_LEN; i++) {
+		data[i].data = i;
+		k_queue_append(&queue, &data[i]);
+	}
+
+	/**TESTPOINT: get a partial batch, then the rest */
+	ret = k_queue_get_many(&queue, items, 2, K_NO_WAIT);
+	zassert_equal(ret, 2, NULL);
+	ret = k_queue_get_many(&queue, items + 2, ARRAY_SIZE(items) - 2,
+			       K_NO_WAIT);
+	zassert_equal(ret, LIST_LEN - 2, NULL);
+	for (int i = 0; i < LIST_LEN; i++) {
+		zassert_equal_ptr(items[i], &data[i], NULL);
+	}
+	zassert_true(k_queue_is_empty(&queue), NULL);
+
+	/**TESTPOINT: nothing to get */
+	zassert_equal(k_queue_get_many(&queue, items, 1, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_queue_get_many(&queue, items, 1, TIMEOUT), 0, NULL);
+	zassert_equal(k_queue_get_many(&queue, items, 0, TIMEOUT), 0, NULL);
+
+	/**TESTPOINT: wait for an element from another thread */
+	k_thread_create(&tdata, tstack, STACK_SIZE, tThread_put, &queue,
+			NULL, NULL, K_PRIO_PREEMPT(0), 0, K_MSEC(10));
+	ret = k_queue_get_many(&queue, items, LIST_LEN, K_FOREVER);
+	zassert_equal(ret, 1, NULL);
+	zassert_equal_ptr(items[0], &data[0], NULL);
+	k_thread_join(&tdata, K_FOREVER);
+}
@@ -441,6 +441,84 @@ void test_wakeup_threads(void)
 	cleanup_resources();
 }
 
+#define STRESS_THREADS (2 * CONFIG_MP_NUM_CPUS)
+#define STRESS_MS 1000
+
+static struct k_thread stress_thread[STRESS_THREADS];
+static K_THREAD_STACK_ARRAY_DEFINE(stress_stack, STRESS_THREADS, STACK_SIZE);
+
+static volatile bool stress_done;
+static atomic_t stress_switches[STRESS_THREADS];
+static atomic_t stress_cpu_switches[CONFIG_MP_NUM_CPUS];
+
+static void stress_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	int thread_num = POINTER_TO_INT(p1);
+
+	while (!stress_done) {
+		atomic_inc(&stress_switches[thread_num]);
+		atomic_inc(&stress_cpu_switches[curr_cpu()]);
+		k_yield();
+	}
+}
+
+/**
+ * @brief Stress the scheduler with yielding threads on all CPUs
+ *
+ * @ingroup kernel_smp_tests
+ *
+ * @details Spawn twice as many equal priority preemptible threads
+ * as there are cores, all of them created from this CPU, and let
+ * them yield to each other in a loop for a fixed time window.  Every
+ * thread and every core must have made progress, i.e. threads must
+ * be spread over all CPUs.  The context switch rate per core and in
+ * total is reported so it can be compared across core counts and
+ * ready queue configurations.
+ */
+void test_switch_rate_stress(void)
+{
+	u32_t total = 0U;
+	int i;
+
+	stress_done = false;
+	for (i = 0; i < STRESS_THREADS; i++) {
+		atomic_clear(&stress_switches[i]);
+	}
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		atomic_clear(&stress_cpu_switches[i]);
+	}
+
+	for (i = 0; i < STRESS_THREADS; i++) {
+		k_thread_create(&stress_thread[i], stress_stack[i],
+				STACK_SIZE, stress_entry,
+				INT_TO_POINTER(i), NULL, NULL,
+				K_PRIO_PREEMPT(10), 0, K_NO_WAIT);
+	}
+
+	k_msleep(STRESS_MS);
+	stress_done = true;
+
+	for (i = 0; i < STRESS_THREADS; i++) {
+		k_thread_join(&stress_thread[i], K_FOREVER);
+		zassert_true(atomic_get(&stress_switches[i]) > 0,
+			     "thread %d did not run", i);
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		u32_t n = atomic_get(&stress_cpu_switches[i]);
+
+		zassert_true(n > 0, "no switches on CPU %d", i);
+		TC_PRINT("cpu %d: %u switches/s\n", i,
+			 n * MSEC_PER_SEC / STRESS_MS);
+		total += n;
+	}
+
+	TC_PRINT("cpus %d threads %d: %u switches/s\n", CONFIG_MP_NUM_CPUS,
+		 STRESS_THREADS, total * MSEC_PER_SEC / STRESS_MS);
+}
+
 void test_main(void)
 {
 	/* Sleep a bit to guarantee that both CPUs enter an idle
@@ -456,7 +534,8 @@ void test_main(void)
 			 ztest_unit_test(test_preempt_resched_threads),
 			 ztest_unit_test(test_yield_threads),
 			 ztest_unit_test(test_sleep_threads),
-			 ztest_unit_test(test_wakeup_threads)
+			 ztest_unit_test(test_wakeup_threads),
+			 ztest_unit_test(test_switch_rate_stress)
 			 );
 	ztest_run_test_suite(smp);
 }
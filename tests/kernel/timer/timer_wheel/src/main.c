@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+/* Each level of the wheel has 32 slots, each 32 times coarser than the
+ * slots of the level below.  Timeouts further out than WHEEL_RANGE ticks
+ * are parked in the top level.
+ */
+#define WHEEL_BITS 5
+#define WHEEL_RANGE (1 << (WHEEL_BITS * CONFIG_TIMEOUT_WHEEL_LEVELS))
+#define TOP_SLOT (WHEEL_RANGE >> WHEEL_BITS)
+
+#define MAX_TIMERS 12
+
+static struct k_timer timers[MAX_TIMERS];
+static s64_t expected[MAX_TIMERS];
+static s64_t fired[MAX_TIMERS];
+static K_SEM_DEFINE(fired_sem, 0, MAX_TIMERS);
+
+static void expiry_fn(struct k_timer *timer)
+{
+	int i = timer - timers;
+
+	fired[i] = k_uptime_ticks();
+	k_sem_give(&fired_sem);
+}
+
+static void arm_all(const k_ticks_t *durations, int n)
+{
+	for (int i = 0; i < n; i++) {
+		s64_t now;
+
+		k_timer_init(&timers[i], expiry_fn, NULL);
+		fired[i] = -1;
+
+		now = k_uptime_ticks();
+		k_timer_start(&timers[i], K_TICKS(durations[i]), K_NO_WAIT);
+		expected[i] = k_timer_expires_ticks(&timers[i]);
+
+		/* Allow for the tick rounding of the timeout API */
+		zassert_true(expected[i] >= now + durations[i] &&
+			     expected[i] <= now + durations[i] + 2,
+			     "timer %d expires at %lld, armed at %lld for %d",
+			     i, expected[i], now, (int)durations[i]);
+	}
+}
+
+static void check_all(int n)
+{
+	for (int i = 0; i < n; i++) {
+		zassert_equal(k_sem_take(&fired_sem, K_FOREVER), 0, NULL);
+	}
+
+	for (int i = 0; i < n; i++) {
+		zassert_equal(fired[i], expected[i],
+			      "timer %d fired at %lld, expected %lld",
+			      i, fired[i], expected[i]);
+	}
+
+	zassert_equal(k_sem_count_get(&fired_sem), 0, "extra expiries");
+}
+
+/**
+ * @brief Verify timeouts cascading down the wheel levels expire on time
+ *
+ * @details Timers are armed around the slot boundaries of every level
+ * above level 0, so that they are moved to lower levels one or more
+ * times before they expire.  Each must fire exactly on its expiry tick.
+ *
+ * @ingroup kernel_timer_tests
+ */
+void test_wheel_cascade(void)
+{
+	k_ticks_t durations[MAX_TIMERS];
+	int n = 0;
+
+	for (int span = 32; span < WHEEL_RANGE && n + 3 <= MAX_TIMERS;
+	     span <<= WHEEL_BITS) {
+		durations[n++] = span - 1;
+		durations[n++] = span;
+		durations[n++] = span + 1;
+	}
+	durations[n++] = WHEEL_RANGE / 2 + 7;
+	durations[n++] = WHEEL_RANGE - 2;
+
+	arm_all(durations, n);
+	check_all(n);
+}
+
+/**
+ * @brief Verify timeouts past the range of the wheel expire on time
+ *
+ * @details Timers further out than the top level can represent are
+ * parked and re-examined once per rotation of the top level.  They must
+ * still fire exactly on their expiry tick, whether they need one or
+ * several rotations, and in order with timers inside the range.
+ *
+ * @ingroup kernel_timer_tests
+ */
+void test_wheel_parked(void)
+{
+	const k_ticks_t durations[] = {
+		WHEEL_RANGE,
+		WHEEL_RANGE + 1,
+		WHEEL_RANGE + TOP_SLOT - 1,
+		WHEEL_RANGE + TOP_SLOT + 3,
+		2 * WHEEL_RANGE + 5,
+		3 * WHEEL_RANGE - 1,
+		WHEEL_RANGE - 1,
+		5,
+	};
+
+	arm_all(durations, ARRAY_SIZE(durations));
+	check_all(ARRAY_SIZE(durations));
+}
+
+/**
+ * @brief Verify aborted parked and cascading timeouts do not fire
+ *
+ * @details A parked timer and a timer due for cascading are stopped
+ * before they expire, while a later timer is left running.  Only the
+ * running timer may fire.
+ *
+ * @ingroup kernel_timer_tests
+ */
+void test_wheel_abort(void)
+{
+	const k_ticks_t durations[] = {
+		2 * WHEEL_RANGE,
+		TOP_SLOT + 1,
+		2 * WHEEL_RANGE + 1,
+	};
+
+	arm_all(durations, ARRAY_SIZE(durations));
+
+	k_sleep(K_TICKS(TOP_SLOT / 2));
+	k_timer_stop(&timers[0]);
+	k_timer_stop(&timers[1]);
+
+	zassert_equal(k_sem_take(&fired_sem, K_FOREVER), 0, NULL);
+	zassert_equal(fired[0], -1, "stopped parked timer fired");
+	zassert_equal(fired[1], -1, "stopped timer fired");
+	zassert_equal(fired[2], expected[2], "timer fired at %lld, not %lld",
+		      fired[2], expected[2]);
+	zassert_equal(k_sem_count_get(&fired_sem), 0, "extra expiries");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(timer_wheel,
+			 ztest_unit_test(test_wheel_cascade),
+			 ztest_unit_test(test_wheel_parked),
+			 ztest_unit_test(test_wheel_abort));
+	ztest_run_test_suite(timer_wheel);
+}
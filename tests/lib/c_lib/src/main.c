@@ -293,6 +293,155 @@ void test_memcmp(void)
 	zassert_true((ret != 0), "memcmp 5");
 }
 
+/*
+ * Buffers for the alignment tests below. Sizes and offsets are chosen so
+ * that every combination of source/destination misalignment and of head,
+ * word and tail lengths is exercised for 32 and 64 bit words.
+ */
+#define ALIGN_TEST_MAX_LEN 72
+#define ALIGN_TEST_MAX_OFF 8
+#define ALIGN_TEST_BUFSIZE (ALIGN_TEST_MAX_LEN + 2 * ALIGN_TEST_MAX_OFF)
+
+static unsigned char __aligned(8) align_src[ALIGN_TEST_BUFSIZE];
+static unsigned char __aligned(8) align_dst[ALIGN_TEST_BUFSIZE];
+static unsigned char align_ref[ALIGN_TEST_BUFSIZE];
+
+static void align_fill(unsigned char *buf, unsigned char seed)
+{
+	for (int i = 0; i < ALIGN_TEST_BUFSIZE; i++) {
+		/* never zero, and with the top bit set in some bytes */
+		buf[i] = (unsigned char)(seed + i * 37) | 0x01;
+	}
+}
+
+static int sign(int v)
+{
+	return (v > 0) - (v < 0);
+}
+
+/**
+ *
+ * @brief Test memory copy functions on all alignments
+ *
+ */
+
+void test_memcpy_align(void)
+{
+	for (int len = 0; len <= ALIGN_TEST_MAX_LEN; len++) {
+		for (int so = 0; so < ALIGN_TEST_MAX_OFF; so++) {
+			for (int d_o = 0; d_o < ALIGN_TEST_MAX_OFF; d_o++) {
+				align_fill(align_src, len);
+				align_fill(align_dst, so + d_o);
+				memcpy(align_ref, align_dst, ALIGN_TEST_BUFSIZE);
+				for (int i = 0; i < len; i++) {
+					align_ref[d_o + i] = align_src[so + i];
+				}
+
+				memcpy(align_dst + d_o, align_src + so, len);
+				zassert_true(memcmp(align_dst, align_ref,
+						    ALIGN_TEST_BUFSIZE) == 0,
+					     "memcpy len %d src %d dst %d",
+					     len, so, d_o);
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test overlapping memory moves on all alignments
+ *
+ */
+
+void test_memmove_align(void)
+{
+	for (int len = 0; len <= ALIGN_TEST_MAX_LEN; len++) {
+		for (int so = 0; so < 2 * ALIGN_TEST_MAX_OFF; so++) {
+			for (int d_o = 0; d_o < 2 * ALIGN_TEST_MAX_OFF; d_o++) {
+				align_fill(align_dst, len + so);
+				memcpy(align_ref, align_dst, ALIGN_TEST_BUFSIZE);
+				for (int i = 0; i < len; i++) {
+					align_src[i] = align_ref[so + i];
+				}
+				for (int i = 0; i < len; i++) {
+					align_ref[d_o + i] = align_src[i];
+				}
+
+				memmove(align_dst + d_o, align_dst + so, len);
+				zassert_true(memcmp(align_dst, align_ref,
+						    ALIGN_TEST_BUFSIZE) == 0,
+					     "memmove len %d src %d dst %d",
+					     len, so, d_o);
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test memset, memchr, memcmp, strlen and strcmp on all alignments
+ *
+ */
+
+void test_mem_str_align(void)
+{
+	for (int len = 0; len <= ALIGN_TEST_MAX_LEN; len++) {
+		for (int off = 0; off < ALIGN_TEST_MAX_OFF; off++) {
+			unsigned char *p = align_dst + off;
+			unsigned char *q = align_src + (len % 3);
+
+			align_fill(align_dst, off);
+			memcpy(align_ref, align_dst, ALIGN_TEST_BUFSIZE);
+			(void)memset(align_ref + off, 0xa5, len);
+			(void)memset(p, 0x1a5, len);
+			zassert_true(memcmp(align_dst, align_ref,
+					    ALIGN_TEST_BUFSIZE) == 0,
+				     "memset len %d off %d", len, off);
+
+			align_fill(align_dst, len);
+			p[len] = '\0';
+			zassert_equal(strlen((char *)p), len,
+				      "strlen len %d off %d", len, off);
+
+			zassert_is_null(memchr(p, 0, len),
+					"memchr len %d off %d", len, off);
+			if (len > 0) {
+				int c = p[len - 1];
+				unsigned char *first = p;
+
+				while (*first != c) {
+					first++;
+				}
+				zassert_equal_ptr(memchr(p, c, len), first,
+						  "memchr len %d off %d",
+						  len, off);
+			}
+
+			memcpy(q, p, len + 1);
+			zassert_equal(memcmp(p, q, len), 0,
+				      "memcmp len %d off %d", len, off);
+			zassert_equal(strcmp((char *)p, (char *)q), 0,
+				      "strcmp len %d off %d", len, off);
+
+			for (int i = 0; i < len; i += 5) {
+				unsigned char save = q[i];
+
+				/* compare as unsigned char */
+				q[i] = 0x80;
+				zassert_equal(sign(memcmp(p, q, len)),
+					      sign(p[i] - 0x80),
+					      "memcmp len %d off %d at %d",
+					      len, off, i);
+				zassert_equal(sign(strcmp((char *)p, (char *)q)),
+					      sign(p[i] - 0x80),
+					      "strcmp len %d off %d at %d",
+					      len, off, i);
+				q[i] = save;
+			}
+		}
+	}
+}
+
 /**
  *
  * @brief Test binary search function
@@ -335,6 +484,9 @@ void test_main(void)
 			 ztest_unit_test(test_strlen),
 			 ztest_unit_test(test_strcmp),
 			 ztest_unit_test(test_strxspn),
+			 ztest_unit_test(test_memcpy_align),
+			 ztest_unit_test(test_memmove_align),
+			 ztest_unit_test(test_mem_str_align),
 			 ztest_unit_test(test_bsearch)
 			 );
 	ztest_run_test_suite(test_c_lib);
@@ -38,6 +38,7 @@
 
 #define BIG_HEAP_SZ MIN(256 * 1024, MEMSZ / 3)
 #define SMALL_HEAP_SZ MIN(BIG_HEAP_SZ, 2048)
+#define STATS_HEAP_SZ MIN(BIG_HEAP_SZ, 8192)
 #define SCRATCH_SZ (sizeof(heapmem) / 2)
 
 /* The test memory.  Make them pointer arrays for robust alignment
@@ -204,12 +205,403 @@ static void test_big_heap(void)
 	log_result(BIG_HEAP_SZ, &result);
 }
 
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+/* Allocated, free and cached memory must always add up to the same
+ * total, and freeing everything must leave one unfragmented free
+ * chunk (small object slabs excepted, one of which is kept per size
+ * class).
+ */
+static void test_runtime_stats(void)
+{
+	struct sys_heap heap;
+	struct sys_heap_runtime_stats st0, st;
+	void *p[16];
+	size_t total;
+
+	sys_heap_init(&heap, heapmem, STATS_HEAP_SZ);
+	zassert_equal(sys_heap_runtime_stats_get(&heap, &st0), 0, "");
+	zassert_equal(sys_heap_runtime_stats_get(&heap, NULL), -EINVAL, "");
+
+	total = st0.allocated_bytes + st0.free_bytes + st0.cached_bytes;
+	zassert_equal(st0.fragmentation, 0, "fresh heap fragmented");
+	zassert_true(st0.max_free_bytes < st0.free_bytes, "");
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		p[i] = sys_heap_alloc(&heap, 8 + (i % 8) * 12);
+		zassert_not_null(p[i], "alloc %d failed", i);
+	}
+
+	sys_heap_runtime_stats_get(&heap, &st);
+	zassert_equal(st.allocated_bytes + st.free_bytes + st.cached_bytes,
+		      total, "");
+	zassert_true(st.allocated_bytes > st0.allocated_bytes, "");
+
+	/* Free every other block to fragment the heap */
+	for (int i = 0; i < ARRAY_SIZE(p); i += 2) {
+		sys_heap_free(&heap, p[i]);
+	}
+
+	sys_heap_runtime_stats_get(&heap, &st);
+	zassert_equal(st.allocated_bytes + st.free_bytes + st.cached_bytes,
+		      total, "");
+	TC_PRINT("half freed: allocated %zu free %zu cached %zu "
+		 "largest %zu fragmentation %u%%\n", st.allocated_bytes,
+		 st.free_bytes, st.cached_bytes, st.max_free_bytes,
+		 st.fragmentation);
+
+	for (int i = 1; i < ARRAY_SIZE(p); i += 2) {
+		sys_heap_free(&heap, p[i]);
+	}
+
+	sys_heap_runtime_stats_get(&heap, &st);
+	zassert_true(sys_heap_validate(&heap), "");
+	zassert_equal(st.allocated_bytes + st.free_bytes + st.cached_bytes,
+		      total, "");
+	if (!IS_ENABLED(CONFIG_SYS_HEAP_SMALL_OBJECTS)) {
+		zassert_equal(st.allocated_bytes, st0.allocated_bytes, "");
+		zassert_equal(st.fragmentation, 0, "");
+	}
+}
+#else
+static void test_runtime_stats(void)
+{
+	ztest_test_skip();
+}
+#endif
+
+#ifdef CONFIG_SYS_HEAP_SMALL_OBJECTS
+/* Small requests of one size class are carved from the same slab in
+ * fixed strides, and every freed block is reused before the heap
+ * grows the class again.
+ */
+static void test_small_objects(void)
+{
+	struct sys_heap heap;
+	void *p[CONFIG_SYS_HEAP_SMALL_OBJECT_BLOCKS];
+	void *q;
+
+	/* Big enough for slab_new() to carve slabs from it */
+	sys_heap_init(&heap, heapmem, STATS_HEAP_SZ);
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		p[i] = sys_heap_alloc(&heap, 30);
+		zassert_not_null(p[i], "");
+		fill_block(p[i], 30);
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+		if (i == 0) {
+			struct sys_heap_runtime_stats st;
+
+			/* The rest of the slab waits in the class */
+			sys_heap_runtime_stats_get(&heap, &st);
+			zassert_true(st.cached_bytes >= 30 * (ARRAY_SIZE(p) - 1),
+				     "no slab created");
+		}
+#endif
+		if (i > 1) {
+			zassert_equal((u8_t *)p[i] - (u8_t *)p[i - 1],
+				      (u8_t *)p[1] - (u8_t *)p[0],
+				      "blocks not in one slab");
+		}
+	}
+	zassert_true(sys_heap_validate(&heap), "");
+
+	/* A freed block is handed out again right away */
+	sys_heap_free(&heap, p[3]);
+	q = sys_heap_alloc(&heap, 25);
+	zassert_equal(q, p[3], "freed block not reused");
+	fill_block(q, 25);
+
+	/* The next one comes from a fresh slab */
+	q = sys_heap_alloc(&heap, 32);
+	zassert_not_null(q, "");
+	zassert_true(q < p[0] || q > p[ARRAY_SIZE(p) - 1], "");
+	zassert_true(sys_heap_validate(&heap), "");
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		check_fill(p[i]);
+		sys_heap_free(&heap, p[i]);
+	}
+	sys_heap_free(&heap, q);
+	zassert_true(sys_heap_validate(&heap), "");
+}
+#else
+static void test_small_objects(void)
+{
+	ztest_test_skip();
+}
+#endif
+
+/* Aligned allocations must honor every power-of-two alignment on
+ * both heap layouts and leave the heap intact.
+ */
+static void test_aligned_alloc(void)
+{
+	struct sys_heap heap;
+	void *p[8];
+	size_t heap_sz[] = { SMALL_HEAP_SZ, BIG_HEAP_SZ };
+
+	for (int h = 0; h < ARRAY_SIZE(heap_sz); h++) {
+		sys_heap_init(&heap, heapmem, heap_sz[h]);
+
+		for (int i = 0; i < ARRAY_SIZE(p); i++) {
+			size_t align = 4 << i;
+
+			p[i] = sys_heap_aligned_alloc(&heap, align, 24 + i);
+			zassert_not_null(p[i], "align %zu failed", align);
+			zassert_true(((uintptr_t)p[i] & (align - 1)) == 0,
+				     "%p not aligned to %zu", p[i], align);
+			fill_block(p[i], 24 + i);
+			zassert_true(sys_heap_validate(&heap), "");
+		}
+
+		for (int i = 0; i < ARRAY_SIZE(p); i++) {
+			check_fill(p[i]);
+			sys_heap_free(&heap, p[i]);
+			zassert_true(sys_heap_validate(&heap), "");
+		}
+	}
+}
+
+static void fill_pattern(u8_t *p, size_t from, size_t to)
+{
+	for (size_t i = from; i < to; i++) {
+		p[i] = (u8_t)(i * 7);
+	}
+}
+
+static bool check_pattern(u8_t *p, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (p[i] != (u8_t)(i * 7)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Grow a buffer in small steps the way a dynamic array does, with
+ * some unrelated allocations in between, and count how many of the
+ * copies a plain alloc+copy+free resize would do are avoided.
+ */
+static void test_realloc(void)
+{
+	struct sys_heap heap;
+	void *others[16];
+	int n_others = 0, in_place = 0, moved = 0;
+	size_t copied = 0, naive = 0;
+	size_t len = 16;
+	u8_t *buf, *p;
+
+	sys_heap_init(&heap, heapmem, STATS_HEAP_SZ);
+
+	buf = sys_heap_realloc(&heap, NULL, len);
+	zassert_not_null(buf, "");
+	fill_pattern(buf, 0, len);
+
+	while (len < 2048) {
+		size_t new_len = len + 48;
+
+		if ((len / 48) % 6 == 0 && n_others < ARRAY_SIZE(others)) {
+			others[n_others++] = sys_heap_alloc(&heap, 40);
+		}
+
+		p = sys_heap_realloc(&heap, buf, new_len);
+		zassert_not_null(p, "realloc to %zu failed", new_len);
+		zassert_true(check_pattern(p, len), "contents lost");
+		zassert_true(sys_heap_validate(&heap), "");
+
+		naive += len;
+		if (p == buf) {
+			in_place++;
+		} else {
+			moved++;
+			copied += len;
+		}
+
+		buf = p;
+		fill_pattern(buf, len, new_len);
+		len = new_len;
+	}
+
+	TC_PRINT("realloc: %d in place, %d moved, copied %zu of %zu bytes\n",
+		 in_place, moved, copied, naive);
+	zassert_true(in_place > moved, "too few in place resizes");
+
+	/* Shrinking never moves */
+	p = sys_heap_realloc(&heap, buf, 100);
+	zassert_equal(p, buf, "shrink moved the block");
+	zassert_true(check_pattern(p, 100), "");
+	zassert_true(sys_heap_validate(&heap), "");
+
+	/* Zero size frees */
+	zassert_is_null(sys_heap_realloc(&heap, buf, 0), "");
+	for (int i = 0; i < n_others; i++) {
+		sys_heap_free(&heap, others[i]);
+	}
+	zassert_true(sys_heap_validate(&heap), "");
+}
+
+/* A block grows in place into a free right neighbor and shrinks in
+ * place, one that can't grow in place moves with its contents.  Sizes
+ * stay above the small object classes so the general allocator is used.
+ */
+static void test_realloc_in_place(void)
+{
+	struct sys_heap heap;
+	u8_t *a, *b, *c, *p, *q;
+
+	sys_heap_init(&heap, heapmem, STATS_HEAP_SZ);
+
+	a = sys_heap_alloc(&heap, 256);
+	b = sys_heap_alloc(&heap, 256);
+	c = sys_heap_alloc(&heap, 256);
+	zassert_true(a != NULL && b != NULL && c != NULL, "");
+	fill_pattern(a, 0, 256);
+
+	sys_heap_free(&heap, b);
+	p = sys_heap_realloc(&heap, a, 480);
+	zassert_equal(p, a, "growth into a free neighbor moved the block");
+	zassert_true(check_pattern(p, 256), "contents lost growing");
+	fill_pattern(p, 256, 480);
+	zassert_true(sys_heap_validate(&heap), "");
+
+	p = sys_heap_realloc(&heap, a, 300);
+	zassert_equal(p, a, "shrink moved the block");
+	zassert_true(check_pattern(p, 300), "contents lost shrinking");
+	zassert_true(sys_heap_validate(&heap), "");
+
+	/* The tail given back is usable right away */
+	q = sys_heap_alloc(&heap, 150);
+	zassert_not_null(q, "");
+	zassert_true(q > a && q < c, "shrunk tail not reused");
+
+	/* Boxed in by allocated neighbors, the block has to move */
+	p = sys_heap_realloc(&heap, a, 1024);
+	zassert_not_null(p, "");
+	zassert_not_equal(p, a, "");
+	zassert_true(check_pattern(p, 300), "contents lost moving");
+	zassert_true(sys_heap_validate(&heap), "");
+
+	/* Aligned blocks stay aligned when they move */
+	a = sys_heap_aligned_alloc(&heap, 256, 200);
+	zassert_not_null(a, "");
+	zassert_true(((uintptr_t)a & 255) == 0, "");
+	fill_pattern(a, 0, 200);
+	b = sys_heap_alloc(&heap, 150);
+	a = sys_heap_aligned_realloc(&heap, a, 256, 700);
+	zassert_not_null(a, "");
+	zassert_true(((uintptr_t)a & 255) == 0, "moved block not aligned");
+	zassert_true(check_pattern(a, 200), "aligned contents lost");
+	zassert_true(sys_heap_validate(&heap), "");
+
+	/* Blocks not aligned yet are moved to an aligned address */
+	p = sys_heap_aligned_realloc(&heap, p, 512, 1024);
+	zassert_not_null(p, "");
+	zassert_true(((uintptr_t)p & 511) == 0, "block not realigned");
+	zassert_true(check_pattern(p, 300), "contents lost realigning");
+	zassert_true(sys_heap_validate(&heap), "");
+
+	sys_heap_free(&heap, a);
+	sys_heap_free(&heap, b);
+	sys_heap_free(&heap, c);
+	sys_heap_free(&heap, p);
+	sys_heap_free(&heap, q);
+	zassert_true(sys_heap_validate(&heap), "");
+}
+
+K_HEAP_DEFINE(test_k_heap, 2048);
+
+/* k_heap_aligned_alloc() honors the alignment and times out, instead
+ * of waiting forever, when the heap can't satisfy the request.
+ */
+static void test_k_heap_aligned_alloc(void)
+{
+	void *p[6];
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		size_t align = 8 << i;
+
+		p[i] = k_heap_aligned_alloc(&test_k_heap, align, 40, K_NO_WAIT);
+		zassert_not_null(p[i], "align %zu failed", align);
+		zassert_true(((uintptr_t)p[i] & (align - 1)) == 0,
+			     "%p not aligned to %zu", p[i], align);
+		fill_block(p[i], 40);
+	}
+
+	zassert_is_null(k_heap_aligned_alloc(&test_k_heap, 64, 4096,
+					     K_MSEC(10)), "");
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		check_fill(p[i]);
+		k_heap_free(&test_k_heap, p[i]);
+	}
+
+	p[0] = k_heap_aligned_alloc(&test_k_heap, 512, 1024, K_NO_WAIT);
+	zassert_not_null(p[0], "heap not restored after free");
+	zassert_true(((uintptr_t)p[0] & 511) == 0, "");
+	k_heap_free(&test_k_heap, p[0]);
+}
+
+/* What malloc() and k_malloc() ask for: small blocks, aligned to
+ * 8 bytes, which must come straight from the small object slabs on a
+ * small heap rather than from the aligned allocation path.
+ */
+static void test_small_alloc_alignment(void)
+{
+	struct sys_heap heap;
+	void *p[3];
+
+	sys_heap_init(&heap, heapmem, SMALL_HEAP_SZ);
+
+	p[0] = sys_heap_alloc(&heap, 16);
+	p[1] = sys_heap_aligned_alloc(&heap, 8, 16);
+	p[2] = k_heap_alloc(&test_k_heap, 16, K_NO_WAIT);
+
+	for (int i = 0; i < ARRAY_SIZE(p); i++) {
+		zassert_not_null(p[i], "alloc %d failed", i);
+		zassert_true(((uintptr_t)p[i] & 7) == 0,
+			     "%p not aligned to 8", p[i]);
+	}
+
+#if defined(CONFIG_SYS_HEAP_SMALL_OBJECTS) && \
+	defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+	struct sys_heap_runtime_stats st0, st;
+
+	/* Each further block is taken from the slab cache */
+	zassert_equal(sys_heap_runtime_stats_get(&heap, &st0), 0, "");
+	zassert_true(st0.cached_bytes > 0, "no slab behind the blocks");
+	sys_heap_free(&heap, p[1]);
+	zassert_equal(sys_heap_runtime_stats_get(&heap, &st), 0, "");
+	zassert_true(st.cached_bytes > st0.cached_bytes, "");
+	p[1] = sys_heap_aligned_alloc(&heap, 8, 16);
+	zassert_equal(sys_heap_runtime_stats_get(&heap, &st), 0, "");
+	zassert_equal(st.cached_bytes, st0.cached_bytes,
+		      "aligned block not served from the slab");
+
+	zassert_equal(sys_heap_runtime_stats_get(&test_k_heap.heap, &st),
+		      0, "");
+	zassert_true(st.cached_bytes > 0, "k_heap block not from a slab");
+#endif
+
+	k_heap_free(&test_k_heap, p[2]);
+	sys_heap_free(&heap, p[1]);
+	sys_heap_free(&heap, p[0]);
+	zassert_true(sys_heap_validate(&heap), "");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_heap_test,
 			 ztest_unit_test(test_small_heap),
 			 ztest_unit_test(test_fragmentation),
-			 ztest_unit_test(test_big_heap)
+			 ztest_unit_test(test_big_heap),
+			 ztest_unit_test(test_runtime_stats),
+			 ztest_unit_test(test_small_objects),
+			 ztest_unit_test(test_aligned_alloc),
+			 ztest_unit_test(test_realloc),
+			 ztest_unit_test(test_realloc_in_place),
+			 ztest_unit_test(test_k_heap_aligned_alloc),
+			 ztest_unit_test(test_small_alloc_alignment)
 			 );
 
 	ztest_run_test_suite(lib_heap_test);
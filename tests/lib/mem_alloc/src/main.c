@@ -108,6 +108,77 @@ void test_realloc(void)
 	ptr = NULL;
 }
 
+/**
+ * @brief Test realloc resizing a block in place
+ *
+ * The minimal libc grows a block into free memory right after it and
+ * shrinks it without moving, and every block it returns is aligned for
+ * 64 bit types.
+ *
+ * @see malloc(), realloc(), free()
+ */
+#ifndef CONFIG_MINIMAL_LIBC
+void test_realloc_in_place(void)
+{
+	/* Other C libraries give no guarantee about block placement */
+	ztest_test_skip();
+}
+#else
+static void fill_pattern(unsigned char *p, size_t from, size_t to)
+{
+	for (size_t i = from; i < to; i++) {
+		p[i] = (unsigned char)(i * 7);
+	}
+}
+
+static bool check_pattern(unsigned char *p, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (p[i] != (unsigned char)(i * 7)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void test_realloc_in_place(void)
+{
+	unsigned char *a, *b, *c, *ptr;
+
+	a = malloc(200);
+	b = malloc(200);
+	c = malloc(200);
+	zassert_true(a != NULL && b != NULL && c != NULL,
+		     "malloc failed, errno: %d", errno);
+	fill_pattern(a, 0, 200);
+
+	free(b);
+	ptr = realloc(a, 380);
+	zassert_equal(ptr, a, "growth into free memory moved the block");
+	zassert_true(check_pattern(ptr, 200), "contents lost growing");
+	zassert_true(((uintptr_t)ptr & 7) == 0, "%p misaligned", ptr);
+
+	ptr = realloc(a, 100);
+	zassert_equal(ptr, a, "shrink moved the block");
+	zassert_true(check_pattern(ptr, 100), "contents lost shrinking");
+
+	/* An odd sized neighbor leaves the next block aligned too */
+	b = malloc(13);
+	zassert_not_null(b, "malloc failed, errno: %d", errno);
+	zassert_true(((uintptr_t)b & 7) == 0, "%p misaligned", b);
+
+	/* Growing past its in use neighbors moves it, still aligned */
+	ptr = realloc(a, 700);
+	zassert_not_null(ptr, "realloc failed, errno: %d", errno);
+	zassert_true(((uintptr_t)ptr & 7) == 0, "%p misaligned", ptr);
+	zassert_true(check_pattern(ptr, 100), "contents lost moving");
+
+	free(ptr);
+	free(b);
+	free(c);
+}
+#endif
+
 /**
  * @brief Test dynamic memory allocation using reallocarray
  *
@@ -203,6 +274,7 @@ void test_main(void)
 			 ztest_user_unit_test(test_free),
 			 ztest_user_unit_test(test_calloc),
 			 ztest_user_unit_test(test_realloc),
+			 ztest_user_unit_test(test_realloc_in_place),
 			 ztest_user_unit_test(test_reallocarray),
 			 ztest_user_unit_test(test_memalloc_all),
 			 ztest_user_unit_test(test_memalloc_max)
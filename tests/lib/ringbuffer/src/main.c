@@ -443,6 +443,204 @@ void test_reset(void)
 	zassert_true(granted == RINGBUFFER_SIZE - 1, NULL);
 }
 
+/*
+ * Concurrency tests: producers and a consumer run without any locking.
+ * On SMP targets they run on different CPUs; elsewhere they preempt each
+ * other or run from a timer ISR.
+ */
+
+#define STRESS_STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define STRESS_BYTES 100000
+#define STRESS_ITEMS 5000
+#define STRESS_TICKS 50
+#define STRESS_PRODUCERS 2
+
+static K_THREAD_STACK_ARRAY_DEFINE(stress_stacks, STRESS_PRODUCERS + 1,
+				   STRESS_STACK_SIZE);
+static struct k_thread stress_threads[STRESS_PRODUCERS + 1];
+static u8_t stress_data[61];
+static struct ring_buf stress_buf;
+static u32_t stress_words[16];
+
+/* Byte stream pattern, with a period not matching the buffer size */
+static inline u8_t stress_byte(u32_t seq)
+{
+	return (u8_t)(seq % 251U);
+}
+
+static void spsc_producer(void *p1, void *p2, void *p3)
+{
+	u32_t seq = 0U;
+
+	while (seq < STRESS_BYTES) {
+		u8_t *data;
+		u32_t want = MIN(1U + (seq % 23U), STRESS_BYTES - seq);
+		u32_t n = ring_buf_put_claim(&stress_buf, &data, want);
+
+		for (u32_t i = 0U; i < n; i++) {
+			data[i] = stress_byte(seq + i);
+		}
+		zassert_equal(ring_buf_put_finish(&stress_buf, n), 0, NULL);
+		seq += n;
+
+		if (n == 0U) {
+			k_yield();
+		}
+	}
+}
+
+static u32_t spsc_consume(u32_t seq, bool sleep)
+{
+	u8_t *data;
+	u32_t n = ring_buf_get_claim(&stress_buf, &data,
+				     1U + (seq % 17U));
+
+	for (u32_t i = 0U; i < n; i++) {
+		zassert_equal(data[i], stress_byte(seq + i),
+			      "byte %u corrupted", seq + i);
+	}
+	zassert_equal(ring_buf_get_finish(&stress_buf, n), 0, NULL);
+
+	if (n == 0U) {
+		if (sleep) {
+			k_msleep(1);
+		} else {
+			k_yield();
+		}
+	}
+
+	return seq + n;
+}
+
+/**
+ * @brief Test one producer and one consumer thread without locking
+ */
+void test_ringbuffer_spsc_stress(void)
+{
+	u32_t seq = 0U;
+
+	ring_buf_init(&stress_buf, sizeof(stress_data), stress_data);
+
+	k_thread_create(&stress_threads[0], stress_stacks[0],
+			STRESS_STACK_SIZE, spsc_producer, NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	while (seq < STRESS_BYTES) {
+		seq = spsc_consume(seq, false);
+	}
+
+	k_thread_join(&stress_threads[0], K_FOREVER);
+	zassert_true(ring_buf_is_empty(&stress_buf), NULL);
+}
+
+static u32_t isr_seq;
+
+static void spsc_timer_producer(struct k_timer *timer)
+{
+	u8_t *data;
+	u32_t n;
+
+	do {
+		n = ring_buf_put_claim(&stress_buf, &data, UINT32_MAX);
+		for (u32_t i = 0U; i < n; i++) {
+			data[i] = stress_byte(isr_seq + i);
+		}
+		(void)ring_buf_put_finish(&stress_buf, n);
+		isr_seq += n;
+	} while (n != 0U);
+}
+
+/**
+ * @brief Test a producer ISR and a consumer thread without locking
+ */
+void test_ringbuffer_spsc_isr_stress(void)
+{
+	struct k_timer timer;
+	u32_t seq = 0U;
+	u32_t total;
+
+	ring_buf_init(&stress_buf, sizeof(stress_data), stress_data);
+	isr_seq = 0U;
+
+	k_timer_init(&timer, spsc_timer_producer, NULL);
+	k_timer_start(&timer, K_TICKS(1), K_TICKS(1));
+
+	/* the ISR fills the buffer at every tick */
+	total = STRESS_TICKS * (sizeof(stress_data) - 1);
+	while (seq < total) {
+		seq = spsc_consume(seq, true);
+	}
+
+	k_timer_stop(&timer);
+}
+
+static void mpsc_producer(void *p1, void *p2, void *p3)
+{
+	u16_t id = POINTER_TO_UINT(p1);
+	u32_t data[3];
+
+	for (u32_t seq = 0U; seq < STRESS_ITEMS; seq++) {
+		u8_t size32 = seq % ARRAY_SIZE(data) + 1;
+
+		for (int i = 0; i < size32; i++) {
+			data[i] = seq ^ (id << 24);
+		}
+
+		while (ring_buf_item_put_mp(&stress_buf, id, size32, data,
+					    size32) != 0) {
+			k_yield();
+		}
+	}
+}
+
+/**
+ * @brief Test several item producers and one consumer without locking
+ */
+void test_ringbuffer_mpsc_item_stress(void)
+{
+	u32_t next[STRESS_PRODUCERS] = { 0 };
+	u32_t received = 0U;
+	int prio = k_thread_priority_get(k_current_get());
+
+	ring_buf_init(&stress_buf, ARRAY_SIZE(stress_words), stress_words);
+
+	for (int i = 0; i < STRESS_PRODUCERS; i++) {
+		k_thread_create(&stress_threads[i], stress_stacks[i],
+				STRESS_STACK_SIZE, mpsc_producer,
+				UINT_TO_POINTER(i), NULL, NULL, prio, 0,
+				K_NO_WAIT);
+	}
+
+	while (received < STRESS_PRODUCERS * STRESS_ITEMS) {
+		u32_t data[3];
+		u8_t size32 = ARRAY_SIZE(data);
+		u16_t type;
+		u8_t value;
+
+		if (ring_buf_item_get(&stress_buf, &type, &value, data,
+				      &size32) != 0) {
+			k_yield();
+			continue;
+		}
+
+		zassert_true(type < STRESS_PRODUCERS, "bad producer %u", type);
+		zassert_equal(size32, next[type] % ARRAY_SIZE(data) + 1,
+			      NULL);
+		zassert_equal(value, size32, NULL);
+		for (int i = 0; i < size32; i++) {
+			zassert_equal(data[i], next[type] ^ (type << 24),
+				      "producer %u item %u", type, next[type]);
+		}
+		next[type]++;
+		received++;
+	}
+
+	for (int i = 0; i < STRESS_PRODUCERS; i++) {
+		k_thread_join(&stress_threads[i], K_FOREVER);
+	}
+	zassert_true(ring_buf_is_empty(&stress_buf), NULL);
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -461,7 +659,10 @@ void test_main(void)
 			 ztest_unit_test(test_byte_put_free),
 			 ztest_unit_test(test_byte_put_free),
 			 ztest_unit_test(test_capacity),
-			 ztest_unit_test(test_reset)
+			 ztest_unit_test(test_reset),
+			 ztest_unit_test(test_ringbuffer_spsc_stress),
+			 ztest_unit_test(test_ringbuffer_spsc_isr_stress),
+			 ztest_unit_test(test_ringbuffer_mpsc_item_stress)
 			 );
 	ztest_run_test_suite(test_ringbuffer_api);
 }
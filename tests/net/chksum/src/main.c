@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_UTILS_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <bench_time.h>
+
+#include "net_private.h"
+
+/* Compute the checksum of the same packet ITERATIONS times, the packet being
+ * split in fragments of increasing sizes.
+ */
+
+#define ITERATIONS	20000
+#define PKT_LEN		1500
+#define IP_HDR_LEN	20
+
+/* Offset of the field rewritten, the acknowledgment number of a TCP header */
+#define FIELD_OFFSET	(IP_HDR_LEN + 8)
+#define FIELD_LEN	4
+
+static const u16_t frag_sizes[] = { 64, 128, 256, 512, 1500 };
+
+NET_BUF_POOL_FIXED_DEFINE(frag_pool, PKT_LEN / 64 + 1, PKT_LEN + 4, NULL);
+
+static u8_t data[PKT_LEN];
+
+static struct net_pkt *pkt_create(u16_t frag_size)
+{
+	struct net_pkt *pkt;
+	struct net_buf *buf;
+	size_t pos = 0;
+	size_t len;
+
+	pkt = net_pkt_alloc(K_NO_WAIT);
+	if (!pkt) {
+		printk("Cannot allocate packet\n");
+		k_oops();
+	}
+
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ip_hdr_len(pkt, IP_HDR_LEN);
+
+	for (int i = 0; pos < PKT_LEN; i++) {
+		len = MIN(frag_size, PKT_LEN - pos);
+
+		buf = net_buf_alloc(&frag_pool, K_NO_WAIT);
+		if (!buf) {
+			printk("Cannot allocate fragment\n");
+			k_oops();
+		}
+
+		/* Vary the alignment of the fragments */
+		net_buf_reserve(buf, i % 4);
+		net_buf_add_mem(buf, &data[pos], len);
+		net_pkt_append_buffer(pkt, buf);
+		pos += len;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static u64_t chksum_run(struct net_pkt *pkt, u16_t *chksum)
+{
+	struct bench_time start;
+
+	bench_time_start(&start);
+	for (u32_t i = 0; i < ITERATIONS; i++) {
+		*chksum = net_calc_chksum(pkt, IPPROTO_UDP);
+	}
+
+	return bench_time_ns(&start);
+}
+
+static void update_run(u16_t chksum, u64_t full_ns)
+{
+	u8_t old[FIELD_LEN], new[FIELD_LEN];
+	struct bench_time start;
+	u64_t ns;
+
+	memcpy(old, &data[FIELD_OFFSET], FIELD_LEN);
+
+	bench_time_start(&start);
+	for (u32_t i = 0; i < ITERATIONS; i++) {
+		sys_put_be32(i, new);
+		chksum = net_chksum_update(chksum, old, new, FIELD_LEN);
+		memcpy(old, new, FIELD_LEN);
+	}
+	ns = bench_time_ns(&start);
+
+	printk("update %4u bytes %6u ns   full sum %6u ns\n", FIELD_LEN,
+	       (u32_t)(ns / ITERATIONS), (u32_t)(full_ns / ITERATIONS));
+
+	/* Keep the result alive */
+	if (chksum == 0x1234) {
+		printk("\n");
+	}
+}
+
+void main(void)
+{
+	struct net_pkt *pkt;
+	u64_t full_ns = 0U;
+	u16_t chksum = 0U;
+	u64_t ns;
+
+	for (int i = 0; i < PKT_LEN; i++) {
+		data[i] = i * 7 + (i >> 8);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(frag_sizes); i++) {
+		pkt = pkt_create(frag_sizes[i]);
+		ns = chksum_run(pkt, &chksum);
+		net_pkt_unref(pkt);
+
+		if (frag_sizes[i] == PKT_LEN) {
+			full_ns = ns;
+		}
+
+		printk("fragments %4u bytes %6u ns/pkt %6u MB/s\n",
+		       frag_sizes[i], (u32_t)(ns / ITERATIONS),
+		       ns ? (u32_t)((u64_t)PKT_LEN * ITERATIONS * 1000U / ns) :
+		       0);
+	}
+
+	update_run(chksum, full_ns);
+
+	printk("fin\n");
+}
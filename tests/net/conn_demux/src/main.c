@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_UDP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+#include <bench_time.h>
+
+#include "connection.h"
+
+/* Match the same packet ITERATIONS times against an increasing number of
+ * registered handlers. The packet is for the handler registered first.
+ */
+
+#define ITERATIONS	20000
+#define LOCAL_PORT	5683
+#define REMOTE_PORT	40000
+
+static const u32_t counts[] = { 1, 8, 32, 128, 256 };
+
+static struct in_addr local = { { { 192, 0, 2, 1 } } };
+static struct in_addr remote = { { { 192, 0, 2, 2 } } };
+
+static struct net_conn_handle *handles[CONFIG_NET_MAX_CONN];
+static u32_t received;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api dummy_api = {
+	.iface_api.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+NET_DEVICE_INIT(conn_demux_test, "conn_demux_test", dummy_dev_init,
+		device_pm_control_nop, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &dummy_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static enum net_verdict recv_cb(struct net_conn *conn, struct net_pkt *pkt,
+				union net_ip_header *ip_hdr,
+				union net_proto_header *proto_hdr,
+				void *user_data)
+{
+	/* The packet is reused, it is not consumed */
+	if (user_data == &handles[0]) {
+		received++;
+	}
+
+	return NET_OK;
+}
+
+static void handlers_register(u32_t count, bool connected)
+{
+	struct sockaddr_in remote_addr = {
+		.sin_family = AF_INET,
+		.sin_addr = remote,
+	};
+	int ret;
+
+	for (u32_t i = 0; i < count; i++) {
+		ret = net_conn_register(IPPROTO_UDP, AF_INET,
+					connected ?
+					(struct sockaddr *)&remote_addr : NULL,
+					NULL,
+					connected ? REMOTE_PORT + i : REMOTE_PORT,
+					connected ? LOCAL_PORT : LOCAL_PORT + i,
+					recv_cb, &handles[i], &handles[i]);
+		if (ret < 0) {
+			printk("Cannot register handler %u (%d)\n", i, ret);
+			k_oops();
+		}
+	}
+}
+
+static void handlers_unregister(u32_t count)
+{
+	for (u32_t i = 0; i < count; i++) {
+		net_conn_unregister(handles[i]);
+	}
+}
+
+static void bench_run(const char *name, u32_t count, bool connected)
+{
+	struct net_ipv4_hdr ipv4 = {
+		.vhl = 0x45,
+		.proto = IPPROTO_UDP,
+	};
+	struct net_udp_hdr udp = {
+		.src_port = htons(REMOTE_PORT),
+		.dst_port = htons(LOCAL_PORT),
+	};
+	union net_ip_header ip_hdr = { .ipv4 = &ipv4 };
+	union net_proto_header proto_hdr = { .udp = &udp };
+	struct net_pkt *pkt;
+	struct bench_time start;
+	u64_t ns;
+
+	net_ipaddr_copy(&ipv4.src, &remote);
+	net_ipaddr_copy(&ipv4.dst, &local);
+
+	pkt = net_pkt_alloc(K_NO_WAIT);
+	if (!pkt) {
+		printk("Cannot allocate packet\n");
+		k_oops();
+	}
+
+	net_pkt_set_iface(pkt, net_if_get_default());
+	net_pkt_set_family(pkt, AF_INET);
+
+	handlers_register(count, connected);
+	received = 0U;
+
+	bench_time_start(&start);
+	for (u32_t i = 0; i < ITERATIONS; i++) {
+		(void)net_conn_input(pkt, &ip_hdr, IPPROTO_UDP, &proto_hdr);
+	}
+	ns = bench_time_ns(&start);
+
+	handlers_unregister(count);
+	net_pkt_unref(pkt);
+
+	if (received != ITERATIONS) {
+		printk("%s: %u packets of %u received\n", name, received,
+		       ITERATIONS);
+		k_oops();
+	}
+
+	printk("%-9s %4u handlers %6u ns/pkt %9u pkts/s\n", name, count,
+	       (u32_t)(ns / ITERATIONS),
+	       ns ? (u32_t)((u64_t)ITERATIONS * NSEC_PER_SEC / ns) : 0);
+}
+
+void main(void)
+{
+	net_if_ipv4_addr_add(net_if_get_default(), &local, NET_ADDR_MANUAL,
+			     0);
+
+	for (int i = 0; i < ARRAY_SIZE(counts); i++) {
+		bench_run("listening", counts[i], false);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(counts); i++) {
+		bench_run("connected", counts[i], true);
+	}
+
+	printk("fin\n");
+}
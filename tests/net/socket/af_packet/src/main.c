@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 #include <net/socket.h>
 #include <net/ethernet.h>
+#include <net/net_pkt.h>
 
 #if defined(CONFIG_NET_SOCKETS_LOG_LEVEL_DBG)
 #define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
@@ -120,6 +121,37 @@ static void iface_cb(struct net_if *iface, void *user_data)
 	ud->second = iface;
 }
 
+/* Feed an Ethernet frame to the interface and read it back, L2 header
+ * included, from the packet socket bound to it.
+ */
+static void recv_frame(int sock, struct net_if *iface)
+{
+	static const u8_t frame[] = {
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, /* dst lladdr1 */
+		0x02, 0x02, 0x02, 0x02, 0x02, 0x02, /* src lladdr2 */
+		0x88, 0xb5,                         /* local experimental */
+		'p', 'a', 'c', 'k', 'e', 't'
+	};
+	u8_t buf[sizeof(frame) + 1];
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(frame), AF_UNSPEC,
+					   0, K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	ret = net_pkt_write(pkt, frame, sizeof(frame));
+	zassert_equal(ret, 0, "Cannot write frame (%d)", ret);
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "Cannot receive frame (%d)", ret);
+
+	ret = recv(sock, buf, sizeof(buf), 0);
+	zassert_equal(ret, sizeof(frame), "Invalid recv length (%d/%d)",
+		      ret, -errno);
+	zassert_mem_equal(buf, frame, sizeof(frame), "Invalid frame data");
+}
+
 static void test_packet_sockets(void)
 {
 	struct user_data ud = { 0 };
@@ -141,6 +173,8 @@ static void test_packet_sockets(void)
 
 	ret = bind_socket(sock2, ud.second);
 	zassert_equal(ret, 0, "Cannot bind 2nd socket (%d)", -errno);
+
+	recv_frame(sock1, ud.first);
 }
 
 void test_main(void)
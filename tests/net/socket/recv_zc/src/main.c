@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/socket.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <bench_time.h>
+
+/* Send TOTAL bytes over a TCP connection on the loopback interface and
+ * receive them with recv() into a buffer, then with zsock_recv_zc() reading
+ * the data in place. The data is checked in both cases.
+ */
+
+#define TOTAL		(1024 * 1024)
+#define CHUNK		4096
+#define SERVER_PORT	4242
+
+#define SENDER_STACK_SIZE 2048
+
+static struct in_addr addr = { { { 127, 0, 0, 1 } } };
+
+static struct sockaddr_in server = {
+	.sin_family = AF_INET,
+	.sin_port = htons(SERVER_PORT),
+	.sin_addr = { { { 127, 0, 0, 1 } } },
+};
+
+static K_THREAD_STACK_DEFINE(sender_stack, SENDER_STACK_SIZE);
+static struct k_thread sender_thread;
+
+static u8_t tx_buf[CHUNK];
+static u8_t rx_buf[CHUNK];
+
+static u8_t pattern(u32_t offset)
+{
+	return offset * 7 + (offset >> 12);
+}
+
+static void fail(const char *msg)
+{
+	printk("%s (%d)\n", msg, errno);
+	k_oops();
+}
+
+static void sender(void *p1, void *p2, void *p3)
+{
+	u32_t sent = 0U;
+	ssize_t ret;
+	int sock;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0 ||
+	    connect(sock, (struct sockaddr *)&server, sizeof(server)) < 0) {
+		fail("Cannot connect");
+	}
+
+	while (sent < TOTAL) {
+		for (int i = 0; i < CHUNK; i++) {
+			tx_buf[i] = pattern(sent + i);
+		}
+
+		ret = send(sock, tx_buf, MIN(CHUNK, TOTAL - sent), 0);
+		if (ret < 0) {
+			fail("Cannot send");
+		}
+
+		/* Short writes are resent from the start of the next chunk */
+		sent += ret;
+	}
+
+	close(sock);
+}
+
+static bool check(const u8_t *data, size_t len, u32_t offset)
+{
+	bool ok = true;
+
+	for (size_t i = 0; i < len; i++) {
+		ok &= (data[i] == pattern(offset + i));
+	}
+
+	return ok;
+}
+
+/* Check the data in the packet fragments, from the packet cursor */
+static bool check_pkt(struct net_pkt *pkt, size_t len, u32_t offset)
+{
+	struct net_buf *buf = pkt->cursor.buf;
+	u8_t *pos = pkt->cursor.pos;
+	bool ok = true;
+	size_t n;
+
+	while (buf && len) {
+		n = MIN(len, buf->len - (pos - buf->data));
+		ok &= check(pos, n, offset);
+		offset += n;
+		len -= n;
+
+		buf = buf->frags;
+		pos = buf ? buf->data : NULL;
+	}
+
+	return ok && !len;
+}
+
+static void run(int listener, bool zerocopy)
+{
+	struct net_pkt *pkt;
+	u32_t received = 0U;
+	u32_t calls = 0U;
+	bool ok = true;
+	struct bench_time start;
+	u64_t us;
+	ssize_t len;
+	int sock;
+
+	k_thread_create(&sender_thread, sender_stack,
+			K_THREAD_STACK_SIZEOF(sender_stack), sender,
+			NULL, NULL, NULL, K_PRIO_PREEMPT(8), 0, K_NO_WAIT);
+
+	sock = accept(listener, NULL, NULL);
+	if (sock < 0) {
+		fail("Cannot accept");
+	}
+
+	bench_time_start(&start);
+
+	do {
+		if (zerocopy) {
+			len = zsock_recv_zc(sock, &pkt, 0);
+			if (len > 0) {
+				ok &= check_pkt(pkt, len, received);
+				zsock_recv_zc_release(sock, pkt, len);
+			}
+		} else {
+			len = recv(sock, rx_buf, sizeof(rx_buf), 0);
+			if (len > 0) {
+				ok &= check(rx_buf, len, received);
+			}
+		}
+
+		if (len < 0) {
+			fail("Cannot receive");
+		}
+
+		received += len;
+		calls++;
+	} while (len > 0);
+
+	us = bench_time_us(&start);
+
+	k_thread_join(&sender_thread, K_FOREVER);
+	close(sock);
+
+	printk("%-8s %u bytes %u calls %u KB/s %s\n",
+	       zerocopy ? "zerocopy" : "copy", received, calls,
+	       us ? (u32_t)((u64_t)received * 1000U / us) : 0,
+	       ok && received == TOTAL ? "ok" : "corrupted");
+}
+
+void main(void)
+{
+	int listener;
+
+	net_if_ipv4_addr_add(net_if_get_default(), &addr, NET_ADDR_MANUAL, 0);
+
+	listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener < 0 ||
+	    bind(listener, (struct sockaddr *)&server, sizeof(server)) < 0 ||
+	    listen(listener, 1) < 0) {
+		fail("Cannot set up server");
+	}
+
+	run(listener, false);
+	run(listener, true);
+
+	close(listener);
+
+	printk("fin\n");
+}
@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 #include <net/socket.h>
 #include <net/ethernet.h>
+#include <net/net_pkt.h>
 
 #include "ipv6.h"
 #include "../../socket_helpers.h"
@@ -310,6 +311,64 @@ void test_send_recv_2_sock(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+void test_recv_zc(void)
+{
+	int sock1, sock2;
+	struct sockaddr_in bind_addr, conn_addr;
+	struct net_pkt *pkt;
+	char buf[STRLEN(TEST_STR2)];
+	int len, rv;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, 55555,
+			    &sock1, &bind_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, 55555,
+			    &sock2, &conn_addr);
+
+	rv = bind(sock1, (struct sockaddr *)&bind_addr, sizeof(bind_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = connect(sock2, (struct sockaddr *)&conn_addr, sizeof(conn_addr));
+	zassert_equal(rv, 0, "connect failed");
+
+	len = send(sock2, BUF_AND_SIZE(TEST_STR2), 0);
+	zassert_equal(len, STRLEN(TEST_STR2), "invalid send len");
+
+	len = recv(sock1, &pkt, sizeof(pkt), MSG_ZEROCOPY | MSG_PEEK);
+	zassert_equal(len, -1, "MSG_PEEK accepted");
+	zassert_equal(errno, EINVAL, "Unexpected errno");
+
+	pkt = NULL;
+	len = zsock_recv_zc(sock1, &pkt, 0);
+	zassert_equal(len, STRLEN(TEST_STR2), "Invalid recv len");
+	zassert_not_null(pkt, "No packet");
+	zassert_equal(net_pkt_remaining_data(pkt), len, "Wrong packet length");
+
+	/* The datagram spans several buffers, read it from the cursor */
+	rv = net_pkt_read(pkt, buf, len);
+	zassert_equal(rv, 0, "Cannot read data");
+	zassert_mem_equal(buf, BUF_AND_SIZE(TEST_STR2), "Wrong data");
+
+	zsock_recv_zc_release(sock1, pkt, len);
+
+	/* An empty datagram is consumed without handing out a packet */
+	len = send(sock2, buf, 0, 0);
+	zassert_equal(len, 0, "invalid send len");
+
+	pkt = (struct net_pkt *)buf;
+	len = zsock_recv_zc(sock1, &pkt, 0);
+	zassert_equal(len, 0, "Invalid recv len");
+	zassert_is_null(pkt, "Packet handed out");
+
+	len = zsock_recv_zc(sock1, &pkt, MSG_DONTWAIT);
+	zassert_equal(len, -1, "Unexpected data");
+	zassert_equal(errno, EAGAIN, "Unexpected errno");
+
+	rv = close(sock1);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(sock2);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_so_priority(void)
 {
 	struct sockaddr_in bind_addr4;
@@ -912,6 +971,7 @@ void test_main(void)
 
 	ztest_test_suite(socket_udp,
 			 ztest_unit_test(test_send_recv_2_sock),
+			 ztest_unit_test(test_recv_zc),
 			 ztest_unit_test(test_v4_sendto_recvfrom),
 			 ztest_unit_test(test_v6_sendto_recvfrom),
 			 ztest_unit_test(test_v4_bind_sendto),
@@ -94,6 +94,7 @@ static void handle_server_test(sa_family_t af, struct tcphdr *th);
 static void handle_syn_resend(void);
 static void handle_client_fin_wait_2_test(sa_family_t af, struct tcphdr *th);
 static void handle_client_closing_test(sa_family_t af, struct tcphdr *th);
+static void handle_gro_test(sa_family_t af, struct tcphdr *th);
 
 static void verify_flags(struct tcphdr *th, u8_t flags,
 			 const char *fun, int line)
@@ -376,6 +377,9 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 	case 8:
 		handle_client_closing_test(net_pkt_family(pkt), &th);
 		break;
+	case 9:
+		handle_gro_test(net_pkt_family(pkt), &th);
+		break;
 	default:
 		zassert_true(false, "Undefined test case");
 	}
@@ -1168,6 +1172,164 @@ static void test_client_closing_ipv6(void)
 	k_sleep(K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY));
 }
 
+static u8_t gro_data[8];
+static size_t gro_len;
+static int gro_deliveries;
+
+static void handle_gro_test(sa_family_t af, struct tcphdr *th)
+{
+	struct net_pkt *reply;
+	int ret;
+
+	switch (t_state) {
+	case T_SYN_ACK:
+		test_verify_flags(th, SYN | ACK);
+		seq++;
+		ack = ntohl(th->th_seq) + 1U;
+		reply = prepare_ack_packet(af, htons(MY_PORT),
+					   htons(PEER_PORT));
+		t_state = T_DATA;
+		break;
+	default:
+		/* Acknowledgments of the data and closing of the connection
+		 * are not checked.
+		 */
+		return;
+	}
+
+	ret = net_recv_data(iface, reply);
+	if (ret < 0) {
+		zassert_true(false, "%s failed", __func__);
+	}
+}
+
+static void test_gro_recv_cb(struct net_context *context,
+			     struct net_pkt *pkt,
+			     union net_ip_header *ip_hdr,
+			     union net_proto_header *proto_hdr,
+			     int status,
+			     void *user_data)
+{
+	size_t len;
+
+	if (!pkt) {
+		return;
+	}
+
+	len = net_pkt_remaining_data(pkt);
+	zassert_true(gro_len + len <= sizeof(gro_data), "Too much data");
+
+	net_pkt_read(pkt, gro_data + gro_len, len);
+	gro_len += len;
+	gro_deliveries++;
+
+	net_pkt_unref(pkt);
+}
+
+static struct net_context *gro_ctx;
+
+static void test_gro_accept_cb(struct net_context *ctx,
+			       struct sockaddr *addr,
+			       socklen_t addrlen,
+			       int status,
+			       void *user_data)
+{
+	if (status) {
+		zassert_true(false, "failed to accept the conn");
+	}
+
+	gro_ctx = ctx;
+	net_context_recv(ctx, test_gro_recv_cb, K_NO_WAIT, NULL);
+
+	test_sem_give();
+}
+
+static void gro_send(u8_t flags, const char *data)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = tester_prepare_tcp_pkt(AF_INET, htons(MY_PORT), htons(PEER_PORT),
+				     flags, (u8_t *)data, 2U);
+	zassert_not_null(pkt, "Cannot prepare segment");
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "Cannot receive segment");
+
+	seq += 2U;
+
+	/* Less than CONFIG_NET_TCP_GRO_TIMEOUT, held segments stay held */
+	k_sleep(K_MSEC(20));
+}
+
+/* Test case scenario IPv4
+ *   send SYN,
+ *   expect SYN ACK,
+ *   send ACK,
+ *   send DATA without PSH, then DATA with PSH,
+ *   expect both delivered at once and in order,
+ *   send DATA without PSH,
+ *   expect it held,
+ *   send DATA with PSH,
+ *   expect both delivered at once and after the previous ones.
+ *   any failures cause test case to fail.
+ */
+static void test_server_gro_ipv4(void)
+{
+	struct net_context *ctx;
+	struct net_pkt *pkt;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_GRO)) {
+		ztest_test_skip();
+		return;
+	}
+
+	t_state = T_SYN_ACK;
+	test_case_no = 9;
+	seq = ack = 0;
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &ctx);
+	zassert_equal(ret, 0, "Failed to get net_context");
+
+	ret = net_context_bind(ctx, (struct sockaddr *)&my_addr_s,
+			       sizeof(struct sockaddr_in));
+	zassert_equal(ret, 0, "Failed to bind net_context");
+
+	ret = net_context_listen(ctx, 1);
+	zassert_equal(ret, 0, "Failed to listen on net_context");
+
+	ret = net_context_accept(ctx, test_gro_accept_cb, K_FOREVER, NULL);
+	zassert_equal(ret, 0, "Failed to set accept on net_context");
+
+	pkt = prepare_syn_packet(AF_INET, htons(MY_PORT), htons(PEER_PORT));
+	zassert_not_null(pkt, "Cannot prepare SYN");
+
+	ret = net_recv_data(iface, pkt);
+	zassert_equal(ret, 0, "Cannot receive SYN");
+
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	gro_send(ACK, "AB");
+	zassert_equal(gro_len, 0, "Segment without PSH not held");
+
+	gro_send(PSH | ACK, "CD");
+	zassert_equal(gro_len, 4, "Held segments not flushed by PSH");
+	zassert_equal(gro_deliveries, 1, "Segments not coalesced");
+	zassert_mem_equal(gro_data, "ABCD", 4, "Wrong data");
+
+	gro_send(ACK, "EF");
+	zassert_equal(gro_len, 4, "Segment without PSH not held");
+
+	gro_send(PSH | ACK, "GH");
+	zassert_equal(gro_len, 8, "Held segments not flushed by PSH");
+	zassert_equal(gro_deliveries, 2, "Segments not coalesced");
+	zassert_mem_equal(gro_data, "ABCDEFGH", 8, "Wrong data");
+
+	net_context_put(gro_ctx);
+	net_context_put(ctx);
+}
+
 /** Test case main entry */
 void test_main(void)
 {
@@ -1180,7 +1342,8 @@ void test_main(void)
 			 ztest_unit_test(test_server_ipv6),
 			 ztest_unit_test(test_client_syn_resend),
 			 ztest_unit_test(test_client_fin_wait_2_ipv4),
-			 ztest_unit_test(test_client_closing_ipv6)
+			 ztest_unit_test(test_client_closing_ipv6),
+			 ztest_unit_test(test_server_gro_ipv4)
 			 );
 
 	ztest_run_test_suite(test_tcp_fn);
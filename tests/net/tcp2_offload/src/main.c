@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+#include <bench_time.h>
+
+/* Send TOTAL bytes in CHUNK sized writes over a TCP connection on the
+ * loopback interface, and check the data received.
+ */
+
+#define TOTAL		(1024 * 1024)
+#define CHUNK		4096
+#define SERVER_PORT	4242
+
+static struct in_addr addr = { { { 127, 0, 0, 1 } } };
+
+static u8_t chunk[CHUNK];
+static u8_t rx_buf[CHUNK];
+
+static struct net_context *accepted;
+static u32_t received;
+static u32_t deliveries;
+static bool corrupted;
+static K_SEM_DEFINE(done, 0, 1);
+
+static u8_t pattern(u32_t offset)
+{
+	return offset * 7 + (offset >> 12);
+}
+
+static void recv_cb(struct net_context *context, struct net_pkt *pkt,
+		    union net_ip_header *ip_hdr,
+		    union net_proto_header *proto_hdr,
+		    int status, void *user_data)
+{
+	size_t len;
+
+	if (!pkt) {
+		return;
+	}
+
+	deliveries++;
+
+	while ((len = MIN(net_pkt_remaining_data(pkt), sizeof(rx_buf)))) {
+		net_pkt_read(pkt, rx_buf, len);
+
+		for (size_t i = 0; i < len; i++) {
+			if (rx_buf[i] != pattern(received + i)) {
+				corrupted = true;
+			}
+		}
+
+		received += len;
+	}
+
+	net_pkt_unref(pkt);
+
+	if (received >= TOTAL) {
+		k_sem_give(&done);
+	}
+}
+
+static void accept_cb(struct net_context *new_context, struct sockaddr *addr,
+		      socklen_t addrlen, int status, void *user_data)
+{
+	accepted = new_context;
+	net_context_recv(new_context, recv_cb, K_NO_WAIT, NULL);
+}
+
+static void fail(const char *msg, int ret)
+{
+	printk("%s (%d)\n", msg, ret);
+	k_oops();
+}
+
+void main(void)
+{
+	struct sockaddr_in server = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+		.sin_addr = { { { 127, 0, 0, 1 } } },
+	};
+	struct net_context *listener, *client;
+	struct net_if *iface;
+	u32_t sent = 0U;
+	struct bench_time start;
+	u64_t us;
+	int ret;
+
+	iface = net_if_get_default();
+	net_if_ipv4_addr_add(iface, &addr, NET_ADDR_MANUAL, 0);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &listener);
+	if (ret == 0) {
+		ret = net_context_bind(listener, (struct sockaddr *)&server,
+				       sizeof(server));
+	}
+
+	if (ret == 0) {
+		ret = net_context_listen(listener, 0);
+	}
+
+	if (ret == 0) {
+		ret = net_context_accept(listener, accept_cb, K_NO_WAIT, NULL);
+	}
+
+	if (ret < 0) {
+		fail("Cannot set up server", ret);
+	}
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &client);
+	if (ret == 0) {
+		ret = net_context_connect(client, (struct sockaddr *)&server,
+					  sizeof(server), NULL, K_NO_WAIT,
+					  NULL);
+	}
+
+	if (ret < 0) {
+		fail("Cannot connect", ret);
+	}
+
+	for (int i = 0; i < 100 && (!accepted ||
+		     net_context_get_state(client) != NET_CONTEXT_CONNECTED);
+	     i++) {
+		k_msleep(10);
+	}
+
+	if (!accepted) {
+		fail("Not connected", -ETIMEDOUT);
+	}
+
+	bench_time_start(&start);
+
+	while (sent < TOTAL) {
+		for (int i = 0; i < CHUNK; i++) {
+			chunk[i] = pattern(sent + i);
+		}
+
+		ret = net_context_send(client, chunk, MIN(CHUNK, TOTAL - sent),
+				       NULL, K_FOREVER, NULL);
+		if (ret < 0) {
+			fail("Cannot send", ret);
+		}
+
+		sent += ret;
+	}
+
+	if (k_sem_take(&done, K_SECONDS(10)) < 0) {
+		printk("received %u of %u bytes\n", received, TOTAL);
+		fail("Data lost", -ETIMEDOUT);
+	}
+
+	us = bench_time_us(&start);
+
+	printk("%u bytes in %u byte writes %u KB/s %u deliveries %s\n",
+	       received, CHUNK, us ? (u32_t)((u64_t)received * 1000U / us) : 0,
+	       deliveries, corrupted ? "corrupted" : "ok");
+
+	printk("fin\n");
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_context.h>
+#include <net/dummy.h>
+#include <bench_time.h>
+
+#include "ipv4.h"
+#include "net_private.h"
+#include "tcp2_priv.h"
+
+/* Establish connections from a simulated peer and time the reception of an
+ * ACK segment for the newest one, for an increasing number of connections.
+ */
+
+#define ITERATIONS	20000
+#define SERVER_PORT	4242
+#define PEER_PORT	10000
+#define PEER_ISN	1000
+
+/* TCP2 starts the sequence numbers of new connections at 0 */
+#define SERVER_ISN	0
+
+static const u32_t counts[] = { 1, 8, 32, 128, 256 };
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *iface;
+static u32_t accepted;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api dummy_api = {
+	.iface_api.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+NET_DEVICE_INIT(tcp2_scaling_test, "tcp2_scaling_test", dummy_dev_init,
+		device_pm_control_nop, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &dummy_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static struct net_pkt *segment_create(u16_t peer_port, u8_t flags,
+				      u32_t seq, u32_t ack)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
+	struct net_pkt *pkt;
+	struct tcphdr *th;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct tcphdr),
+					AF_INET, IPPROTO_TCP, K_NO_WAIT);
+	if (!pkt) {
+		printk("Cannot allocate packet\n");
+		k_oops();
+	}
+
+	if (net_ipv4_create(pkt, &peer_addr, &my_addr) < 0) {
+		printk("Cannot create IPv4 header\n");
+		k_oops();
+	}
+
+	th = (struct tcphdr *)net_pkt_get_data(pkt, &tcp_access);
+	memset(th, 0, sizeof(*th));
+	th->th_sport = htons(peer_port);
+	th->th_dport = htons(SERVER_PORT);
+	th->th_off = 5U;
+	th->th_flags = flags;
+	th->th_win = htons(NET_IPV4_MTU);
+	th->th_seq = htonl(seq);
+	th->th_ack = htonl(ack);
+	net_pkt_set_data(pkt, &tcp_access);
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_TCP);
+
+	return pkt;
+}
+
+/* The stack does not consume segments for which TCP returns NET_DROP, so the
+ * same packet can be received again.
+ */
+static void segment_input(struct net_pkt *pkt)
+{
+	net_pkt_cursor_init(pkt);
+
+	if (net_ipv4_input(pkt) != NET_DROP) {
+		printk("Segment consumed\n");
+		k_oops();
+	}
+}
+
+static void connection_add(u16_t peer_port)
+{
+	struct net_pkt *pkt;
+
+	pkt = segment_create(peer_port, SYN, PEER_ISN, 0);
+	segment_input(pkt);
+	net_pkt_unref(pkt);
+
+	pkt = segment_create(peer_port, ACK, PEER_ISN + 1, SERVER_ISN + 1);
+	segment_input(pkt);
+	net_pkt_unref(pkt);
+}
+
+static void accept_cb(struct net_context *new_context, struct sockaddr *addr,
+		      socklen_t addrlen, int status, void *user_data)
+{
+	accepted++;
+}
+
+static void bench_run(u32_t count)
+{
+	u16_t peer_port = PEER_PORT + count - 1;
+	struct net_pkt *pkt;
+	struct bench_time start;
+	u64_t ns;
+
+	pkt = segment_create(peer_port, ACK, PEER_ISN + 1, SERVER_ISN + 1);
+
+	bench_time_start(&start);
+	for (u32_t i = 0; i < ITERATIONS; i++) {
+		segment_input(pkt);
+	}
+	ns = bench_time_ns(&start);
+
+	net_pkt_unref(pkt);
+
+	printk("connections %4u %6u ns/segment %9u segments/s\n", count,
+	       (u32_t)(ns / ITERATIONS),
+	       ns ? (u32_t)((u64_t)ITERATIONS * NSEC_PER_SEC / ns) : 0);
+}
+
+void main(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	struct net_context *ctx;
+	u32_t established = 0U;
+	int ret;
+
+	iface = net_if_get_default();
+	net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &ctx);
+	if (ret == 0) {
+		ret = net_context_bind(ctx, (struct sockaddr *)&addr,
+				       sizeof(addr));
+	}
+
+	if (ret == 0) {
+		ret = net_context_listen(ctx, 0);
+	}
+
+	if (ret == 0) {
+		ret = net_context_accept(ctx, accept_cb, K_NO_WAIT, NULL);
+	}
+
+	if (ret < 0) {
+		printk("Cannot set up server (%d)\n", ret);
+		k_oops();
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(counts); i++) {
+		while (established < counts[i]) {
+			connection_add(PEER_PORT + established);
+			established++;
+		}
+
+		if (accepted != established) {
+			printk("%u connections of %u accepted\n", accepted,
+			       established);
+			k_oops();
+		}
+
+		bench_run(counts[i]);
+	}
+
+	printk("fin\n");
+}
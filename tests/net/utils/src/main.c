@@ -832,12 +832,165 @@ void test_addr_parse(void)
 #endif
 }
 
+#define CHKSUM_DATA_LEN 600
+#define CHKSUM_IP_HDR_LEN 20
+
+NET_BUF_POOL_FIXED_DEFINE(chksum_pool, 16, CHKSUM_DATA_LEN + 4, NULL);
+
+static u8_t chksum_data[CHKSUM_DATA_LEN];
+
+/* Fragment lengths, the last fragment holds the rest of the data */
+static const u16_t chksum_splits[][4] = {
+	{ CHKSUM_DATA_LEN },
+	{ 20, 1 },
+	{ 21, 3, 2 },
+	{ 33, 100, 7, 64 },
+	{ 128, 128, 128 },
+	{ 255, 1, 1 },
+};
+
+/* Straightforward computation to compare with */
+static u16_t chksum_ref(u32_t sum, const u8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i += 2) {
+		sum += data[i] << 8;
+		if (i + 1 < len) {
+			sum += data[i + 1];
+		}
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+static u16_t chksum_expected(void)
+{
+	u16_t sum;
+
+	sum = chksum_ref(CHKSUM_DATA_LEN - CHKSUM_IP_HDR_LEN + IPPROTO_UDP,
+			 &chksum_data[CHKSUM_IP_HDR_LEN - 8], 8);
+	sum = chksum_ref(sum, &chksum_data[CHKSUM_IP_HDR_LEN],
+			 CHKSUM_DATA_LEN - CHKSUM_IP_HDR_LEN);
+
+	return sum == 0U ? 0U : htons(~sum);
+}
+
+/* Data split in fragments starting at the given offset from alignment */
+static struct net_pkt *chksum_pkt_create(const u16_t *split, int offset)
+{
+	struct net_pkt *pkt;
+	struct net_buf *buf;
+	size_t pos = 0;
+	size_t len;
+
+	pkt = net_pkt_alloc(K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	net_pkt_set_family(pkt, AF_INET);
+	net_pkt_set_ip_hdr_len(pkt, CHKSUM_IP_HDR_LEN);
+
+	for (int i = 0; pos < CHKSUM_DATA_LEN; i++) {
+		len = (i < 4 && split[i]) ? split[i] : CHKSUM_DATA_LEN - pos;
+		len = MIN(len, CHKSUM_DATA_LEN - pos);
+
+		buf = net_buf_alloc(&chksum_pool, K_NO_WAIT);
+		zassert_not_null(buf, "Cannot allocate buffer");
+
+		net_buf_reserve(buf, (offset + i) % 4);
+		net_buf_add_mem(buf, &chksum_data[pos], len);
+		net_pkt_append_buffer(pkt, buf);
+		pos += len;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static void chksum_check(const char *name)
+{
+	struct net_pkt *pkt;
+	u16_t expected = chksum_expected();
+	u16_t chksum;
+
+	for (int i = 0; i < ARRAY_SIZE(chksum_splits); i++) {
+		for (int offset = 0; offset < 4; offset++) {
+			pkt = chksum_pkt_create(chksum_splits[i], offset);
+			chksum = net_calc_chksum(pkt, IPPROTO_UDP);
+			net_pkt_unref(pkt);
+
+			zassert_equal(chksum, expected,
+				      "%s: split %d offset %d: 0x%04x != 0x%04x",
+				      name, i, offset, chksum, expected);
+		}
+	}
+}
+
+void test_chksum(void)
+{
+	for (int i = 0; i < CHKSUM_DATA_LEN; i++) {
+		chksum_data[i] = (i * 37 + 11) ^ (i >> 3);
+	}
+
+	chksum_check("pattern");
+
+	/* Many carries */
+	memset(chksum_data, 0xff, sizeof(chksum_data));
+	chksum_check("ones");
+
+	memset(chksum_data, 0, sizeof(chksum_data));
+	chksum_check("zeros");
+}
+
+void test_chksum_update(void)
+{
+	static const struct {
+		u16_t offset;
+		u8_t len;
+		u8_t data[6];
+	} changes[] = {
+		{ 30, 4, { 0x12, 0x34, 0x56, 0x78 } },
+		{ 32, 2, { 0xff, 0xff } },
+		{ 40, 1, { 0x80 } },
+		{ 100, 6, { 0x00, 0x00, 0x00, 0x00, 0xfe, 0xff } },
+	};
+	static const u16_t split[] = { 64, 0 };
+	struct net_pkt *pkt;
+	u8_t old[6];
+	u16_t chksum;
+
+	for (int i = 0; i < CHKSUM_DATA_LEN; i++) {
+		chksum_data[i] = i * 7;
+	}
+
+	pkt = chksum_pkt_create(split, 0);
+	chksum = net_calc_chksum(pkt, IPPROTO_UDP);
+	net_pkt_unref(pkt);
+
+	for (int i = 0; i < ARRAY_SIZE(changes); i++) {
+		memcpy(old, &chksum_data[changes[i].offset], changes[i].len);
+		memcpy(&chksum_data[changes[i].offset], changes[i].data,
+		       changes[i].len);
+
+		chksum = net_chksum_update(chksum, old, changes[i].data,
+					   changes[i].len);
+		zassert_equal(chksum, chksum_expected(),
+			      "Change %d: 0x%04x != 0x%04x", i, chksum,
+			      chksum_expected());
+	}
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_unit_test(test_net_addr),
 			 ztest_user_unit_test(test_net_addr),
-			 ztest_unit_test(test_addr_parse));
+			 ztest_unit_test(test_addr_parse),
+			 ztest_unit_test(test_chksum),
+			 ztest_unit_test(test_chksum_update));
 
 	ztest_run_test_suite(test_utils_fn);
 }
@@ -21,8 +21,12 @@ extern "C" {
 #endif
 
 #define TEST_FCB_FLASH_AREA_ID DT_FLASH_AREA_IMAGE_1_ID
+#define TEST_FCB_INDEX_CNT 64
 
 extern struct fcb test_fcb;
+#if defined(CONFIG_FCB_INDEX)
+extern struct fcb_index_entry test_fcb_index[];
+#endif
 
 extern struct flash_sector test_fcb_sector[];
 
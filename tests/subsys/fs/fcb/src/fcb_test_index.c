@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "fcb_test.h"
+
+#if defined(CONFIG_FCB_INDEX)
+#define TEST_INDEX_ELEMS 300
+
+static struct fcb_entry index_locs[TEST_INDEX_ELEMS];
+static struct fcb_entry flash_locs[TEST_INDEX_ELEMS];
+
+static bool fcb_test_loc_eq(const struct fcb_entry *a,
+			    const struct fcb_entry *b)
+{
+	return a->fe_sector == b->fe_sector &&
+	       a->fe_elem_off == b->fe_elem_off &&
+	       a->fe_data_off == b->fe_data_off &&
+	       a->fe_data_len == b->fe_data_len;
+}
+
+static int fcb_test_getnext_all(struct fcb *fcb, struct fcb_entry *locs)
+{
+	struct fcb_entry loc;
+	int cnt = 0;
+
+	(void)memset(&loc, 0, sizeof(loc));
+	while (fcb_getnext(fcb, &loc) == 0) {
+		zassert_true(cnt < TEST_INDEX_ELEMS, "too many elements");
+		locs[cnt++] = loc;
+	}
+
+	return cnt;
+}
+
+/* Check that the index gives the same elements as the flash */
+static void fcb_test_index_check(struct fcb *fcb)
+{
+	static const u8_t last_n[] = { 1, 7, 64, 100, 255 };
+	struct fcb_index_entry *index = fcb->f_index;
+	struct fcb_entry loc1, loc2;
+	int cnt1, cnt2;
+	int rc1, rc2;
+
+	cnt1 = fcb_test_getnext_all(fcb, index_locs);
+	for (int i = 0; i < ARRAY_SIZE(last_n); i++) {
+		rc1 = fcb_offset_last_n(fcb, last_n[i], &loc1);
+		fcb->f_index = NULL;
+		rc2 = fcb_offset_last_n(fcb, last_n[i], &loc2);
+		fcb->f_index = index;
+		zassert_equal(rc1, rc2, "last %u: index rc %d flash rc %d",
+			      last_n[i], rc1, rc2);
+		zassert_true(rc1 || fcb_test_loc_eq(&loc1, &loc2),
+			     "last %u: index and flash differ", last_n[i]);
+	}
+
+	fcb->f_index = NULL;
+	cnt2 = fcb_test_getnext_all(fcb, flash_locs);
+	fcb->f_index = index;
+
+	zassert_equal(cnt1, cnt2, "index %d flash %d elements", cnt1, cnt2);
+	for (int i = 0; i < cnt1; i++) {
+		zassert_true(fcb_test_loc_eq(&index_locs[i], &flash_locs[i]),
+			     "element %d differs", i);
+	}
+}
+
+void fcb_test_index(void)
+{
+	struct fcb *fcb = &test_fcb;
+	struct fcb_entry loc;
+	u8_t test_data[400];
+	int rc;
+
+	fcb->f_scratch_cnt = 1U;
+	fcb_test_index_check(fcb);
+
+	for (int i = 0; i < TEST_INDEX_ELEMS - 20; i++) {
+		/* lengths needing one and two length bytes, filling all sectors */
+		u16_t len = (i * 37) % sizeof(test_data);
+
+		rc = fcb_append(fcb, len, &loc);
+		if (rc == -ENOSPC) {
+			rc = fcb_rotate(fcb);
+			zassert_true(rc == 0, "fcb_rotate call failure");
+			fcb_test_index_check(fcb);
+			rc = fcb_append(fcb, len, &loc);
+		}
+		zassert_true(rc == 0, "fcb_append call failure");
+
+		(void)memset(test_data, i, sizeof(test_data));
+		rc = flash_area_write(fcb->fap, FCB_ENTRY_FA_DATA_OFF(loc),
+				      test_data, len);
+		zassert_true(rc == 0, "flash_area_write call failure");
+
+		/* leave some elements unfinished, they are skipped */
+		if ((i % 11) == 5) {
+			continue;
+		}
+
+		rc = fcb_append_finish(fcb, &loc);
+		zassert_true(rc == 0, "fcb_append_finish call failure");
+	}
+	fcb_test_index_check(fcb);
+
+	/* the index is rebuilt from flash */
+	rc = fcb_init(TEST_FCB_FLASH_AREA_ID, fcb);
+	zassert_true(rc == 0, "fcb_init call failure");
+	fcb_test_index_check(fcb);
+
+	while (!fcb_is_empty(fcb)) {
+		rc = fcb_rotate(fcb);
+		zassert_true(rc == 0, "fcb_rotate call failure");
+		fcb_test_index_check(fcb);
+	}
+
+	/* an index without entries is not used */
+	fcb->f_index_cnt = 0U;
+	rc = fcb_init(TEST_FCB_FLASH_AREA_ID, fcb);
+	zassert_true(rc == 0, "fcb_init call failure");
+
+	for (int i = 0; i < 8; i++) {
+		rc = fcb_append(fcb, sizeof(i), &loc);
+		zassert_true(rc == 0, "fcb_append call failure");
+		rc = flash_area_write(fcb->fap, FCB_ENTRY_FA_DATA_OFF(loc),
+				      &i, sizeof(i));
+		zassert_true(rc == 0, "flash_area_write call failure");
+		rc = fcb_append_finish(fcb, &loc);
+		zassert_true(rc == 0, "fcb_append_finish call failure");
+	}
+	fcb_test_index_check(fcb);
+
+	rc = fcb_rotate(fcb);
+	zassert_true(rc == 0, "fcb_rotate call failure");
+	fcb_test_index_check(fcb);
+}
+#else
+void fcb_test_index(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_FCB_INDEX */
@@ -13,6 +13,10 @@
 
 struct fcb test_fcb;
 
+#if defined(CONFIG_FCB_INDEX)
+struct fcb_index_entry test_fcb_index[TEST_FCB_INDEX_CNT];
+#endif
+
 /* Sectors for FCB are defined far from application code
  * area. This test suite is the non bootable application so 1. image slot is
  * suitable for it.
@@ -109,6 +113,10 @@ void fcb_tc_pretest(int sectors)
 	(void)memset(fcb, 0, sizeof(*fcb));
 	fcb->f_sector_cnt = sectors;
 	fcb->f_sectors = test_fcb_sector; /* XXX */
+#if defined(CONFIG_FCB_INDEX)
+	fcb->f_index = test_fcb_index;
+	fcb->f_index_cnt = ARRAY_SIZE(test_fcb_index);
+#endif
 
 	rc = 0;
 	rc = fcb_init(TEST_FCB_FLASH_AREA_ID, fcb);
@@ -142,6 +150,7 @@ void fcb_test_reset(void);
 void fcb_test_rotate(void);
 void fcb_test_multi_scratch(void);
 void fcb_test_last_of_n(void);
+void fcb_test_index(void);
 
 void test_main(void)
 {
@@ -171,6 +180,9 @@ void test_main(void)
 			 ztest_unit_test_setup_teardown(fcb_test_last_of_n,
 							fcb_pretest_4_sectors,
 							teardown_nothing),
+			 ztest_unit_test_setup_teardown(fcb_test_index,
+							fcb_pretest_4_sectors,
+							teardown_nothing),
 			 /* Finally, run one that leaves behind a
 			  * flash.bin file without any random content */
 			 ztest_unit_test_setup_teardown(fcb_test_reset,
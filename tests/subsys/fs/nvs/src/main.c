@@ -596,6 +596,80 @@ void test_delete(void)
 		     " any footprint in the storage");
 }
 
+/**
+ * @brief Test that the lookup cache kept up to date by writes, deletes and gc
+ * matches the cache rebuilt when the file system is mounted.
+ */
+void test_nvs_lookup_cache(void)
+{
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	int err;
+	ssize_t len;
+	u32_t cache[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+	/* more ids than cache entries so that ids share cache entries */
+	const u16_t max_id = CONFIG_NVS_LOOKUP_CACHE_SIZE + 5;
+	u16_t data_read;
+
+	fs.sector_count = 3;
+
+	err = nvs_init(&fs, DT_CHOSEN_ZEPHYR_FLASH_CONTROLLER_LABEL);
+	zassert_true(err == 0,  "nvs_init call failure: %d", err);
+
+	for (u16_t i = 0; i < 20 * max_id; i++) {
+		u16_t id = i % max_id;
+
+		/* keep every third id deleted half of the time */
+		if ((id % 3) == 0 && ((i / max_id) % 2) == 1) {
+			err = nvs_delete(&fs, id);
+			zassert_true(err == 0,  "nvs_delete call failure: %d",
+				     err);
+			continue;
+		}
+
+		len = nvs_write(&fs, id, &i, sizeof(i));
+		zassert_true(len == sizeof(i), "nvs_write failed: %d", len);
+	}
+
+	for (u16_t id = 0; id < max_id; id++) {
+		len = nvs_read(&fs, id, &data_read, sizeof(data_read));
+		if ((id % 3) == 0) {
+			zassert_true(len == -ENOENT,
+				     "nvs_read shouldn't found the entry: %d",
+				     len);
+		} else {
+			zassert_true(len == sizeof(data_read),
+				     "nvs_read failed: %d", len);
+			zassert_equal(data_read, 19 * max_id + id,
+				      "read unexpected data: %d", data_read);
+		}
+	}
+
+	memcpy(cache, fs.lookup_cache, sizeof(cache));
+
+	err = nvs_init(&fs, DT_CHOSEN_ZEPHYR_FLASH_CONTROLLER_LABEL);
+	zassert_true(err == 0,  "nvs_init call failure: %d", err);
+
+	zassert_mem_equal(cache, fs.lookup_cache, sizeof(cache),
+			  "Rebuilt lookup cache differs from maintained one");
+
+	/* deleting an id that was never written makes no footprint */
+	err = nvs_delete(&fs, max_id);
+	zassert_true(err == 0,  "nvs_delete call failure: %d", err);
+	zassert_mem_equal(cache, fs.lookup_cache, sizeof(cache),
+			  "Delete of nonexistent entry changed the cache");
+
+	err = nvs_clear(&fs);
+	zassert_true(err == 0,  "nvs_clear call failure: %d", err);
+
+	for (size_t i = 0; i < CONFIG_NVS_LOOKUP_CACHE_SIZE; i++) {
+		zassert_equal(fs.lookup_cache[i], 0xFFFFFFFF,
+			      "Lookup cache not cleared");
+	}
+#else
+	ztest_test_skip();
+#endif
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_nvs,
@@ -615,7 +689,9 @@ void test_main(void)
 			 ztest_unit_test_setup_teardown(test_nvs_full_sector,
 				 setup, teardown),
 			 ztest_unit_test_setup_teardown(test_delete, setup,
-				 teardown)
+				 teardown),
+			 ztest_unit_test_setup_teardown(test_nvs_lookup_cache,
+				 setup, teardown)
 			);
 
 	ztest_run_test_suite(test_nvs);
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measure the worst case nvs_write() latency while garbage collection keeps
+ * recycling sectors. The flash simulator adds CONFIG_FLASH_SIMULATOR_*_TIME_US
+ * to every operation, so a write that erases a sector inline takes at least
+ * the erase time. With CONFIG_NVS_GC_DEFERRED the erase runs on the NVS gc
+ * work queue while the writer sleeps between writes.
+ */
+
+#include <string.h>
+#include <ztest.h>
+
+#include <drivers/flash.h>
+#include <storage/flash_map.h>
+#include <fs/nvs.h>
+#include "nvs_priv.h"
+
+#define TEST_SECTOR_COUNT	4U
+#define TEST_ID_COUNT		8U
+#define TEST_DATA_LEN		32U
+#define TEST_ERASE_US		CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US
+/* the writer sleeps long enough for the gc work queue to finish an erase */
+#define TEST_WRITE_PERIOD_MS	(2 * TEST_ERASE_US / USEC_PER_MSEC)
+
+static struct nvs_fs fs;
+static struct device *flash_dev;
+static u32_t last_value[TEST_ID_COUNT];
+static u32_t write_count;
+
+static void mount(void)
+{
+	int err;
+
+	err = nvs_init(&fs, DT_CHOSEN_ZEPHYR_FLASH_CONTROLLER_LABEL);
+	zassert_equal(err, 0, "nvs_init call failure: %d", err);
+}
+
+static void setup(void)
+{
+	const struct flash_area *fa;
+	struct flash_pages_info info;
+	int err;
+
+	err = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	zassert_equal(err, 0, "flash_area_open() fail: %d", err);
+
+	flash_dev = flash_area_get_device(fa);
+	err = flash_get_page_info_by_offs(flash_dev, fa->fa_off, &info);
+	zassert_equal(err, 0, "Unable to get page info: %d", err);
+	zassert_true(fa->fa_size >= TEST_SECTOR_COUNT * info.size,
+		     "storage partition too small");
+
+	if (fs.ready) {
+		(void)nvs_gc_flush(&fs);
+	}
+
+	/* start from an empty file system, the flash may hold anything */
+	err = flash_area_erase(fa, 0, TEST_SECTOR_COUNT * info.size);
+	zassert_equal(err, 0, "flash_area_erase() fail: %d", err);
+
+	fs.offset = fa->fa_off;
+	fs.sector_size = info.size;
+	fs.sector_count = TEST_SECTOR_COUNT;
+
+	memset(last_value, 0, sizeof(last_value));
+	write_count = 0U;
+
+	mount();
+}
+
+/* write the next value of a round robin over TEST_ID_COUNT ids, returns the
+ * number of cycles spent in nvs_write().
+ */
+static u32_t write_next(void)
+{
+	u32_t data[TEST_DATA_LEN / sizeof(u32_t)];
+	u16_t id = write_count % TEST_ID_COUNT;
+	u32_t start, cycles;
+	ssize_t len;
+
+	write_count++;
+	for (int i = 0; i < ARRAY_SIZE(data); i++) {
+		data[i] = write_count;
+	}
+
+	start = k_cycle_get_32();
+	len = nvs_write(&fs, id, data, sizeof(data));
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(len, sizeof(data), "nvs_write failed: %d", len);
+	last_value[id] = write_count;
+
+	return cycles;
+}
+
+static void check_content(void)
+{
+	u32_t data[TEST_DATA_LEN / sizeof(u32_t)];
+	ssize_t len;
+
+	for (u16_t id = 0; id < TEST_ID_COUNT; id++) {
+		len = nvs_read(&fs, id, data, sizeof(data));
+		zassert_equal(len, sizeof(data), "nvs_read failed: %d", len);
+		for (int i = 0; i < ARRAY_SIZE(data); i++) {
+			zassert_equal(data[i], last_value[id],
+				      "id %u holds %u instead of %u", id,
+				      data[i], last_value[id]);
+		}
+	}
+}
+
+#ifdef CONFIG_NVS_GC_DEFERRED
+static void check_sector_erased(u32_t addr)
+{
+	u8_t buf[32];
+	off_t offset;
+	int err;
+
+	offset = fs.offset + (addr >> ADDR_SECT_SHIFT) * fs.sector_size;
+	for (size_t i = 0; i < fs.sector_size; i += sizeof(buf)) {
+		err = flash_read(flash_dev, offset + i, buf, sizeof(buf));
+		zassert_equal(err, 0, "flash_read failed: %d", err);
+		for (size_t j = 0; j < sizeof(buf); j++) {
+			zassert_equal(buf[j], 0xff, "sector not erased");
+		}
+	}
+}
+#endif
+
+void test_nvs_gc_write_latency(void)
+{
+	u32_t sector, cycles, max_cycles = 0U, max_us;
+	u16_t switches = 0U;
+
+	setup();
+
+	sector = fs.ate_wra >> ADDR_SECT_SHIFT;
+
+	/* cycle through all sectors twice */
+	while (switches < 2 * TEST_SECTOR_COUNT) {
+		cycles = write_next();
+		max_cycles = MAX(max_cycles, cycles);
+
+		if ((fs.ate_wra >> ADDR_SECT_SHIFT) != sector) {
+			sector = fs.ate_wra >> ADDR_SECT_SHIFT;
+			switches++;
+		}
+
+		k_sleep(K_MSEC(TEST_WRITE_PERIOD_MS));
+	}
+
+	check_content();
+
+	max_us = k_cyc_to_us_floor32(max_cycles);
+	TC_PRINT("nvs write max latency %u us over %u writes, "
+		 "sector erase %u us\n", max_us, write_count,
+		 TEST_ERASE_US);
+
+	if (IS_ENABLED(CONFIG_NVS_GC_DEFERRED)) {
+		zassert_true(max_us < TEST_ERASE_US,
+			     "write waited for a sector erase");
+	} else {
+		zassert_true(max_us >= TEST_ERASE_US,
+			     "no sector erase measured");
+	}
+}
+
+/* write without giving the gc work queue a chance to run until a sector
+ * erase is pending.
+ */
+static void write_until_erase_pending(void)
+{
+#ifdef CONFIG_NVS_GC_DEFERRED
+	while (!fs.gc_erase_pending) {
+		(void)write_next();
+	}
+#endif
+}
+
+void test_nvs_gc_flush(void)
+{
+	if (!IS_ENABLED(CONFIG_NVS_GC_DEFERRED)) {
+		ztest_test_skip();
+	}
+
+	setup();
+
+	/* go around once so gc has valid entries to copy */
+	for (int i = 0; i < TEST_SECTOR_COUNT; i++) {
+		write_until_erase_pending();
+		zassert_equal(nvs_gc_flush(&fs), 0, "nvs_gc_flush failed");
+	}
+	write_until_erase_pending();
+
+#ifdef CONFIG_NVS_GC_DEFERRED
+	u32_t addr = fs.gc_erase_addr;
+
+	zassert_equal(nvs_gc_flush(&fs), 0, "nvs_gc_flush failed");
+	zassert_false(fs.gc_erase_pending, "erase still pending");
+	check_sector_erased(addr);
+#endif
+	check_content();
+}
+
+void test_nvs_gc_remount_erase_pending(void)
+{
+	if (!IS_ENABLED(CONFIG_NVS_GC_DEFERRED)) {
+		ztest_test_skip();
+	}
+
+	setup();
+
+	for (int i = 0; i < TEST_SECTOR_COUNT; i++) {
+		write_until_erase_pending();
+		zassert_equal(nvs_gc_flush(&fs), 0, "nvs_gc_flush failed");
+	}
+	write_until_erase_pending();
+
+	/* a few writes to the new write sector must survive the remount,
+	 * restarting gc instead of finishing the erase would lose them.
+	 */
+	for (int i = 0; i < TEST_ID_COUNT / 2; i++) {
+		(void)write_next();
+	}
+
+#ifdef CONFIG_NVS_GC_DEFERRED
+	u32_t addr = fs.gc_erase_addr;
+
+	mount();
+	zassert_false(fs.gc_erase_pending, "erase still pending");
+	check_sector_erased(addr);
+#endif
+	check_content();
+
+	/* the file system keeps working after the remount */
+	for (int i = 0; i < TEST_ID_COUNT; i++) {
+		(void)write_next();
+	}
+	check_content();
+}
+
+/* an id written once, gc copies it out of the sector waiting for the erase */
+#define TEST_RARE_ID		100U
+
+void test_nvs_gc_read_hist_erase_pending(void)
+{
+	u32_t value = 0x12345678, data;
+	ssize_t len;
+
+	if (!IS_ENABLED(CONFIG_NVS_GC_DEFERRED)) {
+		ztest_test_skip();
+	}
+
+	setup();
+
+	len = nvs_write(&fs, TEST_RARE_ID, &value, sizeof(value));
+	zassert_equal(len, sizeof(value), "nvs_write failed: %d", len);
+
+	write_until_erase_pending();
+
+	for (int i = 0; i < 2; i++) {
+		data = 0U;
+		len = nvs_read_hist(&fs, TEST_RARE_ID, &data, sizeof(data), 0);
+		zassert_equal(len, sizeof(data), "nvs_read_hist failed: %d",
+			      len);
+		zassert_equal(data, value, "wrong value");
+
+		/* the copy left in the gc'ed sector is not history */
+		len = nvs_read_hist(&fs, TEST_RARE_ID, &data, sizeof(data), 1);
+		zassert_equal(len, -ENOENT, "stale entry in the history");
+
+		len = nvs_read(&fs, TEST_RARE_ID + 1, &data, sizeof(data));
+		zassert_equal(len, -ENOENT, "unexpected entry");
+
+		/* same results once the erase is done */
+		zassert_equal(nvs_gc_flush(&fs), 0, "nvs_gc_flush failed");
+	}
+
+	check_content();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_nvs_gc,
+			 ztest_unit_test(test_nvs_gc_write_latency),
+			 ztest_unit_test(test_nvs_gc_flush),
+			 ztest_unit_test(test_nvs_gc_remount_erase_pending),
+			 ztest_unit_test(test_nvs_gc_read_hist_erase_pending)
+			);
+
+	ztest_run_test_suite(test_nvs_gc);
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Test the interrupt driven UART backend output
+ *
+ * The backend is bound to a fake UART whose transmit interrupt is raised
+ * from a timer and which records what is written to its FIFO. A burst
+ * larger than the backend ring buffer must come out complete and in order.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <stdio.h>
+#include <string.h>
+#include <device.h>
+#include <drivers/uart.h>
+#include <logging/log.h>
+#include <logging/log_ctrl.h>
+#ifdef CONFIG_ARCH_POSIX
+#include <arch/posix/posix_trace.h>
+#endif
+
+LOG_MODULE_REGISTER(test, LOG_LEVEL_INF);
+
+#define BURST		64
+#define FIFO_SIZE	16
+
+struct fake_uart_data {
+	uart_irq_callback_user_data_t cb;
+	void *cb_data;
+	struct device *fwd;
+	struct k_timer irq_timer;
+	bool tx_enabled;
+	bool irq_running;
+	char out[BURST * 64 + 1];
+	size_t out_len;
+	u32_t fills;
+};
+
+static struct fake_uart_data fake_data;
+
+/* Console output, not captured */
+static void fake_poll_out(struct device *dev, unsigned char c)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+#ifdef CONFIG_ARCH_POSIX
+	ARG_UNUSED(data);
+	posix_print_trace("%c", c);
+#else
+	if (data->fwd != NULL) {
+		uart_poll_out(data->fwd, c);
+	}
+#endif
+}
+
+static int fake_poll_in(struct device *dev, unsigned char *c)
+{
+	return -1;
+}
+
+static int fake_fifo_fill(struct device *dev, const u8_t *tx_data, int len)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+	len = MIN(len, FIFO_SIZE);
+	/* Keep the capture a string */
+	len = MIN(len, sizeof(data->out) - 1 - data->out_len);
+	memcpy(&data->out[data->out_len], tx_data, len);
+	data->out_len += len;
+	data->fills++;
+
+	return len;
+}
+
+static void irq_timer_expired(struct k_timer *timer)
+{
+	struct fake_uart_data *data =
+		CONTAINER_OF(timer, struct fake_uart_data, irq_timer);
+
+	if (!data->tx_enabled) {
+		k_timer_stop(timer);
+		data->irq_running = false;
+		return;
+	}
+
+	if (data->cb != NULL) {
+		data->cb(data->cb_data);
+	}
+}
+
+static void fake_irq_tx_enable(struct device *dev)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+	data->tx_enabled = true;
+	if (!data->irq_running) {
+		data->irq_running = true;
+		k_timer_start(&data->irq_timer, K_TICKS(1), K_TICKS(1));
+	}
+}
+
+static void fake_irq_tx_disable(struct device *dev)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+	data->tx_enabled = false;
+}
+
+static int fake_irq_tx_ready(struct device *dev)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+	return data->tx_enabled;
+}
+
+static int fake_irq_update(struct device *dev)
+{
+	return 1;
+}
+
+static void fake_irq_callback_set(struct device *dev,
+				  uart_irq_callback_user_data_t cb,
+				  void *user_data)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+	data->cb = cb;
+	data->cb_data = user_data;
+}
+
+static const struct uart_driver_api fake_uart_api = {
+	.poll_in = fake_poll_in,
+	.poll_out = fake_poll_out,
+	.fifo_fill = fake_fifo_fill,
+	.irq_tx_enable = fake_irq_tx_enable,
+	.irq_tx_disable = fake_irq_tx_disable,
+	.irq_tx_ready = fake_irq_tx_ready,
+	.irq_update = fake_irq_update,
+	.irq_callback_set = fake_irq_callback_set,
+};
+
+static int fake_uart_init(struct device *dev)
+{
+	struct fake_uart_data *data = dev->driver_data;
+
+#ifndef CONFIG_ARCH_POSIX
+	data->fwd = device_get_binding("UART_0");
+#endif
+	k_timer_init(&data->irq_timer, irq_timer_expired, NULL);
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(fake_uart, "FAKE_UART", fake_uart_init, &fake_data,
+		    NULL, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &fake_uart_api);
+
+static void test_burst(void)
+{
+	char needle[16];
+	const char *pos;
+
+	(void)memset(fake_data.out, 0, sizeof(fake_data.out));
+	fake_data.out_len = 0;
+	fake_data.fills = 0U;
+
+	for (int i = 0; i < BURST; i++) {
+		LOG_INF("burst message %d", i);
+	}
+
+	/* Waits for the interrupt whenever the backend ring buffer fills */
+	while (log_process(false)) {
+	}
+
+	/* Then the rest is sent */
+	while (fake_data.tx_enabled) {
+		k_sleep(K_MSEC(10));
+	}
+
+	zassert_true(fake_data.out_len > CONFIG_LOG_BACKEND_UART_BUFFER_SIZE,
+		     "burst fits the ring buffer (%zu bytes)",
+		     fake_data.out_len);
+	zassert_true(fake_data.fills > 1U, "");
+
+	pos = fake_data.out;
+	for (int i = 0; i < BURST; i++) {
+		snprintf(needle, sizeof(needle), "message %d\r\n", i);
+		pos = strstr(pos, needle);
+		zassert_not_null(pos, "message %d missing or out of order", i);
+		pos += strlen(needle);
+	}
+
+	zassert_equal(pos, &fake_data.out[fake_data.out_len],
+		      "unexpected trailing output");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_log_backend_uart_async,
+			 ztest_unit_test(test_burst));
+	ztest_run_test_suite(test_log_backend_uart_async);
+}
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Test log message ring
+ *
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <logging/log_backend.h>
+#include <logging/log_ctrl.h>
+#include <logging/log.h>
+
+#define LOG_MODULE_NAME test
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#define PRODUCER_THREADS	3
+#define PRODUCER_ISR		PRODUCER_THREADS
+#define PRODUCERS		(PRODUCER_THREADS + 1)
+#define PRODUCER_MSGS		200
+#define PRODUCER_STACK_SIZE	(1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+typedef void (*put_callback_t)(struct log_msg *msg);
+
+struct backend_cb {
+	u32_t counter;
+	u32_t total_drops;
+	put_callback_t callback;
+};
+
+static struct backend_cb backend_cb;
+
+static void put(struct log_backend const *const backend,
+		struct log_msg *msg)
+{
+	struct backend_cb *cb = (struct backend_cb *)backend->cb->ctx;
+
+	log_msg_get(msg);
+
+	if (cb->callback) {
+		cb->callback(msg);
+	}
+
+	cb->counter++;
+
+	log_msg_put(msg);
+}
+
+static void dropped(struct log_backend const *const backend, u32_t cnt)
+{
+	struct backend_cb *cb = (struct backend_cb *)backend->cb->ctx;
+
+	cb->total_drops += cnt;
+}
+
+static const struct log_backend_api log_backend_test_api = {
+	.put = put,
+	.dropped = dropped,
+};
+
+LOG_BACKEND_DEFINE(backend, log_backend_test_api, false);
+
+static void log_setup(put_callback_t callback)
+{
+	log_init();
+
+	/* drop anything left by a previous test */
+	while (log_process(true)) {
+	}
+
+	memset(&backend_cb, 0, sizeof(backend_cb));
+	backend_cb.callback = callback;
+
+	log_backend_enable(&backend, &backend_cb, LOG_LEVEL_DBG);
+}
+
+static void log_flush(void)
+{
+	while (log_process(false)) {
+	}
+}
+
+static void ring_empty_check(void)
+{
+	struct log_msg_ring_stats stats;
+
+	log_msg_ring_stats_get(&stats);
+	zassert_equal(stats.used, 0, "Ring not empty: %u bytes", stats.used);
+}
+
+/* Arguments are 1, 2, 3, ... */
+static void args_callback(struct log_msg *msg)
+{
+	u32_t nargs = log_msg_nargs_get(msg);
+
+	zassert_equal(nargs, (backend_cb.counter < 8) ? backend_cb.counter : 10,
+		      "Unexpected nargs");
+
+	for (u32_t i = 0; i < nargs; i++) {
+		zassert_equal(log_msg_arg_get(msg, i), i + 1,
+			      "Unexpected argument");
+	}
+}
+
+static void test_ring_arguments(void)
+{
+	log_setup(args_callback);
+
+	LOG_INF("test");
+	LOG_INF("test %d", 1);
+	LOG_INF("test %d %d", 1, 2);
+	LOG_INF("test %d %d %d", 1, 2, 3);
+	LOG_INF("test %d %d %d %d", 1, 2, 3, 4);
+	LOG_INF("test %d %d %d %d %d", 1, 2, 3, 4, 5);
+	LOG_INF("test %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6);
+	LOG_INF("test %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7);
+	LOG_INF("test %d %d %d %d %d %d %d %d %d %d",
+		1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+
+	log_flush();
+
+	zassert_equal(backend_cb.counter, 9, "Unexpected message count");
+	ring_empty_check();
+}
+
+static u8_t hexdump_data[200];
+
+static void hexdump_callback(struct log_msg *msg)
+{
+	u8_t buf[sizeof(hexdump_data)];
+	size_t len = sizeof(buf);
+
+	zassert_false(log_msg_is_std(msg), "Expected hexdump message");
+
+	log_msg_hexdump_data_get(msg, buf, &len, 0);
+	zassert_equal(len, sizeof(hexdump_data), "Unexpected hexdump length");
+	zassert_equal(memcmp(buf, hexdump_data, len), 0,
+		      "Unexpected hexdump data");
+}
+
+static void test_ring_hexdump(void)
+{
+	for (int i = 0; i < sizeof(hexdump_data); i++) {
+		hexdump_data[i] = i;
+	}
+
+	log_setup(hexdump_callback);
+
+	LOG_HEXDUMP_INF(hexdump_data, sizeof(hexdump_data), "test");
+	log_flush();
+
+	zassert_equal(backend_cb.counter, 1, "Unexpected message count");
+	ring_empty_check();
+}
+
+static void strdup_callback(struct log_msg *msg)
+{
+	const char *str = (const char *)log_msg_arg_get(msg, 0);
+
+	zassert_true(log_is_strdup(str), "Expected duplicated string");
+
+	if (backend_cb.counter == 0) {
+		zassert_equal(strcmp(str, "short"), 0, "Unexpected string");
+	} else {
+		zassert_equal(strlen(str), CONFIG_LOG_STRDUP_MAX_STRING,
+			      "Unexpected trimmed length");
+		zassert_equal(str[CONFIG_LOG_STRDUP_MAX_STRING - 1], '~',
+			      "Missing trim marker");
+	}
+}
+
+static void test_ring_strdup(void)
+{
+	char str[CONFIG_LOG_STRDUP_MAX_STRING * 2];
+
+	log_setup(strdup_callback);
+
+	strcpy(str, "short");
+	LOG_INF("%s", log_strdup(str));
+	memset(str, 'x', sizeof(str) - 1);
+	str[sizeof(str) - 1] = '\0';
+	LOG_INF("%s", log_strdup(str));
+
+	/* the copies must not depend on the source */
+	memset(str, 0, sizeof(str));
+
+	log_flush();
+
+	zassert_equal(backend_cb.counter, 2, "Unexpected message count");
+	ring_empty_check();
+}
+
+static u32_t next_seq;
+
+static void seq_callback(struct log_msg *msg)
+{
+	u32_t seq = log_msg_arg_get(msg, 0);
+
+	zassert_true(seq >= next_seq, "Messages out of order");
+	next_seq = seq + 1;
+}
+
+/* Go around the ring many times with messages of different lengths, so
+ * packets end at every position and padding is used at the end of the ring.
+ */
+static void test_ring_wrap(void)
+{
+	struct log_msg_ring_stats stats;
+	u32_t seq = 0;
+
+	log_setup(seq_callback);
+	next_seq = 0;
+
+	log_msg_ring_stats_get(&stats);
+
+	while (seq < 20 * stats.size / sizeof(struct log_msg)) {
+		for (int i = 0; i < 4; i++, seq++) {
+			switch (seq % 3) {
+			case 0:
+				LOG_INF("%d", seq);
+				break;
+			case 1:
+				LOG_INF("%d %d %d %d %d", seq, 2, 3, 4, 5);
+				break;
+			default:
+				LOG_INF("%d %s", seq, log_strdup("wrap"));
+				break;
+			}
+		}
+		log_flush();
+	}
+
+	zassert_equal(backend_cb.counter, seq, "Unexpected message count");
+	zassert_equal(backend_cb.total_drops, 0, "Unexpected drops");
+	ring_empty_check();
+}
+
+/* Log more than fits without processing. In overflow mode the oldest
+ * messages are dropped, otherwise the newest.
+ */
+static void test_ring_full(void)
+{
+	struct log_msg_ring_stats before, after;
+	u32_t count;
+
+	log_setup(seq_callback);
+	next_seq = 0;
+
+	log_msg_ring_stats_get(&before);
+	count = 3 * before.size / sizeof(struct log_msg);
+
+	for (u32_t seq = 0; seq < count; seq++) {
+		LOG_INF("%d", seq);
+	}
+
+	log_msg_ring_stats_get(&after);
+	zassert_true(after.max_used > after.size - sizeof(struct log_msg) - 1,
+		     "Ring not filled");
+	zassert_true(after.dropped > before.dropped, "No drops counted");
+
+	if (IS_ENABLED(CONFIG_LOG_MODE_OVERFLOW)) {
+		/* the oldest message left is not the first one logged */
+		zassert_true(log_process(false), "No message");
+		zassert_true(next_seq > 1, "Oldest message not dropped");
+	} else {
+		zassert_true(log_process(false), "No message");
+		zassert_equal(next_seq, 1, "First message dropped");
+	}
+
+	log_flush();
+
+	if (IS_ENABLED(CONFIG_LOG_MODE_OVERFLOW)) {
+		zassert_equal(next_seq, count, "Last message dropped");
+	}
+
+	zassert_equal(backend_cb.counter + (after.dropped - before.dropped),
+		      count, "Messages lost");
+	zassert_equal(backend_cb.total_drops, after.dropped - before.dropped,
+		      "Unexpected drop notification");
+	ring_empty_check();
+}
+
+static K_THREAD_STACK_ARRAY_DEFINE(producer_stack, PRODUCER_THREADS,
+				   PRODUCER_STACK_SIZE);
+static struct k_thread producer_thread[PRODUCER_THREADS];
+static K_SEM_DEFINE(producers_done, 0, PRODUCERS);
+static u32_t producer_next[PRODUCERS];
+static u32_t producer_received[PRODUCERS];
+static u32_t isr_seq;
+
+static void producer_callback(struct log_msg *msg)
+{
+	u32_t id = log_msg_arg_get(msg, 0);
+	u32_t seq = log_msg_arg_get(msg, 1);
+
+	zassert_true(id < PRODUCERS, "Unexpected producer");
+	zassert_true(seq >= producer_next[id], "Messages out of order");
+	zassert_equal(log_msg_arg_get(msg, 2), seq ^ 0x5a5a,
+		      "Unexpected argument");
+
+	producer_next[id] = seq + 1;
+	producer_received[id]++;
+}
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	u32_t id = POINTER_TO_UINT(p1);
+
+	for (u32_t seq = 0; seq < PRODUCER_MSGS; seq++) {
+		LOG_INF("%d %d %d %s", id, seq, seq ^ 0x5a5a,
+			log_strdup("producer"));
+		k_busy_wait(50 * (id + 1));
+	}
+
+	k_sem_give(&producers_done);
+}
+
+static void isr_producer(struct k_timer *timer)
+{
+	LOG_INF("%d %d %d", PRODUCER_ISR, isr_seq, isr_seq ^ 0x5a5a);
+
+	if (++isr_seq == PRODUCER_MSGS) {
+		k_timer_stop(timer);
+		k_sem_give(&producers_done);
+	}
+}
+
+static K_TIMER_DEFINE(isr_timer, isr_producer, NULL);
+
+/* Threads of different priorities and an interrupt log concurrently while
+ * the test thread processes. Every message is either received in order or
+ * counted as dropped.
+ */
+static void test_ring_producers(void)
+{
+	struct log_msg_ring_stats before, after;
+	u32_t received = 0;
+
+	log_setup(producer_callback);
+	log_msg_ring_stats_get(&before);
+
+	memset(producer_next, 0, sizeof(producer_next));
+	memset(producer_received, 0, sizeof(producer_received));
+	isr_seq = 0;
+
+	for (int i = 0; i < PRODUCER_THREADS; i++) {
+		k_thread_create(&producer_thread[i], producer_stack[i],
+				PRODUCER_STACK_SIZE, producer,
+				UINT_TO_POINTER(i), NULL, NULL,
+				K_PRIO_PREEMPT(i + 1), 0, K_NO_WAIT);
+	}
+	k_timer_start(&isr_timer, K_MSEC(1), K_MSEC(1));
+
+	for (int i = 0; i < PRODUCERS; ) {
+		log_flush();
+		if (k_sem_take(&producers_done, K_MSEC(1)) == 0) {
+			i++;
+		}
+	}
+	log_flush();
+
+	log_msg_ring_stats_get(&after);
+
+	for (int i = 0; i < PRODUCERS; i++) {
+		received += producer_received[i];
+	}
+
+	TC_PRINT("received %u, dropped %u, ring high-water %u of %u bytes\n",
+		 received, after.dropped - before.dropped, after.max_used,
+		 after.size);
+
+	zassert_equal(received + (after.dropped - before.dropped),
+		      PRODUCERS * PRODUCER_MSGS, "Messages lost");
+	ring_empty_check();
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_log_msg_ring,
+			 ztest_unit_test(test_ring_arguments),
+			 ztest_unit_test(test_ring_hexdump),
+			 ztest_unit_test(test_ring_strdup),
+			 ztest_unit_test(test_ring_wrap),
+			 ztest_unit_test(test_ring_full),
+			 ztest_unit_test(test_ring_producers));
+	ztest_run_test_suite(test_log_msg_ring);
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Test dictionary log output
+ */
+
+#include <logging/log.h>
+#include <logging/log_output.h>
+
+#include <tc_util.h>
+#include <stdbool.h>
+#include <zephyr.h>
+#include <ztest.h>
+
+#define LOG_MODULE_NAME test
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#define DICT_TYPE_STD		0xD0
+#define DICT_TYPE_HEXDUMP	0xD1
+#define DICT_TYPE_DROPPED	0xD2
+
+static u8_t mock_buffer[512];
+static u8_t log_output_buf[8];
+static u32_t mock_len;
+static u32_t rd;
+
+static void setup(void)
+{
+	mock_len = 0U;
+	rd = 0U;
+	memset(mock_buffer, 0, sizeof(mock_buffer));
+}
+
+static void teardown(void)
+{
+
+}
+
+static int mock_output_func(u8_t *buf, size_t size, void *ctx)
+{
+	memcpy(&mock_buffer[mock_len], buf, size);
+	mock_len += size;
+
+	return size;
+}
+
+LOG_OUTPUT_DEFINE(log_output, mock_output_func,
+		  log_output_buf, sizeof(log_output_buf));
+
+static void get(void *dst, size_t len)
+{
+	zassert_true(rd + len <= mock_len, "Record too short");
+	memcpy(dst, &mock_buffer[rd], len);
+	rd += len;
+}
+
+static u64_t get_var(void)
+{
+	u64_t val = 0;
+	u8_t b;
+
+	for (int shift = 0; ; shift += 7) {
+		get(&b, sizeof(b));
+		val |= (u64_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			return val;
+		}
+	}
+}
+
+static s64_t get_svar(void)
+{
+	u64_t val = get_var();
+
+	return (s64_t)(val >> 1) ^ -(s64_t)(val & 1);
+}
+
+static void validate_hdr(u8_t type, struct log_msg_ids src_level,
+			 u32_t timestamp)
+{
+	u8_t b[2];
+	u16_t source_id;
+	u32_t ts;
+
+	get(b, sizeof(b));
+	get(&source_id, sizeof(source_id));
+	get(&ts, sizeof(ts));
+
+	zassert_equal(b[0], type, "Unexpected type");
+	zassert_equal(b[1] & 0x7, src_level.level, "Unexpected level");
+	zassert_equal(b[1] >> 3, src_level.domain_id, "Unexpected domain");
+	zassert_equal(source_id, src_level.source_id, "Unexpected source");
+	zassert_equal(ts, timestamp, "Unexpected timestamp");
+}
+
+static void validate_str_addr(const char *str)
+{
+	zassert_equal(get_svar(), (intptr_t)str - (intptr_t)__log_const_start,
+		      "Unexpected string address");
+}
+
+static void validate_nargs(u8_t nargs)
+{
+	u8_t n;
+
+	get(&n, sizeof(n));
+	zassert_equal(n, nargs, "Unexpected nargs");
+}
+
+static void validate_int(s64_t val)
+{
+	zassert_equal(get_svar(), val, "Unexpected argument");
+}
+
+static void validate_str(const char *exp)
+{
+	char buf[CONFIG_LOG_DICTIONARY_MAX_STRING];
+	u8_t len;
+
+	get(&len, sizeof(len));
+	zassert_equal(len, strlen(exp), "Unexpected string length");
+	get(buf, len);
+	zassert_equal(memcmp(buf, exp, len), 0, "Unexpected string");
+}
+
+static void validate_end(void)
+{
+	zassert_equal(rd, mock_len, "Unexpected bytes after record");
+}
+
+static struct log_msg_ids src_level_get(u8_t level)
+{
+	struct log_msg_ids src_level = {
+		.level = level,
+		.source_id = log_const_source_id(
+				&LOG_ITEM_CONST_DATA(LOG_MODULE_NAME)),
+		.domain_id = CONFIG_LOG_DOMAIN_ID,
+	};
+
+	return src_level;
+}
+
+static void log_output_string_varg(const struct log_output *log_output,
+		       struct log_msg_ids src_level, u32_t timestamp,
+		       u32_t flags, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+
+	log_output_string(log_output, src_level, timestamp, fmt, ap, flags);
+
+	va_end(ap);
+}
+
+void test_log_output_dict_string(void)
+{
+	static const char fmt[] = "abc %d %5lu %% %s %c %s %lx %p";
+	struct log_msg_ids src_level = src_level_get(LOG_LEVEL_WRN);
+	char str[] = "transient";
+
+	log_output_string_varg(&log_output, src_level, 123456,
+			       LOG_OUTPUT_FLAG_FORMAT_DICT, fmt,
+			       -1, 12345UL, "short", 'x', str,
+			       0x11223344UL, (void *)0x1000);
+
+	validate_hdr(DICT_TYPE_STD, src_level, 123456);
+	validate_str_addr(fmt);
+	validate_nargs(7);
+	validate_int(-1);
+	validate_int(12345);
+	validate_str("short");
+	validate_int('x');
+	/* trimmed to CONFIG_LOG_DICTIONARY_MAX_STRING */
+	validate_str("transien");
+	validate_int(0x11223344);
+	zassert_equal(get_var(), 0x1000, "Unexpected pointer");
+	validate_end();
+}
+
+void test_log_output_dict_msg(void)
+{
+	static const char fmt[] = "%d %s %d %d";
+	struct log_msg_ids src_level = src_level_get(LOG_LEVEL_INF);
+	log_arg_t args[] = { 1, (log_arg_t)"abc", 3, 4 };
+	struct log_msg *msg;
+
+	if (IS_ENABLED(CONFIG_LOG_IMMEDIATE)) {
+		/* no message pool */
+		ztest_test_skip();
+	}
+
+	msg = log_msg_create_n(fmt, args, ARRAY_SIZE(args));
+	zassert_true(msg != NULL, "Failed to create message");
+	msg->hdr.ids = src_level;
+	msg->hdr.timestamp = 42;
+
+	log_output_msg_process(&log_output, msg, LOG_OUTPUT_FLAG_FORMAT_DICT);
+	log_msg_put(msg);
+
+	validate_hdr(DICT_TYPE_STD, src_level, 42);
+	validate_str_addr(fmt);
+	validate_nargs(ARRAY_SIZE(args));
+	validate_int(1);
+	validate_str("abc");
+	validate_int(3);
+	validate_int(4);
+	validate_end();
+}
+
+void test_log_output_dict_hexdump(void)
+{
+	static const char metadata[] = "data";
+	struct log_msg_ids src_level = src_level_get(LOG_LEVEL_DBG);
+	u8_t data[50];
+	u8_t out[sizeof(data)];
+	struct log_msg *msg;
+	u32_t first_ts = 8;
+	u64_t len;
+
+	for (int i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+
+	if (!IS_ENABLED(CONFIG_LOG_IMMEDIATE)) {
+		msg = log_msg_hexdump_create(metadata, data, sizeof(data));
+		zassert_true(msg != NULL, "Failed to create message");
+		msg->hdr.ids = src_level;
+		msg->hdr.timestamp = 7;
+
+		log_output_msg_process(&log_output, msg,
+				       LOG_OUTPUT_FLAG_FORMAT_DICT);
+		log_msg_put(msg);
+		first_ts = 7;
+	}
+
+	log_output_hexdump(&log_output, src_level, 8, metadata, data,
+			   sizeof(data), LOG_OUTPUT_FLAG_FORMAT_DICT);
+
+	for (u32_t ts = first_ts; ts <= 8; ts++) {
+		validate_hdr(DICT_TYPE_HEXDUMP, src_level, ts);
+		validate_str_addr(metadata);
+		len = get_var();
+		zassert_equal(len, sizeof(data), "Unexpected length");
+		get(out, len);
+		zassert_equal(memcmp(out, data, len), 0, "Unexpected data");
+	}
+	validate_end();
+}
+
+void test_log_output_dict_dropped(void)
+{
+	struct log_msg_ids src_level = { 0 };
+
+	log_output_dict_dropped_process(&log_output, 1234);
+
+	validate_hdr(DICT_TYPE_DROPPED, src_level, 0);
+	zassert_equal(get_var(), 1234, "Unexpected count");
+	validate_end();
+}
+
+/* Typical message, formatted the way backends do and as a record. */
+void test_log_output_dict_size(void)
+{
+	struct log_msg_ids src_level = src_level_get(LOG_LEVEL_INF);
+	u32_t flags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP |
+		      LOG_OUTPUT_FLAG_FORMAT_TIMESTAMP;
+	u32_t text_len;
+
+	log_output_string_varg(&log_output, src_level, 123456, flags,
+			       "connection %d state %d rssi %d", 3, 2, -60);
+	text_len = mock_len;
+
+	setup();
+	log_output_string_varg(&log_output, src_level, 123456,
+			       flags | LOG_OUTPUT_FLAG_FORMAT_DICT,
+			       "connection %d state %d rssi %d", 3, 2, -60);
+
+	TC_PRINT("text %u bytes, dictionary record %u bytes\n", text_len,
+		 mock_len);
+	zassert_true(mock_len < text_len / 3, "Record too big");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_log_output_dict,
+		ztest_unit_test_setup_teardown(test_log_output_dict_string,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_msg,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_hexdump,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_dropped,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_size,
+					       setup, teardown)
+		);
+	ztest_run_test_suite(test_log_output_dict);
+}
@@ -607,6 +607,12 @@ static void test_direct_loading_filter(void)
 }
 
 
+void test_batch_commit(void);
+void test_batch_abort(void);
+void test_batch_overwrite_full(void);
+void test_batch_recover(void);
+void test_batch_flash_bytes(void);
+
 void test_main(void)
 {
 	ztest_test_suite(settings_test_suite,
@@ -614,7 +620,12 @@ void test_main(void)
 			 ztest_unit_test(test_support_rtn),
 			 ztest_unit_test(test_register_and_loading),
 			 ztest_unit_test(test_direct_loading),
-			 ztest_unit_test(test_direct_loading_filter)
+			 ztest_unit_test(test_direct_loading_filter),
+			 ztest_unit_test(test_batch_commit),
+			 ztest_unit_test(test_batch_abort),
+			 ztest_unit_test(test_batch_overwrite_full),
+			 ztest_unit_test(test_batch_recover),
+			 ztest_unit_test(test_batch_flash_bytes)
 			);
 
 	ztest_run_test_suite(settings_test_suite);
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <errno.h>
+#include <settings/settings.h>
+#include <stats/stats.h>
+#include "settings_priv.h"
+
+#ifdef CONFIG_SETTINGS_BATCH
+
+struct batch_values {
+	int a;
+	int b;
+	int c;
+	int journal;
+};
+
+static int batch_loader(const char *key, size_t len, settings_read_cb read_cb,
+			void *cb_arg, void *param)
+{
+	struct batch_values *values = param;
+	int *val;
+
+	if (!strcmp(key, "a")) {
+		val = &values->a;
+	} else if (!strcmp(key, "b")) {
+		val = &values->b;
+	} else if (!strcmp(key, "c")) {
+		val = &values->c;
+	} else {
+		return 0;
+	}
+
+	zassert_equal(read_cb(cb_arg, val, sizeof(*val)), sizeof(*val),
+		      "can't read value of %s", key);
+
+	return 0;
+}
+
+static int batch_journal_loader(const char *key, size_t len,
+				settings_read_cb read_cb, void *cb_arg,
+				void *param)
+{
+	struct batch_values *values = param;
+
+	values->journal = 1;
+
+	return 0;
+}
+
+static void batch_values_load(struct batch_values *values)
+{
+	memset(values, 0, sizeof(*values));
+	settings_load_subtree_direct("batch", batch_loader, values);
+	settings_load_subtree_direct(SETTINGS_BATCH_JOURNAL_NAME,
+				     batch_journal_loader, values);
+}
+
+static void batch_save(const char *name, int val)
+{
+	int rc;
+
+	rc = settings_save_one(name, &val, sizeof(val));
+	zassert_equal(rc, 0, "can't save %s", name);
+}
+
+void test_batch_commit(void)
+{
+	struct batch_values values;
+	int rc;
+
+	rc = settings_subsys_init();
+	zassert_equal(rc, 0, "can't init settings subsystem");
+
+	batch_save("batch/c", 7);
+
+	rc = settings_batch_begin();
+	zassert_equal(rc, 0, "can't begin batch");
+	rc = settings_batch_begin();
+	zassert_equal(rc, -EBUSY, "nested batch allowed");
+
+	batch_save("batch/a", 1);
+	batch_save("batch/b", 2);
+	batch_save("batch/a", 3);
+	rc = settings_delete("batch/c");
+	zassert_equal(rc, 0, "can't delete batch/c");
+
+	/* nothing is written before the commit */
+	batch_values_load(&values);
+	zassert_true(values.a == 0 && values.b == 0 && values.c == 7,
+		     "batch written before commit");
+
+	rc = settings_batch_commit();
+	zassert_equal(rc, 0, "can't commit batch");
+
+	batch_values_load(&values);
+	zassert_equal(values.a, 3, "wrong value of batch/a");
+	zassert_equal(values.b, 2, "wrong value of batch/b");
+	zassert_equal(values.c, 0, "batch/c not deleted");
+	zassert_equal(values.journal, 0, "journal not removed");
+
+	rc = settings_batch_commit();
+	zassert_equal(rc, -EINVAL, "commit without batch allowed");
+}
+
+void test_batch_abort(void)
+{
+	struct batch_values values;
+	static u8_t big[CONFIG_SETTINGS_BATCH_BUF_SIZE];
+	int rc;
+
+	rc = settings_batch_begin();
+	zassert_equal(rc, 0, "can't begin batch");
+
+	batch_save("batch/a", 10);
+	rc = settings_save_one("batch/big", big, sizeof(big));
+	zassert_equal(rc, -ENOMEM, "batch buffer overflow not reported");
+
+	rc = settings_batch_abort();
+	zassert_equal(rc, 0, "can't abort batch");
+
+	batch_values_load(&values);
+	zassert_equal(values.a, 3, "aborted batch written");
+
+	/* settings are written directly again */
+	batch_save("batch/a", 4);
+	batch_values_load(&values);
+	zassert_equal(values.a, 4, "wrong value of batch/a");
+}
+
+void test_batch_overwrite_full(void)
+{
+	struct settings_batch_rec rec;
+	struct batch_values values;
+	static u8_t filler[CONFIG_SETTINGS_BATCH_BUF_SIZE];
+	u8_t big[32] = { 0 };
+	size_t a_len = sizeof(rec) + sizeof("batch/a") + sizeof(int);
+	size_t filler_len;
+	int rc;
+
+	rc = settings_batch_begin();
+	zassert_equal(rc, 0, "can't begin batch");
+
+	batch_save("batch/a", 5);
+
+	/* leave 8 bytes free in the batch buffer */
+	filler_len = CONFIG_SETTINGS_BATCH_BUF_SIZE - a_len - sizeof(rec) -
+		     sizeof("batch/f") - 8;
+	rc = settings_save_one("batch/f", filler, filler_len);
+	zassert_equal(rc, 0, "can't fill batch");
+
+	/* fits in the free space plus the record it replaces */
+	batch_save("batch/a", 6);
+
+	rc = settings_save_one("batch/a", big, sizeof(big));
+	zassert_equal(rc, -ENOMEM, "batch buffer overflow not reported");
+
+	rc = settings_batch_commit();
+	zassert_equal(rc, 0, "can't commit batch");
+
+	batch_values_load(&values);
+	zassert_equal(values.a, 6, "value of batch/a lost on overflow");
+
+	rc = settings_delete("batch/f");
+	zassert_equal(rc, 0, "can't delete batch/f");
+}
+
+static size_t batch_rec_put(u8_t *buf, const char *name, int val)
+{
+	struct settings_batch_rec rec = {
+		.name_len = strlen(name) + 1,
+		.val_len = val ? sizeof(val) : 0,
+	};
+
+	memcpy(buf, &rec, sizeof(rec));
+	memcpy(buf + sizeof(rec), name, rec.name_len);
+	memcpy(buf + sizeof(rec) + rec.name_len, &val, rec.val_len);
+
+	return sizeof(rec) + rec.name_len + rec.val_len;
+}
+
+#ifdef CONFIG_SETTINGS_BATCH_JOURNAL
+void test_batch_recover(void)
+{
+	struct batch_values values;
+	u8_t journal[64];
+	size_t len = 0;
+	int rc;
+
+	/* journal of a batch interrupted before its settings were written */
+	len += batch_rec_put(&journal[len], "batch/a", 0);
+	len += batch_rec_put(&journal[len], "batch/c", 9);
+	rc = settings_save_one(SETTINGS_BATCH_JOURNAL_NAME, journal, len);
+	zassert_equal(rc, 0, "can't save journal");
+
+	rc = settings_batch_recover();
+	zassert_equal(rc, 0, "can't recover batch");
+
+	batch_values_load(&values);
+	zassert_equal(values.a, 0, "batch/a not deleted");
+	zassert_equal(values.b, 2, "wrong value of batch/b");
+	zassert_equal(values.c, 9, "wrong value of batch/c");
+	zassert_equal(values.journal, 0, "journal not removed");
+
+	/* a corrupted journal is discarded */
+	journal[0] = 0xff;
+	rc = settings_save_one(SETTINGS_BATCH_JOURNAL_NAME, journal, len);
+	zassert_equal(rc, 0, "can't save journal");
+
+	rc = settings_batch_recover();
+	zassert_equal(rc, 0, "can't recover batch");
+
+	batch_values_load(&values);
+	zassert_equal(values.c, 9, "wrong value of batch/c");
+	zassert_equal(values.journal, 0, "journal not removed");
+}
+#else
+void test_batch_recover(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_SETTINGS_BATCH_JOURNAL */
+
+#if defined(CONFIG_FLASH_SIMULATOR) && defined(CONFIG_STATS_NAMES)
+#define BATCH_WORDS 4
+
+static int flash_sim_bytes_written_find(struct stats_hdr *hdr, void *arg,
+					const char *name, u16_t off)
+{
+	if (!strcmp(name, "bytes_written")) {
+		u32_t **bytes_written = (u32_t **)arg;
+		*bytes_written = (u32_t *)((u8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+/* Saves every word, each one twice if overwrite is set, and returns the
+ * number of bytes written to flash.
+ */
+static u32_t batch_words_save(u32_t *bytes_written, bool batch,
+			      bool overwrite, int val)
+{
+	char name[] = "batch/w0";
+	u32_t start = *bytes_written;
+	int rc;
+
+	if (batch) {
+		rc = settings_batch_begin();
+		zassert_equal(rc, 0, "can't begin batch");
+	}
+
+	for (int i = 0; i < BATCH_WORDS; i++) {
+		name[sizeof(name) - 2] = '0' + i;
+		if (overwrite) {
+			batch_save(name, val + 100 + i);
+		}
+		batch_save(name, val + i);
+	}
+
+	if (batch) {
+		rc = settings_batch_commit();
+		zassert_equal(rc, 0, "can't commit batch");
+	}
+
+	return *bytes_written - start;
+}
+
+void test_batch_flash_bytes(void)
+{
+	struct stats_hdr *sim_stats = stats_group_find("flash_sim_stats");
+	u32_t *bytes_written = NULL;
+	u32_t plain, plain_ow, batched, batched_ow;
+	char name[] = "batch/w0";
+	int rc;
+
+	zassert_not_null(sim_stats, "no flash simulator statistics");
+	stats_walk(sim_stats, flash_sim_bytes_written_find, &bytes_written);
+	zassert_not_null(bytes_written, "no bytes_written statistic");
+
+	/* Back-ends may store a name on its first save only */
+	(void)batch_words_save(bytes_written, false, false, 0);
+
+	plain = batch_words_save(bytes_written, false, false, 1000);
+	batched = batch_words_save(bytes_written, true, false, 2000);
+	plain_ow = batch_words_save(bytes_written, false, true, 3000);
+	batched_ow = batch_words_save(bytes_written, true, true, 4000);
+
+	TC_PRINT("%d settings written: %u bytes plain, %u batched\n",
+		 BATCH_WORDS, plain, batched);
+	TC_PRINT("each written twice: %u bytes plain, %u batched\n",
+		 plain_ow, batched_ow);
+
+	/* Overwrites within a batch are never written */
+	zassert_equal(batched_ow, batched, "overwritten settings written");
+	if (!IS_ENABLED(CONFIG_SETTINGS_BATCH_JOURNAL)) {
+		zassert_true(batched <= plain, "batch writes more than saves");
+		zassert_true(batched_ow < plain_ow, "");
+	}
+
+	for (int i = 0; i < BATCH_WORDS; i++) {
+		name[sizeof(name) - 2] = '0' + i;
+		rc = settings_delete(name);
+		zassert_equal(rc, 0, "can't delete %s", name);
+	}
+}
+#else
+void test_batch_flash_bytes(void)
+{
+	ztest_test_skip();
+}
+#endif
+
+#else
+
+void test_batch_commit(void)
+{
+	ztest_test_skip();
+}
+
+void test_batch_abort(void)
+{
+	ztest_test_skip();
+}
+
+void test_batch_overwrite_full(void)
+{
+	ztest_test_skip();
+}
+
+void test_batch_recover(void)
+{
+	ztest_test_skip();
+}
+
+void test_batch_flash_bytes(void)
+{
+	ztest_test_skip();
+}
+
+#endif /* CONFIG_SETTINGS_BATCH */
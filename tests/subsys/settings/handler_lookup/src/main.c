@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ *  @brief Settings handler lookup test suite
+ *
+ *  Checks which handler settings_parse_and_lookup() returns for a set of
+ *  names, with a layout of handlers like the one of a board running
+ *  bluetooth, mesh and a number of application subsystems, and measures
+ *  the time needed to dispatch keys to their handlers during a load.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <settings/settings.h>
+
+#define LOAD_KEYS 1000
+
+static u32_t set_calls;
+
+static int lookup_set(const char *name, size_t len, settings_read_cb read_cb,
+		      void *cb_arg)
+{
+	u8_t val;
+
+	if (read_cb(cb_arg, &val, sizeof(val)) == sizeof(val)) {
+		set_calls++;
+	}
+
+	return 0;
+}
+
+#define LOOKUP_HANDLER(_hname, _tree) \
+	SETTINGS_STATIC_HANDLER_DEFINE(_hname, _tree, NULL, lookup_set, \
+				       NULL, NULL)
+
+LOOKUP_HANDLER(bt, "bt");
+LOOKUP_HANDLER(bt_keys, "bt/keys");
+LOOKUP_HANDLER(bt_ccc, "bt/ccc");
+LOOKUP_HANDLER(bt_sc, "bt/sc");
+LOOKUP_HANDLER(bt_mesh, "bt/mesh");
+LOOKUP_HANDLER(bt_mesh_cfg, "bt/mesh/cfg");
+
+#define APP_HANDLER(_n) LOOKUP_HANDLER(app_a##_n, "app/a" #_n)
+
+APP_HANDLER(0);
+APP_HANDLER(1);
+APP_HANDLER(2);
+APP_HANDLER(3);
+APP_HANDLER(4);
+APP_HANDLER(5);
+APP_HANDLER(6);
+APP_HANDLER(7);
+APP_HANDLER(8);
+APP_HANDLER(9);
+APP_HANDLER(10);
+APP_HANDLER(11);
+APP_HANDLER(12);
+APP_HANDLER(13);
+APP_HANDLER(14);
+APP_HANDLER(15);
+APP_HANDLER(16);
+APP_HANDLER(17);
+APP_HANDLER(18);
+APP_HANDLER(19);
+APP_HANDLER(20);
+APP_HANDLER(21);
+APP_HANDLER(22);
+APP_HANDLER(23);
+APP_HANDLER(24);
+APP_HANDLER(25);
+APP_HANDLER(26);
+APP_HANDLER(27);
+APP_HANDLER(28);
+APP_HANDLER(29);
+APP_HANDLER(30);
+APP_HANDLER(31);
+
+static struct settings_handler dyn_handler = {
+	.name = "dyn",
+	.h_set = lookup_set,
+};
+
+static struct settings_handler dyn_mesh_handler = {
+	.name = "bt/mesh/dyn",
+	.h_set = lookup_set,
+};
+
+struct lookup_case {
+	const char *name;
+	const char *handler;
+	const char *next;
+};
+
+static const struct lookup_case lookup_cases[] = {
+	{ "bt", "bt", NULL },
+	{ "bt=", "bt", NULL },
+	{ "bt/name", "bt", "name" },
+	{ "bt/keys", "bt/keys", NULL },
+	{ "bt/keys/c2a3b4c5d6e7f8", "bt/keys", "c2a3b4c5d6e7f8" },
+	{ "bt/keysx/1", "bt", "keysx/1" },
+	{ "bt/mesh/net", "bt/mesh", "net" },
+	{ "bt/mesh/cfg", "bt/mesh/cfg", NULL },
+	{ "bt/mesh/cfg/hb=", "bt/mesh/cfg", "hb=" },
+	{ "bt/mesh/dyn/x", "bt/mesh/dyn", "x" },
+	{ "dyn/a/b", "dyn", "a/b" },
+	{ "app/a0/v", "app/a0", "v" },
+	{ "app/a31", "app/a31", NULL },
+	{ "app/a7/x/y", "app/a7", "x/y" },
+	{ "app/a70", NULL, NULL },
+	{ "app", NULL, NULL },
+	{ "btx/a", NULL, NULL },
+	{ "", NULL, NULL },
+};
+
+static void test_handler_lookup(void)
+{
+	struct settings_handler_static *handler;
+	const char *next;
+
+	for (int i = 0; i < ARRAY_SIZE(lookup_cases); i++) {
+		const struct lookup_case *lc = &lookup_cases[i];
+
+		handler = settings_parse_and_lookup(lc->name, &next);
+		if (!lc->handler) {
+			zassert_is_null(handler, "%s: unexpected handler",
+					lc->name);
+			continue;
+		}
+
+		zassert_not_null(handler, "%s: no handler", lc->name);
+		zassert_true(!strcmp(handler->name, lc->handler),
+			     "%s: wrong handler", lc->name);
+		if (!lc->next) {
+			zassert_is_null(next, "%s: unexpected next",
+					lc->name);
+		} else {
+			zassert_not_null(next, "%s: no next", lc->name);
+			zassert_true(!strcmp(next, lc->next),
+				     "%s: wrong next", lc->name);
+		}
+	}
+
+	handler = settings_parse_and_lookup(NULL, &next);
+	zassert_is_null(handler, "handler found for NULL name");
+}
+
+static ssize_t lookup_read(void *cb_arg, void *data, size_t len)
+{
+	*(u8_t *)data = 0xa5;
+
+	return 1;
+}
+
+static void test_handler_lookup_load(void)
+{
+	static const char * const prefixes[] = {
+		"bt/keys/c2a3b4c5d6e7f8", "bt/mesh/cfg/hb", "bt/mesh/s/1/data",
+		"bt/ccc/c2a3b4c5d6e7f8", "app/a3/val", "app/a17/val",
+		"app/a29/val", "dyn/val",
+	};
+	char name[SETTINGS_MAX_NAME_LEN];
+	u32_t start, lookup_cycles, load_cycles;
+	struct settings_handler_static *handler;
+	const char *next;
+	int rc;
+
+	/* lookups only */
+	start = k_cycle_get_32();
+	for (int i = 0; i < LOAD_KEYS; i++) {
+		handler = settings_parse_and_lookup(
+			prefixes[i % ARRAY_SIZE(prefixes)], &next);
+		zassert_not_null(handler, "no handler");
+	}
+	lookup_cycles = k_cycle_get_32() - start;
+
+	/* dispatch as done by the backends when loading */
+	set_calls = 0U;
+	start = k_cycle_get_32();
+	for (int i = 0; i < LOAD_KEYS; i++) {
+		snprintk(name, sizeof(name), "%s/%d",
+			 prefixes[i % ARRAY_SIZE(prefixes)], i);
+		rc = settings_call_set_handler(name, 1, lookup_read, NULL,
+					       NULL);
+		zassert_equal(rc, 0, "set handler failed");
+	}
+	load_cycles = k_cycle_get_32() - start;
+	zassert_equal(set_calls, LOAD_KEYS, "not all keys dispatched");
+
+	TC_PRINT("settings lookup %u keys %u cycles/key\n", LOAD_KEYS,
+		 lookup_cycles / LOAD_KEYS);
+	TC_PRINT("settings load dispatch %u keys %u cycles/key\n", LOAD_KEYS,
+		 load_cycles / LOAD_KEYS);
+}
+
+void test_main(void)
+{
+	int rc;
+
+	rc = settings_subsys_init();
+	zassert_equal(rc, 0, "subsys init failed");
+	rc = settings_register(&dyn_handler);
+	zassert_equal(rc, 0, "can't register dyn handler");
+	rc = settings_register(&dyn_mesh_handler);
+	zassert_equal(rc, 0, "can't register dyn mesh handler");
+
+	ztest_test_suite(settings_handler_lookup,
+			 ztest_unit_test(test_handler_lookup),
+			 ztest_unit_test(test_handler_lookup_load)
+			);
+	ztest_run_test_suite(settings_handler_lookup);
+}
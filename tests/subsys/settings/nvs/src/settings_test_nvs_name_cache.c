@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <storage/flash_map.h>
+#include <drivers/flash.h>
+
+#include "settings_test.h"
+#include "settings/settings_nvs.h"
+#include "settings_priv.h"
+
+#define NAME_CACHE_TEST_NAMES 12
+
+static struct settings_nvs cf;
+
+static int name_cache_loader(const char *key, size_t len,
+			     settings_read_cb read_cb, void *cb_arg,
+			     void *param)
+{
+	u32_t *loaded = param;
+	u32_t val;
+	int rc;
+
+	rc = read_cb(cb_arg, &val, sizeof(val));
+	zassert_equal(rc, sizeof(val), "can't read value of %s", key);
+	zassert_equal(strncmp(key, "nc/k", 4), 0, "unexpected name %s", key);
+
+	loaded[strtoul(key + 4, NULL, 10)] = val;
+
+	return 0;
+}
+
+static void name_cache_load(u32_t *loaded)
+{
+	struct settings_load_arg arg = {
+		.cb = name_cache_loader,
+		.param = loaded,
+	};
+	int rc;
+
+	rc = cf.cf_store.cs_itf->csi_load(&cf.cf_store, &arg);
+	zassert_equal(rc, 0, "can't load settings");
+}
+
+static void name_cache_save(int idx, u32_t val)
+{
+	char name[16];
+	int rc;
+
+	snprintf(name, sizeof(name), "nc/k%d", idx);
+	rc = cf.cf_store.cs_itf->csi_save(&cf.cf_store, name,
+					  (const char *)&val,
+					  val ? sizeof(val) : 0);
+	zassert_equal(rc, 0, "can't save %s", name);
+}
+
+/* count the names stored in NVS, a name saved twice would count twice */
+static int name_cache_stored_names(void)
+{
+	char name[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+	int cnt = 0;
+
+	for (u16_t id = NVS_NAMECNT_ID + 1; id <= cf.last_name_id; id++) {
+		if (nvs_read(&cf.cf_nvs, id, name, sizeof(name)) > 0) {
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+static void name_cache_check(int names, const u32_t *expected)
+{
+	u32_t loaded[2 * NAME_CACHE_TEST_NAMES] = { 0 };
+
+	name_cache_load(loaded);
+	zassert_equal(name_cache_stored_names(), names,
+		      "wrong number of stored names");
+	zassert_mem_equal(loaded, expected, sizeof(loaded),
+			  "wrong values loaded");
+}
+
+void test_config_nvs_name_cache(void)
+{
+	const struct flash_area *fa;
+	struct flash_pages_info info;
+	u32_t expected[2 * NAME_CACHE_TEST_NAMES] = { 0 };
+	u16_t last_name_id;
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	zassert_equal(rc, 0, "can't open storage area");
+	rc = flash_get_page_info_by_offs(
+		device_get_binding(fa->fa_dev_name), fa->fa_off, &info);
+	zassert_equal(rc, 0, "can't get page info");
+
+	cf.cf_nvs.offset = fa->fa_off;
+	cf.cf_nvs.sector_size = info.size;
+	cf.cf_nvs.sector_count = MIN(fa->fa_size / info.size, 4);
+	cf.flash_dev_name = fa->fa_dev_name;
+	cf.cf_store.cs_itf = NULL;
+
+	rc = settings_nvs_backend_init(&cf);
+	zassert_equal(rc, 0, "can't init nvs backend");
+	rc = nvs_clear(&cf.cf_nvs);
+	zassert_equal(rc, 0, "can't clear nvs");
+	rc = settings_nvs_backend_init(&cf);
+	zassert_equal(rc, 0, "can't init nvs backend");
+
+	/* use the backend interface without registering the backend */
+	settings_nvs_dst(&cf);
+	config_wipe_srcs();
+
+	for (int i = 0; i < NAME_CACHE_TEST_NAMES; i++) {
+		name_cache_save(i, i + 1);
+		expected[i] = i + 1;
+	}
+
+	/* the load fills the cache */
+	name_cache_check(NAME_CACHE_TEST_NAMES, expected);
+#ifdef CONFIG_SETTINGS_NVS_NAME_CACHE
+	zassert_equal(cf.cache_complete,
+		      NAME_CACHE_TEST_NAMES <= CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE,
+		      "wrong cache state after load");
+#endif
+
+	/* updates must find the existing names */
+	last_name_id = cf.last_name_id;
+	for (int i = 0; i < NAME_CACHE_TEST_NAMES; i++) {
+		name_cache_save(i, 100 + i);
+		expected[i] = 100 + i;
+	}
+	zassert_equal(cf.last_name_id, last_name_id, "names were added");
+	name_cache_check(NAME_CACHE_TEST_NAMES, expected);
+
+	/* delete an entry in the middle and the last one */
+	name_cache_save(3, 0);
+	expected[3] = 0;
+	name_cache_save(NAME_CACHE_TEST_NAMES - 1, 0);
+	expected[NAME_CACHE_TEST_NAMES - 1] = 0;
+	zassert_equal(cf.last_name_id, last_name_id - 1,
+		      "last name id not updated");
+	name_cache_check(NAME_CACHE_TEST_NAMES - 2, expected);
+
+	/* more names than a small cache can hold */
+	for (int i = NAME_CACHE_TEST_NAMES; i < 2 * NAME_CACHE_TEST_NAMES;
+	     i++) {
+		name_cache_save(i, i + 1);
+		expected[i] = i + 1;
+	}
+	for (int i = 0; i < 2 * NAME_CACHE_TEST_NAMES; i++) {
+		if (expected[i]) {
+			name_cache_save(i, 200 + i);
+			expected[i] = 200 + i;
+		}
+	}
+	name_cache_check(2 * NAME_CACHE_TEST_NAMES - 2, expected);
+
+	/* the cache is rebuilt after a reboot */
+	rc = settings_nvs_backend_init(&cf);
+	zassert_equal(rc, 0, "can't init nvs backend");
+	name_cache_check(2 * NAME_CACHE_TEST_NAMES - 2, expected);
+	name_cache_save(3, 1000);
+	expected[3] = 1000;
+	name_cache_check(2 * NAME_CACHE_TEST_NAMES - 1, expected);
+}
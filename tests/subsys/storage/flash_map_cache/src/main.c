@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2020 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <drivers/flash.h>
+#include <storage/flash_map.h>
+
+#define PAGE_SIZE CONFIG_FLASH_MAP_CACHE_PAGE_SIZE
+#define TIMED_READS 100
+
+static const struct flash_area *fa;
+static struct device *flash_dev;
+static u8_t wd[PAGE_SIZE];
+static u8_t rd[PAGE_SIZE];
+
+static void erase_area(void)
+{
+	int rc;
+
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	zassert_equal(rc, 0, "flash_area_erase() fail");
+}
+
+static bool is_erased(const u8_t *buf, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (buf[i] != 0xff) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void test_flash_map_cache_read(void)
+{
+	struct flash_area_cache_stats stats;
+	int rc;
+
+	erase_area();
+
+	(void)memset(wd, 0x5a, sizeof(wd));
+	rc = flash_area_write(fa, 0, wd, 64);
+	zassert_equal(rc, 0, "flash_area_write() fail");
+
+	flash_area_cache_stats_reset();
+
+	for (int i = 0; i < 2; i++) {
+		(void)memset(rd, 0, sizeof(rd));
+		rc = flash_area_read(fa, 8, rd, 16);
+		zassert_equal(rc, 0, "flash_area_read() fail");
+		zassert_mem_equal(rd, wd, 16, "read data != write data");
+	}
+
+	flash_area_cache_stats_get(&stats);
+	if (IS_ENABLED(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)) {
+		/* the write brought the page in */
+		zassert_equal(stats.hits, 2, "wrong hits %u", stats.hits);
+		zassert_equal(stats.misses, 0, "wrong misses %u",
+			      stats.misses);
+	} else {
+		zassert_equal(stats.hits, 1, "wrong hits %u", stats.hits);
+		zassert_equal(stats.misses, 1, "wrong misses %u",
+			      stats.misses);
+	}
+
+	/* a read across a page boundary uses both pages */
+	rc = flash_area_write(fa, PAGE_SIZE, wd, 64);
+	zassert_equal(rc, 0, "flash_area_write() fail");
+	rc = flash_area_read(fa, PAGE_SIZE - 32, rd, 64);
+	zassert_equal(rc, 0, "flash_area_read() fail");
+	zassert_true(is_erased(rd, 32), "unexpected data");
+	zassert_mem_equal(&rd[32], wd, 32, "read data != write data");
+}
+
+void test_flash_map_cache_lru(void)
+{
+	struct flash_area_cache_stats stats;
+	static const u8_t pages[] = { 0, 1, 2, 3, 0, 4, 0, 1 };
+	int rc;
+
+	zassert_equal(CONFIG_FLASH_MAP_CACHE_PAGES, 4, "test expects 4 pages");
+
+	erase_area();
+	flash_area_cache_stats_reset();
+
+	for (int i = 0; i < ARRAY_SIZE(pages); i++) {
+		rc = flash_area_read(fa, pages[i] * PAGE_SIZE, rd, 4);
+		zassert_equal(rc, 0, "flash_area_read() fail");
+	}
+
+	/* page 4 replaces page 1, page 1 then replaces page 2 */
+	flash_area_cache_stats_get(&stats);
+	zassert_equal(stats.hits, 2, "wrong hits %u", stats.hits);
+	zassert_equal(stats.misses, 6, "wrong misses %u", stats.misses);
+	zassert_equal(stats.evictions, 2, "wrong evictions %u",
+		      stats.evictions);
+}
+
+void test_flash_map_cache_write_back(void)
+{
+	struct flash_area_cache_stats stats;
+	size_t unit;
+	int rc;
+
+	if (!IS_ENABLED(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)) {
+		ztest_test_skip();
+		return;
+	}
+
+	erase_area();
+
+	for (int i = 0; i < sizeof(wd); i++) {
+		wd[i] = i;
+	}
+
+	/* adjacent writes of whole program units */
+	unit = MAX(flash_area_align(fa), 8);
+	for (size_t off = 0; off < 128; off += unit) {
+		rc = flash_area_write(fa, off, &wd[off], unit);
+		zassert_equal(rc, 0, "flash_area_write() fail");
+	}
+	rc = flash_area_write(fa, 192, &wd[192], unit);
+	zassert_equal(rc, 0, "flash_area_write() fail");
+
+	/* the device has not been written yet */
+	rc = flash_read(flash_dev, fa->fa_off, rd, PAGE_SIZE);
+	zassert_equal(rc, 0, "flash_read() fail");
+	zassert_true(is_erased(rd, PAGE_SIZE), "device written before flush");
+
+	rc = flash_area_read(fa, 0, rd, 128);
+	zassert_equal(rc, 0, "flash_area_read() fail");
+	zassert_mem_equal(rd, wd, 128, "read data != write data");
+
+	flash_area_cache_stats_reset();
+	rc = flash_area_flush(fa);
+	zassert_equal(rc, 0, "flash_area_flush() fail");
+
+	flash_area_cache_stats_get(&stats);
+	zassert_equal(stats.write_backs, 2, "writes not coalesced (%u)",
+		      stats.write_backs);
+
+	rc = flash_read(flash_dev, fa->fa_off, rd, PAGE_SIZE);
+	zassert_equal(rc, 0, "flash_read() fail");
+	zassert_mem_equal(rd, wd, 128, "device data != write data");
+	zassert_true(is_erased(&rd[128], 64), "unexpected device data");
+	zassert_mem_equal(&rd[192], &wd[192], unit,
+			  "device data != write data");
+
+	/* nothing left to write */
+	rc = flash_area_flush(fa);
+	zassert_equal(rc, 0, "flash_area_flush() fail");
+	flash_area_cache_stats_get(&stats);
+	zassert_equal(stats.write_backs, 2, "page flushed twice");
+}
+
+void test_flash_map_cache_erase(void)
+{
+	int rc;
+
+	erase_area();
+
+	(void)memset(wd, 0xa5, sizeof(wd));
+	rc = flash_area_write(fa, 0, wd, sizeof(wd));
+	zassert_equal(rc, 0, "flash_area_write() fail");
+	rc = flash_area_read(fa, 0, rd, sizeof(rd));
+	zassert_equal(rc, 0, "flash_area_read() fail");
+	zassert_mem_equal(rd, wd, sizeof(rd), "read data != write data");
+
+	/* written data, flushed or not, is gone */
+	erase_area();
+
+	rc = flash_area_read(fa, 0, rd, sizeof(rd));
+	zassert_equal(rc, 0, "flash_area_read() fail");
+	zassert_true(is_erased(rd, sizeof(rd)), "cached data not erased");
+
+	rc = flash_area_flush(fa);
+	zassert_equal(rc, 0, "flash_area_flush() fail");
+	rc = flash_read(flash_dev, fa->fa_off, rd, sizeof(rd));
+	zassert_equal(rc, 0, "flash_read() fail");
+	zassert_true(is_erased(rd, sizeof(rd)), "device not erased");
+}
+
+void test_flash_map_cache_erase_flush(void)
+{
+	struct flash_pages_info info;
+	int rc;
+
+	if (!IS_ENABLED(CONFIG_FLASH_MAP_CACHE_WRITE_BACK)) {
+		ztest_test_skip();
+		return;
+	}
+
+	erase_area();
+
+	(void)memset(wd, 0x3c, sizeof(wd));
+	rc = flash_area_write(fa, 0, wd, sizeof(wd));
+	zassert_equal(rc, 0, "flash_area_write() fail");
+
+	/* erasing the last sector writes back the rest of the area */
+	rc = flash_get_page_info_by_offs(flash_dev,
+					 fa->fa_off + fa->fa_size - 1, &info);
+	zassert_equal(rc, 0, "flash_get_page_info_by_offs() fail");
+	zassert_true(info.size < fa->fa_size, "area of a single sector");
+
+	rc = flash_area_erase(fa, fa->fa_size - info.size, info.size);
+	zassert_equal(rc, 0, "flash_area_erase() fail");
+
+	rc = flash_read(flash_dev, fa->fa_off, rd, sizeof(rd));
+	zassert_equal(rc, 0, "flash_read() fail");
+	zassert_mem_equal(rd, wd, sizeof(rd), "data not written back");
+}
+
+void test_flash_map_cache_timing(void)
+{
+	u32_t start, cached, direct;
+	int rc;
+
+	erase_area();
+
+	/* fill the cache */
+	rc = flash_area_read(fa, 0, rd, 16);
+	zassert_equal(rc, 0, "flash_area_read() fail");
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < TIMED_READS; i++) {
+		(void)flash_area_read(fa, 0, rd, 16);
+	}
+	cached = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < TIMED_READS; i++) {
+		(void)flash_read(flash_dev, fa->fa_off, rd, 16);
+	}
+	direct = k_cycle_get_32() - start;
+
+	TC_PRINT("flash_map read cached %u direct %u cycles/read\n",
+		 cached / TIMED_READS, direct / TIMED_READS);
+	zassert_true(cached <= direct, "cached reads slower than device");
+}
+
+void test_main(void)
+{
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	zassert_equal(rc, 0, "flash_area_open() fail");
+	flash_dev = flash_area_get_device(fa);
+	zassert_not_null(flash_dev, "no flash device");
+
+	ztest_test_suite(test_flash_map_cache,
+			 ztest_unit_test(test_flash_map_cache_read),
+			 ztest_unit_test(test_flash_map_cache_lru),
+			 ztest_unit_test(test_flash_map_cache_write_back),
+			 ztest_unit_test(test_flash_map_cache_erase),
+			 ztest_unit_test(test_flash_map_cache_erase_flush),
+			 ztest_unit_test(test_flash_map_cache_timing)
+			);
+	ztest_run_test_suite(test_flash_map_cache);
+}